@@ -22,6 +22,7 @@
 #include "adt/Casts.h"
 #include "adt/Invariant.h"
 #include "common/Common.h"
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -91,8 +92,10 @@ constexpr std::array<uint64_t, 4> NumConsecutive0xFF00Frequency = {0, 22513031,
 #pragma GCC diagnostic ignored "-Wstack-usage="
 __attribute__((noinline)) __attribute__((visibility("default")))
 JPEGStuffedByteStreamGenerator::JPEGStuffedByteStreamGenerator(
-    const int64_t numBytesMax, bool AppendStuffingByte) {
+    const int64_t numBytesMax, bool AppendStuffingByte,
+    int FFDensityMultiplier) {
   invariant(numBytesMax > 0);
+  invariant(FFDensityMultiplier > 0);
   const auto expectedOverhead = roundUpDivisionSafe(numBytesMax, 100); // <=1%
   dataStorage.reserve(implicit_cast<size_t>(numBytesMax + expectedOverhead));
 
@@ -104,8 +107,9 @@ JPEGStuffedByteStreamGenerator::JPEGStuffedByteStreamGenerator(
   constexpr uint64_t ControlSequenceStartWeight = ByteFrequency.back();
 
   std::bernoulli_distribution controlSequenceStartDistribution(
-      implicit_cast<double>(ControlSequenceStartWeight) /
-      implicit_cast<double>(TotalWeight));
+      std::min(1.0, implicit_cast<double>(FFDensityMultiplier) *
+                        implicit_cast<double>(ControlSequenceStartWeight) /
+                        implicit_cast<double>(TotalWeight)));
   std::discrete_distribution<uint8_t> numConsecutive0xFF00Distribution(
       NumConsecutive0xFF00Frequency.begin(),
       NumConsecutive0xFF00Frequency.end());
@@ -39,8 +39,11 @@ struct JPEGStuffedByteStreamGenerator final {
     return {dataStorage.data(), implicit_cast<int>(dataStorage.size())};
   }
 
+  // The 0xFF bytes are FFDensityMultiplier times as frequent as they are
+  // in an average JPEG byte stream.
   explicit JPEGStuffedByteStreamGenerator(int64_t numBytesMax,
-                                          bool AppendStuffingByte);
+                                          bool AppendStuffingByte,
+                                          int FFDensityMultiplier = 1);
 };
 
 struct NonJPEGByteStreamGenerator final {
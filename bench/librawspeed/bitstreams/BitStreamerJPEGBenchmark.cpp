@@ -25,8 +25,10 @@
 #include "bench/Common.h"
 #include "bitstreams/BitStreamJPEGUtils.h"
 #include "bitstreams/BitStreamerMSB.h"
+#include "bitstreams/JPEGUnstuffer.h"
 #include <cassert>
 #include <cstdint>
+#include <type_traits>
 #include <benchmark/benchmark.h>
 
 #ifndef NDEBUG
@@ -37,7 +39,12 @@ namespace rawspeed {
 
 namespace {
 
-template <typename T> void BM(benchmark::State& state, bool Stuffed) {
+// Removes the stuffing of the whole stream up front, and then reads it
+// with the BitStreamerMSB.
+struct JPEGUnstufferMSB final {};
+
+template <typename T>
+void BM(benchmark::State& state, bool Stuffed, int FFDensityMultiplier = 1) {
   int64_t numBytes = state.range(0);
   assert(numBytes > 0);
   assert(numBytes <= std::numeric_limits<int>::max());
@@ -46,7 +53,8 @@ template <typename T> void BM(benchmark::State& state, bool Stuffed) {
   Optional<NonJPEGByteStreamGenerator> genUnstuffed;
   Optional<Array1DRef<const uint8_t>> input;
   if (Stuffed) {
-    genStuffed.emplace(numBytes, /*AppendStuffingByte=*/true);
+    genStuffed.emplace(numBytes, /*AppendStuffingByte=*/true,
+                       FFDensityMultiplier);
     numBytes = genStuffed->numBytesGenerated;
     input = genStuffed->getInput();
   } else {
@@ -56,9 +64,7 @@ template <typename T> void BM(benchmark::State& state, bool Stuffed) {
   }
   benchmark::DoNotOptimize(input->begin());
 
-  for (auto _ : state) {
-    T bs(*input);
-
+  auto readAll = [numBytes](auto& bs) {
     constexpr int MaxGetBits = 32;
     int processedBytes = 0;
     for (processedBytes = 0; processedBytes != numBytes;
@@ -67,6 +73,18 @@ template <typename T> void BM(benchmark::State& state, bool Stuffed) {
       benchmark::DoNotOptimize(bits);
     }
     invariant(numBytes == processedBytes);
+  };
+
+  JPEGUnstuffer unstuffer;
+  for (auto _ : state) {
+    if constexpr (std::is_same_v<T, JPEGUnstufferMSB>) {
+      const UnstuffedJPEGSegment segment = unstuffer.unstuff(*input);
+      BitStreamerMSB bs(segment.bytes);
+      readAll(bs);
+    } else {
+      T bs(*input);
+      readAll(bs);
+    }
   }
 
   state.SetComplexityN(numBytes);
@@ -117,8 +135,20 @@ void CustomArguments(benchmark::internal::Benchmark* b) {
 
 BENCHMARK_TEMPLATE1_CAPTURE(BM, BitStreamerJPEG, Stuffed, true)
     ->Apply(CustomArguments);
+BENCHMARK_TEMPLATE1_CAPTURE(BM, BitStreamerJPEG, Stuffed8x, true, 8)
+    ->Apply(CustomArguments);
+BENCHMARK_TEMPLATE1_CAPTURE(BM, BitStreamerJPEG, Stuffed64x, true, 64)
+    ->Apply(CustomArguments);
 BENCHMARK_TEMPLATE1_CAPTURE(BM, BitStreamerJPEG, Unstuffed, false)
     ->Apply(CustomArguments);
+BENCHMARK_TEMPLATE1_CAPTURE(BM, JPEGUnstufferMSB, Stuffed, true)
+    ->Apply(CustomArguments);
+BENCHMARK_TEMPLATE1_CAPTURE(BM, JPEGUnstufferMSB, Stuffed8x, true, 8)
+    ->Apply(CustomArguments);
+BENCHMARK_TEMPLATE1_CAPTURE(BM, JPEGUnstufferMSB, Stuffed64x, true, 64)
+    ->Apply(CustomArguments);
+BENCHMARK_TEMPLATE1_CAPTURE(BM, JPEGUnstufferMSB, Unstuffed, false)
+    ->Apply(CustomArguments);
 BENCHMARK_TEMPLATE1_CAPTURE(BM, BitStreamerMSB, Unstuffed, false)
     ->Apply(CustomArguments);
 
@@ -0,0 +1,201 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "bench/Common.h"
+#include "bitstreams/BitStreamerMSB.h"
+#include "codes/AbstractPrefixCode.h"
+#include "codes/HuffmanCode.h"
+#include "codes/PrefixCode.h"
+#include "codes/PrefixCodeDecoder.h"
+#include "io/Buffer.h"
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+using rawspeed::BaselineCodeTag;
+
+namespace {
+
+// The code tables the LJpeg-family decompressors actually use. Every table
+// is the 16 entries of codes per bit length, followed by the code values.
+struct NEF12Lossless final {
+  static constexpr std::array<uint8_t, 16> nCodesPerLength = {
+      0, 1, 4, 2, 3, 1, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  static constexpr std::array<uint8_t, 13> codeValues = {
+      5, 4, 6, 3, 7, 2, 8, 1, 9, 0, 10, 11, 12};
+};
+
+struct NEF14Lossless final {
+  static constexpr std::array<uint8_t, 16> nCodesPerLength = {
+      0, 1, 4, 2, 2, 3, 1, 2, 0, 0, 0, 0, 0, 0, 0, 0};
+  static constexpr std::array<uint8_t, 15> codeValues = {
+      7, 6, 8, 5, 9, 4, 10, 3, 11, 12, 2, 0, 1, 13, 14};
+};
+
+struct NEF14Lossy final {
+  static constexpr std::array<uint8_t, 16> nCodesPerLength = {
+      0, 1, 4, 3, 1, 1, 1, 1, 1, 2, 0, 0, 0, 0, 0, 0};
+  static constexpr std::array<uint8_t, 15> codeValues = {
+      5, 6, 4, 7, 8, 3, 9, 2, 1, 0, 10, 11, 12, 13, 14};
+};
+
+struct PEF final {
+  static constexpr std::array<uint8_t, 16> nCodesPerLength = {
+      0, 2, 3, 1, 1, 1, 1, 1, 1, 2, 0, 0, 0, 0, 0, 0};
+  static constexpr std::array<uint8_t, 13> codeValues = {3, 4, 2, 5, 1, 6, 0,
+                                                         7, 8, 9, 10, 11, 12};
+};
+
+// ITU T.81 Annex K.3, the DC luminance table, with the 12..16-bit categories
+// appended the way the lossless encoders do it.
+struct LJpeg16 final {
+  static constexpr std::array<uint8_t, 16> nCodesPerLength = {
+      0, 1, 5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0};
+  static constexpr std::array<uint8_t, 17> codeValues = {
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+};
+
+template <typename Table> rawspeed::HuffmanCode<BaselineCodeTag> getCode() {
+  rawspeed::HuffmanCode<BaselineCodeTag> hc;
+  const auto count = hc.setNCodesPerLength(
+      rawspeed::Buffer(Table::nCodesPerLength.data(),
+                       rawspeed::implicit_cast<rawspeed::Buffer::size_type>(
+                           Table::nCodesPerLength.size())));
+  assert(count == Table::codeValues.size());
+  hc.setCodeValues(rawspeed::Array1DRef<const uint8_t>(
+      Table::codeValues.data(), rawspeed::implicit_cast<int>(count)));
+  return hc;
+}
+
+// Encodes numSymbols random symbols, each one with the probability of
+// 2^(-code length), which is the distribution the code is optimal for,
+// followed by uniformly random difference bits.
+std::vector<uint8_t> genStream(const rawspeed::PrefixCode<BaselineCodeTag>& pc,
+                               int numSymbols) {
+  std::vector<uint8_t> out;
+  uint64_t cache = 0;
+  int fillLevel = 0;
+  auto put = [&out, &cache, &fillLevel](uint32_t bits, int len) {
+    cache = (cache << len) | bits;
+    fillLevel += len;
+    for (; fillLevel >= 8; fillLevel -= 8)
+      out.push_back(static_cast<uint8_t>(cache >> (fillLevel - 8)));
+  };
+
+  uint32_t seed = 1;
+  auto rng = [&seed]() {
+    seed = (seed * 1103515245U) + 12345U;
+    return seed >> 16U;
+  };
+
+  for (int i = 0; i < numSymbols;) {
+    const uint32_t u = rng();
+    for (int s = 0; s != static_cast<int>(pc.symbols.size()); ++s) {
+      const auto& symbol = pc.symbols[s];
+      if (u >> (16 - symbol.code_len) != symbol.code)
+        continue;
+      put(symbol.code, symbol.code_len);
+      if (const int diff_l = pc.codeValues[s]; diff_l != 16)
+        put(rng() & ((1U << diff_l) - 1U), diff_l);
+      ++i;
+      break;
+    }
+  }
+  put(0, 7);
+  out.resize(out.size() + 8);
+  return out;
+}
+
+template <typename Table, typename Decoder>
+inline void BM_PrefixCodeDecoder(benchmark::State& state) {
+  const int numSymbols = rawspeed::implicit_cast<int>(state.range(0));
+
+  const auto stream = genStream(
+      getCode<Table>().operator rawspeed::PrefixCode<BaselineCodeTag>(),
+      numSymbols);
+  const rawspeed::Array1DRef<const uint8_t> input(
+      stream.data(), rawspeed::implicit_cast<int>(stream.size()));
+
+  Decoder ht(getCode<Table>());
+  ht.setup(/*fullDecode_=*/true, /*fixDNGBug16_=*/false);
+
+  // Like the decompressors do, decode into a buffer. A lookup may produce
+  // more differences than there is space left, so leave some slack.
+  std::vector<int> diffs(numSymbols + 8);
+  for (auto _ : state) {
+    rawspeed::BitStreamerMSB bs(input);
+    if constexpr (requires { Decoder::MaxSymbolsPerLookup; }) {
+      for (int i = 0; i < numSymbols;) {
+        std::array<int, Decoder::MaxSymbolsPerLookup> batch;
+        const int num = ht.decodeDifferences(bs, batch);
+        for (int j = 0; j != Decoder::MaxSymbolsPerLookup; ++j)
+          diffs[i + j] = batch[j];
+        i += num;
+      }
+    } else {
+      for (int i = 0; i != numSymbols; ++i)
+        diffs[i] = ht.decodeDifference(bs);
+    }
+    benchmark::DoNotOptimize(diffs.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetComplexityN(numSymbols);
+  state.SetItemsProcessed(state.complexity_length_n() * state.iterations());
+}
+
+inline void CustomArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kMicrosecond);
+  b->Arg(benchmarkDryRun() ? 1 << 10 : 1 << 22);
+}
+
+template <unsigned Depth>
+using Single = rawspeed::PrefixCodeDecoder<BaselineCodeTag, Depth>;
+
+template <unsigned Depth>
+using Multi = rawspeed::MultiSymbolPrefixCodeDecoder<BaselineCodeTag, Depth>;
+
+#define GEN_DEPTH(Table, Depth)                                                \
+  BENCHMARK_TEMPLATE(BM_PrefixCodeDecoder, Table, Single<Depth>)               \
+      ->Apply(CustomArgs);                                                     \
+  BENCHMARK_TEMPLATE(BM_PrefixCodeDecoder, Table, Multi<Depth>)                \
+      ->Apply(CustomArgs);
+
+#define GEN(Table)                                                             \
+  GEN_DEPTH(Table, 9)                                                          \
+  GEN_DEPTH(Table, 10)                                                         \
+  GEN_DEPTH(Table, 11)                                                         \
+  GEN_DEPTH(Table, 12)                                                         \
+  GEN_DEPTH(Table, 13)                                                         \
+  GEN_DEPTH(Table, 14)
+
+GEN(NEF12Lossless)
+GEN(NEF14Lossless)
+GEN(NEF14Lossy)
+GEN(PEF)
+GEN(LJpeg16)
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,113 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "adt/Array1DRef.h"
+#include "adt/Point.h"
+#include "bench/Common.h"
+#include "common/Common.h"
+#include "common/RawImage.h"
+#include <cstdint>
+#include <numeric>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::iPoint2D;
+using rawspeed::RawImage;
+
+namespace {
+
+void BM_GetMinMax(benchmark::State& state) {
+  const auto numValues = static_cast<int>(state.range(0));
+  std::vector<uint16_t> values(numValues);
+  std::iota(values.begin(), values.end(), uint16_t(0));
+
+  for (auto _ : state) {
+    const auto minMax =
+        rawspeed::getMinMax(Array1DRef<const uint16_t>(values.data(),
+                                                       numValues));
+    benchmark::DoNotOptimize(minMax);
+  }
+
+  state.SetComplexityN(numValues);
+  state.SetItemsProcessed(state.complexity_length_n() * state.iterations());
+  state.SetBytesProcessed(sizeof(uint16_t) * state.items_processed());
+}
+
+// The black and white levels of an image without black areas are estimated
+// from the minimum and the maximum of (most of) the image.
+void BM_EstimateBlackWhite(benchmark::State& state) {
+  const iPoint2D dim = areaToRectangle(state.range(0), {3, 2});
+  RawImage mRaw = RawImage::create(dim);
+
+  auto img = mRaw->getU16DataAsUncroppedArray2DRef();
+  for (int row = 0; row < img.height(); row++) {
+    for (int col = 0; col < img.width(); col++)
+      img(row, col) = static_cast<uint16_t>(row + col);
+  }
+  // As the full range is in use, the values are not scaled afterwards.
+  img(img.height() / 2, img.width() / 2) = 0;
+  img(img.height() / 2, (img.width() / 2) + 1) = 65535;
+
+  for (auto _ : state) {
+    mRaw->blackLevel = -1;
+    mRaw->whitePoint.reset();
+    mRaw->scaleBlackWhite();
+  }
+
+  state.SetComplexityN(dim.area());
+  state.SetItemsProcessed(state.complexity_length_n() * state.iterations());
+  state.SetBytesProcessed(sizeof(uint16_t) * state.items_processed());
+}
+
+inline void MinMaxArgs(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kMicrosecond);
+
+  if (benchmarkDryRun()) {
+    static constexpr int L2dByteSize = 512U * (1U << 10U);
+    b->Arg(L2dByteSize / sizeof(uint16_t));
+    return;
+  }
+
+  b->RangeMultiplier(2);
+  b->Range(1, 1 * 1024 * 1024)->Complexity(benchmark::oN);
+}
+
+inline void ImageArgs(benchmark::internal::Benchmark* b) {
+  b->MeasureProcessCPUTime();
+  b->UseRealTime();
+  b->Unit(benchmark::kMillisecond);
+
+  // Anything smaller than 500x500 pixels is not sampled at all.
+  if (benchmarkDryRun()) {
+    b->Arg(1024 * 1024);
+    return;
+  }
+
+  b->RangeMultiplier(2);
+  b->Range(1024 * 1024, 128 * 1024 * 1024)->Complexity(benchmark::oN);
+}
+
+BENCHMARK(BM_GetMinMax)->Apply(MinMaxArgs);
+BENCHMARK(BM_EstimateBlackWhite)->Apply(ImageArgs);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -38,6 +38,7 @@
 
 using rawspeed::BitOrder;
 using rawspeed::Buffer;
+using rawspeed::Endianness;
 using rawspeed::UncompressedDecompressor;
 
 namespace {
@@ -82,6 +83,33 @@ inline void BM_UncompressedDecompressor(benchmark::State& state) {
   state.SetBytesProcessed(BPS::value * state.items_processed() / 8);
 }
 
+template <Endianness E>
+inline void BM_Decode12BitRawWithControl(benchmark::State& state) {
+  auto dim = areaToRectangle(state.range(0), {10, 1});
+
+  // Each 10 pixels are followed by a control byte.
+  const int inputPitchBytes = (12 * dim.x / 8) + ((dim.x + 2) / 10);
+
+  auto packedLength = inputPitchBytes * dim.y;
+  const std::vector<uint8_t> buf(packedLength);
+  const rawspeed::ByteStream bs(rawspeed::DataBuffer(
+      Buffer(buf.data(), packedLength), rawspeed::Endianness::little));
+
+  auto mRaw =
+      rawspeed::RawImage::create(dim, rawspeed::RawImageType::UINT16, 1);
+
+  for (auto _ : state) {
+    UncompressedDecompressor d(bs, mRaw,
+                               rawspeed::iRectangle2D({0, 0}, mRaw->dim),
+                               inputPitchBytes, 12, BitOrder::MSB);
+    d.decode12BitRawWithControl<E>();
+  }
+
+  state.SetComplexityN(dim.area());
+  state.SetItemsProcessed(state.complexity_length_n() * state.iterations());
+  state.SetBytesProcessed(12 * state.items_processed() / 8);
+}
+
 inline void CustomArgs(benchmark::internal::Benchmark* b) {
   b->Unit(benchmark::kMicrosecond);
 
@@ -133,6 +161,11 @@ GEN_BO(BitOrder::MSB)
 GEN_U(BitOrder::MSB16)
 GEN_U(BitOrder::MSB32)
 
+BENCHMARK_TEMPLATE(BM_Decode12BitRawWithControl, Endianness::little)
+    ->Apply(CustomArgs);
+BENCHMARK_TEMPLATE(BM_Decode12BitRawWithControl, Endianness::big)
+    ->Apply(CustomArgs);
+
 } // namespace
 
 BENCHMARK_MAIN();
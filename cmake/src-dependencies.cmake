@@ -114,6 +114,11 @@ else()
 endif()
 add_feature_info("OpenMP-based threading" HAVE_OPENMP "used for parallelization of the library")
 
+# The in-tree ThreadPool executor is always available.
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
+target_link_libraries(rawspeed PUBLIC Threads::Threads)
+
 unset(HAVE_PUGIXML)
 if(WITH_PUGIXML)
   message(STATUS "Looking for pugixml")
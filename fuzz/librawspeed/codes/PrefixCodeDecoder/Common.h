@@ -28,6 +28,7 @@
 #include "common/RawspeedException.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <type_traits>
@@ -164,3 +165,37 @@ static T createPrefixCodeDecoder(rawspeed::ByteStream& bs) {
 
   return std::move(*ht);
 }
+
+// Decodes the symbols one by one, but if the decoder is able to decode several
+// differences per lookup, goes through that interface instead, so that it gets
+// cross-checked against the single-symbol decoding too.
+template <typename HT, bool IsFullDecode> class SymbolDecoder final {
+  const HT& ht;
+
+  static constexpr bool IsMultiSymbol =
+      IsFullDecode && requires { HT::MaxSymbolsPerLookup; };
+
+  struct Empty final {};
+  struct Pending final {
+    std::array<int, HT::MaxSymbolsPerLookup> diffs;
+    int num = 0;
+    int next = 0;
+  };
+  [[no_unique_address]] std::conditional_t<IsMultiSymbol, Pending, Empty>
+      pending;
+
+public:
+  explicit SymbolDecoder(const HT& ht_) : ht(ht_) {}
+
+  template <typename Pump> int decode(Pump& bits) {
+    if constexpr (IsMultiSymbol) {
+      if (pending.next == pending.num) {
+        pending.num = ht.decodeDifferences(bits, pending.diffs);
+        pending.next = 0;
+      }
+      assert(pending.next < pending.num);
+      return pending.diffs[pending.next++];
+    } else
+      return ht.template decode<Pump, IsFullDecode>(bits);
+  }
+};
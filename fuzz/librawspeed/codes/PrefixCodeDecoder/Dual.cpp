@@ -32,10 +32,11 @@
 #include "bitstreams/BitStreamerMSB32.h"
 #include "codes/PrefixCodeDecoder.h" // IWYU pragma: keep
 #include "codes/PrefixCodeDecoder/Common.h"
-#include "codes/PrefixCodeLUTDecoder.h"    // IWYU pragma: keep
-#include "codes/PrefixCodeLookupDecoder.h" // IWYU pragma: keep
-#include "codes/PrefixCodeTreeDecoder.h"   // IWYU pragma: keep
-#include "codes/PrefixCodeVectorDecoder.h" // IWYU pragma: keep
+#include "codes/PrefixCodeLUTDecoder.h"      // IWYU pragma: keep
+#include "codes/PrefixCodeLookupDecoder.h"   // IWYU pragma: keep
+#include "codes/PrefixCodeMultiLUTDecoder.h" // IWYU pragma: keep
+#include "codes/PrefixCodeTreeDecoder.h"     // IWYU pragma: keep
+#include "codes/PrefixCodeVectorDecoder.h"   // IWYU pragma: keep
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
@@ -57,6 +58,9 @@ void workloop(rawspeed::Array1DRef<const uint8_t> input, const HT0& ht0,
   Pump bits0(input);
   Pump bits1(input);
 
+  SymbolDecoder<HT0, IsFullDecode> decoder0(ht0);
+  SymbolDecoder<HT1, IsFullDecode> decoder1(ht1);
+
   while (true) {
     int decoded0;
     int decoded1;
@@ -65,7 +69,7 @@ void workloop(rawspeed::Array1DRef<const uint8_t> input, const HT0& ht0,
     bool failure1 = false;
 
     try {
-      decoded1 = ht1.template decode<decltype(bits1), IsFullDecode>(bits1);
+      decoded1 = decoder1.decode(bits1);
     } catch (const rawspeed::IOException&) {
       // For now, let's ignore stream depleteon issues.
       throw;
@@ -74,7 +78,7 @@ void workloop(rawspeed::Array1DRef<const uint8_t> input, const HT0& ht0,
     }
 
     try {
-      decoded0 = ht0.template decode<decltype(bits0), IsFullDecode>(bits0);
+      decoded0 = decoder0.decode(bits0);
     } catch (const rawspeed::IOException&) {
       // For now, let's ignore stream depleteon issues.
       throw;
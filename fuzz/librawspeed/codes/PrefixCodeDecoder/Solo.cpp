@@ -29,10 +29,11 @@
 #include "bitstreams/BitStreamerMSB32.h"
 #include "codes/PrefixCodeDecoder.h" // IWYU pragma: keep
 #include "codes/PrefixCodeDecoder/Common.h"
-#include "codes/PrefixCodeLUTDecoder.h"    // IWYU pragma: keep
-#include "codes/PrefixCodeLookupDecoder.h" // IWYU pragma: keep
-#include "codes/PrefixCodeTreeDecoder.h"   // IWYU pragma: keep
-#include "codes/PrefixCodeVectorDecoder.h" // IWYU pragma: keep
+#include "codes/PrefixCodeLUTDecoder.h"      // IWYU pragma: keep
+#include "codes/PrefixCodeLookupDecoder.h"   // IWYU pragma: keep
+#include "codes/PrefixCodeMultiLUTDecoder.h" // IWYU pragma: keep
+#include "codes/PrefixCodeTreeDecoder.h"     // IWYU pragma: keep
+#include "codes/PrefixCodeVectorDecoder.h"   // IWYU pragma: keep
 #include "common/RawspeedException.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
@@ -51,8 +52,9 @@ namespace {
 template <typename Pump, bool IsFullDecode, typename HT>
 void workloop(rawspeed::Array1DRef<const uint8_t> input, const HT& ht) {
   Pump bits(input);
+  SymbolDecoder<HT, IsFullDecode> decoder(ht);
   while (true)
-    ht.template decode<Pump, IsFullDecode>(bits);
+    decoder.decode(bits);
   // FIXME: do we need to escape the result to avoid dead code elimination?
 }
 
@@ -26,17 +26,24 @@
 #include "rawspeedconfig.h"
 #include "adt/Mutex.h"
 #include "adt/Point.h"
+#include "common/Cancellation.h"
 #include "common/Common.h"
+#include "common/Executor.h"
 #include "common/RawImage.h"
 #include "common/RawspeedException.h"
+#include "common/ThreadPool.h"
+#include "decoders/BatchDecoder.h"
 #include "decoders/RawDecoder.h"
+#include "io/BlockCachedInput.h"
 #include "io/Buffer.h"
 #include "io/Endianness.h"
 #include "io/FileReader.h"
+#include "io/InputSource.h"
 #include "metadata/BlackArea.h"
 #include "metadata/Camera.h"
 #include "metadata/CameraMetaData.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/CompiledCameraMetaData.h"
 #include "parsers/RawParser.h"
 
 // IWYU pragma: end_exports
@@ -25,6 +25,8 @@
 
 #ifdef HAVE_OPENMP
 #include <omp.h>
+#else
+#include <mutex>
 #endif
 
 namespace rawspeed {
@@ -64,6 +66,8 @@ public:
 #else
 
 class CAPABILITY("mutex") Mutex final {
+  std::mutex mutex;
+
 public:
   explicit Mutex() = default;
 
@@ -77,20 +81,13 @@ public:
   // Acquire/lock this mutex exclusively.  Only one thread can have exclusive
   // access at any one time.  Write operations to guarded data require an
   // exclusive lock.
-  void Lock() const ACQUIRE() {
-    // NOP, since there is no mutex. only here to still check for proper locking
-  }
+  void Lock() ACQUIRE() { mutex.lock(); }
 
   // Release/unlock an exclusive mutex.
-  void Unlock() const RELEASE() {
-    // NOP, since there is no mutex. only here to still check for proper locking
-  }
+  void Unlock() RELEASE() { mutex.unlock(); }
 
   // Try to acquire the mutex.  Returns true on success, and false on failure.
-  bool TryLock() const TRY_ACQUIRE(true) {
-    // NOP, since there is no mutex. only here to still check for proper locking
-    return true;
-  }
+  bool TryLock() TRY_ACQUIRE(true) { return mutex.try_lock(); }
 
   // For negative capabilities.
   const Mutex& operator!() const { return *this; }
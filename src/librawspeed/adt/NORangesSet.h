@@ -69,6 +69,9 @@ public:
   }
 
   [[nodiscard]] std::size_t size() const { return elts.size(); }
+
+  [[nodiscard]] auto begin() const { return elts.begin(); }
+  [[nodiscard]] auto end() const { return elts.end(); }
 };
 
 } // namespace rawspeed
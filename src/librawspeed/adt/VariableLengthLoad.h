@@ -31,6 +31,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <type_traits>
 
 namespace rawspeed {
@@ -98,6 +99,25 @@ inline void variableLengthLoad(Array1DRef<std::byte> out,
   memcpy(out.begin(), &tmp, sizeof(T));
 }
 
+template <typename T>
+  requires std::is_unsigned_v<T>
+inline void variableLengthLoadFromPadded(Array1DRef<std::byte> out,
+                                         Array1DRef<const std::byte> in,
+                                         int inPos) {
+  invariant(out.size() == sizeof(T));
+
+  // In the little-endian order, the bytes past the end are the high ones.
+  auto tmp = getLE<T>(in.begin() + inPos);
+
+  const int numBytesPastEnd =
+      std::clamp(inPos + out.size() - in.size(), 0, out.size());
+  tmp &= logicalRightShiftSafe(std::numeric_limits<T>::max(),
+                               CHAR_BIT * numBytesPastEnd);
+
+  tmp = getLE<T>(&tmp);
+  memcpy(out.begin(), &tmp, sizeof(T));
+}
+
 } // namespace impl
 
 inline void variableLengthLoad(const Array1DRef<std::byte> out,
@@ -128,6 +148,36 @@ inline void variableLengthLoad(const Array1DRef<std::byte> out,
   }
 }
 
+// Same as variableLengthLoad(), but the input must be followed by enough
+// readable tail padding for a full-width load at inPos, so no bounds checks
+// are needed.
+inline void variableLengthLoadFromPadded(const Array1DRef<std::byte> out,
+                                         Array1DRef<const std::byte> in,
+                                         int inPos) {
+  invariant(out.size() != 0);
+  invariant(isPowerOfTwo(out.size()));
+  invariant(out.size() <= 8);
+  invariant(in.size() != 0);
+  invariant(inPos >= 0);
+
+  switch (out.size()) {
+  case 1:
+    impl::variableLengthLoadFromPadded<uint8_t>(out, in, inPos);
+    return;
+  case 2:
+    impl::variableLengthLoadFromPadded<uint16_t>(out, in, inPos);
+    return;
+  case 4:
+    impl::variableLengthLoadFromPadded<uint32_t>(out, in, inPos);
+    return;
+  case 8:
+    impl::variableLengthLoadFromPadded<uint64_t>(out, in, inPos);
+    return;
+  default:
+    __builtin_unreachable();
+  }
+}
+
 inline void variableLengthLoadNaiveViaConditionalLoad(
     Array1DRef<std::byte> out, Array1DRef<const std::byte> in, int inPos) {
   invariant(out.size() != 0);
@@ -150,7 +200,7 @@ inline void variableLengthLoadNaiveViaMemcpy(Array1DRef<std::byte> out,
                                              int inPos) {
   invariant(out.size() != 0);
   invariant(in.size() != 0);
-  invariant(out.size() <= in.size());
+  // NOTE: unlike the other variants, the input may be smaller than output.
   invariant(inPos >= 0);
 
   std::fill(out.begin(), out.end(), std::byte{0x00});
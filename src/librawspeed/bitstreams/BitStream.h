@@ -26,6 +26,7 @@
 #include "adt/Casts.h"
 #include "adt/Invariant.h"
 #include "bitstreams/BitStreams.h"
+#include <climits>
 #include <cstdint>
 
 namespace rawspeed {
@@ -47,6 +48,10 @@ struct BitStreamCacheBase {
   // how many bits could be requested to be filled
   static constexpr int MaxGetBits = bitwidth<uint32_t>();
 
+  // how many bits could be requested to be filled by the wide (bytewise)
+  // refill, which tops up the cache with all the whole bytes that fit.
+  static constexpr int MaxWideGetBits = Size - CHAR_BIT;
+
   void establishClassInvariants() const noexcept;
 };
 
@@ -67,6 +72,19 @@ struct BitStreamCacheLeftInRightOut final : BitStreamCacheBase {
     fillLevel += count;
   }
 
+  // Pushes as many of the low bytes of `bits` as fit (possibly none),
+  // so that at least MaxWideGetBits bits end up in the cache.
+  // Returns how many bytes were pushed.
+  int pushBytes(uint64_t bits) noexcept {
+    establishClassInvariants();
+    const int numBytes = (Size - 1 - fillLevel) / CHAR_BIT;
+    const int count = CHAR_BIT * numBytes;
+    invariant(count <= MaxWideGetBits);
+    push(bits & ((uint64_t(1) << count) - 1U), count);
+    invariant(fillLevel >= MaxWideGetBits);
+    return numBytes;
+  }
+
   [[nodiscard]] uint32_t peek(int count) const noexcept {
     establishClassInvariants();
     invariant(count >= 0);
@@ -77,6 +95,15 @@ struct BitStreamCacheLeftInRightOut final : BitStreamCacheBase {
     return extractLowBits(static_cast<uint32_t>(cache), count);
   }
 
+  [[nodiscard]] uint64_t peekWide(int count) const noexcept {
+    establishClassInvariants();
+    invariant(count >= 0);
+    invariant(count <= MaxWideGetBits);
+    invariant(count != 0);
+    invariant(count <= fillLevel);
+    return extractLowBits(cache, count);
+  }
+
   void skip(int count) noexcept {
     establishClassInvariants();
     invariant(count >= 0);
@@ -116,6 +143,20 @@ struct BitStreamCacheRightInLeftOut final : BitStreamCacheBase {
     fillLevel += count;
   }
 
+  // Pushes as many of the high bytes of `bits` as fit (possibly none),
+  // so that at least MaxWideGetBits bits end up in the cache.
+  // Returns how many bytes were pushed.
+  int pushBytes(uint64_t bits) noexcept {
+    establishClassInvariants();
+    const int numBytes = (Size - 1 - fillLevel) / CHAR_BIT;
+    const int count = CHAR_BIT * numBytes;
+    invariant(count <= MaxWideGetBits);
+    // Two shifts, so that neither one of them is out-of-bounds.
+    push((bits >> (Size - MaxWideGetBits)) >> (MaxWideGetBits - count), count);
+    invariant(fillLevel >= MaxWideGetBits);
+    return numBytes;
+  }
+
   [[nodiscard]] auto peek(int count) const noexcept {
     establishClassInvariants();
     invariant(count >= 0);
@@ -128,6 +169,16 @@ struct BitStreamCacheRightInLeftOut final : BitStreamCacheBase {
                         /*effectiveBitwidth=*/BitStreamCacheBase::Size));
   }
 
+  [[nodiscard]] uint64_t peekWide(int count) const noexcept {
+    establishClassInvariants();
+    invariant(count >= 0);
+    invariant(count <= MaxWideGetBits);
+    invariant(count != 0);
+    invariant(count <= fillLevel);
+    return extractHighBits(cache, count,
+                           /*effectiveBitwidth=*/BitStreamCacheBase::Size);
+  }
+
   void skip(int count) noexcept {
     establishClassInvariants();
     invariant(count >= 0);
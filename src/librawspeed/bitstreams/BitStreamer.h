@@ -29,10 +29,13 @@
 #include "adt/VariableLengthLoad.h"
 #include "bitstreams/BitStream.h"
 #include "bitstreams/BitStreamPosition.h"
+#include "io/Buffer.h"
 #include "io/Endianness.h"
 #include "io/IOException.h"
+#include <algorithm>
 #include <array>
 #include <climits>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
 
@@ -46,15 +49,28 @@ template <typename Tag> struct BitStreamerReplenisherBase {
   using Traits = BitStreamerTraits<Tag>;
   using StreamTraits = BitStreamTraits<Traits::Tag>;
 
+  // The widest load that may be requested from the input.
+  static constexpr int MaxLoadBytes =
+      std::max<int>(BitStreamerTraits<Tag>::MaxProcessBytes, sizeof(uint64_t));
+
+  // We may over-read past-the-end by this much, and then load a full chunk.
+  static constexpr int MaxUsefulTailPadding =
+      3 * BitStreamerTraits<Tag>::MaxProcessBytes;
+
   Array1DRef<const std::byte> input;
   int pos = 0;
 
+  // How many bytes past the end of the input can be loaded (but not used).
+  int tailPadding = 0;
+
   void establishClassInvariants() const noexcept;
 
   BitStreamerReplenisherBase() = delete;
 
-  explicit BitStreamerReplenisherBase(Array1DRef<const std::byte> input_)
-      : input(input_) {
+  explicit BitStreamerReplenisherBase(Array1DRef<const std::byte> input_,
+                                      int tailPadding_ = 0)
+      : input(input_),
+        tailPadding(std::min(tailPadding_, MaxUsefulTailPadding)) {
     if (input.size() < BitStreamerTraits<Tag>::MaxProcessBytes)
       ThrowIOE("Bit stream size is smaller than MaxProcessBytes");
   }
@@ -68,6 +84,8 @@ BitStreamerReplenisherBase<Tag>::establishClassInvariants() const noexcept {
   invariant(pos >= 0);
   invariant(pos % StreamTraits::MinLoadStepByteMultiple == 0);
   // `pos` *could* be out-of-bounds of `input`.
+  invariant(tailPadding >= 0);
+  invariant(tailPadding <= MaxUsefulTailPadding);
 }
 
 template <typename Tag>
@@ -92,28 +110,36 @@ struct BitStreamerForwardSequentialReplenisher final
   void markNumBytesAsConsumed(typename Base::size_type numBytes) {
     Base::establishClassInvariants();
     invariant(numBytes >= 0);
-    invariant(numBytes != 0);
+    // `numBytes` could be zero after a wide refill.
     invariant(numBytes % StreamTraits::MinLoadStepByteMultiple == 0);
     Base::pos += numBytes;
   }
 
-  std::array<std::byte, BitStreamerTraits<Tag>::MaxProcessBytes> getInput() {
+  template <int NumBytes = BitStreamerTraits<Tag>::MaxProcessBytes>
+  std::array<std::byte, NumBytes> getInput() {
+    static_assert(NumBytes <= Base::MaxLoadBytes);
     Base::establishClassInvariants();
 
-    std::array<std::byte, BitStreamerTraits<Tag>::MaxProcessBytes> tmpStorage;
+    std::array<std::byte, NumBytes> tmpStorage;
     auto tmp = Array1DRef<std::byte>(tmpStorage.data(),
                                      implicit_cast<int>(tmpStorage.size()));
 
-    // Do we have BitStreamerTraits<Tag>::MaxProcessBytes or more bytes left in
-    // the input buffer? If so, then we can just read from said buffer.
-    if (getPos() + BitStreamerTraits<Tag>::MaxProcessBytes <=
-        Base::input.size()) [[likely]] {
+    // Do we have NumBytes or more bytes left in the input buffer?
+    // If so, then we can just read from said buffer.
+    if (getPos() + NumBytes <= Base::input.size()) [[likely]] {
       auto currInput =
-          Base::input.getCrop(getPos(), BitStreamerTraits<Tag>::MaxProcessBytes)
-              .getAsArray1DRef();
+          Base::input.getCrop(getPos(), NumBytes).getAsArray1DRef();
       invariant(currInput.size() == tmp.size());
-      memcpy(tmp.begin(), currInput.begin(),
-             BitStreamerTraits<Tag>::MaxProcessBytes);
+      memcpy(tmp.begin(), currInput.begin(), NumBytes);
+      return tmpStorage;
+    }
+
+    // If the input is padded, we can still do a full-width load, and then
+    // clear the bytes past the end. The padding never extends past the
+    // allowed over-read, so that is still detected below.
+    if (getPos() + NumBytes <= Base::input.size() + Base::tailPadding)
+        [[likely]] {
+      variableLengthLoadFromPadded(tmp, Base::input, getPos());
       return tmpStorage;
     }
 
@@ -189,10 +215,19 @@ public:
 
   BitStreamer() = delete;
 
-  explicit BitStreamer(Array1DRef<const std::byte> input) : replenisher(input) {
+  // The input may be followed by tailPadding readable bytes, which allows
+  // to read up to the end of it without switching to a slower code path.
+  explicit BitStreamer(Array1DRef<const std::byte> input, int tailPadding = 0)
+      : replenisher(input, tailPadding) {
     establishClassInvariants();
   }
 
+  template <typename T>
+    requires std::same_as<T, Buffer>
+  explicit BitStreamer(T input)
+      : BitStreamer(input.getAsArray1DRef(),
+                    implicit_cast<int>(input.getTailPadding())) {}
+
   void reload() {
     establishClassInvariants();
 
@@ -201,7 +236,7 @@ public:
     state.fillLevel = getFillLevel();
     const auto bsPos = getAsByteStreamPosition(state);
 
-    auto replacement = BitStreamer(replenisher.input);
+    auto replacement = BitStreamer(replenisher.input, replenisher.tailPadding);
     if (bsPos.bytePos != 0)
       replacement.replenisher.markNumBytesAsConsumed(bsPos.bytePos);
     replacement.fill(Cache::MaxGetBits);
@@ -228,6 +263,41 @@ public:
     invariant(cache.fillLevel >= nbits);
   }
 
+  // Unconditionally tops up the cache with a single 8-byte load, consuming
+  // as many whole bytes as fit (possibly none), so that at least
+  // MaxWideGetBits bits are in the cache afterwards.
+  void refillWide()
+    requires(Traits::canUseWideRefill)
+  {
+    establishClassInvariants();
+    static_assert(StreamTraits::MinLoadStepByteMultiple == 1);
+
+    const auto input = replenisher.template getInput<sizeof(uint64_t)>();
+    const auto bits = getByteSwapped<uint64_t>(
+        input.data(), StreamTraits::ChunkEndianness != getHostEndianness());
+    const int numBytes = cache.pushBytes(bits);
+    replenisher.markNumBytesAsConsumed(numBytes);
+    invariant(cache.fillLevel >= Cache::MaxWideGetBits);
+  }
+
+  // Same as fill(), but if the cache needs to be refilled, and the stream
+  // supports that, it is topped up as much as possible, so fewer refills
+  // are needed later on.
+  void fillWide(int nbits = Cache::MaxGetBits) {
+    establishClassInvariants();
+    invariant(nbits >= 0);
+    invariant(nbits != 0);
+    if constexpr (Traits::canUseWideRefill) {
+      invariant(nbits <= Cache::MaxWideGetBits);
+      if (cache.fillLevel >= nbits)
+        return;
+      refillWide();
+      invariant(cache.fillLevel >= nbits);
+    } else {
+      fill(nbits);
+    }
+  }
+
   // these methods might be specialized by implementations that support it
   [[nodiscard]] size_type RAWSPEED_READONLY getInputPosition() const {
     establishClassInvariants();
@@ -262,7 +332,7 @@ public:
     establishClassInvariants();
     invariant(nbits >= 0);
     // `nbits` could be zero.
-    invariant(nbits <= Cache::MaxGetBits);
+    invariant(nbits <= Cache::MaxWideGetBits);
     cache.skip(nbits);
   }
 
@@ -276,6 +346,25 @@ public:
     return ret;
   }
 
+  // Same as peekBitsNoFill(), but for up to MaxWideGetBits bits.
+  uint64_t RAWSPEED_READONLY peekBitsNoFillWide(int nbits) {
+    establishClassInvariants();
+    invariant(nbits >= 0);
+    invariant(nbits != 0);
+    invariant(nbits <= Cache::MaxWideGetBits);
+    return cache.peekWide(nbits);
+  }
+
+  uint64_t getBitsNoFillWide(int nbits) {
+    establishClassInvariants();
+    invariant(nbits >= 0);
+    invariant(nbits != 0);
+    invariant(nbits <= Cache::MaxWideGetBits);
+    uint64_t ret = peekBitsNoFillWide(nbits);
+    skipBitsNoFill(nbits);
+    return ret;
+  }
+
   uint32_t peekBits(int nbits) {
     establishClassInvariants();
     invariant(nbits >= 0);
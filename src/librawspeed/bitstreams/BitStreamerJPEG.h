@@ -77,6 +77,10 @@ template <> struct BitStreamerTraits<BitStreamerJPEG> final {
   // an 0xFF byte, separated by 0x00 byte, signifying that 0xFF is a data byte.
   static constexpr int MaxProcessBytes = 8;
   static_assert(MaxProcessBytes == sizeof(uint64_t));
+
+  // Can the cache be topped up bytewise, with a single wide load?
+  // No, the byte stuffing must be handled.
+  static constexpr bool canUseWideRefill = false;
 };
 
 // The JPEG data is ordered in MSB bit order,
@@ -34,6 +34,9 @@ template <> struct BitStreamerTraits<BitStreamerLSB> final {
   // How many bytes can we read from the input per each fillCache(), at most?
   static constexpr int MaxProcessBytes = 4;
   static_assert(MaxProcessBytes == sizeof(uint32_t));
+
+  // Can the cache be topped up bytewise, with a single wide load?
+  static constexpr bool canUseWideRefill = true;
 };
 
 // The LSBPump is ordered in LSB bit order,
@@ -36,6 +36,9 @@ template <> struct BitStreamerTraits<BitStreamerMSB> final {
   // How many bytes can we read from the input per each fillCache(), at most?
   static constexpr int MaxProcessBytes = 4;
   static_assert(MaxProcessBytes == sizeof(uint32_t));
+
+  // Can the cache be topped up bytewise, with a single wide load?
+  static constexpr bool canUseWideRefill = true;
 };
 
 // The MSB data is ordered in MSB bit order,
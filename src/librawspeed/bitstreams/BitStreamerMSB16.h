@@ -34,6 +34,10 @@ template <> struct BitStreamerTraits<BitStreamerMSB16> final {
   // How many bytes can we read from the input per each fillCache(), at most?
   static constexpr int MaxProcessBytes = 4;
   static_assert(MaxProcessBytes == 2 * sizeof(uint16_t));
+
+  // Can the cache be topped up bytewise, with a single wide load?
+  // No, the input is consumed in 2-byte steps.
+  static constexpr bool canUseWideRefill = false;
 };
 
 // The MSB data is ordered in MSB bit order,
@@ -36,6 +36,10 @@ template <> struct BitStreamerTraits<BitStreamerMSB32> final {
   // How many bytes can we read from the input per each fillCache(), at most?
   static constexpr int MaxProcessBytes = 4;
   static_assert(MaxProcessBytes == sizeof(uint32_t));
+
+  // Can the cache be topped up bytewise, with a single wide load?
+  // No, the input is consumed in 4-byte steps.
+  static constexpr bool canUseWideRefill = false;
 };
 
 // The MSB data is ordered in MSB bit order,
@@ -0,0 +1,160 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "bitstreams/JPEGUnstuffer.h"
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "adt/Invariant.h"
+#include "common/CpuFeatures.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+#include <bit>
+#include <immintrin.h>
+#endif
+
+namespace rawspeed {
+
+namespace {
+
+// Copies the input, up to the first marker, into the output, with the
+// stuffing removed. Returns the number of the consumed input bytes (i.e. the
+// position of the marker, if any), and the number of the produced bytes.
+// The output must have space for at least as many bytes as the input has.
+using UnstuffKernel = std::pair<int, int> (*)(Array1DRef<const uint8_t> input,
+                                              uint8_t* out);
+
+// Skips the 0xFF byte at the given position, and its stuffing byte.
+// Returns false, without advancing, if it begins a marker instead.
+// Like for BitStreamerJPEG, the input is zero-padded, so a trailing 0xFF
+// is a data byte.
+inline bool skipDataFF(Array1DRef<const uint8_t> input, int& pos) {
+  invariant(input(pos) == 0xFF);
+  if (pos + 1 == input.size()) {
+    ++pos;
+    return true;
+  }
+  if (input(pos + 1) != 0x00)
+    return false;
+  pos += 2;
+  return true;
+}
+
+std::pair<int, int> unstuffTail(Array1DRef<const uint8_t> input, uint8_t* out,
+                                int inPos, int outPos) {
+  while (inPos != input.size()) {
+    const uint8_t* begin = input.begin() + inPos;
+    const auto* ff = static_cast<const uint8_t*>(
+        std::memchr(begin, 0xFF, implicit_cast<size_t>(input.size() - inPos)));
+    const int run = ff ? implicit_cast<int>(ff - begin) : input.size() - inPos;
+    std::memcpy(out + outPos, begin, implicit_cast<size_t>(run));
+    inPos += run;
+    outPos += run;
+    if (inPos == input.size() || !skipDataFF(input, inPos))
+      break;
+    out[outPos++] = 0xFF;
+  }
+  return {inPos, outPos};
+}
+
+std::pair<int, int> unstuffGeneric(Array1DRef<const uint8_t> input,
+                                   uint8_t* out) {
+  return unstuffTail(input, out, /*inPos=*/0, /*outPos=*/0);
+}
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+RAWSPEED_TARGET_AVX2 std::pair<int, int>
+unstuffAVX2(Array1DRef<const uint8_t> input, uint8_t* out) {
+  constexpr int VecBytes = sizeof(__m256i);
+  const __m256i allOnes = _mm256_set1_epi8(-1);
+
+  int inPos = 0;
+  int outPos = 0;
+  while (inPos + VecBytes <= input.size()) {
+    const __m256i v = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(input.begin() + inPos));
+    // The output never runs ahead of the input, so the whole vector can be
+    // stored. Whatever follows the first 0xFF will be overwritten later.
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + outPos), v);
+    const auto mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, allOnes)));
+    if (mask == 0) {
+      inPos += VecBytes;
+      outPos += VecBytes;
+      continue;
+    }
+    const int numDataBytes = std::countr_zero(mask);
+    inPos += numDataBytes;
+    outPos += numDataBytes;
+    if (!skipDataFF(input, inPos))
+      return {inPos, outPos};
+    out[outPos++] = 0xFF;
+  }
+  return unstuffTail(input, out, inPos, outPos);
+}
+
+#endif
+
+UnstuffKernel getUnstuffKernel() {
+  return selectKernel<UnstuffKernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX2, &unstuffAVX2},
+#endif
+      {CpuIsa::Generic, &unstuffGeneric},
+  });
+}
+
+} // namespace
+
+UnstuffedJPEGSegment
+JPEGUnstuffer::unstuff(Array1DRef<const uint8_t> input) {
+  static const UnstuffKernel kernel = getUnstuffKernel();
+
+  storage.resize(implicit_cast<size_t>(input.size()) + Padding);
+  const auto [streamPosition, numBytes] = kernel(input, storage.data());
+  invariant(numBytes <= streamPosition);
+  invariant(streamPosition <= input.size());
+
+  std::fill_n(storage.begin() + numBytes, Padding, uint8_t(0));
+  return {Array1DRef<const uint8_t>(storage.data(), numBytes + Padding),
+          streamPosition};
+}
+
+int JPEGUnstuffer::findMarker(Array1DRef<const uint8_t> input) {
+  int pos = 0;
+  while (pos != input.size()) {
+    const uint8_t* begin = input.begin() + pos;
+    const auto* ff = static_cast<const uint8_t*>(
+        std::memchr(begin, 0xFF, implicit_cast<size_t>(input.size() - pos)));
+    if (!ff)
+      return input.size();
+    pos += implicit_cast<int>(ff - begin);
+    if (!skipDataFF(input, pos))
+      break;
+  }
+  return pos;
+}
+
+} // namespace rawspeed
@@ -0,0 +1,64 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Array1DRef.h"
+#include "adt/DefaultInitAllocatorAdaptor.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rawspeed {
+
+// The entropy-coded segment of a JPEG stream, with the stuffing bytes
+// (the 0x00's following the 0xFF data bytes) already removed, so that it can
+// be read with the plain BitStreamerMSB.
+struct UnstuffedJPEGSegment final {
+  // The data bytes, followed by (at least) Padding zero bytes.
+  Array1DRef<const uint8_t> bytes;
+
+  // Same as BitStreamerJPEG::getStreamPosition() after consuming the whole
+  // segment: the position of the marker that ended it, or the input size,
+  // if there was none.
+  int streamPosition;
+};
+
+// Removes the JPEG byte stuffing with a vectorized scan for the 0xFF bytes,
+// instead of checking for them on every refill of the bit cache.
+// The storage is reused between the segments, so that a decompressor can
+// unstuff every restart interval without reallocating.
+class JPEGUnstuffer final {
+  std::vector<uint8_t, DefaultInitAllocatorAdaptor<uint8_t>> storage;
+
+public:
+  // Like BitStreamerJPEG, after the end of the segment, the stream reads as
+  // zeros. A few refills worth of those are provided in-bounds.
+  static constexpr int Padding = 16;
+
+  // Unstuffs the segment at the beginning of the input.
+  [[nodiscard]] UnstuffedJPEGSegment unstuff(Array1DRef<const uint8_t> input);
+
+  // Same as unstuff(input).streamPosition, but without producing the bytes,
+  // for when only the segment boundaries are needed.
+  [[nodiscard]] static int findMarker(Array1DRef<const uint8_t> input);
+};
+
+} // namespace rawspeed
@@ -44,6 +44,8 @@ template <typename CodeTag> struct CodeTraits final {
   // static constexpr CodeValueTy MaxDiffLength = <???>;
 
   // static constexpr bool SupportsFullDecode = <???>;
+
+  // static constexpr int LookupDepth = <???>;
 };
 
 struct BaselineCodeTag;
@@ -61,6 +63,9 @@ template <> struct CodeTraits<BaselineCodeTag> final {
   static constexpr CodeValueTy MaxDiffLength = 16;
 
   static constexpr bool SupportsFullDecode = true;
+
+  // Default depth of the lookup table of PrefixCodeLUTDecoder.
+  static constexpr int LookupDepth = 11;
 };
 
 struct VC5CodeTag;
@@ -78,6 +83,9 @@ template <> struct CodeTraits<VC5CodeTag> final {
   static constexpr CodeValueTy MaxDiffLength = -1; // unused
 
   static constexpr bool SupportsFullDecode = false;
+
+  // Default depth of the lookup table of PrefixCodeLUTDecoder.
+  static constexpr int LookupDepth = 11;
 };
 
 template <typename CodeTag> struct CodeTraitsValidator final {
@@ -132,6 +140,8 @@ template <typename CodeTag> struct CodeTraitsValidator final {
                      ((1ULL << Traits::MaxDiffLengthBits) - 1ULL)));
   static_assert(!Traits::SupportsFullDecode || (Traits::MaxDiffLength == 16));
 
+  static_assert(Traits::LookupDepth > 0 && Traits::LookupDepth < 16);
+
   static constexpr bool validate() { return true; }
 };
 
@@ -25,6 +25,7 @@
 #include "codes/AbstractPrefixCode.h"
 #include "codes/PrefixCodeLUTDecoder.h"
 #include "codes/PrefixCodeLookupDecoder.h"
+#include "codes/PrefixCodeMultiLUTDecoder.h"
 // #include "codes/PrefixCodeLookupDecoder.h"
 // #include "codes/PrefixCodeTreeDecoder.h"
 // #include "codes/PrefixCodeVectorDecoder.h"
@@ -33,9 +34,18 @@
 
 namespace rawspeed {
 
-template <typename CodeTag = BaselineCodeTag>
+template <typename CodeTag = BaselineCodeTag,
+          unsigned LookupDepth = CodeTraits<CodeTag>::LookupDepth>
 using PrefixCodeDecoder =
-    PrefixCodeLUTDecoder<CodeTag, PrefixCodeLookupDecoder<CodeTag>>;
+    PrefixCodeLUTDecoder<CodeTag, PrefixCodeLookupDecoder<CodeTag>,
+                         LookupDepth>;
+
+// Can also resolve several differences per lookup, see decodeDifferences().
+template <typename CodeTag = BaselineCodeTag,
+          unsigned LookupDepth = CodeTraits<CodeTag>::LookupDepth>
+using MultiSymbolPrefixCodeDecoder =
+    PrefixCodeMultiLUTDecoder<CodeTag, PrefixCodeLookupDecoder<CodeTag>,
+                              LookupDepth>;
 
 // template <typename CodeTag>
 // using PrefixCodeDecoder = PrefixCodeLookupDecoder<CodeTag>;
@@ -25,6 +25,7 @@
 #include "adt/Casts.h"
 #include "adt/Invariant.h"
 #include "bitstreams/BitStreamer.h"
+#include "codes/AbstractPrefixCode.h"
 #include "decoders/RawDecoderException.h"
 #include <cassert>
 #include <cstddef>
@@ -67,7 +68,8 @@
 
 namespace rawspeed {
 
-template <typename CodeTag, typename BackendPrefixCodeDecoder>
+template <typename CodeTag, typename BackendPrefixCodeDecoder,
+          unsigned LookupDepth_ = CodeTraits<CodeTag>::LookupDepth>
 class PrefixCodeLUTDecoder : public BackendPrefixCodeDecoder {
 public:
   using Tag = CodeTag;
@@ -77,16 +79,19 @@ public:
   // NOLINTNEXTLINE(cppcoreguidelines-rvalue-reference-param-not-moved)
   using Base::Base;
 
-private:
+protected:
   // lookup table containing 3 fields: payload:16|flag:8|len:8
   // The payload may be the fully decoded diff or the length of the diff.
   // The len field contains the number of bits, this lookup consumed.
   // A lookup value of 0 means the code was too big to fit into the table.
-  // The optimal LookupDepth is also likely to depend on the CPU architecture.
+  // The optimal LookupDepth depends on the code length distribution of the
+  // codec and on the CPU architecture (L1 size), so it is a parameter;
+  // see PrefixCodeDecoderBenchmark.
   static constexpr unsigned PayloadShift = 9;
   static constexpr unsigned FlagMask = 0x100;
   static constexpr unsigned LenMask = 0xff;
-  static constexpr unsigned LookupDepth = 11;
+  static constexpr unsigned LookupDepth = LookupDepth_;
+  static_assert(LookupDepth > 0 && LookupDepth < 16);
   using LUTEntryTy = int32_t;
   using LUTUnsignedEntryTy = std::make_unsigned_t<LUTEntryTy>;
   std::vector<LUTEntryTy> decodeLookup;
@@ -175,7 +180,7 @@ public:
         BitStreamerTraits<BIT_STREAM>::canUseWithPrefixCodeDecoder,
         "This BitStreamer specialization is not marked as usable here");
     invariant(FULL_DECODE == Base::isFullDecode());
-    bs.fill(32);
+    bs.fillWide(32);
 
     typename Base::CodeSymbol partial;
     partial.code_len = LookupDepth;
@@ -182,7 +182,7 @@ public:
   template <typename BIT_STREAM, bool FULL_DECODE>
   int decode(BIT_STREAM& bs) const {
     invariant(FULL_DECODE == Base::isFullDecode());
-    bs.fill(32);
+    bs.fillWide(32);
 
     typename Base::CodeSymbol symbol;
     typename Traits::CodeValueTy codeValue;
@@ -0,0 +1,131 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Casts.h"
+#include "adt/Invariant.h"
+#include "bitstreams/BitStreamer.h"
+#include "codes/AbstractPrefixCode.h"
+#include "codes/PrefixCodeLUTDecoder.h"
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace rawspeed {
+
+// Same as PrefixCodeLUTDecoder, but, when doing the full decode, it can also
+// resolve several consecutive symbols with a single lookup: for every
+// LookupDepth-bit prefix of the stream, a second table stores all the
+// differences that are *completely* contained within those bits.
+// Short codes with short differences are what the LJpeg-family streams mostly
+// consist of, so that roughly halves the number of dependent table loads.
+template <typename CodeTag, typename BackendPrefixCodeDecoder,
+          unsigned LookupDepth_ = CodeTraits<CodeTag>::LookupDepth>
+class PrefixCodeMultiLUTDecoder
+    : public PrefixCodeLUTDecoder<CodeTag, BackendPrefixCodeDecoder,
+                                  LookupDepth_> {
+public:
+  using Tag = CodeTag;
+  using Base =
+      PrefixCodeLUTDecoder<CodeTag, BackendPrefixCodeDecoder, LookupDepth_>;
+  using Traits = typename Base::Traits;
+
+  // NOLINTNEXTLINE(cppcoreguidelines-rvalue-reference-param-not-moved)
+  using Base::Base;
+
+  static constexpr int MaxSymbolsPerLookup = 3;
+
+private:
+  // Up to MaxSymbolsPerLookup fully decoded differences, and the total number
+  // of bits they occupy. An entry without symbols means that even the first
+  // symbol does not fit (or the input is corrupt), and the single-symbol
+  // decoding must be used instead.
+  struct MultiLUTEntry final {
+    std::array<int16_t, MaxSymbolsPerLookup> diffs;
+    uint8_t numSymbols;
+    uint8_t len;
+  };
+  static_assert(sizeof(MultiLUTEntry) == 8);
+
+  std::vector<MultiLUTEntry> multiLookup;
+
+public:
+  void setup(bool fullDecode_, bool fixDNGBug16_) {
+    Base::setup(fullDecode_, fixDNGBug16_);
+
+    multiLookup.clear();
+    if (!Base::isFullDecode())
+      return;
+
+    // Chain the single-symbol lookups. The bits past the end of the index are
+    // zeros, so only the entries that did not consume any of them are usable.
+    const unsigned mask = (1U << Base::LookupDepth) - 1U;
+    multiLookup.resize(1U << Base::LookupDepth);
+    for (unsigned c = 0; c != multiLookup.size(); ++c) {
+      MultiLUTEntry& e = multiLookup[c];
+      e = {};
+      unsigned len = 0;
+      while (e.numSymbols != MaxSymbolsPerLookup) {
+        const auto lutEntry =
+            static_cast<unsigned>(Base::decodeLookup[(c << len) & mask]);
+        const unsigned symbolLen = lutEntry & Base::LenMask;
+        if (!(lutEntry & Base::FlagMask) ||
+            len + symbolLen > Base::LookupDepth)
+          break;
+        invariant(symbolLen > 0);
+        const int payload = static_cast<int>(lutEntry) >> Base::PayloadShift;
+        e.diffs[e.numSymbols] = implicit_cast<int16_t>(payload);
+        ++e.numSymbols;
+        len += symbolLen;
+      }
+      e.len = implicit_cast<uint8_t>(len);
+    }
+  }
+
+  // Decodes the next one or more differences into diffs, returns their count.
+  template <typename BIT_STREAM>
+  __attribute__((always_inline)) int
+  decodeDifferences(BIT_STREAM& bs,
+                    std::array<int, MaxSymbolsPerLookup>& diffs) const {
+    static_assert(
+        BitStreamerTraits<BIT_STREAM>::canUseWithPrefixCodeDecoder,
+        "This BitStreamer specialization is not marked as usable here");
+    invariant(Base::isFullDecode());
+    bs.fillWide(32);
+
+    const auto code = bs.peekBitsNoFill(Base::LookupDepth);
+    assert(code < multiLookup.size());
+    const MultiLUTEntry& e = multiLookup[code];
+
+    if (e.numSymbols == 0) [[unlikely]] {
+      diffs[0] = Base::template decode<BIT_STREAM, true>(bs);
+      return 1;
+    }
+
+    bs.skipBitsNoFill(e.len);
+    for (int i = 0; i != MaxSymbolsPerLookup; ++i)
+      diffs[i] = e.diffs[i];
+    return e.numSymbols;
+  }
+};
+
+} // namespace rawspeed
@@ -0,0 +1,57 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "common/Cancellation.h"
+#include <atomic>
+
+namespace rawspeed {
+
+void DecodeCancelledException::anchor() const {
+  // Empty out-of-line definition for the purpose of anchoring
+  // the class's vtable to this Translational Unit.
+}
+
+void CancellationToken::cancel() noexcept {
+  cancelled.store(true, std::memory_order_relaxed);
+}
+
+void CancellationToken::setDeadline(Clock::time_point t) noexcept {
+  deadline.store(t.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+bool CancellationToken::isCancelled() const noexcept {
+  if (cancelled.load(std::memory_order_relaxed))
+    return true;
+
+  const Clock::rep d = deadline.load(std::memory_order_relaxed);
+  if (d == noDeadline || Clock::now().time_since_epoch().count() < d)
+    return false;
+
+  // Latch it, so that the answer does not depend on the deadline anymore.
+  cancelled.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void CancellationToken::check() const {
+  if (isCancelled())
+    ThrowDCE("Decoding was cancelled");
+}
+
+} // namespace rawspeed
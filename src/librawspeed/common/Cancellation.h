@@ -0,0 +1,71 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "rawspeedconfig.h"
+#include "common/RawspeedException.h"
+#include <atomic>
+#include <chrono>
+
+namespace rawspeed {
+
+// Thrown once a decode notices that it has been cancelled.
+// Nothing that was being decoded should be used afterwards.
+class DecodeCancelledException final : public RawspeedException {
+  void anchor() const override;
+
+public:
+  using RawspeedException::RawspeedException;
+};
+
+#define ThrowDCE(...)                                                          \
+  ThrowExceptionHelper(rawspeed::DecodeCancelledException, __VA_ARGS__)
+
+// Lets the embedder stop an in-flight decode, either explicitly, or once the
+// deadline has passed. The decoders poll it at row / tile / strip granularity.
+// A single token may be shared by any number of concurrent decodes.
+class CancellationToken final {
+public:
+  using Clock = std::chrono::steady_clock;
+
+private:
+  static constexpr Clock::rep noDeadline =
+      Clock::time_point::max().time_since_epoch().count();
+
+  mutable std::atomic<bool> cancelled{false};
+  std::atomic<Clock::rep> deadline{noDeadline};
+
+public:
+  // May be called from any thread. Can not be undone.
+  void cancel() noexcept;
+
+  // The decode is cancelled once the clock reaches the deadline.
+  void setDeadline(Clock::time_point t) noexcept;
+  void setTimeout(Clock::duration d) noexcept { setDeadline(Clock::now() + d); }
+
+  // Once this returns true, it will always return true.
+  [[nodiscard]] bool isCancelled() const noexcept;
+
+  // Throws DecodeCancelledException if isCancelled().
+  void check() const;
+};
+
+} // namespace rawspeed
@@ -19,8 +19,18 @@
 */
 
 #include "common/Common.h"
+#include "adt/Array1DRef.h"
+#include "adt/Invariant.h"
+#include "common/CpuFeatures.h"
+#include <algorithm>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
+#include <utility>
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+#include <immintrin.h>
+#endif
 
 // #define _DEBUG
 
@@ -58,4 +68,94 @@ void writeLog(DEBUG_PRIO priority, const char* format, ...) {
 
 #endif
 
+namespace {
+
+using MinMax = std::pair<uint16_t, uint16_t>;
+
+MinMax getMinMax_plain(const uint16_t* values, int numValues) {
+  uint16_t lo = values[0];
+  uint16_t hi = values[0];
+  for (int i = 1; i < numValues; i++) {
+    lo = std::min(lo, values[i]);
+    hi = std::max(hi, values[i]);
+  }
+  return {lo, hi};
+}
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+RAWSPEED_TARGET_AVX2 inline MinMax reduceMinMax(__m128i lo, __m128i hi) {
+  // There is only a horizontal minimum, so the maximum is computed
+  // as the minimum of the complement.
+  const __m128i ones = _mm_set1_epi16(-1);
+  return {static_cast<uint16_t>(_mm_cvtsi128_si32(_mm_minpos_epu16(lo))),
+          static_cast<uint16_t>(~_mm_cvtsi128_si32(
+              _mm_minpos_epu16(_mm_xor_si128(hi, ones))))};
+}
+
+RAWSPEED_TARGET_AVX2 MinMax getMinMax_AVX2(const uint16_t* values,
+                                           int numValues) {
+  __m256i lo = _mm256_set1_epi16(-1);
+  __m256i hi = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 16 <= numValues; i += 16) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+    lo = _mm256_min_epu16(lo, v);
+    hi = _mm256_max_epu16(hi, v);
+  }
+  auto [l, h] =
+      reduceMinMax(_mm_min_epu16(_mm256_castsi256_si128(lo),
+                                 _mm256_extracti128_si256(lo, 1)),
+                   _mm_max_epu16(_mm256_castsi256_si128(hi),
+                                 _mm256_extracti128_si256(hi, 1)));
+  for (; i < numValues; i++) {
+    l = std::min(l, values[i]);
+    h = std::max(h, values[i]);
+  }
+  return {l, h};
+}
+
+RAWSPEED_TARGET_AVX512 MinMax getMinMax_AVX512(const uint16_t* values,
+                                               int numValues) {
+  __m512i lo = _mm512_set1_epi16(-1);
+  __m512i hi = _mm512_setzero_si512();
+  // The tail is loaded masked, with the neutral elements elsewhere.
+  for (int i = 0; i < numValues; i += 32) {
+    const __mmask32 mask = numValues - i >= 32
+                               ? ~__mmask32(0)
+                               : (__mmask32(1) << (numValues - i)) - 1;
+    lo = _mm512_min_epu16(lo, _mm512_mask_loadu_epi16(lo, mask, values + i));
+    hi = _mm512_max_epu16(hi, _mm512_mask_loadu_epi16(hi, mask, values + i));
+  }
+  // NOTE: the unmasked extracts (and casts) trip GCC's -Wuninitialized.
+  const __m256i lo256 =
+      _mm256_min_epu16(_mm512_maskz_extracti64x4_epi64(0xF, lo, 0),
+                       _mm512_maskz_extracti64x4_epi64(0xF, lo, 1));
+  const __m256i hi256 =
+      _mm256_max_epu16(_mm512_maskz_extracti64x4_epi64(0xF, hi, 0),
+                       _mm512_maskz_extracti64x4_epi64(0xF, hi, 1));
+  return reduceMinMax(_mm_min_epu16(_mm256_castsi256_si128(lo256),
+                                    _mm256_extracti128_si256(lo256, 1)),
+                      _mm_max_epu16(_mm256_castsi256_si128(hi256),
+                                    _mm256_extracti128_si256(hi256, 1)));
+}
+
+#endif
+
+} // namespace
+
+std::pair<uint16_t, uint16_t> getMinMax(Array1DRef<const uint16_t> values) {
+  using Kernel = MinMax (*)(const uint16_t*, int);
+  static const Kernel kernel = selectKernel<Kernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX512, &getMinMax_AVX512},
+      {CpuIsa::AVX2, &getMinMax_AVX2},
+#endif
+      {CpuIsa::Generic, &getMinMax_plain},
+  });
+  invariant(values.size() > 0);
+  return kernel(values.begin(), values.size());
+}
+
 } // namespace rawspeed
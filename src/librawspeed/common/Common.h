@@ -36,6 +36,7 @@
 #include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 extern "C" int rawspeed_get_number_of_processor_cores();
@@ -92,6 +93,10 @@ inline void copyPixels(std::byte* destPtr, int dstPitch,
   copyPixelsImpl(dest, src);
 }
 
+// The smallest and the largest of the (non-zero number of) values.
+[[nodiscard]] std::pair<uint16_t, uint16_t>
+getMinMax(Array1DRef<const uint16_t> values);
+
 template <typename T>
   requires std::is_pointer_v<T>
 constexpr uint64_t RAWSPEED_READNONE getMisalignmentOffset(T value,
@@ -159,8 +164,8 @@ bool RAWSPEED_READONLY isIn(const T value,
                      [value](const T2& t) { return t == value; });
 }
 
-// Trim both leading and trailing spaces from the string
-inline std::string trimSpaces(std::string_view str) {
+// Trim both leading and trailing spaces from the string, without copying it
+inline std::string_view trimSpacesView(std::string_view str) {
   // Find the first character position after excluding leading blank spaces
   size_t startpos = str.find_first_not_of(" \t");
 
@@ -169,10 +174,14 @@ inline std::string trimSpaces(std::string_view str) {
 
   // if all spaces or empty return an empty string
   if ((startpos == std::string::npos) || (endpos == std::string::npos))
-    return "";
+    return {};
 
-  str = str.substr(startpos, endpos - startpos + 1);
-  return {str.begin(), str.end()};
+  return str.substr(startpos, endpos - startpos + 1);
+}
+
+// Trim both leading and trailing spaces from the string
+inline std::string trimSpaces(std::string_view str) {
+  return std::string(trimSpacesView(str));
 }
 
 inline std::vector<std::string> splitString(const std::string& input,
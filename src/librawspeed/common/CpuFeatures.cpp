@@ -1,7 +1,7 @@
 /*
     RawSpeed - RAW file decoder.
 
-    Copyright (C) 2017 Roman Lebedev
+    Copyright (C) 2017-2026 Roman Lebedev
 
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -19,6 +19,10 @@
 */
 
 #include "common/CpuFeatures.h"
+#include "common/Common.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 #if defined(__i386__) || defined(__x86_64__)
 #include <cpuid.h>
@@ -28,22 +32,138 @@ namespace rawspeed {
 
 #if defined(__i386__) || defined(__x86_64__)
 
-bool Cpuid::SSE2() {
+namespace {
+
+struct CpuidRegs final {
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int ecx = 0;
+  unsigned int edx = 0;
+};
+
+CpuidRegs leaf(unsigned int level, unsigned int subleaf = 0) {
+  CpuidRegs r;
+  if (!__get_cpuid_count(level, subleaf, &r.eax, &r.ebx, &r.ecx, &r.edx))
+    return {};
+  return r;
+}
+
+// XCR0 state-component bits.
+enum : uint64_t {
+  XSTATE_SSE = 1U << 1U,
+  XSTATE_YMM = 1U << 2U,
+  XSTATE_OPMASK = 1U << 5U,
+  XSTATE_ZMM_HI256 = 1U << 6U,
+  XSTATE_HI16_ZMM = 1U << 7U,
+};
+
+// Whether the OS saves the given register state on context switches.
+bool osSavesState(uint64_t mask) {
+  if (!(leaf(1).ecx & bit_OSXSAVE))
+    return false;
   unsigned int eax;
-  unsigned int ebx;
-  unsigned int ecx;
   unsigned int edx;
+  __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  const uint64_t xcr0 = (uint64_t(edx) << 32U) | eax;
+  return (xcr0 & mask) == mask;
+}
 
-  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
-    return false;
+bool osSavesYMM() { return osSavesState(XSTATE_SSE | XSTATE_YMM); }
+
+bool osSavesZMM() {
+  return osSavesState(XSTATE_SSE | XSTATE_YMM | XSTATE_OPMASK |
+                      XSTATE_ZMM_HI256 | XSTATE_HI16_ZMM);
+}
+
+} // namespace
+
+bool Cpuid::SSE2() { return leaf(1).edx & bit_SSE2; }
+
+bool Cpuid::AVX2() {
+  return (leaf(1).ecx & bit_FMA) && (leaf(7).ebx & bit_AVX2) && osSavesYMM();
+}
+
+bool Cpuid::BMI2() {
+  const unsigned int ebx = leaf(7).ebx;
+  return (ebx & bit_BMI) && (ebx & bit_BMI2);
+}
 
-  return edx & bit_SSE2;
+bool Cpuid::AVX512BW() {
+  const unsigned int ebx = leaf(7).ebx;
+  return (ebx & bit_AVX512F) && (ebx & bit_AVX512BW) && (ebx & bit_AVX512VL) &&
+         osSavesZMM();
+}
+
+bool Cpuid::AVX512VBMI() {
+  return (leaf(7).ecx & bit_AVX512VBMI) && osSavesZMM();
 }
 
 #else
 
 bool Cpuid::SSE2() { return false; }
+bool Cpuid::AVX2() { return false; }
+bool Cpuid::BMI2() { return false; }
+bool Cpuid::AVX512BW() { return false; }
+bool Cpuid::AVX512VBMI() { return false; }
+
+#endif
 
+namespace {
+
+CpuIsa detectSupportedCpuIsa() {
+  if (!Cpuid::SSE2())
+    return CpuIsa::Generic;
+#ifndef RAWSPEED_HAVE_CPU_DISPATCH
+  return CpuIsa::SSE2;
+#else
+  if (!Cpuid::AVX2() || !Cpuid::BMI2())
+    return CpuIsa::SSE2;
+  if (!Cpuid::AVX512BW())
+    return CpuIsa::AVX2;
+  if (!Cpuid::AVX512VBMI())
+    return CpuIsa::AVX512;
+  return CpuIsa::AVX512VBMI;
 #endif
+}
+
+} // namespace
+
+const char* getCpuIsaName(CpuIsa isa) {
+  switch (isa) {
+    using enum CpuIsa;
+  case Generic:
+    return "generic";
+  case SSE2:
+    return "sse2";
+  case AVX2:
+    return "avx2";
+  case AVX512:
+    return "avx512";
+  case AVX512VBMI:
+    return "avx512vbmi";
+  }
+  __builtin_unreachable();
+}
+
+CpuIsa detectCpuIsa(const char* requested) {
+  const CpuIsa supported = detectSupportedCpuIsa();
+  if (!requested)
+    return supported;
+
+  for (const CpuIsa isa : {CpuIsa::Generic, CpuIsa::SSE2, CpuIsa::AVX2,
+                           CpuIsa::AVX512, CpuIsa::AVX512VBMI}) {
+    if (0 == strcmp(requested, getCpuIsaName(isa)))
+      return std::min(isa, supported);
+  }
+
+  writeLog(DEBUG_PRIO::WARNING, "Ignoring unknown ISA level \"%s\"",
+           requested);
+  return supported;
+}
+
+CpuIsa getCpuIsa() {
+  static const CpuIsa isa = detectCpuIsa(std::getenv("RAWSPEED_ISA"));
+  return isa;
+}
 
 } // namespace rawspeed
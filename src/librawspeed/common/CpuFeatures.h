@@ -1,7 +1,7 @@
 /*
     RawSpeed - RAW file decoder.
 
-    Copyright (C) 2017 Roman Lebedev
+    Copyright (C) 2017-2026 Roman Lebedev
 
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -21,12 +21,71 @@
 #pragma once
 
 #include "rawspeedconfig.h"
+#include "adt/Invariant.h"
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+// Ability to compile individual functions for a wider ISA than the rest of
+// the library, so that one generic binary can carry several kernel variants.
+#if (defined(__i386__) || defined(__x86_64__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#define RAWSPEED_HAVE_CPU_DISPATCH
+#define RAWSPEED_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,fma")))
+#define RAWSPEED_TARGET_AVX512                                                 \
+  __attribute__((target("avx2,bmi,bmi2,fma,avx512f,avx512bw,avx512vl")))
+#define RAWSPEED_TARGET_AVX512VBMI                                             \
+  __attribute__((                                                              \
+      target("avx2,bmi,bmi2,fma,avx512f,avx512bw,avx512vl,avx512vbmi")))
+#endif
 
 namespace rawspeed {
 
 class Cpuid final {
 public:
   static bool RAWSPEED_READNONE SSE2();
+  static bool RAWSPEED_READNONE AVX2();
+  static bool RAWSPEED_READNONE BMI2();
+  // AVX-512 Foundation, Byte/Word and Vector Length extensions.
+  static bool RAWSPEED_READNONE AVX512BW();
+  static bool RAWSPEED_READNONE AVX512VBMI();
+};
+
+// Instruction set levels that kernels are specialized for. Each level implies
+// all of the previous ones.
+enum class CpuIsa : uint8_t {
+  Generic,
+  SSE2,
+  AVX2,   // AVX2 + BMI2 + FMA
+  AVX512, // AVX-512 F/BW/VL
+  AVX512VBMI,
 };
 
+[[nodiscard]] const char* getCpuIsaName(CpuIsa isa);
+
+// Highest level supported by the CPU (and the OS), but no higher than
+// \p requested, which is one of the getCpuIsaName() spellings.
+// Null requests do not restrict anything, unknown ones are ignored with a
+// warning.
+[[nodiscard]] CpuIsa detectCpuIsa(const char* requested);
+
+// detectCpuIsa() for the RAWSPEED_ISA environment variable, evaluated once.
+[[nodiscard]] CpuIsa getCpuIsa();
+
+// Picks the kernel variant for the best level not exceeding getCpuIsa().
+// The variants must be ordered from the widest ISA to the narrowest one,
+// and the last one must be CpuIsa::Generic. Resolve into a function-local
+// static so that the choice is made once per kernel.
+template <typename Fn>
+[[nodiscard]] Fn
+selectKernel(std::initializer_list<std::pair<CpuIsa, Fn>> variants) {
+  const CpuIsa isa = getCpuIsa();
+  for (const auto& [variantIsa, fn] : variants) {
+    if (variantIsa <= isa)
+      return fn;
+  }
+  invariant(false && "No generic kernel variant.");
+  __builtin_unreachable();
+}
+
 } // namespace rawspeed
@@ -0,0 +1,75 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "rawspeedconfig.h"
+#include "common/CpuFeatures.h"
+#include <cstdint>
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace rawspeed {
+
+// Counter-based noise for dithering. The noise only depends on the pixel's
+// position (its counter), not on what was generated before it, so it can be
+// produced for a whole vector of pixels at once, and any kernel variant
+// (and any row partitioning) produces bit-identical images.
+
+inline constexpr int ditherNoiseBits = 11;
+
+// A well-mixing 32-bit integer hash (lowbias32); the noise is its top bits.
+constexpr uint32_t RAWSPEED_READNONE ditherNoise(uint32_t counter) {
+  uint32_t h = counter;
+  h ^= h >> 16U;
+  h *= 0x7feb352dU;
+  h ^= h >> 15U;
+  h *= 0x846ca68bU;
+  h ^= h >> 16U;
+  return h >> (32 - ditherNoiseBits);
+}
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+RAWSPEED_TARGET_AVX2 inline __m256i ditherNoise(__m256i counter) {
+  __m256i h = counter;
+  h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+  h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x7feb352d));
+  h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+  h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0x846ca68bU)));
+  h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+  return _mm256_srli_epi32(h, 32 - ditherNoiseBits);
+}
+
+RAWSPEED_TARGET_AVX512 inline __m512i ditherNoise(__m512i counter) {
+  __m512i h = counter;
+  h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+  h = _mm512_mullo_epi32(h, _mm512_set1_epi32(0x7feb352d));
+  h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 15));
+  h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(0x846ca68bU)));
+  h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+  return _mm512_srli_epi32(h, 32 - ditherNoiseBits);
+}
+
+#endif
+
+} // namespace rawspeed
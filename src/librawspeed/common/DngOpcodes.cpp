@@ -173,11 +173,10 @@ public:
     MutexLocker guard(&ri->mBadPixelMutex);
     const CroppedArray2DRef<uint16_t> img(ri->getU16DataAsCroppedArray2DRef());
     iPoint2D crop = ri->getCropOffset();
-    uint32_t offset = crop.x | (crop.y << 16);
     for (auto row = 0; row < img.croppedHeight; ++row) {
       for (auto col = 0; col < img.croppedWidth; ++col) {
         if (img(row, col) == value)
-          ri->mBadPixelPositions.push_back(offset + (row << 16 | col));
+          ri->mBadPixelPositions.emplace_back(crop + iPoint2D(col, row));
       }
     }
   }
@@ -261,7 +260,7 @@ void DngOpcodes::DummyROIOpcode::anchor() const {
 // ****************************************************************************
 
 class DngOpcodes::FixBadPixelsList final : public DngOpcodes::DngOpcode {
-  std::vector<uint32_t> badPixels;
+  std::vector<iPoint2D> badPixels;
 
   void anchor() const override;
 
@@ -290,10 +289,11 @@ public:
       auto y = bs.getU32();
       auto x = bs.getU32();
 
-      if (const iPoint2D badPoint(x, y); !fullImage.isPointInside(badPoint))
+      const iPoint2D badPoint(x, y);
+      if (!fullImage.isPointInside(badPoint))
         ThrowRDE("Bad point not inside image.");
 
-      badPixels.emplace_back(y << 16 | x);
+      badPixels.emplace_back(badPoint);
     }
 
     // Read rects
@@ -308,8 +308,8 @@ public:
       badPixels.reserve(badPixels.size() + area);
       for (auto y = 0; y < badRect.getHeight(); ++y) {
         for (auto x = 0; x < badRect.getWidth(); ++x) {
-          badPixels.emplace_back((badRect.getTop() + y) << 16 |
-                                 (badRect.getLeft() + x));
+          badPixels.emplace_back(badRect.getLeft() + x,
+                                 badRect.getTop() + y);
         }
       }
     }
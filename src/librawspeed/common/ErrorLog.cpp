@@ -20,6 +20,7 @@
 
 #include "ErrorLog.h"
 #include "adt/Mutex.h"
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,9 +30,14 @@ namespace rawspeed {
 void ErrorLog::setError(const std::string& err) {
   MutexLocker guard(&mutex);
   errors.push_back(err);
+  numErrors.store(static_cast<unsigned>(errors.size()),
+                  std::memory_order_release);
 }
 
 bool ErrorLog::isTooManyErrors(unsigned many, std::string* firstErr) {
+  if (getNumErrors() < many)
+    return false;
+
   MutexLocker guard(&mutex);
 
   if (errors.size() < many)
@@ -44,9 +50,12 @@ bool ErrorLog::isTooManyErrors(unsigned many, std::string* firstErr) {
   return true;
 }
 
-std::vector<std::string>&& ErrorLog::getErrors() {
+std::vector<std::string> ErrorLog::getErrors() {
   MutexLocker guard(&mutex);
-  return std::move(errors);
+  std::vector<std::string> taken = std::move(errors);
+  errors.clear();
+  numErrors.store(0, std::memory_order_release);
+  return taken;
 }
 
 } // namespace rawspeed
@@ -22,6 +22,7 @@
 
 #include "ThreadSafetyAnalysis.h"
 #include "adt/Mutex.h"
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -31,11 +32,24 @@ class ErrorLog {
   Mutex mutex;
   std::vector<std::string> errors GUARDED_BY(mutex);
 
+  // Mirrors errors.size(), but can be read without taking the mutex.
+  std::atomic<unsigned> numErrors{0};
+
 public:
   void setError(const std::string& err) REQUIRES(!mutex);
+
+  // Lock-free, so that the parallel loops can cheaply check it between
+  // their work items, and give up as soon as any of the items has failed.
+  [[nodiscard]] bool hasErrors() const noexcept { return getNumErrors() != 0; }
+  [[nodiscard]] unsigned getNumErrors() const noexcept {
+    return numErrors.load(std::memory_order_acquire);
+  }
+
   bool isTooManyErrors(unsigned many, std::string* firstErr = nullptr)
       REQUIRES(!mutex);
-  std::vector<std::string>&& getErrors() REQUIRES(!mutex);
+
+  // Takes all the errors logged so far, leaving the log empty.
+  std::vector<std::string> getErrors() REQUIRES(!mutex);
 };
 
 } // namespace rawspeed
@@ -0,0 +1,106 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "rawspeedconfig.h"
+#include "common/Executor.h"
+#include "adt/Invariant.h"
+#include "common/Common.h"
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace rawspeed {
+
+std::pair<int, int> Executor::getChunk(int numItems, int numChunks,
+                                       int chunk) {
+  invariant(numItems > 0);
+  invariant(numChunks > 0 && numChunks <= numItems);
+  invariant(chunk >= 0 && chunk < numChunks);
+  // The first numItems % numChunks chunks get one extra item.
+  const int base = numItems / numChunks;
+  const int extra = numItems % numChunks;
+  const int begin = chunk * base + std::min(chunk, extra);
+  const int end = begin + base + (chunk < extra ? 1 : 0);
+  return {begin, end};
+}
+
+const std::shared_ptr<Executor>& Executor::getDefault() {
+#ifdef HAVE_OPENMP
+  static const std::shared_ptr<Executor> executor =
+      std::make_shared<OpenMPExecutor>();
+#else
+  static const std::shared_ptr<Executor> executor =
+      std::make_shared<SerialExecutor>();
+#endif
+  return executor;
+}
+
+void SerialExecutor::parallelFor(int numItems,
+                                 const std::function<void(int, int)>& body) {
+  if (numItems > 0)
+    body(0, numItems);
+}
+
+void SerialExecutor::submit(std::function<void()> task) { task(); }
+
+#ifdef HAVE_OPENMP
+
+int OpenMPExecutor::getNumThreads() const {
+  return std::max(1, rawspeed_get_number_of_processor_cores());
+}
+
+void OpenMPExecutor::parallelFor(int numItems,
+                                 const std::function<void(int, int)>& body) {
+  if (numItems <= 0)
+    return;
+
+  const int numChunks = std::min(numItems, getNumThreads());
+  if (numChunks == 1) {
+    body(0, numItems);
+    return;
+  }
+
+  std::exception_ptr firstException;
+
+#pragma omp parallel for default(none) shared(body, firstException)           \
+    firstprivate(numItems, numChunks) num_threads(numChunks) schedule(static)
+  for (int chunk = 0; chunk < numChunks; ++chunk) {
+    const auto [begin, end] = getChunk(numItems, numChunks, chunk);
+    try {
+      body(begin, end);
+    } catch (...) {
+      // Propagate the exception out of OpenMP magic.
+#pragma omp critical(executor)
+      if (!firstException)
+        firstException = std::current_exception();
+    }
+  }
+
+  if (firstException)
+    std::rethrow_exception(firstException);
+}
+
+void OpenMPExecutor::submit(std::function<void()> task) { task(); }
+
+#endif
+
+} // namespace rawspeed
@@ -0,0 +1,99 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "rawspeedconfig.h"
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace rawspeed {
+
+// Runs the parallelizable parts of the decoding (and post-processing).
+// A single executor may be shared by any number of concurrent decodes.
+class Executor {
+public:
+  Executor() = default;
+  Executor(const Executor&) = delete;
+  Executor(Executor&&) = delete;
+  Executor& operator=(const Executor&) = delete;
+  Executor& operator=(Executor&&) = delete;
+  virtual ~Executor() = default;
+
+  // How many threads may be working on a single parallelFor() at once.
+  [[nodiscard]] virtual int getNumThreads() const = 0;
+
+  // How many threads the code that is parallelized with OpenMP directly,
+  // instead of through this executor, may start. Unless the executor is
+  // itself OpenMP-based, such a team would just oversubscribe its threads.
+  [[nodiscard]] virtual int getNumOpenMPThreads() const { return 1; }
+
+  // Splits [0, numItems) into at most getNumThreads() contiguous chunks, and
+  // calls body(begin, end) once per chunk, possibly concurrently.
+  // Returns once all the chunks are done. If any of the calls throws,
+  // the first exception is rethrown afterwards.
+  virtual void parallelFor(int numItems,
+                           const std::function<void(int, int)>& body) = 0;
+
+  // Schedules the task to be run at some point. The task must not throw.
+  virtual void submit(std::function<void()> task) = 0;
+
+  // The executor that is used unless the embedder has provided one.
+  [[nodiscard]] static const std::shared_ptr<Executor>& getDefault();
+
+protected:
+  // The [begin, end) of the chunk'th of numChunks equally-sized chunks.
+  [[nodiscard]] static std::pair<int, int> getChunk(int numItems, int numChunks,
+                                                    int chunk);
+};
+
+// Does all the work on the calling thread.
+class SerialExecutor final : public Executor {
+public:
+  [[nodiscard]] int getNumThreads() const override { return 1; }
+
+  void parallelFor(int numItems,
+                   const std::function<void(int, int)>& body) override;
+
+  void submit(std::function<void()> task) override;
+};
+
+#ifdef HAVE_OPENMP
+
+// Does the work on an OpenMP team of rawspeed_get_number_of_processor_cores()
+// threads. Submitted tasks are run synchronously, on the calling thread.
+class OpenMPExecutor final : public Executor {
+public:
+  [[nodiscard]] int getNumThreads() const override;
+
+  [[nodiscard]] int getNumOpenMPThreads() const override {
+    return getNumThreads();
+  }
+
+  void parallelFor(int numItems,
+                   const std::function<void(int, int)>& body) override;
+
+  void submit(std::function<void()> task) override;
+};
+
+#endif
+
+} // namespace rawspeed
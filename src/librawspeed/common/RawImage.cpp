@@ -30,6 +30,8 @@
 #include "io/IOException.h"
 #include "parsers/TiffParserException.h"
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -201,31 +203,38 @@ void RawImageData::subFrame(iRectangle2D crop) {
 void RawImageData::createBadPixelMap() {
   if (!isAllocated())
     ThrowRDE("(internal) Bad pixel map cannot be allocated before image.");
-  mBadPixelMapPitch = implicit_cast<uint32_t>(
-      roundUp(roundUpDivisionSafe(uncropped_dim.x, 8), 16));
+  mBadPixelMapPitch =
+      implicit_cast<uint32_t>(roundUpDivisionSafe(uncropped_dim.x, 64));
   assert(mBadPixelMap.empty());
   mBadPixelMap.resize(static_cast<size_t>(mBadPixelMapPitch) * uncropped_dim.y,
-                      uint8_t(0));
+                      uint64_t(0));
 }
 
 void RawImageData::transferBadPixelsToMap() {
-  MutexLocker guard(&mBadPixelMutex);
-  if (mBadPixelPositions.empty())
+  std::vector<iPoint2D> positions;
+  {
+    MutexLocker guard(&mBadPixelMutex);
+    positions.swap(mBadPixelPositions);
+  }
+  if (positions.empty())
     return;
 
   if (mBadPixelMap.empty())
     createBadPixelMap();
 
-  for (unsigned int pos : mBadPixelPositions) {
-    uint16_t pos_x = pos & 0xffff;
-    uint16_t pos_y = pos >> 16;
-
-    assert(pos_x < static_cast<uint16_t>(uncropped_dim.x));
-    assert(pos_y < static_cast<uint16_t>(uncropped_dim.y));
-
-    mBadPixelMap[mBadPixelMapPitch * pos_y + (pos_x >> 3)] |= 1 << (pos_x & 7);
-  }
-  mBadPixelPositions.clear();
+  // Different positions may well land in the same word of the map.
+  executor->parallelFor(
+      implicit_cast<int>(positions.size()), [&](int begin, int end) {
+        for (int i = begin; i != end; ++i) {
+          const iPoint2D pos = positions[i];
+          assert(pos.x >= 0 && pos.x < uncropped_dim.x);
+          assert(pos.y >= 0 && pos.y < uncropped_dim.y);
+          std::atomic_ref<uint64_t> word(
+              mBadPixelMap[(static_cast<size_t>(pos.y) * mBadPixelMapPitch) +
+                           (pos.x / 64)]);
+          word.fetch_or(uint64_t(1) << (pos.x % 64), std::memory_order_relaxed);
+        }
+      });
 }
 
 void RawImageData::fixBadPixels() {
@@ -240,11 +249,10 @@ void RawImageData::fixBadPixels() {
 
 #else // EMULATE_DCRAW_BAD_PIXELS - not recommended, testing purposes only
 
-  for (vector<uint32_t>::iterator i = mBadPixelPositions.begin();
+  for (vector<iPoint2D>::iterator i = mBadPixelPositions.begin();
        i != mBadPixelPositions.end(); ++i) {
-    uint32_t pos = *i;
-    uint32_t pos_x = pos & 0xffff;
-    uint32_t pos_y = pos >> 16;
+    uint32_t pos_x = i->x;
+    uint32_t pos_y = i->y;
     uint32_t total = 0;
     uint32_t div = 0;
     // 0 side covered by unsignedness.
@@ -278,45 +286,31 @@ void RawImageData::startWorker(const RawImageWorker::RawImageWorkerTask task,
     return h;
   }();
 
-  const int threads = rawspeed_get_number_of_processor_cores();
-  const int y_per_thread = (height + threads - 1) / threads;
-
-#ifdef HAVE_OPENMP
-#pragma omp parallel for default(none)                                         \
-    firstprivate(threads, y_per_thread, height, task) num_threads(threads)     \
-    schedule(static)
-#endif
-  for (int i = 0; i < threads; i++) {
-    int y_offset = std::min(i * y_per_thread, height);
-    int y_end = std::min((i + 1) * y_per_thread, height);
-
-    RawImageWorker worker(this, task, y_offset, y_end);
-  }
+  // Each thread goes through its rows a few at a time, and gives up
+  // as soon as any of the rows (of any of the threads) has failed.
+  static constexpr int rowsPerWorkItem = 16;
+  const unsigned numErrorsBefore = getNumErrors();
+  executor->parallelFor(
+      height, [this, task, numErrorsBefore](int y_offset, int y_end) {
+        for (int y = y_offset; y < y_end; y += rowsPerWorkItem) {
+          if (getNumErrors() != numErrorsBefore)
+            break;
+          RawImageWorker worker(this, task, y,
+                                std::min(y + rowsPerWorkItem, y_end));
+        }
+      });
 }
 
 void RawImageData::fixBadPixelsThread(int start_y, int end_y) {
-  int gw = (uncropped_dim.x + 15) / 32;
-
-  const auto bad =
-      Array2DRef(mBadPixelMap.data(), mBadPixelMapPitch, uncropped_dim.y);
+  const auto bad = Array2DRef(mBadPixelMap.data(),
+                              implicit_cast<int>(mBadPixelMapPitch),
+                              uncropped_dim.y);
 
   for (int y = start_y; y < end_y; y++) {
-    for (int x = 0; x < gw; x++) {
-      const auto block = bad[y].getBlock(32 / 8, x);
-
-      // Test if there is a bad pixel within these 32 pixels
-      if (std::all_of(block.begin(), block.end(),
-                      [](const auto& val) { return val == 0; }))
-        continue;
-
-      // Go through each pixel
-      for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 8; j++) {
-          if (1 != ((block(i) >> j) & 1))
-            continue;
-
-          fixBadPixel(x * 32 + i * 8 + j, y, 0);
-        }
+    for (int word = 0; word < bad.width(); word++) {
+      // Visit just the set bits, lowest first.
+      for (uint64_t bits = bad(y, word); bits != 0; bits &= bits - 1) {
+        fixBadPixel((64 * word) + std::countr_zero(bits), y, 0);
       }
     }
   }
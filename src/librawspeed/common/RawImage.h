@@ -31,8 +31,11 @@
 #include "adt/NotARational.h"
 #include "adt/Optional.h"
 #include "adt/Point.h"
+#include "common/Cancellation.h"
 #include "common/Common.h"
+#include "common/CpuFeatures.h"
 #include "common/ErrorLog.h"
+#include "common/Executor.h"
 #include "common/TableLookUp.h"
 #include "metadata/BlackArea.h"
 #include "metadata/ColorFilterArray.h"
@@ -141,8 +144,6 @@ public:
   [[nodiscard]] iPoint2D RAWSPEED_READONLY getCropOffset() const;
   virtual void scaleBlackWhite() = 0;
   virtual void calculateBlackAreas() = 0;
-  virtual void setWithLookUp(uint16_t value, std::byte* dst,
-                             uint32_t* random) = 0;
   void sixteenBitLookup();
   void transferBadPixelsToMap() REQUIRES(!mBadPixelMutex);
   void fixBadPixels() REQUIRES(!mBadPixelMutex);
@@ -173,16 +174,43 @@ public:
 
   std::vector<BlackArea> blackAreas;
 
-  /* Vector containing the positions of bad pixels */
-  /* Format is x | (y << 16), so maximum pixel position is 65535 */
-  // Positions of zeroes that must be interpolated
-  std::vector<uint32_t> mBadPixelPositions GUARDED_BY(mBadPixelMutex);
-  std::vector<uint8_t, AlignedAllocator<uint8_t, 16>> mBadPixelMap;
-  uint32_t mBadPixelMapPitch = 0;
+  // Positions (in the uncropped image) of the pixels that must be
+  // interpolated. Producers should collect their positions locally,
+  // and only append them here (under the mutex) in bulk.
+  std::vector<iPoint2D> mBadPixelPositions GUARDED_BY(mBadPixelMutex);
+  // One bit per pixel of the uncropped image, 64 pixels per word.
+  std::vector<uint64_t, AlignedAllocator<uint64_t, 16>> mBadPixelMap;
+  uint32_t mBadPixelMapPitch = 0; // In words.
+
+  [[nodiscard]] bool isBadPixel(int x, int y) const {
+    return (mBadPixelMap[(static_cast<size_t>(y) * mBadPixelMapPitch) +
+                         (x / 64)] >>
+            (x % 64)) &
+           1;
+  }
   bool mDitherScale =
       true; // Should upscaling be done with dither to minimize banding?
   ImageMetaData metadata;
 
+  // Runs the parallelizable parts of the decoding and processing of the image.
+  std::shared_ptr<Executor> executor = Executor::getDefault();
+
+  // If set, the decoding of the image is abandoned once it is cancelled.
+  std::shared_ptr<const CancellationToken> cancellation;
+
+  // Whether the LJpeg decompressors may remove the JPEG byte stuffing of each
+  // entropy-coded segment up front, into a scratch copy of it.
+  bool unstuffJPEGUpFront = false;
+
+  // For the decompressors to poll, at row / tile / strip granularity.
+  [[nodiscard]] bool isCancelled() const {
+    return cancellation && cancellation->isCancelled();
+  }
+  void checkCancelled() const {
+    if (cancellation)
+      cancellation->check();
+  }
+
   Mutex mBadPixelMutex; // Mutex for 'mBadPixelPositions, must be used if more
                         // than 1 thread is accessing vector
 
@@ -213,15 +241,20 @@ public:
 
   void scaleBlackWhite() override;
   void calculateBlackAreas() override;
-  void setWithLookUp(uint16_t value, std::byte* dst, uint32_t* random) override;
 
 private:
   void scaleValues_plain(int start_y, int end_y);
-#ifdef WITH_SSE2
-  void scaleValues_SSE2(int start_y, int end_y);
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+  void scaleValues_AVX2(int start_y, int end_y);
+  void scaleValues_AVX512(int start_y, int end_y);
 #endif
   void scaleValues(int start_y, int end_y) override;
   void fixBadPixel(uint32_t x, uint32_t y, int component = 0) override;
+  void doLookup_plain(int start_y, int end_y);
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+  void doLookup_AVX2(int start_y, int end_y);
+  void doLookup_AVX512(int start_y, int end_y);
+#endif
   void doLookup(int start_y, int end_y) override;
 
   friend class RawImage;
@@ -234,9 +267,13 @@ public:
 
   void scaleBlackWhite() override;
   void calculateBlackAreas() override;
-  void setWithLookUp(uint16_t value, std::byte* dst, uint32_t* random) override;
 
 private:
+  void scaleValues_plain(int start_y, int end_y);
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+  void scaleValues_AVX2(int start_y, int end_y);
+  void scaleValues_AVX512(int start_y, int end_y);
+#endif
   void scaleValues(int start_y, int end_y) override;
   void fixBadPixel(uint32_t x, uint32_t y, int component = 0) override;
   [[noreturn]] void doLookup(int start_y, int end_y) override;
@@ -327,31 +364,9 @@ RawImageData::getByteDataAsUncroppedArray2DRef() noexcept {
   __builtin_unreachable();
 }
 
-// setWithLookUp will set a single pixel by using the lookup table if supplied,
-// You must supply the destination where the value should be written, and a
-// pointer to a value that will be used to store a random counter that can be
-// reused between calls. this needs to be inline to speed up tight decompressor
-// loops
-inline void RawImageDataU16::setWithLookUp(uint16_t value, std::byte* dst,
-                                           uint32_t* random) {
-  auto* dest = reinterpret_cast<uint16_t*>(dst);
-  if (table == nullptr) {
-    *dest = value;
-    return;
-  }
-  if (table->dither) {
-    uint32_t base = table->tables[2 * value + 0];
-    uint32_t delta = table->tables[2 * value + 1];
-    uint32_t r = *random;
-
-    uint32_t pix = base + ((delta * (r & 2047) + 1024) >> 12);
-    *random = 15700 * (r & 65535) + (r >> 16);
-    *dest = implicit_cast<uint16_t>(pix);
-    return;
-  }
-  *dest = table->tables[value];
-}
-
+// The decompressors store the raw codes, and the curve is then applied to the
+// whole image at once, in parallel, by apply(). If the uncorrected raw values
+// were requested, the curve is instead left in the image, for later use.
 class RawImageCurveGuard final {
   const RawImage* mRaw;
   const std::vector<uint16_t>& curve;
@@ -373,6 +388,12 @@ public:
     (*mRaw)->setTable(curve, true);
   }
 
+  // To be called once the raw codes have been decoded.
+  void apply() const {
+    if (!uncorrectedRawValues)
+      (*mRaw)->sixteenBitLookup();
+  }
+
   ~RawImageCurveGuard() {
     // Set the table, if it should be needed later.
     if (uncorrectedRawValues)
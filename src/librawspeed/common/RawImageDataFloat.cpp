@@ -25,16 +25,20 @@
 #include "adt/CroppedArray2DRef.h"
 #include "adt/Point.h"
 #include "common/Common.h"
+#include "common/CpuFeatures.h"
 #include "decoders/RawDecoderException.h"
 #include "metadata/BlackArea.h"
 #include <algorithm>
 #include <array>
 #include <cassert>
-#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
 
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 using std::max;
 using std::min;
 
@@ -145,30 +149,126 @@ void RawImageDataFloat::scaleBlackWhite() {
   startWorker(RawImageWorker::RawImageWorkerTask::SCALE_VALUES, true);
 }
 
-void RawImageDataFloat::scaleValues(int start_y, int end_y) {
-  const CroppedArray2DRef<float> img = getF32DataAsCroppedArray2DRef();
-  int gw = dim.x * cpp;
-  std::array<float, 4> mul;
+namespace {
+
+// Black/white scaling parameters, per position within the 2x2 CFA pattern
+// of the cropped image.
+struct ScaleParams final {
   std::array<float, 4> sub;
-  assert(blackLevelSeparate->width() == 2 && blackLevelSeparate->height() == 2);
-  auto blackLevelSeparate1D = *blackLevelSeparate->getAsArray1DRef();
+  std::array<float, 4> mul;
+
+  [[nodiscard]] float apply(float pixel, int cfa) const {
+    return (pixel - sub[cfa]) * mul[cfa];
+  }
+};
+
+ScaleParams getScaleParams(Array2DRef<int> blackLevelSeparate, int whitePoint,
+                           iPoint2D offset) {
+  assert(blackLevelSeparate.width() == 2 && blackLevelSeparate.height() == 2);
+  auto blackLevelSeparate1D = *blackLevelSeparate.getAsArray1DRef();
+
+  ScaleParams p;
   for (int i = 0; i < 4; i++) {
     int v = i;
-    if ((mOffset.x & 1) != 0)
+    if ((offset.x & 1) != 0)
       v ^= 1;
-    if ((mOffset.y & 1) != 0)
+    if ((offset.y & 1) != 0)
       v ^= 2;
-    mul[i] =
-        65535.0F / static_cast<float>(*whitePoint - blackLevelSeparate1D(v));
-    sub[i] = static_cast<float>(blackLevelSeparate1D(v));
+    p.mul[i] =
+        65535.0F / static_cast<float>(whitePoint - blackLevelSeparate1D(v));
+    p.sub[i] = static_cast<float>(blackLevelSeparate1D(v));
   }
+  return p;
+}
+
+} // namespace
+
+void RawImageDataFloat::scaleValues(int start_y, int end_y) {
+  using Kernel = void (RawImageDataFloat::*)(int, int);
+  static const Kernel kernel = selectKernel<Kernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX512, &RawImageDataFloat::scaleValues_AVX512},
+      {CpuIsa::AVX2, &RawImageDataFloat::scaleValues_AVX2},
+#endif
+      {CpuIsa::Generic, &RawImageDataFloat::scaleValues_plain},
+  });
+  (this->*kernel)(start_y, end_y);
+}
+
+void RawImageDataFloat::scaleValues_plain(int start_y, int end_y) {
+  const CroppedArray2DRef<float> img = getF32DataAsCroppedArray2DRef();
+  const ScaleParams p = getScaleParams(*blackLevelSeparate, *whitePoint,
+                                       mOffset);
+  int gw = dim.x * cpp;
   for (int y = start_y; y < end_y; y++) {
     for (int x = 0; x < gw; x++)
-      img(y, x) = (img(y, x) - sub[(2 * (y & 1)) + (x & 1)]) *
-                  mul[(2 * (y & 1)) + (x & 1)];
+      img(y, x) = p.apply(img(y, x), (2 * (y & 1)) + (x & 1));
+  }
+}
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+RAWSPEED_TARGET_AVX2 void RawImageDataFloat::scaleValues_AVX2(int start_y,
+                                                               int end_y) {
+  const CroppedArray2DRef<float> img = getF32DataAsCroppedArray2DRef();
+  const ScaleParams p = getScaleParams(*blackLevelSeparate, *whitePoint,
+                                       mOffset);
+  int gw = dim.x * cpp;
+  for (int y = start_y; y < end_y; y++) {
+    const int row = 2 * (y & 1);
+    // Even lanes are the even columns.
+    std::array<float, 8> subs;
+    std::array<float, 8> muls;
+    for (int i = 0; i < 8; i++) {
+      subs[i] = p.sub[row + (i & 1)];
+      muls[i] = p.mul[row + (i & 1)];
+    }
+    const __m256 sub = _mm256_loadu_ps(subs.data());
+    const __m256 mul = _mm256_loadu_ps(muls.data());
+    float* line = &img(y, 0);
+
+    int x = 0;
+    for (; x + 8 <= gw; x += 8) {
+      const __m256 pix = _mm256_loadu_ps(line + x);
+      _mm256_storeu_ps(line + x, _mm256_mul_ps(_mm256_sub_ps(pix, sub), mul));
+    }
+    for (; x < gw; x++)
+      line[x] = p.apply(line[x], row + (x & 1));
+  }
+}
+
+RAWSPEED_TARGET_AVX512 void RawImageDataFloat::scaleValues_AVX512(int start_y,
+                                                                   int end_y) {
+  const CroppedArray2DRef<float> img = getF32DataAsCroppedArray2DRef();
+  const ScaleParams p = getScaleParams(*blackLevelSeparate, *whitePoint,
+                                       mOffset);
+  int gw = dim.x * cpp;
+  for (int y = start_y; y < end_y; y++) {
+    const int row = 2 * (y & 1);
+    // Even lanes are the even columns.
+    std::array<float, 16> subs;
+    std::array<float, 16> muls;
+    for (int i = 0; i < 16; i++) {
+      subs[i] = p.sub[row + (i & 1)];
+      muls[i] = p.mul[row + (i & 1)];
+    }
+    const __m512 sub = _mm512_loadu_ps(subs.data());
+    const __m512 mul = _mm512_loadu_ps(muls.data());
+    float* line = &img(y, 0);
+
+    // The tail of the row is handled via masked loads and stores.
+    for (int x = 0; x < gw; x += 16) {
+      const __mmask16 mask =
+          gw - x >= 16 ? 0xFFFF : static_cast<__mmask16>((1U << (gw - x)) - 1);
+      const __m512 pix = _mm512_maskz_loadu_ps(mask, line + x);
+      _mm512_mask_storeu_ps(line + x, mask,
+                            _mm512_mul_ps(_mm512_sub_ps(pix, sub), mul));
+    }
   }
 }
 
+#endif
+
 /* This performs a 4 way interpolated pixel */
 /* The value is interpolated from the 4 closest valid pixels in */
 /* the horizontal and vertical direction. Pixels found further away */
@@ -182,8 +282,6 @@ void RawImageDataFloat::fixBadPixel(uint32_t x, uint32_t y, int component) {
   std::array<float, 4> dist = {{}};
   std::array<float, 4> weight;
 
-  const auto bad =
-      Array2DRef(mBadPixelMap.data(), mBadPixelMapPitch, uncropped_dim.y);
   // We can have cfa or no-cfa for RawImageDataFloat
   int step = isCFA ? 2 : 1;
 
@@ -191,7 +289,7 @@ void RawImageDataFloat::fixBadPixel(uint32_t x, uint32_t y, int component) {
   int x_find = static_cast<int>(x) - step;
   int curr = 0;
   while (x_find >= 0 && values[curr] < 0) {
-    if (0 == ((bad(y, x_find >> 3) >> (x_find & 7)) & 1)) {
+    if (!isBadPixel(x_find, static_cast<int>(y))) {
       values[curr] = img(y, x_find + component);
       dist[curr] = static_cast<float>(static_cast<int>(x) - x_find);
     }
@@ -201,7 +299,7 @@ void RawImageDataFloat::fixBadPixel(uint32_t x, uint32_t y, int component) {
   x_find = static_cast<int>(x) + step;
   curr = 1;
   while (x_find < uncropped_dim.x && values[curr] < 0) {
-    if (0 == ((bad(y, x_find >> 3) >> (x_find & 7)) & 1)) {
+    if (!isBadPixel(x_find, static_cast<int>(y))) {
       values[curr] = img(y, x_find + component);
       dist[curr] = static_cast<float>(x_find - static_cast<int>(x));
     }
@@ -212,7 +310,7 @@ void RawImageDataFloat::fixBadPixel(uint32_t x, uint32_t y, int component) {
   int y_find = static_cast<int>(y) - step;
   curr = 2;
   while (y_find >= 0 && values[curr] < 0) {
-    if (0 == ((bad(y_find, x >> 3) >> (x & 7)) & 1)) {
+    if (!isBadPixel(static_cast<int>(x), y_find)) {
       values[curr] = img(y_find, x + component);
       dist[curr] = static_cast<float>(static_cast<int>(y) - y_find);
     }
@@ -222,7 +320,7 @@ void RawImageDataFloat::fixBadPixel(uint32_t x, uint32_t y, int component) {
   y_find = static_cast<int>(y) + step;
   curr = 3;
   while (y_find < uncropped_dim.y && values[curr] < 0) {
-    if (0 == ((bad(y_find, x >> 3) >> (x & 7)) & 1)) {
+    if (!isBadPixel(static_cast<int>(x), y_find)) {
       values[curr] = img(y_find, x + component);
       dist[curr] = static_cast<float>(y_find - static_cast<int>(y));
     }
@@ -263,15 +361,4 @@ void RawImageDataFloat::doLookup(int start_y, int end_y) {
   ThrowRDE("Float point lookup tables not implemented");
 }
 
-void RawImageDataFloat::setWithLookUp(uint16_t value, std::byte* dst,
-                                      uint32_t* random) {
-  auto* dest = reinterpret_cast<float*>(dst);
-  if (table == nullptr) {
-    *dest = static_cast<float>(value) * (1.0F / 65535);
-    return;
-  }
-
-  ThrowRDE("Float point lookup tables not implemented");
-}
-
 } // namespace rawspeed
@@ -25,8 +25,11 @@
 #include "adt/Bit.h"
 #include "adt/Casts.h"
 #include "adt/CroppedArray2DRef.h"
+#include "adt/Mutex.h"
 #include "adt/Point.h"
 #include "common/Common.h"
+#include "common/CpuFeatures.h"
+#include "common/Dither.h"
 #include "common/TableLookUp.h"
 #include "decoders/RawDecoderException.h"
 #include "metadata/BlackArea.h"
@@ -37,9 +40,8 @@
 #include <memory>
 #include <vector>
 
-#ifdef WITH_SSE2
-#include "common/CpuFeatures.h"
-#include <emmintrin.h>
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+#include <immintrin.h>
 #endif
 
 using std::array;
@@ -60,14 +62,9 @@ RawImageDataU16::RawImageDataU16(const iPoint2D& _dim, uint32_t _cpp)
 void RawImageDataU16::calculateBlackAreas() {
   const Array2DRef<uint16_t> img = getU16DataAsUncroppedArray2DRef();
 
-  std::vector<uint16_t> histogramStorage;
-  auto histogram = Array2DRef<uint16_t>::create(histogramStorage, 65536, 4);
-
-  for (int row = 0; row != histogram.height(); ++row) {
-    for (int col = 0; col != histogram.width(); ++col) {
-      histogram(row, col) = 0;
-    }
-  }
+  // NOTE: 32-bit bins, a single value may well occur more than 65535 times.
+  std::vector<uint32_t> histogramStorage(65536 * 4, 0);
+  auto histogram = Array2DRef(histogramStorage.data(), 65536, 4);
 
   int totalpixels = 0;
 
@@ -81,13 +78,16 @@ void RawImageDataU16::calculateBlackAreas() {
       if (static_cast<int>(area.offset) + static_cast<int>(area.size) >
           uncropped_dim.y)
         ThrowRDE("Offset + size is larger than height of image");
+      // Of the columns [mOffset.x, mOffset.x + dim.x), how many are of the
+      // same parity as mOffset.x, and how many are not.
+      const std::array<uint32_t, 2> numCols = {
+          static_cast<uint32_t>((dim.x + 1) / 2),
+          static_cast<uint32_t>(dim.x / 2)};
       for (uint32_t y = area.offset; y < area.offset + area.size; y++) {
-        for (int x = mOffset.x; x < dim.x + mOffset.x; x++) {
-          // FIXME: this only samples a single row, not an area.
-          const auto localhist = histogram[(2 * (y & 1)) + (x & 1)];
-          const auto hBin = img(y, mOffset.x);
-          localhist(hBin)++;
-        }
+        // FIXME: this only samples a single row, not an area.
+        const auto hBin = img(y, mOffset.x);
+        for (int i = 0; i < 2; i++)
+          histogram[(2 * (y & 1)) + ((mOffset.x + i) & 1)](hBin) += numCols[i];
       }
       totalpixels += area.size * dim.x;
     }
@@ -97,13 +97,16 @@ void RawImageDataU16::calculateBlackAreas() {
       if (static_cast<int>(area.offset) + static_cast<int>(area.size) >
           uncropped_dim.x)
         ThrowRDE("Offset + size is larger than width of image");
+      // Of the columns [area.offset, area.offset + area.size), how many are
+      // of the same parity as area.offset, and how many are not.
+      const std::array<uint32_t, 2> numCols = {(area.size + 1) / 2,
+                                               area.size / 2};
       for (int y = mOffset.y; y < dim.y + mOffset.y; y++) {
-        for (uint32_t x = area.offset; x < area.size + area.offset; x++) {
-          // FIXME: this only samples a single row, not an area.
-          const auto localhist = histogram[(2 * (y & 1)) + (x & 1)];
-          const auto hBin = img(y, area.offset);
-          localhist(hBin)++;
-        }
+        // FIXME: this only samples a single row, not an area.
+        const auto hBin = img(y, area.offset);
+        for (int i = 0; i < 2; i++)
+          histogram[(2 * (y & 1)) + ((area.offset + i) & 1)](hBin) +=
+              numCols[i];
       }
       totalpixels += area.size * dim.y;
     }
@@ -125,7 +128,7 @@ void RawImageDataU16::calculateBlackAreas() {
 
   for (int i = 0; i < 4; i++) {
     const auto localhist = histogram[i];
-    int acc_pixels = localhist(0);
+    int64_t acc_pixels = localhist(0);
     int pixel_value = 0;
     while (acc_pixels <= totalpixels && pixel_value < 65535) {
       pixel_value++;
@@ -150,15 +153,28 @@ void RawImageDataU16::scaleBlackWhite() {
   int gw = (dim.x - skipBorder) * cpp;
   if ((blackAreas.empty() && !blackLevelSeparate && blackLevel < 0) ||
       !whitePoint) { // Estimate
+    auto img = getU16DataAsCroppedArray2DRef();
+    const int numRows = dim.y - (2 * skipBorder);
+    const int numCols = gw - skipBorder;
+
     int b = 65536;
     int m = 0;
-    auto img = getU16DataAsCroppedArray2DRef();
-    for (int row = skipBorder; row < (dim.y - skipBorder); row++) {
-      for (int col = skipBorder; col < gw; col++) {
-        uint16_t pixel = img(row, skipBorder + col);
-        b = min(static_cast<int>(pixel), b);
-        m = max(static_cast<int>(pixel), m);
-      }
+    if (numRows > 0 && numCols > 0) {
+      // Each chunk of rows is reduced separately, and then merged.
+      Mutex mergeMutex;
+      executor->parallelFor(numRows, [&](int begin, int end) {
+        int chunkMin = 65536;
+        int chunkMax = 0;
+        for (int row = skipBorder + begin; row < skipBorder + end; row++) {
+          const auto [lo, hi] = getMinMax(Array1DRef<const uint16_t>(
+              &img(row, 2 * skipBorder), numCols));
+          chunkMin = min(static_cast<int>(lo), chunkMin);
+          chunkMax = max(static_cast<int>(hi), chunkMax);
+        }
+        MutexLocker guard(&mergeMutex);
+        b = min(chunkMin, b);
+        m = max(chunkMax, m);
+      });
     }
     if (blackLevel < 0)
       blackLevel = b;
@@ -182,215 +198,262 @@ void RawImageDataU16::scaleBlackWhite() {
   startWorker(RawImageWorker::RawImageWorkerTask::SCALE_VALUES, true);
 }
 
-void RawImageDataU16::scaleValues(int start_y, int end_y) {
-#ifndef WITH_SSE2
-
-  return scaleValues_plain(start_y, end_y);
-
-#else
+namespace {
 
-  int depth_values = *whitePoint - (*blackLevelSeparate)(0, 0);
-  float app_scale = 65535.0F / implicit_cast<float>(depth_values);
-
-  // Check SSE2
-  if (Cpuid::SSE2() && app_scale < 63) {
-    scaleValues_SSE2(start_y, end_y);
-  } else {
-    scaleValues_plain(start_y, end_y);
+// Black/white scaling parameters, per position within the 2x2 CFA pattern
+// of the cropped image. The multipliers are in 18.14 fixed point.
+struct ScaleParams final {
+  std::array<int, 4> sub;
+  std::array<int, 4> mul;
+  // The black-subtracted pixels are clamped to [lo, hi]. That does not change
+  // the (clamped) result, but keeps the products within 32 bits.
+  std::array<int, 4> lo;
+  std::array<int, 4> hi;
+  int fullScaleFp; // 30.2 fp
+  int halfScaleFp; // 18.14 fp
+  bool dither;
+
+  [[nodiscard]] uint16_t apply(int pixel, int cfa, uint32_t counter) const {
+    int rand = 0;
+    if (dither) {
+      rand = halfScaleFp -
+             (fullScaleFp * static_cast<int>(ditherNoise(counter)));
+    }
+    const int v = std::clamp(pixel - sub[cfa], lo[cfa], hi[cfa]);
+    return clampBits(((v * mul[cfa]) + 8192 + rand) >> 14, 16);
   }
+};
 
-#endif
+// The dither counter of the first pixel of the row. It is computed in 64 bits,
+// since y * gw may not fit into an int, and then wraps around.
+uint32_t getDitherCounter(int y, int gw) {
+  return static_cast<uint32_t>(static_cast<int64_t>(y) * gw);
 }
 
-#ifdef WITH_SSE2
-void RawImageDataU16::scaleValues_SSE2(int start_y, int end_y) {
-  assert(blackLevelSeparate->width() == 2 && blackLevelSeparate->height() == 2);
-  auto blackLevelSeparate1D = *blackLevelSeparate->getAsArray1DRef();
+ScaleParams getScaleParams(Array2DRef<int> blackLevelSeparate, int whitePoint,
+                           iPoint2D offset, bool dither) {
+  assert(blackLevelSeparate.width() == 2 && blackLevelSeparate.height() == 2);
+  auto blackLevelSeparate1D = *blackLevelSeparate.getAsArray1DRef();
 
-  int depth_values = *whitePoint - blackLevelSeparate1D(0);
+  int depth_values = whitePoint - blackLevelSeparate1D(0);
   float app_scale = 65535.0F / implicit_cast<float>(depth_values);
 
+  ScaleParams p;
   // Scale in 30.2 fp
-  auto full_scale_fp = static_cast<int>(app_scale * 4.0F);
+  p.fullScaleFp = static_cast<int>(app_scale * 4.0F);
   // Half Scale in 18.14 fp
-  auto half_scale_fp = static_cast<int>(app_scale * 4095.0F);
-
-  __m128i sseround;
-  __m128i ssesub2;
-  __m128i ssesign;
-  __m128i rand_mul;
-  __m128i rand_mask;
-  __m128i sse_full_scale_fp;
-  __m128i sse_half_scale_fp;
-
-  std::array<uint32_t, 4 * 4> sub_mul;
-
-  // 10 bit fraction
-  uint32_t mul = static_cast<int>(
-      1024.0F * 65535.0F /
-      static_cast<float>(*whitePoint - blackLevelSeparate1D(mOffset.x & 1)));
-  mul |= (static_cast<int>(
-             1024.0F * 65535.0F /
-             static_cast<float>(*whitePoint -
-                                blackLevelSeparate1D((mOffset.x + 1) & 1))))
-         << 16;
-  uint32_t b = blackLevelSeparate1D(mOffset.x & 1) |
-               (blackLevelSeparate1D((mOffset.x + 1) & 1) << 16);
+  p.halfScaleFp = static_cast<int>(app_scale * 4095.0F);
+  p.dither = dither;
 
   for (int i = 0; i < 4; i++) {
-    sub_mul[i] = b;       // Subtract even lines
-    sub_mul[4 + i] = mul; // Multiply even lines
+    int v = i;
+    if ((offset.x & 1) != 0)
+      v ^= 1;
+    if ((offset.y & 1) != 0)
+      v ^= 2;
+    const int range = whitePoint - blackLevelSeparate1D(v);
+    p.mul[i] =
+        static_cast<int>(16384.0F * 65535.0F / static_cast<float>(range));
+    p.sub[i] = blackLevelSeparate1D(v);
+    p.lo[i] = -range;
+    p.hi[i] = range + (range / 2);
   }
+  return p;
+}
 
-  mul = static_cast<int>(
-      1024.0F * 65535.0F /
-      static_cast<float>(*whitePoint -
-                         blackLevelSeparate1D(2 + (mOffset.x & 1))));
-  mul |= (static_cast<int>(
-             1024.0F * 65535.0F /
-             static_cast<float>(*whitePoint - blackLevelSeparate1D(
-                                                  2 + ((mOffset.x + 1) & 1)))))
-         << 16;
-  b = blackLevelSeparate1D(2 + (mOffset.x & 1)) |
-      (blackLevelSeparate1D(2 + ((mOffset.x + 1) & 1)) << 16);
+} // namespace
 
-  for (int i = 0; i < 4; i++) {
-    sub_mul[8 + i] = b;    // Subtract odd lines
-    sub_mul[12 + i] = mul; // Multiply odd lines
-  }
+void RawImageDataU16::scaleValues(int start_y, int end_y) {
+  using Kernel = void (RawImageDataU16::*)(int, int);
+  static const Kernel kernel = selectKernel<Kernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX512, &RawImageDataU16::scaleValues_AVX512},
+      {CpuIsa::AVX2, &RawImageDataU16::scaleValues_AVX2},
+#endif
+      {CpuIsa::Generic, &RawImageDataU16::scaleValues_plain},
+  });
 
-  sseround = _mm_set_epi32(512, 512, 512, 512);
-  ssesub2 = _mm_set_epi32(32768, 32768, 32768, 32768);
-  ssesign = _mm_set_epi32(0x80008000, 0x80008000, 0x80008000, 0x80008000);
-  sse_full_scale_fp = _mm_set1_epi32(full_scale_fp | (full_scale_fp << 16));
-  sse_half_scale_fp = _mm_set1_epi32(half_scale_fp >> 4);
+  int depth_values = *whitePoint - (*blackLevelSeparate)(0, 0);
+  float app_scale = 65535.0F / implicit_cast<float>(depth_values);
 
-  if (mDitherScale) {
-    rand_mul = _mm_set1_epi32(0x4d9f1d32);
-  } else {
-    rand_mul = _mm_set1_epi32(0);
+  // The vectorized kernels rely on the products of the black-subtracted
+  // pixels fitting into 32 bits.
+  if (app_scale >= 63) {
+    scaleValues_plain(start_y, end_y);
+    return;
   }
-  rand_mask = _mm_set1_epi32(0x00ff00ff); // 8 random bits
 
-  Array2DRef<uint16_t> out(getU16DataAsUncroppedArray2DRef());
+  (this->*kernel)(start_y, end_y);
+}
 
+void RawImageDataU16::scaleValues_plain(int start_y, int end_y) {
+  const CroppedArray2DRef<uint16_t> img(getU16DataAsCroppedArray2DRef());
+  const ScaleParams p = getScaleParams(*blackLevelSeparate, *whitePoint,
+                                       mOffset, mDitherScale);
+
+  int gw = dim.x * cpp;
   for (int y = start_y; y < end_y; y++) {
-    __m128i sserandom;
-    if (mDitherScale) {
-      sserandom =
-          _mm_set_epi32(dim.x * 1676 + y * 18000, dim.x * 2342 + y * 34311,
-                        dim.x * 4272 + y * 12123, dim.x * 1234 + y * 23464);
-    } else {
-      sserandom = _mm_setzero_si128();
-    }
-    __m128i ssescale;
-    __m128i ssesub;
-    if (((y + mOffset.y) & 1) == 0) {
-      ssesub = _mm_loadu_si128(reinterpret_cast<__m128i*>(&sub_mul[0]));
-      ssescale = _mm_loadu_si128(reinterpret_cast<__m128i*>(&sub_mul[4]));
-    } else {
-      ssesub = _mm_loadu_si128(reinterpret_cast<__m128i*>(&sub_mul[8]));
-      ssescale = _mm_loadu_si128(reinterpret_cast<__m128i*>(&sub_mul[12]));
+    const uint32_t rowCounter = getDitherCounter(y, gw);
+    for (int x = 0; x < gw; x++) {
+      uint16_t& pixel = img(y, x);
+      pixel = p.apply(pixel, (2 * (y & 1)) + (x & 1), rowCounter + x);
     }
+  }
+}
 
-    for (int x = 0; x < static_cast<int>(roundDown(uncropped_dim.x, 8));
-         x += 8) {
-      __m128i pix_high;
-      __m128i temp;
-      __m128i pix_low =
-          _mm_load_si128(reinterpret_cast<__m128i*>(&out(mOffset.y + y, x)));
-      // Subtract black
-      pix_low = _mm_subs_epu16(pix_low, ssesub);
-      // Multiply the two unsigned shorts and combine it to 32 bit result
-      pix_high = _mm_mulhi_epu16(pix_low, ssescale);
-      temp = _mm_mullo_epi16(pix_low, ssescale);
-      pix_low = _mm_unpacklo_epi16(temp, pix_high);
-      pix_high = _mm_unpackhi_epi16(temp, pix_high);
-      // Add rounder
-      pix_low = _mm_add_epi32(pix_low, sseround);
-      pix_high = _mm_add_epi32(pix_high, sseround);
-
-      sserandom = _mm_xor_si128(_mm_mulhi_epi16(sserandom, rand_mul),
-                                _mm_mullo_epi16(sserandom, rand_mul));
-      __m128i rand_masked =
-          _mm_and_si128(sserandom, rand_mask); // Get 8 random bits
-      rand_masked = _mm_mullo_epi16(rand_masked, sse_full_scale_fp);
-
-      __m128i zero = _mm_setzero_si128();
-      __m128i rand_lo = _mm_sub_epi32(sse_half_scale_fp,
-                                      _mm_unpacklo_epi16(rand_masked, zero));
-      __m128i rand_hi = _mm_sub_epi32(sse_half_scale_fp,
-                                      _mm_unpackhi_epi16(rand_masked, zero));
-
-      pix_low = _mm_add_epi32(pix_low, rand_lo);
-      pix_high = _mm_add_epi32(pix_high, rand_hi);
-
-      // Shift down
-      pix_low = _mm_srai_epi32(pix_low, 10);
-      pix_high = _mm_srai_epi32(pix_high, 10);
-      // Subtract to avoid clipping
-      pix_low = _mm_sub_epi32(pix_low, ssesub2);
-      pix_high = _mm_sub_epi32(pix_high, ssesub2);
-      // Pack
-      pix_low = _mm_packs_epi32(pix_low, pix_high);
-      // Shift sign off
-      pix_low = _mm_xor_si128(pix_low, ssesign);
-      _mm_store_si128(reinterpret_cast<__m128i*>(&out(mOffset.y + y, x)),
-                      pix_low);
-    }
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+namespace {
+
+struct ScaleVectorsAVX2 final {
+  __m256i sub;
+  __m256i mul;
+  __m256i lo;
+  __m256i hi;
+  __m256i bias; // Rounding, plus the dither offset.
+  __m256i fullScaleFp;
+};
+
+// Even lanes get the first value, odd lanes get the second one.
+RAWSPEED_TARGET_AVX2 inline __m256i broadcastPairAVX2(int even, int odd) {
+  return _mm256_set1_epi64x(static_cast<int64_t>(
+      (static_cast<uint64_t>(static_cast<uint32_t>(odd)) << 32U) |
+      static_cast<uint32_t>(even)));
+}
+
+RAWSPEED_TARGET_AVX2 inline ScaleVectorsAVX2
+getScaleVectorsAVX2(const ScaleParams& p, int row) {
+  return {broadcastPairAVX2(p.sub[row], p.sub[row + 1]),
+          broadcastPairAVX2(p.mul[row], p.mul[row + 1]),
+          broadcastPairAVX2(p.lo[row], p.lo[row + 1]),
+          broadcastPairAVX2(p.hi[row], p.hi[row + 1]),
+          _mm256_set1_epi32(8192 + (p.dither ? p.halfScaleFp : 0)),
+          _mm256_set1_epi32(p.fullScaleFp)};
+}
+
+// Scales 8 pixels, as ScaleParams::apply() would, but without final clamp.
+RAWSPEED_TARGET_AVX2 inline __m256i
+scaleLanesAVX2(__m256i pix, const ScaleVectorsAVX2& k, bool dither,
+               uint32_t counter) {
+  __m256i bias = k.bias;
+  if (dither) {
+    const __m256i counters =
+        _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(counter)),
+                         _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    bias = _mm256_sub_epi32(
+        bias, _mm256_mullo_epi32(k.fullScaleFp, ditherNoise(counters)));
   }
+  __m256i v = _mm256_sub_epi32(pix, k.sub);
+  v = _mm256_min_epi32(_mm256_max_epi32(v, k.lo), k.hi);
+  v = _mm256_add_epi32(_mm256_mullo_epi32(v, k.mul), bias);
+  return _mm256_srai_epi32(v, 14);
 }
-#endif
 
-void RawImageDataU16::scaleValues_plain(int start_y, int end_y) {
-  const CroppedArray2DRef<uint16_t> img(getU16DataAsCroppedArray2DRef());
+struct ScaleVectorsAVX512 final {
+  __m512i sub;
+  __m512i mul;
+  __m512i lo;
+  __m512i hi;
+  __m512i bias; // Rounding, plus the dither offset.
+  __m512i fullScaleFp;
+};
+
+// Even lanes get the first value, odd lanes get the second one.
+RAWSPEED_TARGET_AVX512 inline __m512i broadcastPairAVX512(int even, int odd) {
+  return _mm512_set1_epi64(static_cast<int64_t>(
+      (static_cast<uint64_t>(static_cast<uint32_t>(odd)) << 32U) |
+      static_cast<uint32_t>(even)));
+}
 
-  assert(blackLevelSeparate->width() == 2 && blackLevelSeparate->height() == 2);
-  auto blackLevelSeparate1D = *blackLevelSeparate->getAsArray1DRef();
+RAWSPEED_TARGET_AVX512 inline ScaleVectorsAVX512
+getScaleVectorsAVX512(const ScaleParams& p, int row) {
+  return {broadcastPairAVX512(p.sub[row], p.sub[row + 1]),
+          broadcastPairAVX512(p.mul[row], p.mul[row + 1]),
+          broadcastPairAVX512(p.lo[row], p.lo[row + 1]),
+          broadcastPairAVX512(p.hi[row], p.hi[row + 1]),
+          _mm512_set1_epi32(8192 + (p.dither ? p.halfScaleFp : 0)),
+          _mm512_set1_epi32(p.fullScaleFp)};
+}
 
-  int depth_values = *whitePoint - blackLevelSeparate1D(0);
-  float app_scale = 65535.0F / implicit_cast<float>(depth_values);
+// Scales 16 pixels, as ScaleParams::apply() would.
+RAWSPEED_TARGET_AVX512 inline __m256i
+scaleLanesAVX512(__m256i pix, const ScaleVectorsAVX512& k, bool dither,
+                 uint32_t counter) {
+  __m512i bias = k.bias;
+  if (dither) {
+    const __m512i counters = _mm512_add_epi32(
+        _mm512_set1_epi32(static_cast<int>(counter)),
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                          15));
+    bias = _mm512_sub_epi32(
+        bias, _mm512_mullo_epi32(k.fullScaleFp, ditherNoise(counters)));
+  }
+  __m512i v = _mm512_sub_epi32(_mm512_cvtepu16_epi32(pix), k.sub);
+  v = _mm512_min_epi32(_mm512_max_epi32(v, k.lo), k.hi);
+  v = _mm512_add_epi32(_mm512_mullo_epi32(v, k.mul), bias);
+  v = _mm512_max_epi32(_mm512_srai_epi32(v, 14), _mm512_setzero_si512());
+  return _mm512_cvtusepi32_epi16(v);
+}
 
-  // Scale in 30.2 fp
-  auto full_scale_fp = static_cast<int>(app_scale * 4.0F);
-  // Half Scale in 18.14 fp
-  auto half_scale_fp = static_cast<int>(app_scale * 4095.0F);
+} // namespace
+
+RAWSPEED_TARGET_AVX2 void RawImageDataU16::scaleValues_AVX2(int start_y,
+                                                             int end_y) {
+  const CroppedArray2DRef<uint16_t> img(getU16DataAsCroppedArray2DRef());
+  const ScaleParams p = getScaleParams(*blackLevelSeparate, *whitePoint,
+                                       mOffset, mDitherScale);
 
-  // Not SSE2
   int gw = dim.x * cpp;
-  std::array<int, 4> mul;
-  std::array<int, 4> sub;
-  for (int i = 0; i < 4; i++) {
-    int v = i;
-    if ((mOffset.x & 1) != 0)
-      v ^= 1;
-    if ((mOffset.y & 1) != 0)
-      v ^= 2;
-    mul[i] = static_cast<int>(
-        16384.0F * 65535.0F /
-        static_cast<float>(*whitePoint - blackLevelSeparate1D(v)));
-    sub[i] = blackLevelSeparate1D(v);
+  for (int y = start_y; y < end_y; y++) {
+    const int row = 2 * (y & 1);
+    const ScaleVectorsAVX2 k = getScaleVectorsAVX2(p, row);
+    const uint32_t rowCounter = getDitherCounter(y, gw);
+    uint16_t* line = &img(y, 0);
+
+    int x = 0;
+    for (; x + 16 <= gw; x += 16) {
+      auto* ptr = reinterpret_cast<__m256i*>(line + x);
+      const __m256i pix = _mm256_loadu_si256(ptr);
+      const __m256i lo = scaleLanesAVX2(
+          _mm256_cvtepu16_epi32(_mm256_castsi256_si128(pix)), k, p.dither,
+          rowCounter + x);
+      const __m256i hi = scaleLanesAVX2(
+          _mm256_cvtepu16_epi32(_mm256_extracti128_si256(pix, 1)), k,
+          p.dither, rowCounter + x + 8);
+      // Packing works within 128-bit lanes, restore the order.
+      _mm256_storeu_si256(ptr, _mm256_permute4x64_epi64(
+                                   _mm256_packus_epi32(lo, hi), 0b11011000));
+    }
+    for (; x < gw; x++)
+      line[x] = p.apply(line[x], row + (x & 1), rowCounter + x);
   }
+}
+
+RAWSPEED_TARGET_AVX512 void RawImageDataU16::scaleValues_AVX512(int start_y,
+                                                                 int end_y) {
+  const CroppedArray2DRef<uint16_t> img(getU16DataAsCroppedArray2DRef());
+  const ScaleParams p = getScaleParams(*blackLevelSeparate, *whitePoint,
+                                       mOffset, mDitherScale);
+
+  int gw = dim.x * cpp;
   for (int y = start_y; y < end_y; y++) {
-    int v = dim.x + y * 36969;
-    for (int x = 0; x < gw; x++) {
-      int rand;
-      if (mDitherScale) {
-        v = 18000 * (v & 65535) + (v >> 16);
-        rand = half_scale_fp - (full_scale_fp * (v & 2047));
-      } else {
-        rand = 0;
-      }
-      uint16_t& pixel = img(y, x);
-      pixel = clampBits(((pixel - sub[(2 * (y & 1)) + (x & 1)]) *
-                             mul[(2 * (y & 1)) + (x & 1)] +
-                         8192 + rand) >>
-                            14,
-                        16);
+    const ScaleVectorsAVX512 k = getScaleVectorsAVX512(p, 2 * (y & 1));
+    const uint32_t rowCounter = getDitherCounter(y, gw);
+    uint16_t* line = &img(y, 0);
+
+    // The tail of the row is handled via masked loads and stores.
+    for (int x = 0; x < gw; x += 16) {
+      const __mmask16 mask =
+          gw - x >= 16 ? 0xFFFF : static_cast<__mmask16>((1U << (gw - x)) - 1);
+      const __m256i pix = _mm256_maskz_loadu_epi16(mask, line + x);
+      _mm256_mask_storeu_epi16(
+          line + x, mask, scaleLanesAVX512(pix, k, p.dither, rowCounter + x));
     }
   }
 }
 
+#endif
+
 /* This performs a 4 way interpolated pixel */
 /* The value is interpolated from the 4 closest valid pixels in */
 /* the horizontal and vertical direction. Pixels found further away */
@@ -407,15 +470,13 @@ void RawImageDataU16::fixBadPixel(uint32_t x, uint32_t y, int component) {
   dist.fill(0);
   weight.fill(0);
 
-  const auto bad =
-      Array2DRef(mBadPixelMap.data(), mBadPixelMapPitch, uncropped_dim.y);
   int step = isCFA ? 2 : 1;
 
   // Find pixel to the left
   int x_find = static_cast<int>(x) - step;
   int curr = 0;
   while (x_find >= 0 && values[curr] < 0) {
-    if (0 == ((bad(y, x_find >> 3) >> (x_find & 7)) & 1)) {
+    if (!isBadPixel(x_find, static_cast<int>(y))) {
       values[curr] = img(y, x_find + component);
       dist[curr] = static_cast<int>(x) - x_find;
     }
@@ -425,7 +486,7 @@ void RawImageDataU16::fixBadPixel(uint32_t x, uint32_t y, int component) {
   x_find = static_cast<int>(x) + step;
   curr = 1;
   while (x_find < uncropped_dim.x && values[curr] < 0) {
-    if (0 == ((bad(y, x_find >> 3) >> (x_find & 7)) & 1)) {
+    if (!isBadPixel(x_find, static_cast<int>(y))) {
       values[curr] = img(y, x_find + component);
       dist[curr] = x_find - static_cast<int>(x);
     }
@@ -436,7 +497,7 @@ void RawImageDataU16::fixBadPixel(uint32_t x, uint32_t y, int component) {
   int y_find = static_cast<int>(y) - step;
   curr = 2;
   while (y_find >= 0 && values[curr] < 0) {
-    if (0 == ((bad(y_find, x >> 3) >> (x & 7)) & 1)) {
+    if (!isBadPixel(static_cast<int>(x), y_find)) {
       values[curr] = img(y_find, x + component);
       dist[curr] = static_cast<int>(y) - y_find;
     }
@@ -446,7 +507,7 @@ void RawImageDataU16::fixBadPixel(uint32_t x, uint32_t y, int component) {
   y_find = static_cast<int>(y) + step;
   curr = 3;
   while (y_find < uncropped_dim.y && values[curr] < 0) {
-    if (0 == ((bad(y_find, x >> 3) >> (x & 7)) & 1)) {
+    if (!isBadPixel(static_cast<int>(x), y_find)) {
       values[curr] = img(y_find, x + component);
       dist[curr] = y_find - static_cast<int>(y);
     }
@@ -484,38 +545,153 @@ void RawImageDataU16::fixBadPixel(uint32_t x, uint32_t y, int component) {
       fixBadPixel(x, y, i);
 }
 
-// TODO: Could be done with SSE2
 void RawImageDataU16::doLookup(int start_y, int end_y) {
-  const Array2DRef<uint16_t> img = getU16DataAsUncroppedArray2DRef();
+  using Kernel = void (RawImageDataU16::*)(int, int);
+  static const Kernel kernel = selectKernel<Kernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX512, &RawImageDataU16::doLookup_AVX512},
+      {CpuIsa::AVX2, &RawImageDataU16::doLookup_AVX2},
+#endif
+      {CpuIsa::Generic, &RawImageDataU16::doLookup_plain},
+  });
 
-  if (table->ntables == 1) {
-    if (table->dither) {
-      int gw = uncropped_dim.x * cpp;
-      const auto t = table->getTable(0);
-      for (int y = start_y; y < end_y; y++) {
-        uint32_t v = (uncropped_dim.x + y * 13) ^ 0x45694584;
-        for (int x = 0; x < gw; x++) {
-          uint16_t p = img(y, x);
-          uint32_t base = t(2 * p + 0);
-          uint32_t delta = t(2 * p + 1);
-          v = 15700 * (v & 65535) + (v >> 16);
-          uint32_t pix = base + ((delta * (v & 2047) + 1024) >> 12);
-          img(y, x) = clampBits(pix, 16);
-        }
-      }
-      return;
-    }
+  if (table->ntables != 1)
+    ThrowRDE("Table lookup with multiple components not implemented");
 
-    int gw = uncropped_dim.x * cpp;
-    const auto t = table->getTable(0);
+  (this->*kernel)(start_y, end_y);
+}
+
+void RawImageDataU16::doLookup_plain(int start_y, int end_y) {
+  const Array2DRef<uint16_t> img = getU16DataAsUncroppedArray2DRef();
+  const Array1DRef<const uint16_t> t = table->getTable(0);
+
+  if (!table->dither) {
     for (int y = start_y; y < end_y; y++) {
-      for (int x = 0; x < gw; x++) {
+      for (int x = 0; x < img.width(); x++)
         img(y, x) = t(img(y, x));
-      }
     }
     return;
   }
-  ThrowRDE("Table lookup with multiple components not implemented");
+
+  for (int y = start_y; y < end_y; y++) {
+    const auto rowCounter = static_cast<uint32_t>(y * img.width());
+    for (int x = 0; x < img.width(); x++)
+      img(y, x) = TableLookUp::lookUpDithered(t, img(y, x), rowCounter + x);
+  }
+}
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+namespace {
+
+// The kernels gather 32-bit words at the 16-bit positions of the table.
+// For a plain table, the wanted value is the low half of the word,
+// for a dithered one, the word is the (base, delta) pair. Even the word at
+// the very last position is within the table, since it is allocated with
+// the room for the dithered pairs either way.
+
+// Looks up 8 pixels, as TableLookUp::lookUpDithered() would, but without
+// the final clamp.
+RAWSPEED_TARGET_AVX2 inline __m256i lookUpLanesAVX2(const uint16_t* t,
+                                                    bool dither, __m256i pix,
+                                                    uint32_t counter) {
+  const auto* words = reinterpret_cast<const int*>(t);
+  const __m256i lowHalf = _mm256_set1_epi32(0xFFFF);
+  if (!dither)
+    return _mm256_and_si256(_mm256_i32gather_epi32(words, pix, 2), lowHalf);
+
+  const __m256i pair = _mm256_i32gather_epi32(words, pix, 4);
+  const __m256i counters = _mm256_xor_si256(
+      _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(counter)),
+                       _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)),
+      _mm256_set1_epi32(TableLookUp::ditherSeed));
+  __m256i v = _mm256_mullo_epi32(_mm256_srli_epi32(pair, 16),
+                                 ditherNoise(counters));
+  v = _mm256_srli_epi32(_mm256_add_epi32(v, _mm256_set1_epi32(1024)), 12);
+  return _mm256_add_epi32(_mm256_and_si256(pair, lowHalf), v);
+}
+
+// Looks up 16 pixels, as TableLookUp::lookUpDithered() would.
+RAWSPEED_TARGET_AVX512 inline __m256i lookUpLanesAVX512(const uint16_t* t,
+                                                        bool dither,
+                                                        __m256i pix,
+                                                        uint32_t counter) {
+  const auto* words = reinterpret_cast<const int*>(t);
+  const __m512i idx = _mm512_cvtepu16_epi32(pix);
+  if (!dither)
+    return _mm512_cvtepi32_epi16(_mm512_i32gather_epi32(idx, words, 2));
+
+  const __m512i pair = _mm512_i32gather_epi32(idx, words, 4);
+  const __m512i counters = _mm512_xor_si512(
+      _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(counter)),
+                       _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                         11, 12, 13, 14, 15)),
+      _mm512_set1_epi32(TableLookUp::ditherSeed));
+  __m512i v = _mm512_mullo_epi32(_mm512_srli_epi32(pair, 16),
+                                 ditherNoise(counters));
+  v = _mm512_srli_epi32(_mm512_add_epi32(v, _mm512_set1_epi32(1024)), 12);
+  v = _mm512_add_epi32(_mm512_and_si512(pair, _mm512_set1_epi32(0xFFFF)), v);
+  return _mm512_cvtusepi32_epi16(v);
+}
+
+} // namespace
+
+RAWSPEED_TARGET_AVX2 void RawImageDataU16::doLookup_AVX2(int start_y,
+                                                          int end_y) {
+  const Array2DRef<uint16_t> img = getU16DataAsUncroppedArray2DRef();
+  const Array1DRef<const uint16_t> t = table->getTable(0);
+  const bool dither = table->dither;
+
+  for (int y = start_y; y < end_y; y++) {
+    const auto rowCounter = static_cast<uint32_t>(y * img.width());
+    uint16_t* line = &img(y, 0);
+
+    int x = 0;
+    for (; x + 16 <= img.width(); x += 16) {
+      auto* ptr = reinterpret_cast<__m256i*>(line + x);
+      const __m256i pix = _mm256_loadu_si256(ptr);
+      const __m256i lo = lookUpLanesAVX2(
+          t.begin(), dither, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(pix)),
+          rowCounter + x);
+      const __m256i hi = lookUpLanesAVX2(
+          t.begin(), dither,
+          _mm256_cvtepu16_epi32(_mm256_extracti128_si256(pix, 1)),
+          rowCounter + x + 8);
+      // Packing works within 128-bit lanes, restore the order.
+      _mm256_storeu_si256(ptr, _mm256_permute4x64_epi64(
+                                   _mm256_packus_epi32(lo, hi), 0b11011000));
+    }
+    for (; x < img.width(); x++) {
+      line[x] = dither ? TableLookUp::lookUpDithered(t, line[x], rowCounter + x)
+                       : t(line[x]);
+    }
+  }
 }
 
+RAWSPEED_TARGET_AVX512 void RawImageDataU16::doLookup_AVX512(int start_y,
+                                                              int end_y) {
+  const Array2DRef<uint16_t> img = getU16DataAsUncroppedArray2DRef();
+  const Array1DRef<const uint16_t> t = table->getTable(0);
+  const bool dither = table->dither;
+
+  for (int y = start_y; y < end_y; y++) {
+    const auto rowCounter = static_cast<uint32_t>(y * img.width());
+    uint16_t* line = &img(y, 0);
+
+    // The tail of the row is handled via masked loads and stores.
+    for (int x = 0; x < img.width(); x += 16) {
+      const __mmask16 mask =
+          img.width() - x >= 16
+              ? 0xFFFF
+              : static_cast<__mmask16>((1U << (img.width() - x)) - 1);
+      const __m256i pix = _mm256_maskz_loadu_epi16(mask, line + x);
+      _mm256_mask_storeu_epi16(
+          line + x, mask,
+          lookUpLanesAVX512(t.begin(), dither, pix, rowCounter + x));
+    }
+  }
+}
+
+#endif
+
 } // namespace rawspeed
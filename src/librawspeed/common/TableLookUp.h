@@ -22,6 +22,8 @@
 #pragma once
 
 #include "adt/Array1DRef.h"
+#include "adt/Bit.h"
+#include "common/Dither.h"
 #include <cstdint>
 #include <vector>
 
@@ -36,6 +38,22 @@ public:
   const int ntables;
   std::vector<uint16_t> tables;
   const bool dither;
+
+  // Seeds the dither noise of the lookups, so that it does not correlate
+  // with the noise of the black/white scaling of the same pixel.
+  static constexpr uint32_t ditherSeed = 0x45694584;
+
+  // Maps a value through a dithered table. The noise only depends on the
+  // value's position (its counter), so the values may be looked up in any
+  // order, by any number of threads, several at a time.
+  [[nodiscard]] static uint16_t
+  lookUpDithered(Array1DRef<const uint16_t> t, uint16_t value,
+                 uint32_t counter) {
+    const uint32_t base = t(2 * value + 0);
+    const uint32_t delta = t(2 * value + 1);
+    const uint32_t noise = ditherNoise(counter ^ ditherSeed);
+    return clampBits(base + ((delta * noise + 1024) >> 12), 16);
+  }
 };
 
 } // namespace rawspeed
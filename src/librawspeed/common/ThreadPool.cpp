@@ -0,0 +1,196 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "common/ThreadPool.h"
+#include "adt/Invariant.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace rawspeed {
+
+namespace {
+
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentWorker = -1;
+
+} // namespace
+
+ThreadPool::ThreadPool(int numThreads) {
+  if (numThreads <= 0)
+    numThreads = static_cast<int>(std::thread::hardware_concurrency());
+  numThreads = std::max(numThreads, 1);
+
+  queues.reserve(numThreads);
+  for (int i = 0; i != numThreads; ++i)
+    queues.emplace_back(std::make_unique<TaskQueue>());
+
+  workers.reserve(numThreads);
+  for (int i = 0; i != numThreads; ++i)
+    workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock lock(sleepMutex);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  for (std::thread& worker : workers)
+    worker.join();
+  invariant(numQueuedTasks == 0);
+}
+
+int ThreadPool::getCurrentWorker() const {
+  return currentPool == this ? currentWorker : -1;
+}
+
+void ThreadPool::push(std::function<void()> task) {
+  // Workers push onto their own queue, everyone else spreads the tasks.
+  int q = getCurrentWorker();
+  if (q < 0)
+    q = static_cast<int>(nextQueue++ % queues.size());
+
+  {
+    std::scoped_lock lock(queues[q]->mutex);
+    queues[q]->tasks.emplace_back(std::move(task));
+  }
+  ++numQueuedTasks;
+
+  // Make sure that a worker that is about to go to sleep notices the task.
+  { std::scoped_lock lock(sleepMutex); }
+  wakeUp.notify_one();
+}
+
+bool ThreadPool::tryRunOne(int self) {
+  const auto numQueues = static_cast<int>(queues.size());
+  const int first = self >= 0 ? self : 0;
+
+  std::function<void()> task;
+  for (int i = 0; i != numQueues && !task; ++i) {
+    TaskQueue& queue = *queues[(first + i) % numQueues];
+    std::scoped_lock lock(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+    // Our own newest task is the hottest in cache, but steal the oldest one,
+    // which is the least likely to be needed by its owner soon.
+    if (i == 0 && self >= 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+  }
+
+  if (!task)
+    return false;
+
+  --numQueuedTasks;
+  task();
+  return true;
+}
+
+void ThreadPool::workerLoop(int self) {
+  currentPool = this;
+  currentWorker = self;
+
+  while (true) {
+    if (tryRunOne(self))
+      continue;
+
+    std::unique_lock lock(sleepMutex);
+    wakeUp.wait(lock, [this]() { return stopping || numQueuedTasks > 0; });
+    if (stopping && numQueuedTasks == 0)
+      return;
+  }
+}
+
+void ThreadPool::parallelFor(int numItems,
+                             const std::function<void(int, int)>& body) {
+  if (numItems <= 0)
+    return;
+
+  const int numChunks = std::min(numItems, getNumThreads());
+  if (numChunks == 1) {
+    body(0, numItems);
+    return;
+  }
+
+  // The chunks are claimed from a shared counter, both by the caller and by
+  // the helper tasks that are queued in the pool. A helper that only runs
+  // after all the chunks were claimed does nothing, but it may outlive this
+  // call, hence the shared ownership.
+  struct LoopState final {
+    std::atomic<int> nextChunk = 0;
+    std::mutex mutex;
+    std::condition_variable done;
+    int remaining;
+    std::exception_ptr firstException;
+  };
+  const auto state = std::make_shared<LoopState>();
+  state->remaining = numChunks;
+
+  // NOTE: `body` is only accessed after claiming a chunk, and the caller does
+  // not return until all the claimed chunks are done.
+  auto runChunks = [numItems, numChunks, &body](LoopState& loop) {
+    for (int chunk = loop.nextChunk++; chunk < numChunks;
+         chunk = loop.nextChunk++) {
+      const auto [begin, end] = getChunk(numItems, numChunks, chunk);
+      std::exception_ptr exception;
+      try {
+        body(begin, end);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+      std::scoped_lock lock(loop.mutex);
+      if (exception && !loop.firstException)
+        loop.firstException = exception;
+      if (--loop.remaining == 0)
+        loop.done.notify_all();
+    }
+  };
+
+  for (int helper = 1; helper != numChunks; ++helper)
+    push([state, runChunks]() { runChunks(*state); });
+
+  // Only ever help with the chunks of this very loop: running some unrelated
+  // queued task here could block us for arbitrarily long.
+  runChunks(*state);
+
+  {
+    // Whatever is still remaining is already being processed by someone.
+    std::unique_lock lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->remaining == 0; });
+  }
+
+  if (state->firstException)
+    std::rethrow_exception(state->firstException);
+}
+
+void ThreadPool::submit(std::function<void()> task) { push(std::move(task)); }
+
+} // namespace rawspeed
@@ -0,0 +1,79 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "common/Executor.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rawspeed {
+
+// A work-stealing pool of threads. Each worker has its own queue of tasks,
+// which it processes in LIFO order, and when it is empty, it steals
+// the oldest tasks from the other workers. The thread that is waiting on
+// a parallelFor() helps with the chunks of that loop (but never with any
+// other queued work) instead of sleeping, so it is fine to nest
+// parallelFor()'s, and to share one pool between concurrent decodes.
+class ThreadPool final : public Executor {
+  struct TaskQueue final {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<TaskQueue>> queues; // One per worker.
+  std::vector<std::thread> workers;
+
+  std::atomic<int> numQueuedTasks = 0;
+  std::atomic<unsigned> nextQueue = 0;
+
+  std::mutex sleepMutex;
+  std::condition_variable wakeUp;
+  bool stopping = false; // Guarded by sleepMutex.
+
+  // Index of the worker of this pool that is the current thread, or -1.
+  [[nodiscard]] int getCurrentWorker() const;
+
+  void push(std::function<void()> task);
+  bool tryRunOne(int self);
+  void workerLoop(int self);
+
+public:
+  // By default, one worker per hardware thread.
+  explicit ThreadPool(int numThreads = 0);
+  ~ThreadPool() override;
+
+  [[nodiscard]] int getNumThreads() const override {
+    return static_cast<int>(workers.size());
+  }
+
+  void parallelFor(int numItems,
+                   const std::function<void(int, int)>& body) override;
+
+  void submit(std::function<void()> task) override;
+};
+
+} // namespace rawspeed
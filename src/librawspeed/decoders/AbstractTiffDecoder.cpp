@@ -20,10 +20,13 @@
 
 #include "decoders/AbstractTiffDecoder.h"
 #include "decoders/RawDecoderException.h"
+#include "io/BlockCachedInput.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
 #include "tiff/TiffTag.h"
+#include <algorithm>
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 namespace rawspeed {
@@ -55,4 +58,25 @@ AbstractTiffDecoder::getIFDWithLargestImage(TiffTag filter) const {
   return res;
 }
 
+void AbstractTiffDecoder::fetchStripsAndTiles(BlockCachedInput* input,
+                                              const TiffIFD* ifd) const {
+  for (const auto& [offsetsTag, countsTag] :
+       {std::pair(TiffTag::STRIPOFFSETS, TiffTag::STRIPBYTECOUNTS),
+        std::pair(TiffTag::TILEOFFSETS, TiffTag::TILEBYTECOUNTS)}) {
+    if (!ifd->hasEntry(offsetsTag) || !ifd->hasEntry(countsTag))
+      continue;
+
+    const TiffEntry* offsets = ifd->getEntry(offsetsTag);
+    const TiffEntry* counts = ifd->getEntry(countsTag);
+    for (uint32_t i = 0; i < std::min(offsets->count, counts->count); ++i) {
+      const uint32_t offset = offsets->getU32(i);
+      // Truncated chunks are diagnosed (or tolerated) by the decoding itself.
+      if (!mFile.isValid(offset))
+        continue;
+      (void)input->fetch(offset,
+                         std::min(counts->getU32(i), mFile.getSize() - offset));
+    }
+  }
+}
+
 } // namespace rawspeed
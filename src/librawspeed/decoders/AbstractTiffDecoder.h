@@ -30,6 +30,7 @@
 
 namespace rawspeed {
 
+class BlockCachedInput;
 class Buffer;
 class CameraMetaData;
 
@@ -68,6 +69,10 @@ public:
 
   [[nodiscard]] const TiffIFD*
   getIFDWithLargestImage(TiffTag filter = TiffTag::IMAGEWIDTH) const;
+
+protected:
+  // Fetches all the strips and tiles of the given IFD.
+  void fetchStripsAndTiles(BlockCachedInput* input, const TiffIFD* ifd) const;
 };
 
 } // namespace rawspeed
@@ -34,16 +34,19 @@
 #include "decompressors/LJpegDecoder.h"
 #include "decompressors/SonyArw1Decompressor.h"
 #include "decompressors/SonyArw2Decompressor.h"
+#include "decompressors/TileEngine.h"
 #include "decompressors/UncompressedDecompressor.h"
+#include "io/BlockCachedInput.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
-#include "io/IOException.h"
 #include "metadata/Camera.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
 #include "tiff/TiffTag.h"
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cinttypes>
@@ -138,7 +141,7 @@ RawImage ArwDecoder::decodeTransitionalArw() {
     return mRaw;
   }
 
-  if (hints.contains("srf_format"))
+  if (hints.contains(Hint::srf_format))
     return decodeSRF();
 
   ThrowRDE("No image data found");
@@ -256,6 +259,10 @@ RawImage ArwDecoder::decodeRawInternal() {
   } else
     DecodeARW2(input, width, height, bitPerPixel);
 
+  // Only the compressed ARW2 images are stored via the curve.
+  if (!arw1 && bitPerPixel == 8)
+    curveHandler.apply();
+
   if (bitPerPixel == 12)
     mShiftDownScaleForExif = 2;
 
@@ -278,7 +285,7 @@ void ArwDecoder::DecodeUncompressed(const TiffIFD* raw) const {
 
   const Buffer buf(mFile.getSubView(off, c2));
 
-  if (hints.contains("sr2_format")) {
+  if (hints.contains(Hint::sr2_format)) {
     UncompressedDecompressor u(ByteStream(DataBuffer(buf, Endianness::little)),
                                mRaw,
                                iRectangle2D({0, 0}, iPoint2D(width, height)),
@@ -367,44 +374,34 @@ void ArwDecoder::DecodeLJpeg(const TiffIFD* raw) {
   }
 
   mRaw->createData();
-#ifdef HAVE_OPENMP
-#pragma omp parallel for schedule(static) default(none)                        \
-    shared(offsets, counts) firstprivate(tilesX, tilew, tileh)
-#endif
-  for (int tile = 0U; tile < static_cast<int>(offsets->count); tile++) {
-    try {
-      const uint32_t tileX = tile % tilesX;
-      const uint32_t tileY = tile / tilesX;
-      const uint32_t offset = offsets->getU32(tile);
-      const uint32_t length = counts->getU32(tile);
-
-      LJpegDecoder decoder(
-          ByteStream(
-              DataBuffer(mFile.getSubView(offset, length), Endianness::little)),
-          mRaw);
-      auto offsetX = implicit_cast<uint32_t>(tileX * tilew);
-      auto offsetY = tileY * tileh;
-      auto tileWidth = implicit_cast<uint32_t>(tilew);
-      auto tileHeight = tileh;
-      auto maxDim = iPoint2D{implicit_cast<int>(tileWidth),
-                             implicit_cast<int>(tileHeight)};
-      decoder.decode(offsetX, offsetY, tileWidth, tileHeight, maxDim,
-                     /*fixDng16Bug=*/false);
-    } catch (const RawDecoderException& err) {
-      mRaw->setError(err.what());
-    } catch (const IOException& err) {
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
-  }
 
-  std::string firstErr;
-  if (mRaw->isTooManyErrors(1, &firstErr)) {
-    ThrowRDE("Too many errors encountered. Giving up. First Error:\n%s",
-             firstErr.c_str());
-  }
+  // The compressed size of a tile is a good estimate of its decoding cost.
+  std::vector<TileEngine::Cost> costs;
+  costs.reserve(offsets->count);
+  for (int tile = 0U; tile < implicit_cast<int>(offsets->count); tile++)
+    costs.emplace_back(counts->getU32(tile));
+
+  TileEngine(mRaw, Array1DRef<const TileEngine::Cost>(
+                       costs.data(), implicit_cast<int>(costs.size())))
+      .run([this, offsets, counts, tilesX, tilew, tileh](int tile) {
+        const uint32_t tileX = tile % tilesX;
+        const uint32_t tileY = tile / tilesX;
+        const uint32_t offset = offsets->getU32(tile);
+        const uint32_t length = counts->getU32(tile);
+
+        LJpegDecoder decoder(
+            ByteStream(DataBuffer(mFile.getSubView(offset, length),
+                                  Endianness::little)),
+            mRaw);
+        auto offsetX = implicit_cast<uint32_t>(tileX * tilew);
+        auto offsetY = tileY * tileh;
+        auto tileWidth = implicit_cast<uint32_t>(tilew);
+        auto tileHeight = tileh;
+        auto maxDim = iPoint2D{implicit_cast<int>(tileWidth),
+                               implicit_cast<int>(tileHeight)};
+        decoder.decode(offsetX, offsetY, tileWidth, tileHeight, maxDim,
+                       /*fixDng16Bug=*/false);
+      });
 
   const TiffEntry* size_entry = raw->getEntry(TiffTag::SONYRAWIMAGESIZE);
   iRectangle2D crop(0, 0, size_entry->getU32(0), size_entry->getU32(1));
@@ -436,6 +433,58 @@ void ArwDecoder::DecodeARW2(ByteStream input, uint32_t w, uint32_t h,
   ThrowRDE("Unsupported bit depth");
 }
 
+bool ArwDecoder::fetchPayload(BlockCachedInput* input) {
+  const vector<const TiffIFD*> data =
+      mRootIFD->getIFDsWithTag(TiffTag::STRIPOFFSETS);
+
+  // The transitional formats read the image from the hardcoded offsets.
+  if (data.empty())
+    return false;
+  if (const TiffEntry* model = mRootIFD->getEntryRecursive(TiffTag::MODEL);
+      model && model->getString() == "DSLR-A100")
+    return false;
+
+  fetchStripsAndTiles(input, data[0]);
+
+  // The white balance, see GetWB(), is stored in an encrypted IFD that is
+  // referenced from the SR2 private IFD.
+  const TiffEntry* priv = mRootIFD->getEntryRecursive(TiffTag::DNGPRIVATEDATA);
+  if (!priv)
+    return true;
+
+  const DataBuffer privData = priv->getRootIfdData();
+  if (privData.begin() != mFile.begin())
+    return false;
+
+  const uint32_t off = priv->getU32();
+  (void)input->fetch(off, 2);
+  // 2 bytes for entry count, 12 bytes per entry, 4 bytes next IFD offset.
+  const uint32_t numEntries = privData.get<uint16_t>(off);
+  (void)input->fetch(off, 2 + 12 * numEntries + 4);
+
+  // Anything this IFD refers to that is not fetched yet reads as zeros.
+  NORangesSet<Buffer> ifds;
+  const TiffRootIFD makerNoteIFD(nullptr, &ifds, privData, off);
+  const TiffEntry* sony_offset =
+      makerNoteIFD.getEntryRecursive(TiffTag::SONYOFFSET);
+  const TiffEntry* sony_length =
+      makerNoteIFD.getEntryRecursive(TiffTag::SONYLENGTH);
+  const TiffEntry* sony_key = makerNoteIFD.getEntryRecursive(TiffTag::SONYKEY);
+  if (!sony_offset || !sony_length || !sony_key)
+    return true; // GetWB() will complain.
+
+  const Buffer key = sony_key->getData();
+  (void)input->fetch(
+      implicit_cast<Buffer::size_type>(key.begin() - mFile.begin()),
+      key.getSize());
+
+  if (const uint32_t encOff = sony_offset->getU32(); mFile.isValid(encOff))
+    (void)input->fetch(encOff, std::min(sony_length->getU32(),
+                                        mFile.getSize() - encOff));
+
+  return true;
+}
+
 void ArwDecoder::ParseA100WB() const {
   if (!mRootIFD->hasEntryRecursive(TiffTag::DNGPRIVATEDATA))
     return;
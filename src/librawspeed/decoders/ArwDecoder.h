@@ -33,6 +33,7 @@
 
 namespace rawspeed {
 
+class BlockCachedInput;
 class Buffer;
 class CameraMetaData;
 
@@ -45,6 +46,8 @@ public:
   RawImage decodeRawInternal() override;
   void decodeMetaDataInternal(const CameraMetaData* meta) override;
 
+  bool fetchPayload(BlockCachedInput* input) override;
+
 private:
   void ParseA100WB() const;
 
@@ -0,0 +1,350 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decoders/BatchDecoder.h"
+#include "adt/Invariant.h"
+#include "adt/Optional.h"
+#include "common/Cancellation.h"
+#include "common/Executor.h"
+#include "common/RawImage.h"
+#include "common/RawspeedException.h"
+#include "common/ThreadPool.h"
+#include "decoders/RawDecoder.h"
+#include "io/Buffer.h"
+#include "io/FileReader.h"
+#include "parsers/RawParser.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace rawspeed {
+
+namespace {
+
+// Describes the exception that is currently being handled. Not everything
+// that escapes a decoder is a RawspeedException (think std::bad_alloc),
+// but any of it must still be reported as a failure of that one file,
+// or else it would escape pump(), and the file would never be finished.
+std::string describeCurrentException() {
+  try {
+    throw;
+  } catch (const std::exception& e) {
+    if (*e.what() != '\0')
+      return e.what();
+  } catch (...) { // NOLINT(bugprone-empty-catch)
+  }
+  return "Unknown exception";
+}
+
+} // namespace
+
+struct BatchDecoder::Job final {
+  int index = -1;
+  std::string name;
+  bool isFile = false;
+
+  std::unique_ptr<FileMapping> mapping;
+  Buffer input;
+  std::unique_ptr<RawDecoder> decoder;
+  bool intraFileParallelism = false;
+
+  Optional<RawImage> image;
+  std::string error;
+  bool cancelled = false;
+};
+
+BatchDecoder::BatchDecoder(const CameraMetaData* meta_,
+                           std::shared_ptr<ThreadPool> pool_, Callback onDone_,
+                           Options options_)
+    : meta(meta_), pool(std::move(pool_)),
+      serial(std::make_shared<SerialExecutor>()), onDone(std::move(onDone_)),
+      options(options_) {
+  invariant(pool != nullptr);
+  invariant(onDone != nullptr);
+  if (options.queueDepth <= 0)
+    options.queueDepth = 2 * pool->getNumThreads();
+  ioThread = std::thread([this]() { ioLoop(); });
+}
+
+BatchDecoder::~BatchDecoder() {
+  wait();
+  {
+    std::scoped_lock lock(mutex);
+    stopping = true;
+  }
+  ioWakeUp.notify_all();
+  ioThread.join();
+}
+
+int BatchDecoder::enqueue(std::unique_ptr<Job> job) {
+  int index;
+  {
+    std::scoped_lock lock(mutex);
+    index = numSubmitted++;
+    job->index = index;
+    submitted.emplace_back(std::move(job));
+  }
+  ioWakeUp.notify_all();
+  return index;
+}
+
+int BatchDecoder::submit(std::string path) {
+  auto job = std::make_unique<Job>();
+  job->name = std::move(path);
+  job->isFile = true;
+  return enqueue(std::move(job));
+}
+
+int BatchDecoder::submit(std::string name, Buffer input) {
+  auto job = std::make_unique<Job>();
+  job->name = std::move(name);
+  job->input = input;
+  return enqueue(std::move(job));
+}
+
+void BatchDecoder::wait() {
+  std::unique_lock lock(mutex);
+  allDone.wait(lock, [this]() {
+    return numFinished == numSubmitted && numPumps == 0;
+  });
+}
+
+void BatchDecoder::ioLoop() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    ioWakeUp.wait(lock, [this]() {
+      return stopping ||
+             (!submitted.empty() &&
+              static_cast<int>(fetched.size()) < options.queueDepth);
+    });
+    if (submitted.empty()) {
+      invariant(stopping);
+      return;
+    }
+
+    std::unique_ptr<Job> job = std::move(submitted.front());
+    submitted.pop_front();
+
+    // Only this thread ever adds to `fetched`, so the slot stays free.
+    lock.unlock();
+    fetch(job.get());
+    lock.lock();
+
+    fetched.emplace_back(std::move(job));
+    ++numInFlight;
+    schedule();
+  }
+}
+
+int BatchDecoder::getNumRunnableJobs() const {
+  const int depth = options.queueDepth;
+  const auto numParsable = std::min(
+      static_cast<int>(fetched.size()),
+      depth - static_cast<int>(parsed.size()) - numBeingParsed);
+  const auto numDecodable = std::min(
+      static_cast<int>(parsed.size()),
+      depth - static_cast<int>(decoded.size()) - numBeingDecoded);
+  return static_cast<int>(decoded.size()) + std::max(numDecodable, 0) +
+         std::max(numParsable, 0);
+}
+
+// NOTE: must be called with the mutex held.
+void BatchDecoder::schedule() {
+  // Every pump that is not busy is about to pick up a job.
+  while (numPumps < pool->getNumThreads() &&
+         numPumps - numBusyPumps < getNumRunnableJobs()) {
+    ++numPumps;
+    pool->submit([this]() { pump(); });
+  }
+}
+
+// Keeps advancing the jobs through the stages, preferring the ones that are
+// the furthest along, until there is nothing to do. The later stages never
+// block on a full queue, because a job is only picked up if there is room
+// for it in the next queue.
+void BatchDecoder::pump() {
+  enum class Stage : uint8_t { Parse, Decode, Finish };
+
+  std::unique_lock lock(mutex);
+  while (true) {
+    const int depth = options.queueDepth;
+    std::unique_ptr<Job> job;
+    Stage stage;
+    if (!decoded.empty()) {
+      stage = Stage::Finish;
+      job = std::move(decoded.front());
+      decoded.pop_front();
+    } else if (!parsed.empty() &&
+               static_cast<int>(decoded.size()) + numBeingDecoded < depth) {
+      stage = Stage::Decode;
+      job = std::move(parsed.front());
+      parsed.pop_front();
+      ++numBeingDecoded;
+      // Big files, or too few files to keep the pool busy anyway,
+      // get the whole pool.
+      job->intraFileParallelism =
+          job->input.getSize() >= options.intraFileParallelismMinSize ||
+          numInFlight < pool->getNumThreads();
+    } else if (!fetched.empty() &&
+               static_cast<int>(parsed.size()) + numBeingParsed < depth) {
+      stage = Stage::Parse;
+      job = std::move(fetched.front());
+      fetched.pop_front();
+      ++numBeingParsed;
+      ioWakeUp.notify_all();
+    } else
+      break;
+
+    ++numBusyPumps;
+    lock.unlock();
+
+    switch (stage) {
+      using enum Stage;
+    case Parse:
+      parse(job.get());
+      break;
+    case Decode:
+      decode(job.get());
+      break;
+    case Finish:
+      finish(job.get());
+      job.reset();
+      break;
+    }
+
+    lock.lock();
+    --numBusyPumps;
+
+    switch (stage) {
+      using enum Stage;
+    case Parse:
+      --numBeingParsed;
+      parsed.emplace_back(std::move(job));
+      break;
+    case Decode:
+      --numBeingDecoded;
+      decoded.emplace_back(std::move(job));
+      break;
+    case Finish:
+      --numInFlight;
+      ++numFinished;
+      break;
+    }
+
+    schedule();
+  }
+
+  --numPumps;
+  allDone.notify_all();
+}
+
+void BatchDecoder::fetch(Job* job) const {
+  if (!job->isFile)
+    return;
+
+  try {
+    std::tie(job->mapping, job->input) =
+        FileReader(job->name.c_str()).mapFile();
+
+    // Fault the whole file in now, so that the decoding threads don't have to.
+    constexpr size_t PageSize = 4096;
+    uint8_t sum = 0;
+    for (size_t i = 0; i < job->input.getSize(); i += PageSize)
+      sum ^= job->input.begin()[i];
+    [[maybe_unused]] volatile uint8_t sink = sum;
+  } catch (const RawspeedException& e) {
+    job->error = e.what();
+  } catch (...) {
+    job->error = describeCurrentException();
+  }
+}
+
+void BatchDecoder::parse(Job* job) const {
+  if (!job->error.empty())
+    return;
+
+  try {
+    RawParser parser(job->input);
+    job->decoder = parser.getDecoder(meta);
+    job->decoder->failOnUnknown = options.failOnUnknown;
+    job->decoder->interpolateBadPixels = options.interpolateBadPixels;
+    job->decoder->applyCrop = options.applyCrop;
+    job->decoder->uncorrectedRawValues = options.uncorrectedRawValues;
+    job->decoder->unstuffJPEGUpFront = options.unstuffJPEGUpFront;
+    job->decoder->cancellation = options.cancellation;
+    job->decoder->checkSupport(meta);
+  } catch (const RawspeedException& e) {
+    job->error = e.what();
+  } catch (...) {
+    job->error = describeCurrentException();
+  }
+}
+
+void BatchDecoder::decode(Job* job) const {
+  if (!job->error.empty())
+    return;
+
+  try {
+    if (job->intraFileParallelism)
+      job->decoder->executor = pool;
+    else
+      job->decoder->executor = serial;
+    if (options.cancellation)
+      options.cancellation->check();
+    job->decoder->decodeRaw();
+  } catch (const DecodeCancelledException& e) {
+    job->error = e.what();
+    job->cancelled = true;
+  } catch (const RawspeedException& e) {
+    job->error = e.what();
+  } catch (...) {
+    job->error = describeCurrentException();
+  }
+}
+
+void BatchDecoder::finish(Job* job) const {
+  if (job->error.empty()) {
+    try {
+      job->decoder->decodeMetaData(meta);
+      job->image = job->decoder->mRaw;
+    } catch (const RawspeedException& e) {
+      job->error = e.what();
+    } catch (...) {
+      job->error = describeCurrentException();
+    }
+  }
+
+  // The decoder references the input, so it must go before the mapping does.
+  job->decoder.reset();
+  job->mapping.reset();
+
+  onDone(Result{job->index, std::move(job->name), std::move(job->image),
+                std::move(job->error), job->cancelled});
+}
+
+} // namespace rawspeed
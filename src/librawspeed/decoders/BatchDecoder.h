@@ -0,0 +1,153 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Optional.h"
+#include "common/Cancellation.h"
+#include "common/RawImage.h"
+#include "io/Buffer.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace rawspeed {
+
+class CameraMetaData;
+class SerialExecutor;
+class ThreadPool;
+
+// Decodes many raws, pipelined in four stages: fetching the input (on its
+// own I/O thread), parsing + checkSupport(), decodeRaw(), and
+// decodeMetaData(). There is a bounded queue between each two stages,
+// so the I/O runs ahead of the decoding by at most a few files.
+// The decoding stages are run on the pool. Each file is decoded either
+// on a single thread (inter-file parallelism), or with the whole pool
+// (intra-file parallelism), depending on its size and on how many files
+// there are in flight.
+class BatchDecoder final {
+public:
+  struct Options final {
+    // Capacity of each of the queues between the stages.
+    // Zero means twice the number of threads of the pool.
+    int queueDepth = 0;
+
+    // Files at least this large are always decoded with intra-file
+    // parallelism. Smaller ones only are if there are not enough files
+    // in flight to keep the whole pool busy.
+    int64_t intraFileParallelismMinSize = int64_t(32) << 20;
+
+    // These are passed on to each RawDecoder.
+    bool failOnUnknown = false;
+    bool interpolateBadPixels = true;
+    bool applyCrop = true;
+    bool uncorrectedRawValues = false;
+    bool unstuffJPEGUpFront = false;
+
+    // If set, the decodings that are still pending once it gets cancelled
+    // fail with Result::cancelled set.
+    std::shared_ptr<const CancellationToken> cancellation;
+  };
+
+  struct Result final {
+    int index; // In the order of submission.
+    std::string name;
+    Optional<RawImage> image; // Unless the decoding failed.
+    std::string error;        // If the decoding failed.
+    bool cancelled = false;   // If it failed because it got cancelled.
+  };
+
+  // Called once per submitted input, from one of the threads of the pool,
+  // possibly concurrently, in no particular order. Must not throw.
+  using Callback = std::function<void(Result)>;
+
+private:
+  struct Job;
+
+  const CameraMetaData* meta;
+  std::shared_ptr<ThreadPool> pool;
+  std::shared_ptr<SerialExecutor> serial;
+  Callback onDone;
+  Options options;
+
+  std::mutex mutex;
+  std::condition_variable ioWakeUp;
+  std::condition_variable allDone;
+
+  // All of the following are guarded by the mutex.
+  std::deque<std::unique_ptr<Job>> submitted; // Not bounded.
+  std::deque<std::unique_ptr<Job>> fetched;
+  std::deque<std::unique_ptr<Job>> parsed;
+  std::deque<std::unique_ptr<Job>> decoded;
+  int numBeingParsed = 0;
+  int numBeingDecoded = 0;
+  int numInFlight = 0; // Fetched, but not yet finished.
+  int numPumps = 0;    // Alive pump() tasks.
+  int numBusyPumps = 0;
+  int numSubmitted = 0;
+  int numFinished = 0;
+  bool stopping = false;
+
+  std::thread ioThread;
+
+  int enqueue(std::unique_ptr<Job> job);
+  void ioLoop();
+  [[nodiscard]] int getNumRunnableJobs() const;
+  void schedule();
+  void pump();
+
+  void fetch(Job* job) const;
+  void parse(Job* job) const;
+  void decode(Job* job) const;
+  void finish(Job* job) const;
+
+public:
+  BatchDecoder(const CameraMetaData* meta, std::shared_ptr<ThreadPool> pool,
+               Callback onDone, Options options);
+  BatchDecoder(const CameraMetaData* meta_, std::shared_ptr<ThreadPool> pool_,
+               Callback onDone_)
+      : BatchDecoder(meta_, std::move(pool_), std::move(onDone_), Options()) {}
+
+  BatchDecoder(const BatchDecoder&) = delete;
+  BatchDecoder(BatchDecoder&&) = delete;
+  BatchDecoder& operator=(const BatchDecoder&) = delete;
+  BatchDecoder& operator=(BatchDecoder&&) = delete;
+
+  // Waits for all the submitted inputs to be decoded.
+  ~BatchDecoder();
+
+  // Queues the file to be decoded. Returns its index.
+  int submit(std::string path);
+
+  // Queues the in-memory input to be decoded. Returns its index.
+  // The input must remain valid until its callback is called.
+  int submit(std::string name, Buffer input);
+
+  // Blocks until all the inputs submitted so far are decoded.
+  void wait();
+};
+
+} // namespace rawspeed
@@ -38,6 +38,7 @@
 #include "io/Endianness.h"
 #include "metadata/Camera.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include "parsers/TiffParserException.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
@@ -111,10 +112,7 @@ RawImage Cr2Decoder::decodeOldFormat() {
       curve && curve->type == TiffDataType::SHORT && curve->count == 4096) {
     auto table = curve->getU16Array(curve->count);
     RawImageCurveGuard curveHandler(&mRaw, table, uncorrectedRawValues);
-
-    // Apply table
-    if (!uncorrectedRawValues)
-      mRaw->sixteenBitLookup();
+    curveHandler.apply();
   }
 
   return mRaw;
@@ -541,7 +539,7 @@ iPoint2D Cr2Decoder::getSubSampling() const {
 }
 
 int Cr2Decoder::getHue() const {
-  if (hints.contains("old_sraw_hue"))
+  if (hints.contains(Hint::old_sraw_hue))
     return (mRaw->metadata.subsampling.y * mRaw->metadata.subsampling.x);
 
   if (!mRootIFD->hasEntryRecursive(static_cast<TiffTag>(0x10))) {
@@ -550,7 +548,7 @@ int Cr2Decoder::getHue() const {
   if (uint32_t model_id =
           mRootIFD->getEntryRecursive(static_cast<TiffTag>(0x10))->getU32();
       model_id >= 0x80000281 || model_id == 0x80000218 ||
-      (hints.contains("force_new_sraw_hue"))) {
+      (hints.contains(Hint::force_new_sraw_hue))) {
     return ((mRaw->metadata.subsampling.y * mRaw->metadata.subsampling.x) -
             1) >>
            1;
@@ -575,7 +573,7 @@ void Cr2Decoder::sRawInterpolate() {
   sraw_coeffs[1] = (wb->getU16(offset + 1) + wb->getU16(offset + 2) + 1) >> 1;
   sraw_coeffs[2] = wb->getU16(offset + 3);
 
-  if (hints.contains("invert_sraw_wb")) {
+  if (hints.contains(Hint::invert_sraw_wb)) {
     sraw_coeffs[0] = static_cast<int>(
         1024.0F / (static_cast<float>(sraw_coeffs[0]) / 1024.0F));
     sraw_coeffs[2] = static_cast<int>(
@@ -594,6 +592,9 @@ void Cr2Decoder::sRawInterpolate() {
       subsampledRaw->metadata.subsampling.y * subsampledRaw->dim.y};
 
   mRaw = RawImage::create(interpolatedDims, RawImageType::UINT16, 3);
+  mRaw->executor = executor;
+  mRaw->cancellation = cancellation;
+  mRaw->unstuffJPEGUpFront = unstuffJPEGUpFront;
   mRaw->metadata.subsampling = subsampledRaw->metadata.subsampling;
   mRaw->isCFA = false;
 
@@ -601,8 +602,8 @@ void Cr2Decoder::sRawInterpolate() {
                         sraw_coeffs, hue);
 
   /* Determine sRaw coefficients */
-  bool isOldSraw = hints.contains("sraw_40d");
-  bool isNewSraw = hints.contains("sraw_new");
+  bool isOldSraw = hints.contains(Hint::sraw_40d);
+  bool isNewSraw = hints.contains(Hint::sraw_new);
 
   int version;
   if (isOldSraw)
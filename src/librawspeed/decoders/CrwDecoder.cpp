@@ -34,6 +34,7 @@
 #include "io/Buffer.h"
 #include "metadata/Camera.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include "tiff/CiffEntry.h"
 #include "tiff/CiffIFD.h"
 #include "tiff/CiffTag.h"
@@ -96,7 +97,7 @@ RawImage CrwDecoder::decodeRawInternal() {
   assert(decTable != nullptr);
   uint32_t dec_table = decTable->getU32();
 
-  bool lowbits = !hints.contains("no_decompressed_lowbits");
+  bool lowbits = !hints.contains(Hint::no_decompressed_lowbits);
 
   ByteStream rawInput = rawData->getData();
 
@@ -202,10 +203,10 @@ void CrwDecoder::decodeMetaDataInternal(const CameraMetaData* meta) {
       } else if (wb->type == CiffDataType::BYTE &&
                  wb->count > 768) { // Other G series and S series cameras
         // correct offset for most cameras
-        int offset = hints.get("wb_offset", 120);
+        int offset = hints.get(Hint::wb_offset, 120);
 
         std::array<uint16_t, 2> key = {{0x410, 0x45f3}};
-        if (!hints.contains("wb_mangle"))
+        if (!hints.contains(Hint::wb_mangle))
           key[0] = key[1] = 0;
 
         offset /= 2;
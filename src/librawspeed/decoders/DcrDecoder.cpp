@@ -112,9 +112,10 @@ RawImage DcrDecoder::decodeRawInternal() {
     }
   }();
 
-  KodakDecompressor k(mRaw, input, bps, uncorrectedRawValues);
+  KodakDecompressor k(mRaw, input, bps);
   mRaw->createData();
   k.decompress();
+  curveHandler.apply();
 
   return mRaw;
 }
@@ -75,10 +75,8 @@ RawImage DcsDecoder::decodeRawInternal() {
       BitOrder::LSB);
   mRaw->createData();
 
-  if (uncorrectedRawValues)
-    u.decode8BitRaw<true>();
-  else
-    u.decode8BitRaw<false>();
+  u.decode8BitRaw();
+  curveHandler.apply();
 
   return mRaw;
 }
@@ -33,6 +33,7 @@
 #include "decoders/AbstractTiffDecoder.h"
 #include "decoders/RawDecoderException.h"
 #include "decompressors/AbstractDngDecompressor.h"
+#include "io/BlockCachedInput.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include "metadata/Camera.h"
@@ -445,6 +446,16 @@ void DngDecoder::decodeData(const TiffIFD* raw, uint32_t sample_format) const {
   slices.decompress();
 }
 
+bool DngDecoder::fetchPayload(BlockCachedInput* input) {
+  // Everything but the image data itself is stored in the tags.
+  std::vector<const TiffIFD*> data =
+      mRootIFD->getIFDsWithTag(TiffTag::COMPRESSION);
+  dropUnsuportedChunks(&data);
+  for (const auto* raw : data)
+    fetchStripsAndTiles(input, raw);
+  return true;
+}
+
 RawImage DngDecoder::decodeRawInternal() {
   vector<const TiffIFD*> data = mRootIFD->getIFDsWithTag(TiffTag::COMPRESSION);
 
@@ -485,6 +496,9 @@ RawImage DngDecoder::decodeRawInternal() {
              "format %u is not supported.",
              sample_format);
   }
+  mRaw->executor = executor;
+  mRaw->cancellation = cancellation;
+  mRaw->unstuffJPEGUpFront = unstuffJPEGUpFront;
 
   mRaw->isCFA =
       (raw->getEntry(TiffTag::PHOTOMETRICINTERPRETATION)->getU16() == 32803);
@@ -610,8 +624,7 @@ void DngDecoder::handleMetadata(const TiffIFD* raw) {
     const TiffEntry* lintable = raw->getEntry(TiffTag::LINEARIZATIONTABLE);
     auto table = lintable->getU16Array(lintable->count);
     RawImageCurveGuard curveHandler(&mRaw, table, uncorrectedRawValues);
-    if (!uncorrectedRawValues)
-      mRaw->sixteenBitLookup();
+    curveHandler.apply();
   }
 
   // Set black
@@ -29,6 +29,7 @@
 
 namespace rawspeed {
 
+class BlockCachedInput;
 class Buffer;
 class CameraMetaData;
 class iRectangle2D;
@@ -43,6 +44,8 @@ public:
   void decodeMetaDataInternal(const CameraMetaData* meta) override;
   void checkSupportInternal(const CameraMetaData* meta) override;
 
+  bool fetchPayload(BlockCachedInput* input) override;
+
 private:
   [[nodiscard]] int getDecoderVersion() const override { return 0; }
   bool mFixLjpeg;
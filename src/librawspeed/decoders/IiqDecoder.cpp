@@ -521,8 +521,7 @@ void IiqDecoder::correctSensorDefects(ByteStream data) const {
 
 void IiqDecoder::handleBadPixel(const uint16_t col, const uint16_t row) const {
   MutexLocker guard(&mRaw->mBadPixelMutex);
-  mRaw->mBadPixelPositions.insert(mRaw->mBadPixelPositions.end(),
-                                  (static_cast<uint32_t>(row) << 16) + col);
+  mRaw->mBadPixelPositions.emplace_back(col, row);
 }
 
 void IiqDecoder::correctBadColumn(const uint16_t col) const {
@@ -31,6 +31,7 @@
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
 #include "metadata/Camera.h"
+#include "metadata/Hints.h"
 #include "parsers/TiffParserException.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
@@ -66,7 +67,7 @@ Buffer KdcDecoder::getInputBuffer() const {
     ThrowRDE("Offset is too large.");
 
   // Offset hardcoding gotten from dcraw
-  if (hints.contains("easyshare_offset_hack"))
+  if (hints.contains(Hint::easyshare_offset_hack))
     off = off < 0x15000 ? 0x15000 : 0x17000;
 
   return mFile.getSubView(implicit_cast<Buffer::size_type>(off));
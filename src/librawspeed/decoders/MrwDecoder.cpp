@@ -30,6 +30,7 @@
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
 #include "metadata/Camera.h"
+#include "metadata/Hints.h"
 #include "parsers/TiffParser.h"
 #include "tiff/TiffIFD.h"
 #include <array>
@@ -196,7 +197,7 @@ void MrwDecoder::decodeMetaDataInternal(const CameraMetaData* meta) {
   auto id = rootIFD->getID();
   setMetaData(meta, id.make, id.model, "", iso);
 
-  if (hints.contains("swapped_wb")) {
+  if (hints.contains(Hint::swapped_wb)) {
     mRaw->metadata.wbCoeffs[0] = wb_coeffs[2];
     mRaw->metadata.wbCoeffs[1] = wb_coeffs[0];
     mRaw->metadata.wbCoeffs[2] = wb_coeffs[1];
@@ -31,6 +31,7 @@
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
 #include "metadata/Camera.h"
+#include "metadata/Hints.h"
 #include <map>
 #include <string>
 #include <string_view>
@@ -66,29 +67,31 @@ void NakedDecoder::parseHints() {
   const auto& make = cam->make.c_str();
   const auto& model = cam->model.c_str();
 
-  auto parseHint = [&cHints, &make, &model](const std::string& name) {
-    if (!cHints.contains(name))
+  auto parseHint = [&cHints, &make, &model](Hint hint) {
+    if (!cHints.contains(hint)) {
+      const std::string name(Hints::getName(hint));
       ThrowRDE("%s %s: couldn't find %s", make, model, name.c_str());
+    }
 
-    return cHints.get(name, 0U);
+    return cHints.get(hint, 0U);
   };
 
-  width = parseHint("full_width");
-  height = parseHint("full_height");
+  width = parseHint(Hint::full_width);
+  height = parseHint(Hint::full_height);
 
   if (width == 0 || height == 0)
     ThrowRDE("%s %s: image is of zero size?", make, model);
 
-  filesize = parseHint("filesize");
-  offset = cHints.get("offset", 0);
+  filesize = parseHint(Hint::filesize);
+  offset = cHints.get(Hint::offset, 0);
   if (filesize == 0 || offset >= filesize)
     ThrowRDE("%s %s: no image data found", make, model);
 
-  bits = cHints.get("bits", (filesize - offset) * 8 / width / height);
+  bits = cHints.get(Hint::bits, (filesize - offset) * 8 / width / height);
   if (bits == 0)
     ThrowRDE("%s %s: image bpp is invalid: %u", make, model, bits);
 
-  auto order = cHints.get("order", std::string());
+  auto order = cHints.get(Hint::order, std::string());
   if (!order.empty()) {
     auto bo_ = getAsBitOrder(order);
     if (!bo_)
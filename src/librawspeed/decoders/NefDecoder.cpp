@@ -29,6 +29,7 @@
 #include "bitstreams/BitStreams.h"
 #include "common/Common.h"
 #include "common/RawImage.h"
+#include "common/TableLookUp.h"
 #include "decoders/RawDecoderException.h"
 #include "decompressors/NikonDecompressor.h"
 #include "decompressors/UncompressedDecompressor.h"
@@ -39,6 +40,7 @@
 #include "metadata/Camera.h"
 #include "metadata/CameraMetaData.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
 #include "tiff/TiffTag.h"
@@ -46,7 +48,6 @@
 #include <array>
 #include <cassert>
 #include <cmath>
-#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <sstream>
@@ -87,7 +88,7 @@ RawImage NefDecoder::decodeRawInternal() {
     }
   }
 
-  if (compression == 1 || (hints.contains("force_uncompressed")) ||
+  if (compression == 1 || (hints.contains(Hint::force_uncompressed)) ||
       NEFIsUncompressed(raw)) {
     DecodeUncompressed();
     return mRaw;
@@ -269,7 +270,7 @@ void NefDecoder::DecodeUncompressed() const {
     bitPerPixel = 16; // D3 & D810
 
   mRaw->createData();
-  bitPerPixel = hints.get("real_bpp", bitPerPixel);
+  bitPerPixel = hints.get(Hint::real_bpp, bitPerPixel);
 
   switch (bitPerPixel) {
   case 12:
@@ -287,19 +288,19 @@ void NefDecoder::DecodeUncompressed() const {
     iPoint2D size(width, slice.h);
     iPoint2D pos(0, offY);
 
-    if (hints.contains("coolpixmangled")) {
+    if (hints.contains(Hint::coolpixmangled)) {
       UncompressedDecompressor u(in, mRaw, iRectangle2D(pos, size),
                                  width * bitPerPixel / 8, 12, BitOrder::MSB32);
       u.readUncompressedRaw();
     } else {
-      if (hints.contains("coolpixsplit")) {
+      if (hints.contains(Hint::coolpixsplit)) {
         readCoolpixSplitRaw(in, size, pos, width * bitPerPixel / 8);
       } else {
         if (in.getSize() % size.y != 0)
           ThrowRDE("Inconsistent row size");
         const auto inputPitchBytes = in.getSize() / size.y;
         BitOrder bo = (mRootIFD->rootBuffer.getByteOrder() == Endianness::big) ^
-                              hints.contains("msb_override")
+                              hints.contains(Hint::msb_override)
                           ? BitOrder::MSB
                           : BitOrder::LSB;
         UncompressedDecompressor u(in, mRaw, iRectangle2D(pos, size),
@@ -602,7 +603,7 @@ void NefDecoder::parseWhiteBalance() const {
     }
   }
 
-  if (hints.contains("nikon_wb_adjustment")) {
+  if (hints.contains(Hint::nikon_wb_adjustment)) {
     mRaw->metadata.wbCoeffs[0] *= 256.0F / 527.0F;
     mRaw->metadata.wbCoeffs[2] *= 256.0F / 317.0F;
   }
@@ -702,17 +703,22 @@ void NefDecoder::DecodeNikonSNef(ByteStream input) const {
 
   curve.resize(4095);
 
-  RawImageCurveGuard curveHandler(&mRaw, curve, false);
-
-  uint16_t tmp;
-  auto* tmpch = reinterpret_cast<std::byte*>(&tmp);
+  // The white balance is applied after the curve, so unlike elsewhere, the
+  // curve can not be applied to the whole image afterwards.
+  TableLookUp lut(1, true);
+  lut.setTable(0, curve);
+  const Array1DRef<const uint16_t> t = lut.getTable(0);
 
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
   const auto in = Array2DRef(input.peekData(out.width() * out.height()),
                              out.width(), out.height());
 
   for (int row = 0; row < out.height(); row++) {
-    uint32_t random = in(row, 0) + (in(row, 1) << 8) + (in(row, 2) << 16);
+    const auto rowCounter = static_cast<uint32_t>(row * out.width());
+    const auto lookUp = [t, rowCounter](double v, int col) -> int {
+      return TableLookUp::lookUpDithered(t, clampBits(static_cast<int>(v), 12),
+                                         rowCounter + col);
+    };
     for (int col = 0; col < out.width(); col += 6) {
       uint32_t g1 = in(row, col + 0);
       uint32_t g2 = in(row, col + 1);
@@ -743,51 +749,39 @@ void NefDecoder::DecodeNikonSNef(ByteStream input) const {
       cb2 -= 2048;
       cr2 -= 2048;
 
-      mRaw->setWithLookUp(
-          clampBits(static_cast<int>(implicit_cast<double>(y1) +
-                                     1.370705 * implicit_cast<double>(cr)),
-                    12),
-          tmpch, &random);
-      out(row, col) = clampBits((inv_wb_r * tmp + (1 << 9)) >> 10, 15);
-
-      mRaw->setWithLookUp(
-          clampBits(static_cast<int>(implicit_cast<double>(y1) -
-                                     0.337633 * implicit_cast<double>(cb) -
-                                     0.698001 * implicit_cast<double>(cr)),
-                    12),
-          reinterpret_cast<std::byte*>(&out(row, col + 1)), &random);
-
-      mRaw->setWithLookUp(
-          clampBits(
-              static_cast<int>(implicit_cast<double>(y1) +
-                               1.732446 // NOLINT(modernize-use-std-numbers)
-                                   * implicit_cast<double>(cb)),
-              12),
-          tmpch, &random);
-      out(row, col + 2) = clampBits((inv_wb_b * tmp + (1 << 9)) >> 10, 15);
-
-      mRaw->setWithLookUp(
-          clampBits(static_cast<int>(implicit_cast<double>(y2) +
-                                     1.370705 * implicit_cast<double>(cr2)),
-                    12),
-          tmpch, &random);
-      out(row, col + 3) = clampBits((inv_wb_r * tmp + (1 << 9)) >> 10, 15);
-
-      mRaw->setWithLookUp(
-          clampBits(static_cast<int>(implicit_cast<double>(y2) -
-                                     0.337633 * implicit_cast<double>(cb2) -
-                                     0.698001 * implicit_cast<double>(cr2)),
-                    12),
-          reinterpret_cast<std::byte*>(&out(row, col + 4)), &random);
-
-      mRaw->setWithLookUp(
-          clampBits(
-              static_cast<int>(implicit_cast<double>(y2) +
-                               1.732446 // NOLINT(modernize-use-std-numbers)
-                                   * implicit_cast<double>(cb2)),
-              12),
-          tmpch, &random);
-      out(row, col + 5) = clampBits((inv_wb_b * tmp + (1 << 9)) >> 10, 15);
+      int r = lookUp(implicit_cast<double>(y1) +
+                         1.370705 * implicit_cast<double>(cr),
+                     col);
+      out(row, col) = clampBits((inv_wb_r * r + (1 << 9)) >> 10, 15);
+
+      out(row, col + 1) = implicit_cast<uint16_t>(
+          lookUp(implicit_cast<double>(y1) -
+                     0.337633 * implicit_cast<double>(cb) -
+                     0.698001 * implicit_cast<double>(cr),
+                 col + 1));
+
+      int b = lookUp(implicit_cast<double>(y1) +
+                         1.732446 // NOLINT(modernize-use-std-numbers)
+                             * implicit_cast<double>(cb),
+                     col + 2);
+      out(row, col + 2) = clampBits((inv_wb_b * b + (1 << 9)) >> 10, 15);
+
+      r = lookUp(implicit_cast<double>(y2) +
+                     1.370705 * implicit_cast<double>(cr2),
+                 col + 3);
+      out(row, col + 3) = clampBits((inv_wb_r * r + (1 << 9)) >> 10, 15);
+
+      out(row, col + 4) = implicit_cast<uint16_t>(
+          lookUp(implicit_cast<double>(y2) -
+                     0.337633 * implicit_cast<double>(cb2) -
+                     0.698001 * implicit_cast<double>(cr2),
+                 col + 4));
+
+      b = lookUp(implicit_cast<double>(y2) +
+                     1.732446 // NOLINT(modernize-use-std-numbers)
+                         * implicit_cast<double>(cb2),
+                 col + 5);
+      out(row, col + 5) = clampBits((inv_wb_b * b + (1 << 9)) >> 10, 15);
     }
   }
 }
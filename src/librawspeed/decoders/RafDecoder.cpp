@@ -36,6 +36,7 @@
 #include "metadata/CameraMetaData.h"
 #include "metadata/CameraSensorInfo.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
 #include "tiff/TiffTag.h"
@@ -148,7 +149,7 @@ RawImage RafDecoder::decodeRawInternal() {
              counts->getU32(), width, height);
   }
 
-  double_width = hints.contains("double_width_unpacked");
+  double_width = hints.contains(Hint::double_width_unpacked);
   const uint32_t real_width = double_width ? 2U * width : width;
 
   mRaw->dim = iPoint2D(real_width, height);
@@ -169,7 +170,7 @@ RawImage RafDecoder::decodeRawInternal() {
     u.readUncompressedRaw();
   } else {
     iPoint2D pos(0, 0);
-    if (hints.contains("jpeg32_bitorder")) {
+    if (hints.contains(Hint::jpeg32_bitorder)) {
       UncompressedDecompressor u(input, mRaw, iRectangle2D(pos, mRaw->dim),
                                  width * bps / 8, bps, BitOrder::MSB32);
       mRaw->createData();
@@ -214,7 +215,7 @@ void RafDecoder::applyCorrections(const Camera* cam) {
       new_size = vendor_crop.dim;
       crop_offset = vendor_crop.pos;
     }
-    bool double_width = hints.contains("double_width_unpacked");
+    bool double_width = hints.contains(Hint::double_width_unpacked);
     // If crop size is negative, use relative cropping
     if (new_size.x <= 0) {
       new_size.x =
@@ -225,7 +226,7 @@ void RafDecoder::applyCorrections(const Camera* cam) {
       new_size.y = mRaw->dim.y - crop_offset.y + new_size.y;
   }
 
-  bool rotate = hints.contains("fuji_rotate");
+  bool rotate = hints.contains(Hint::fuji_rotate);
   rotate = rotate && fujiRotate;
 
   // Rotate 45 degrees - could be multithreaded.
@@ -267,6 +268,8 @@ void RafDecoder::applyCorrections(const Camera* cam) {
           ThrowRDE("Trying to write out of bounds");
       }
     }
+    rotated->executor = mRaw->executor;
+    rotated->cancellation = mRaw->cancellation;
     mRaw = rotated;
   } else if (applyCrop) {
     mRaw->subFrame(iRectangle2D(crop_offset, new_size));
@@ -26,6 +26,7 @@
 #include "adt/Casts.h"
 #include "adt/Point.h"
 #include "bitstreams/BitStreams.h"
+#include "common/Cancellation.h"
 #include "common/Common.h"
 #include "common/RawImage.h"
 #include "decompressors/UncompressedDecompressor.h"
@@ -38,6 +39,7 @@
 #include "metadata/CameraMetaData.h"
 #include "metadata/CameraSensorInfo.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include "parsers/TiffParserException.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
@@ -298,7 +300,7 @@ void RawDecoder::setMetaData(const CameraMetaData* meta,
   // (the same order as the in the CFA tag)
   // A hint could be:
   // <Hint name="final_cfa_black" value="10,20,30,20"/>
-  std::string cfa_black = hints.get("final_cfa_black", std::string());
+  std::string cfa_black = hints.get(Hint::final_cfa_black, std::string());
   if (!cfa_black.empty()) {
     vector<std::string> v = splitString(cfa_black, ',');
     if (v.size() != 4) {
@@ -319,17 +321,30 @@ rawspeed::iRectangle2D RawDecoder::getDefaultCrop() {
 
 rawspeed::RawImage RawDecoder::decodeRaw() {
   try {
+    mRaw->executor = executor;
+    mRaw->cancellation = cancellation;
+    mRaw->unstuffJPEGUpFront = unstuffJPEGUpFront;
     RawImage raw = decodeRawInternal();
+    raw->executor = executor;
+    raw->cancellation = cancellation;
+    raw->unstuffJPEGUpFront = unstuffJPEGUpFront;
     MSan::CheckMemIsInitialized(raw->getByteDataAsUncroppedArray2DRef());
 
     raw->metadata.pixelAspectRatio =
-        hints.get("pixel_aspect_ratio", raw->metadata.pixelAspectRatio);
+        hints.get(Hint::pixel_aspect_ratio, raw->metadata.pixelAspectRatio);
     if (interpolateBadPixels) {
       raw->fixBadPixels();
       MSan::CheckMemIsInitialized(raw->getByteDataAsUncroppedArray2DRef());
     }
 
+    // Not every decompressor polls, and those that do may have stopped early.
+    raw->checkCancelled();
+
     return raw;
+  } catch (const DecodeCancelledException&) {
+    // Do not expose the partially-decoded image.
+    mRaw = RawImage::create();
+    throw;
   } catch (const TiffParserException& e) {
     ThrowRDE("%s", e.what());
   } catch (const FileIOException& e) {
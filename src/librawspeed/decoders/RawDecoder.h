@@ -23,14 +23,18 @@
 
 #include "adt/Point.h"
 #include "bitstreams/BitStreams.h"
+#include "common/Cancellation.h"
+#include "common/Executor.h"
 #include "common/RawImage.h"
 #include "io/Buffer.h"
 #include "metadata/Camera.h"
 #include <cstdint>
+#include <memory>
 #include <string>
 
 namespace rawspeed {
 
+class BlockCachedInput;
 class CameraMetaData;
 class TiffIFD;
 
@@ -64,6 +68,14 @@ public:
   /* compensation is not expected to be applied to the image */
   void decodeMetaData(const CameraMetaData* meta);
 
+  /* Fetches the parts of the input (which must be the one this decoder was */
+  /* constructed on) that decodeRaw() and decodeMetaData() will access, */
+  /* and returns true. Returns false if they are not known, in which case */
+  /* the whole input must be fetched. */
+  virtual bool fetchPayload([[maybe_unused]] BlockCachedInput* input) {
+    return false;
+  }
+
   /* Allows access to the root IFD structure */
   /* If image isn't TIFF based NULL will be returned */
   virtual TiffIFD* getRootIFD() { return nullptr; }
@@ -73,6 +85,16 @@ public:
    * this class is destroyed */
   RawImage mRaw = RawImage::create();
 
+  /* Runs the parallelizable parts of the decoding. */
+  /* May be shared between any number of concurrent decodes. */
+  /* The decoded image keeps using it for the post-processing. */
+  std::shared_ptr<Executor> executor = Executor::getDefault();
+
+  /* If set, decodeRaw() is abandoned once it gets cancelled, */
+  /* by throwing DecodeCancelledException, and mRaw is reset. */
+  /* May be shared between any number of concurrent decodes. */
+  std::shared_ptr<const CancellationToken> cancellation;
+
   /* You can set this if you do not want Rawspeed to attempt to decode images,
    */
   /* where it does not have reliable information about CFA, cropping, black and
@@ -101,6 +123,12 @@ public:
   /* Only enable if you are sure that is what you want */
   bool uncorrectedRawValues{false};
 
+  /* Remove the JPEG byte stuffing of the LJpeg-compressed images up front. */
+  /* That roughly doubles the decoding speed of the entropy-coded data, but */
+  /* needs a scratch copy of it: of each restart interval, or, for the CR2's */
+  /* (which have none), of the whole compressed image. */
+  bool unstuffJPEGUpFront{false};
+
   /* Should Fuji images be rotated? */
   bool fujiRotate{true};
 
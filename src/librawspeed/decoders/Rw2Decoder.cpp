@@ -37,6 +37,7 @@
 #include "io/Endianness.h"
 #include "metadata/Camera.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
 #include "tiff/TiffTag.h"
@@ -114,7 +115,7 @@ RawImage Rw2Decoder::decodeRawInternal() {
       PanasonicV4Decompressor p(
           mRaw,
           ByteStream(DataBuffer(mFile.getSubView(offset), Endianness::little)),
-          hints.contains("zero_is_not_bad"), section_split_offset);
+          hints.contains(Hint::zero_is_not_bad), section_split_offset);
       mRaw->createData();
       p.decompress();
     }
@@ -139,7 +140,7 @@ RawImage Rw2Decoder::decodeRawInternal() {
                 raw->getEntry(TiffTag::PANASONIC_RAWFORMAT)->getU16()) {
     case 4: {
       uint32_t section_split_offset = 0x1FF8;
-      PanasonicV4Decompressor p(mRaw, bs, hints.contains("zero_is_not_bad"),
+      PanasonicV4Decompressor p(mRaw, bs, hints.contains(Hint::zero_is_not_bad),
                                 section_split_offset);
       mRaw->createData();
       p.decompress();
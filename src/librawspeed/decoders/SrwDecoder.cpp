@@ -31,6 +31,7 @@
 #include "io/Endianness.h"
 #include "metadata/Camera.h"
 #include "metadata/CameraMetaData.h"
+#include "metadata/Hints.h"
 #include "tiff/TiffEntry.h"
 #include "tiff/TiffIFD.h"
 #include "tiff/TiffTag.h"
@@ -73,7 +74,8 @@ RawImage SrwDecoder::decodeRawInternal() {
   if (const auto wrongComp =
           32770 == compression && !raw->hasEntry(static_cast<TiffTag>(40976));
       32769 == compression || wrongComp) {
-    bool bit_order = hints.get("msb_override", wrongComp ? bits == 12 : false);
+    bool bit_order =
+        hints.get(Hint::msb_override, wrongComp ? bits == 12 : false);
     this->decodeUncompressed(raw, bit_order ? BitOrder::MSB : BitOrder::LSB);
     return mRaw;
   }
@@ -30,6 +30,7 @@
 #include "common/RawImage.h"
 #include "decoders/RawDecoderException.h"
 #include "decompressors/LJpegDecoder.h"
+#include "decompressors/TileEngine.h"
 #include "decompressors/UncompressedDecompressor.h"
 #include "decompressors/VC5Decompressor.h"
 #include "io/ByteStream.h"
@@ -37,12 +38,11 @@
 #include "io/IOException.h"
 #include <cstdint>
 #include <limits>
-#include <string>
+#include <memory>
 #include <vector>
 
 #ifdef HAVE_ZLIB
 #include "decompressors/DeflateDecompressor.h"
-#include <memory>
 #endif
 
 #ifdef HAVE_JPEG
@@ -51,204 +51,136 @@
 
 namespace rawspeed {
 
-template <> void AbstractDngDecompressor::decompressThread<1>() const noexcept {
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (const auto& e :
-       Array1DRef(slices.data(), implicit_cast<int>(slices.size()))) {
-    try {
-      iPoint2D tileSize(e.width, e.height);
-      iPoint2D pos(e.offX, e.offY);
-
-      bool big_endian = e.bs.getByteOrder() == Endianness::big;
-
-      // DNG spec says that if not 8/16/32 bit/sample, always use big endian.
-      // It's not very obvious, but that does not appear to apply to FP.
-      switch (mBps) {
-      case 8:
-      case 16:
-      case 32:
-        break;
-      default:
-        if (mRaw->getDataType() == RawImageType::UINT16)
-          big_endian = true;
-        break;
-      }
-
-      const uint32_t inputPixelBits = mRaw->getCpp() * mBps;
-
-      if (e.dsc.tileW > std::numeric_limits<int>::max() / inputPixelBits)
-        ThrowIOE("Integer overflow when calculating input pitch");
-
-      const int inputPitchBits = inputPixelBits * e.dsc.tileW;
-      invariant(inputPitchBits > 0);
-
-      if (inputPitchBits % 8 != 0) {
-        ThrowRDE("Bad combination of cpp (%u), bps (%u) and width (%u), the "
-                 "pitch is %d bits, which is not a multiple of 8 (1 byte)",
-                 mRaw->getCpp(), mBps, e.width, inputPitchBits);
-      }
-
-      const int inputPitch = inputPitchBits / 8;
-      if (inputPitch == 0)
-        ThrowRDE("Data input pitch is too short. Can not decode!");
-
-      UncompressedDecompressor decompressor(
-          e.bs, mRaw, iRectangle2D(pos, tileSize), inputPitch, mBps,
-          big_endian ? BitOrder::MSB : BitOrder::LSB);
-      decompressor.readUncompressedRaw();
-    } catch (const RawDecoderException& err) {
-      mRaw->setError(err.what());
-    } catch (const IOException& err) {
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
+template <>
+void AbstractDngDecompressor::decompressSlice<1>(
+    const DngSliceElement& e) const {
+  iPoint2D tileSize(e.width, e.height);
+  iPoint2D pos(e.offX, e.offY);
+
+  bool big_endian = e.bs.getByteOrder() == Endianness::big;
+
+  // DNG spec says that if not 8/16/32 bit/sample, always use big endian.
+  // It's not very obvious, but that does not appear to apply to FP.
+  switch (mBps) {
+  case 8:
+  case 16:
+  case 32:
+    break;
+  default:
+    if (mRaw->getDataType() == RawImageType::UINT16)
+      big_endian = true;
+    break;
   }
-}
 
-template <> void AbstractDngDecompressor::decompressThread<7>() const noexcept {
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (const auto& e :
-       Array1DRef(slices.data(), implicit_cast<int>(slices.size()))) {
-    try {
-      LJpegDecoder d(e.bs, mRaw);
-      d.decode(e.offX, e.offY, e.width, e.height,
-               iPoint2D(e.dsc.tileW, e.dsc.tileH), mFixLjpeg);
-    } catch (const RawDecoderException& err) {
-      mRaw->setError(err.what());
-    } catch (const IOException& err) {
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
+  const uint32_t inputPixelBits = mRaw->getCpp() * mBps;
+
+  if (e.dsc.tileW > std::numeric_limits<int>::max() / inputPixelBits)
+    ThrowIOE("Integer overflow when calculating input pitch");
+
+  const int inputPitchBits = inputPixelBits * e.dsc.tileW;
+  invariant(inputPitchBits > 0);
+
+  if (inputPitchBits % 8 != 0) {
+    ThrowRDE("Bad combination of cpp (%u), bps (%u) and width (%u), the "
+             "pitch is %d bits, which is not a multiple of 8 (1 byte)",
+             mRaw->getCpp(), mBps, e.width, inputPitchBits);
   }
+
+  const int inputPitch = inputPitchBits / 8;
+  if (inputPitch == 0)
+    ThrowRDE("Data input pitch is too short. Can not decode!");
+
+  UncompressedDecompressor decompressor(
+      e.bs, mRaw, iRectangle2D(pos, tileSize), inputPitch, mBps,
+      big_endian ? BitOrder::MSB : BitOrder::LSB);
+  decompressor.readUncompressedRaw();
 }
 
-#ifdef HAVE_ZLIB
-template <> void AbstractDngDecompressor::decompressThread<8>() const noexcept {
-  // NOLINTNEXTLINE(modernize-avoid-c-arrays)
-  std::unique_ptr<unsigned char[]> uBuffer;
+template <>
+void AbstractDngDecompressor::decompressSlice<7>(
+    const DngSliceElement& e) const {
+  LJpegDecoder d(e.bs, mRaw);
+  d.decode(e.offX, e.offY, e.width, e.height,
+           iPoint2D(e.dsc.tileW, e.dsc.tileH), mFixLjpeg);
+}
 
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (const auto& e :
-       Array1DRef(slices.data(), implicit_cast<int>(slices.size()))) {
-    try {
-      DeflateDecompressor z(e.bs.peekBuffer(e.bs.getRemainSize()), mRaw,
-                            mPredictor, mBps);
-      z.decode(&uBuffer, iPoint2D(mRaw->getCpp() * e.dsc.tileW, e.dsc.tileH),
-               iPoint2D(mRaw->getCpp() * e.width, e.height),
-               iPoint2D(mRaw->getCpp() * e.offX, e.offY));
-    } catch (const RawDecoderException& err) {
-      mRaw->setError(err.what());
-    } catch (const IOException& err) {
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
-  }
+#ifdef HAVE_ZLIB
+void AbstractDngDecompressor::decompressDeflateSlice(
+    const DngSliceElement& e,
+    // NOLINTNEXTLINE(modernize-avoid-c-arrays)
+    std::unique_ptr<unsigned char[]>* uBuffer) const {
+  DeflateDecompressor z(e.bs.peekBuffer(e.bs.getRemainSize()), mRaw,
+                        mPredictor, mBps);
+  z.decode(uBuffer, iPoint2D(mRaw->getCpp() * e.dsc.tileW, e.dsc.tileH),
+           iPoint2D(mRaw->getCpp() * e.width, e.height),
+           iPoint2D(mRaw->getCpp() * e.offX, e.offY));
 }
 #endif
 
-template <> void AbstractDngDecompressor::decompressThread<9>() const noexcept {
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (const auto& e :
-       Array1DRef(slices.data(), implicit_cast<int>(slices.size()))) {
-    try {
-      VC5Decompressor d(e.bs, mRaw);
-      d.decode(e.offX, e.offY, e.width, e.height);
-    } catch (const RawDecoderException& err) {
-      mRaw->setError(err.what());
-    } catch (const IOException& err) {
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
-  }
+template <>
+void AbstractDngDecompressor::decompressSlice<9>(
+    const DngSliceElement& e) const {
+  VC5Decompressor d(e.bs, mRaw);
+  d.decode(e.offX, e.offY, e.width, e.height);
 }
 
 #ifdef HAVE_JPEG
 template <>
-void AbstractDngDecompressor::decompressThread<0x884c>() const noexcept {
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (const auto& e :
-       Array1DRef(slices.data(), implicit_cast<int>(slices.size()))) {
-    try {
-      JpegDecompressor j(e.bs.peekBuffer(e.bs.getRemainSize()), mRaw);
-      j.decode(e.offX, e.offY);
-    } catch (const RawDecoderException& err) {
-      mRaw->setError(err.what());
-    } catch (const IOException& err) {
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
-  }
+void AbstractDngDecompressor::decompressSlice<0x884c>(
+    const DngSliceElement& e) const {
+  JpegDecompressor j(e.bs.peekBuffer(e.bs.getRemainSize()), mRaw);
+  j.decode(e.offX, e.offY);
 }
 #endif
 
-void AbstractDngDecompressor::decompressThread() const noexcept {
+void AbstractDngDecompressor::decompress() const {
   invariant(mRaw->dim.x > 0);
   invariant(mRaw->dim.y > 0);
   invariant(mRaw->getCpp() > 0 && mRaw->getCpp() <= 4);
   invariant(mBps > 0 && mBps <= 32);
 
+  // The compressed size of a slice is a good estimate of its decoding cost.
+  std::vector<TileEngine::Cost> costs;
+  costs.reserve(slices.size());
+  for (const auto& e : slices)
+    costs.emplace_back(e.bs.getRemainSize());
+  TileEngine engine(
+      mRaw, Array1DRef<const TileEngine::Cost>(
+                costs.data(), implicit_cast<int>(costs.size())));
+
   if (compression == 1) {
     /* Uncompressed */
-    decompressThread<1>();
+    engine.run([this](int i) { decompressSlice<1>(slices[i]); });
   } else if (compression == 7) {
     /* Lossless JPEG */
-    decompressThread<7>();
+    engine.run([this](int i) { decompressSlice<7>(slices[i]); });
   } else if (compression == 8) {
     /* Deflate compression */
 #ifdef HAVE_ZLIB
-    decompressThread<8>();
+    engine.run(
+        // NOLINTNEXTLINE(modernize-avoid-c-arrays)
+        []() { return std::unique_ptr<unsigned char[]>(); },
+        [this](auto& uBuffer, int i) {
+          decompressDeflateSlice(slices[i], &uBuffer);
+        });
 #else
 #pragma message                                                                \
     "ZLIB is not present! Deflate compression will not be supported!"
-    mRaw->setError("deflate support is disabled.");
+    ThrowRDE("deflate support is disabled.");
 #endif
   } else if (compression == 9) {
     /* GOPRO VC-5 */
-    decompressThread<9>();
+    engine.run([this](int i) { decompressSlice<9>(slices[i]); });
   } else if (compression == 0x884c) {
     /* Lossy DNG */
 #ifdef HAVE_JPEG
-    decompressThread<0x884c>();
+    engine.run([this](int i) { decompressSlice<0x884c>(slices[i]); });
 #else
 #pragma message "JPEG is not present! Lossy JPEG DNG will not be supported!"
-    mRaw->setError("jpeg support is disabled.");
+    ThrowRDE("jpeg support is disabled.");
 #endif
   } else
-    mRaw->setError("AbstractDngDecompressor: Unknown compression");
-}
-
-void AbstractDngDecompressor::decompress() const {
-#ifdef HAVE_OPENMP
-#pragma omp parallel default(none) num_threads(                                \
-        rawspeed_get_number_of_processor_cores()) if (slices.size() > 1)
-#endif
-  decompressThread();
-
-  std::string firstErr;
-  if (mRaw->isTooManyErrors(1, &firstErr)) {
-    ThrowRDE("Too many errors encountered. Giving up. First Error:\n%s",
-             firstErr.c_str());
-  }
+    ThrowRDE("AbstractDngDecompressor: Unknown compression");
 }
 
 } // namespace rawspeed
@@ -29,6 +29,7 @@
 #include "decompressors/AbstractDecompressor.h"
 #include "io/ByteStream.h"
 #include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -127,9 +128,14 @@ struct DngSliceElement final {
 class AbstractDngDecompressor final : public AbstractDecompressor {
   RawImage mRaw;
 
-  template <int compression> void decompressThread() const noexcept;
+  template <int compression>
+  void decompressSlice(const DngSliceElement& e) const;
 
-  void decompressThread() const noexcept;
+  // Deflate reuses its scratch buffer across the slices.
+  void decompressDeflateSlice(
+      const DngSliceElement& e,
+      // NOLINTNEXTLINE(modernize-avoid-c-arrays)
+      std::unique_ptr<unsigned char[]>* uBuffer) const;
 
 public:
   AbstractDngDecompressor(RawImage img, const DngTilingDescription& dsc_,
@@ -154,6 +154,9 @@ private:
   template <int N_COMP>
   [[nodiscard]] std::array<uint16_t, N_COMP> getInitialPreds() const;
 
+  template <int N_COMP, int X_S_F, int Y_S_F, typename BitStreamer>
+  void decodeN_X_Y(BitStreamer& bs) const;
+
   template <int N_COMP, int X_S_F, int Y_S_F>
   [[nodiscard]] __attribute__((noinline)) ByteStream::size_type
   decompressN_X_Y() const;
@@ -23,14 +23,18 @@
 #include "rawspeedconfig.h"
 #include "adt/Array1DRef.h"
 #include "adt/Array2DRef.h"
+#include "adt/Casts.h"
 #include "adt/Invariant.h"
 #include "adt/Optional.h"
 #include "adt/Point.h"
 #include "adt/iterator_range.h"
 #include "bitstreams/BitStreamerJPEG.h"
+#include "bitstreams/BitStreamerMSB.h"
+#include "bitstreams/JPEGUnstuffer.h"
 #include "common/RawImage.h"
 #include "decoders/RawDecoderException.h"
 #include "decompressors/Cr2Decompressor.h"
+#include "decompressors/LJpegPredictor.h"
 #include "io/ByteStream.h"
 #include <algorithm>
 #include <array>
@@ -394,9 +398,8 @@ Cr2Decompressor<PrefixCodeDecoder>::getInitialPreds() const {
 // Y_S_F  == y/vertical   sampling factor (1 or 2)
 
 template <typename PrefixCodeDecoder>
-template <int N_COMP, int X_S_F, int Y_S_F>
-ByteStream::size_type
-Cr2Decompressor<PrefixCodeDecoder>::decompressN_X_Y() const {
+template <int N_COMP, int X_S_F, int Y_S_F, typename BitStreamer>
+void Cr2Decompressor<PrefixCodeDecoder>::decodeN_X_Y(BitStreamer& bs) const {
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
 
   // To understand the CR2 slice handling and sampling factor behavior, see
@@ -416,7 +419,11 @@ Cr2Decompressor<PrefixCodeDecoder>::decompressN_X_Y() const {
                       .getCrop(/*offset=*/0, /*size=*/dsc.groupSize)
                       .getAsArray1DRef();
 
-  BitStreamerJPEG bs(input);
+  // The differences of one run of pixels, see below.
+  std::vector<uint16_t> diffsStorage(
+      implicit_cast<size_t>(dsc.groupSize) * frame.x);
+  const auto diffs = Array1DRef(diffsStorage.data(),
+                                implicit_cast<int>(diffsStorage.size()));
 
   int globalFrameCol = 0;
   int globalFrameRow = 0;
@@ -431,6 +438,8 @@ Cr2Decompressor<PrefixCodeDecoder>::decompressN_X_Y() const {
   for (iRectangle2D output : getVerticalOutputStrips()) {
     for (int row = output.getTop(), rowEnd = output.getBottom(); row != rowEnd;
          ++row) {
+      mRaw->checkCancelled();
+
       for (int col = output.getLeft(), colEnd = output.getRight();
            col != colEnd;) {
         // check if we processed one full raw row worth of pixels
@@ -452,19 +461,64 @@ Cr2Decompressor<PrefixCodeDecoder>::decompressN_X_Y() const {
 
         // How many pixel can we decode until we finish the row of either
         // the frame (i.e. predictor change time), or of the current slice?
-        for (int colFrameEnd = std::min(colEnd, col + frameColsRemaining());
-             col != colFrameEnd; ++col, ++globalFrameCol) {
+        const int colFrameEnd = std::min(colEnd, col + frameColsRemaining());
+        const int numGroups = colFrameEnd - col;
+        const auto runDiffs =
+            diffs.getCrop(/*offset=*/0, /*size=*/dsc.groupSize * numGroups)
+                .getAsArray1DRef();
+        const auto runOut = out[row]
+                                .getCrop(/*offset=*/dsc.groupSize * col,
+                                         /*size=*/dsc.groupSize * numGroups)
+                                .getAsArray1DRef();
+
+        // First, only decode the differences, ...
+        for (int g = 0; g != numGroups; ++g) {
           for (int p = 0; p < dsc.groupSize; ++p) {
             int c = p < dsc.pixelsPerGroup ? 0 : p - dsc.pixelsPerGroup + 1;
-            out(row, dsc.groupSize * col + p) = pred[c] +=
+            runDiffs((dsc.groupSize * g) + p) = uint16_t(
                 (static_cast<const PrefixCodeDecoder&>(ht[c]))
-                    .decodeDifference(bs);
+                    .decodeDifference(bs));
           }
         }
+
+        // ... and then reconstruct the pixels.
+        if constexpr (dsc.groupSize == N_COMP) {
+          // Each component is predicted from its own previous sample.
+          reconstructFromLeftPredictor(
+              runOut, runDiffs, Array1DRef(pred.data(), N_COMP));
+        } else {
+          for (int g = 0; g != numGroups; ++g) {
+            for (int p = 0; p < dsc.groupSize; ++p) {
+              int c = p < dsc.pixelsPerGroup ? 0 : p - dsc.pixelsPerGroup + 1;
+              int i = (dsc.groupSize * g) + p;
+              runOut(i) = pred[c] += runDiffs(i);
+            }
+          }
+        }
+
+        col = colFrameEnd;
+        globalFrameCol += numGroups;
       }
     }
   }
-  return bs.getStreamPosition();
+}
+
+template <typename PrefixCodeDecoder>
+template <int N_COMP, int X_S_F, int Y_S_F>
+ByteStream::size_type
+Cr2Decompressor<PrefixCodeDecoder>::decompressN_X_Y() const {
+  if (!mRaw->unstuffJPEGUpFront) {
+    BitStreamerJPEG bs(input);
+    decodeN_X_Y<N_COMP, X_S_F, Y_S_F>(bs);
+    return bs.getStreamPosition();
+  }
+
+  // There are no restart markers, so the whole stream gets unstuffed at once.
+  JPEGUnstuffer unstuffer;
+  const UnstuffedJPEGSegment segment = unstuffer.unstuff(input);
+  BitStreamerMSB bs(segment.bytes);
+  decodeN_X_Y<N_COMP, X_S_F, Y_S_F>(bs);
+  return segment.streamPosition;
 }
 
 template <typename PrefixCodeDecoder>
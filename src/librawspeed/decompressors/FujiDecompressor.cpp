@@ -37,6 +37,7 @@
 #include "common/RawImage.h"
 #include "common/XTransPhase.h"
 #include "decoders/RawDecoderException.h"
+#include "decompressors/TileEngine.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
@@ -48,7 +49,6 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
-#include <string>
 #include <utility>
 #include <vector>
 
@@ -241,11 +241,12 @@ int8_t fuji_compressed_params::qTableLookup(int cur_val) const {
 }
 
 struct fuji_compressed_block final {
+  const RawImageData& raw;
   const Array2DRef<uint16_t> img;
   const FujiDecompressor::FujiHeader& header;
   const fuji_compressed_params& common_info;
 
-  fuji_compressed_block(Array2DRef<uint16_t> img,
+  fuji_compressed_block(const RawImageData& raw, Array2DRef<uint16_t> img,
                         const FujiDecompressor::FujiHeader& header,
                         const fuji_compressed_params& common_info);
 
@@ -297,9 +298,10 @@ struct fuji_compressed_block final {
 };
 
 fuji_compressed_block::fuji_compressed_block(
-    Array2DRef<uint16_t> img_, const FujiDecompressor::FujiHeader& header_,
+    const RawImageData& raw_, Array2DRef<uint16_t> img_,
+    const FujiDecompressor::FujiHeader& header_,
     const fuji_compressed_params& common_info_)
-    : img(img_), header(header_), common_info(common_info_),
+    : raw(raw_), img(img_), header(header_), common_info(common_info_),
       linealloc(ltotal * (common_info.line_width + 2), 0),
       lines(&linealloc[0], common_info.line_width + 2, ltotal) {}
 
@@ -742,6 +744,9 @@ void fuji_compressed_block::fuji_decode_strip(const FujiStrip& strip) {
   const std::array<i_pair, 3> colors = {{{R0, 5}, {G0, 8}, {B0, 5}}};
 
   for (int cur_line = 0; cur_line < strip.height(); cur_line++) {
+    if (raw.hasErrors() || raw.isCancelled())
+      return;
+
     if (header.raw_type == 16) {
       xtrans_decode_block(cur_line);
     } else {
@@ -786,8 +791,6 @@ class FujiDecompressorImpl final {
 
   const fuji_compressed_params common_info;
 
-  void decompressThread() const noexcept;
-
 public:
   FujiDecompressorImpl(RawImage mRaw,
                        Array1DRef<const Array1DRef<const uint8_t>> strips,
@@ -802,41 +805,27 @@ FujiDecompressorImpl::FujiDecompressorImpl(
     : mRaw(std::move(mRaw_)), strips(strips_), header(h_), common_info(header) {
 }
 
-void FujiDecompressorImpl::decompressThread() const noexcept {
-  fuji_compressed_block block_info(mRaw->getU16DataAsUncroppedArray2DRef(),
-                                   header, common_info);
-
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (int block = 0; block < header.blocks_in_row; ++block) {
-    try {
-      FujiStrip strip(header, block, strips(block));
-      block_info.reset();
-      block_info.pump = BitStreamerMSB(strip.input);
-      block_info.fuji_decode_strip(strip);
-    } catch (const RawspeedException& err) {
-      // Propagate the exception out of OpenMP magic.
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
-  }
-}
-
 void FujiDecompressorImpl::decompress() {
-#ifdef HAVE_OPENMP
-#pragma omp parallel default(none)                                             \
-    num_threads(rawspeed_get_number_of_processor_cores())
-#endif
-  decompressThread();
-
-  std::string firstErr;
-  if (mRaw->isTooManyErrors(1, &firstErr)) {
-    ThrowRDE("Too many errors encountered. Giving up. First Error:\n%s",
-             firstErr.c_str());
-  }
+  // The compressed size of a strip is a good estimate of its decoding cost.
+  std::vector<TileEngine::Cost> costs;
+  costs.reserve(header.blocks_in_row);
+  for (int block = 0; block < header.blocks_in_row; ++block)
+    costs.emplace_back(strips(block).size());
+
+  TileEngine(mRaw, Array1DRef<const TileEngine::Cost>(
+                       costs.data(), implicit_cast<int>(costs.size())))
+      .run(
+          [this]() {
+            return fuji_compressed_block(
+                *mRaw, mRaw->getU16DataAsUncroppedArray2DRef(), header,
+                common_info);
+          },
+          [this](fuji_compressed_block& block_info, int block) {
+            FujiStrip strip(header, block, strips(block));
+            block_info.reset();
+            block_info.pump = BitStreamerMSB(strip.input);
+            block_info.fuji_decode_strip(strip);
+          });
 }
 
 } // namespace
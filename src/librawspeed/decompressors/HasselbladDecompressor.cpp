@@ -83,6 +83,8 @@ ByteStream::size_type HasselbladDecompressor::decompress() {
   // [p1_length_as_huffman][p2_length_as_huffman][p0_diff_with_length][p1_diff_with_length]|NEXT
   // PIXELS
   for (int row = 0; row < out.height(); row++) {
+    mRaw->checkCancelled();
+
     int p1 = rec.initPred;
     int p2 = rec.initPred;
     for (int col = 0; col < out.width(); col += 2) {
@@ -33,7 +33,6 @@
 #include "io/ByteStream.h"
 #include <algorithm>
 #include <array>
-#include <cstddef>
 #include <cstdint>
 #include <utility>
 
@@ -43,10 +42,8 @@
 
 namespace rawspeed {
 
-KodakDecompressor::KodakDecompressor(RawImage img, ByteStream bs, int bps_,
-                                     bool uncorrectedRawValues_)
-    : mRaw(std::move(img)), input(bs), bps(bps_),
-      uncorrectedRawValues(uncorrectedRawValues_) {
+KodakDecompressor::KodakDecompressor(RawImage img, ByteStream bs, int bps_)
+    : mRaw(std::move(img)), input(bs), bps(bps_) {
   if (mRaw->getCpp() != 1 || mRaw->getDataType() != RawImageType::UINT16 ||
       mRaw->getBpp() != sizeof(uint16_t))
     ThrowRDE("Unexpected component count / data type");
@@ -120,8 +117,9 @@ KodakDecompressor::decodeSegment(const uint32_t bsize) {
 void KodakDecompressor::decompress() {
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
 
-  uint32_t random = 0;
   for (int row = 0; row < out.height(); row++) {
+    mRaw->checkCancelled();
+
     for (int col = 0; col < out.width();) {
       const int len = std::min(segment_size, mRaw->dim.x - col);
 
@@ -137,13 +135,7 @@ void KodakDecompressor::decompress() {
         if (!isIntN(value, bps))
           ThrowRDE("Value out of bounds %d (bps = %i)", value, bps);
 
-        if (uncorrectedRawValues)
-          out(row, col) = implicit_cast<uint16_t>(value);
-        else {
-          mRaw->setWithLookUp(implicit_cast<uint16_t>(value),
-                              reinterpret_cast<std::byte*>(&out(row, col)),
-                              &random);
-        }
+        out(row, col) = implicit_cast<uint16_t>(value);
       }
     }
   }
@@ -34,7 +34,6 @@ class KodakDecompressor final : public AbstractDecompressor {
   RawImage mRaw;
   ByteStream input;
   int bps;
-  bool uncorrectedRawValues;
 
   static constexpr int segment_size = 256; // pixels
   using segment = std::array<int16_t, segment_size>;
@@ -42,8 +41,7 @@ class KodakDecompressor final : public AbstractDecompressor {
   segment decodeSegment(uint32_t bsize);
 
 public:
-  KodakDecompressor(RawImage img, ByteStream bs, int bps,
-                    bool uncorrectedRawValues_);
+  KodakDecompressor(RawImage img, ByteStream bs, int bps);
 
   void decompress();
 };
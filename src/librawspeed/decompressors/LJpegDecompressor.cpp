@@ -23,16 +23,21 @@
 #include "adt/Array1DRef.h"
 #include "adt/Array2DRef.h"
 #include "adt/Casts.h"
+#include "adt/CroppedArray1DRef.h"
 #include "adt/CroppedArray2DRef.h"
 #include "adt/Invariant.h"
 #include "adt/Optional.h"
 #include "adt/Point.h"
 #include "bitstreams/BitStreamerJPEG.h"
+#include "bitstreams/BitStreamerMSB.h"
+#include "bitstreams/JPEGUnstuffer.h"
 #include "codes/PrefixCodeDecoder.h"
 #include "common/Common.h"
+#include "common/Executor.h"
 #include "common/RawImage.h"
 #include "decoders/RawDecoderException.h"
 #include "decompressors/JpegMarkers.h"
+#include "decompressors/LJpegPredictor.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
@@ -174,6 +179,38 @@ std::array<uint16_t, N_COMP> LJpegDecompressor::getInitialPreds() const {
   return preds;
 }
 
+std::vector<ByteStream::size_type>
+LJpegDecompressor::findRestartIntervals(int numRestartIntervals) const {
+  invariant(numRestartIntervals > 0);
+
+  std::vector<ByteStream::size_type> intervalBegins;
+  intervalBegins.reserve(numRestartIntervals);
+
+  // Each restart interval, but the last one, is terminated by the next
+  // restart marker. Only look for them, the entropy-coded segments themselves
+  // are left for the decoding.
+  ByteStream inputStream(DataBuffer(input, Endianness::little));
+  for (int restartIntervalIndex = 0;
+       restartIntervalIndex != numRestartIntervals; ++restartIntervalIndex) {
+    if (restartIntervalIndex != 0) {
+      inputStream.skipBytes(JPEGUnstuffer::findMarker(
+          inputStream.peekRemainingBuffer().getAsArray1DRef()));
+      auto marker = peekMarker(inputStream);
+      if (!marker) // FIXME: can there be padding bytes before the marker?
+        ThrowRDE("Jpeg marker not encountered");
+      Optional<int> number = getRestartMarkerNumber(*marker);
+      if (!number)
+        ThrowRDE("Not a restart marker!");
+      if (*number != ((restartIntervalIndex - 1) % 8))
+        ThrowRDE("Unexpected restart marker found");
+      inputStream.skipBytes(2); // Good restart marker.
+    }
+    intervalBegins.emplace_back(inputStream.getPosition());
+  }
+
+  return intervalBegins;
+}
+
 namespace {
 
 template <int MCUWidth, int MCUHeight>
@@ -181,72 +218,72 @@ constexpr iPoint2D MCU = {MCUWidth, MCUHeight};
 
 } // namespace
 
-template <const iPoint2D& MCUSize, int N_COMP>
+template <const iPoint2D& MCUSize, int N_COMP, typename BitStreamer>
 void LJpegDecompressor::decodeRowN(
     Array2DRef<uint16_t> outStripe, Array2DRef<const uint16_t> pred,
+    Array2DRef<uint16_t> diffs,
     std::array<std::reference_wrapper<const PrefixCodeDecoder<>>, N_COMP> ht,
-    BitStreamerJPEG& bs) const {
+    BitStreamer& bs) const {
   invariant(MCUSize.area() == N_COMP);
   invariant(outStripe.width() >= MCUSize.x);
   invariant(outStripe.height() == MCUSize.y);
   invariant(pred.width() == MCUSize.x);
   invariant(pred.height() == MCUSize.y);
-
-  // FIXME: predictor may have value outside of the uint16_t.
-  // https://github.com/darktable-org/rawspeed/issues/175
-
+  invariant(diffs.height() == MCUSize.y);
+  invariant(diffs.width() ==
+            MCUSize.x * (numFullMCUs + (trailingPixels != 0 ? 1 : 0)));
+
+  // First, only decode the differences of the whole row, so that the prefix
+  // code decoding is not also serialized on the reconstruction.
+  // For x, we first decode all the MCUs that are (at least partially) within
+  // the image buffer ...
   int mcuIdx = 0;
-  // For x, we first process all full pixel MCUs within the image buffer ...
-  for (; mcuIdx < numFullMCUs; ++mcuIdx) {
-    const auto outTile = CroppedArray2DRef(outStripe,
-                                           /*offsetCols=*/MCUSize.x * mcuIdx,
-                                           /*offsetRows=*/0,
-                                           /*croppedWidth=*/MCUSize.x,
-                                           /*croppedHeight=*/MCUSize.y)
-                             .getAsArray2DRef();
+  for (; mcuIdx != diffs.width() / MCUSize.x; ++mcuIdx) {
     for (int MCURow = 0; MCURow != MCUSize.y; ++MCURow) {
       for (int MCUСol = 0; MCUСol != MCUSize.x; ++MCUСol) {
         int c = MCUSize.x * MCURow + MCUСol;
-        int prediction = pred(MCURow, MCUСol);
         int diff = (static_cast<const PrefixCodeDecoder<>&>(ht[c]))
                        .decodeDifference(bs);
-        int pix = prediction + diff;
-        outTile(MCURow, MCUСol) = uint16_t(pix);
+        diffs(MCURow, (MCUSize.x * mcuIdx) + MCUСol) = uint16_t(diff);
       }
     }
-    // The predictor for the next MCU of the row is the just-decoded MCU.
-    pred = outTile;
   }
 
-  // Sometimes we also need to consume one more MCU, and produce part of it.
-  if (trailingPixels != 0) {
-    // Some rather esoteric DNG's have odd dimensions, e.g. width % 2 = 1.
-    // We may end up needing just part of last N_COMP pixels.
-    invariant(trailingPixels > 0);
-    invariant(trailingPixels < N_COMP);
-    invariant(N_COMP > 1 && "can't want part of 1-pixel-wide block");
+  // ... and discard the rest.
+  for (; mcuIdx < frame.dim.x; ++mcuIdx) {
+    for (int i = 0; i != N_COMP; ++i)
+      (static_cast<const PrefixCodeDecoder<>&>(ht[i])).decodeDifference(bs);
+  }
+
+  // FIXME: predictor may have value outside of the uint16_t.
+  // https://github.com/darktable-org/rawspeed/issues/175
+
+  // Then, reconstruct the pixels. The predictor for the each MCU of the row
+  // is the previous MCU, so each row of the MCU's is a running sum.
+  const int numFullCols = MCUSize.x * numFullMCUs;
+  for (int MCURow = 0; MCURow != MCUSize.y; ++MCURow) {
+    std::array<uint16_t, MCUSize.x> preds;
+    for (int MCUСol = 0; MCUСol != MCUSize.x; ++MCUСol)
+      preds[MCUСol] = pred(MCURow, MCUСol);
+
+    reconstructFromLeftPredictor(
+        outStripe[MCURow].getCrop(0, numFullCols).getAsArray1DRef(),
+        diffs[MCURow].getCrop(0, numFullCols).getAsArray1DRef(),
+        Array1DRef(preds.data(), MCUSize.x));
+
+    // Sometimes we also need to produce part of one more MCU.
     // Some rather esoteric DNG's have odd dimensions, e.g. width % 2 = 1.
-    // We may end up needing just part of last N_COMP pixels.
-    for (int MCURow = 0; MCURow != MCUSize.y; ++MCURow) {
+    if (trailingPixels != 0) {
+      invariant(trailingPixels > 0);
+      invariant(trailingPixels < N_COMP);
+      invariant(N_COMP > 1 && "can't want part of 1-pixel-wide block");
       for (int MCUСol = 0; MCUСol != MCUSize.x; ++MCUСol) {
-        int c = MCUSize.x * MCURow + MCUСol;
-        int prediction = pred(MCURow, MCUСol);
-        int diff = (static_cast<const PrefixCodeDecoder<>&>(ht[c]))
-                       .decodeDifference(bs);
-        int pix = prediction + diff;
-        int stripeRow = MCURow;
-        int stripeCol = (MCUSize.x * mcuIdx) + MCUСol;
+        int stripeCol = numFullCols + MCUСol;
+        int pix = preds[MCUСol] + diffs(MCURow, stripeCol);
         if (stripeCol < outStripe.width())
-          outStripe(stripeRow, stripeCol) = uint16_t(pix);
+          outStripe(MCURow, stripeCol) = uint16_t(pix);
       }
     }
-    ++mcuIdx; // We did just process one more MCU.
-  }
-
-  // ... and discard the rest.
-  for (; mcuIdx < frame.dim.x; ++mcuIdx) {
-    for (int i = 0; i != N_COMP; ++i)
-      (static_cast<const PrefixCodeDecoder<>&>(ht[i])).decodeDifference(bs);
   }
 }
 
@@ -279,63 +316,92 @@ ByteStream::size_type LJpegDecompressor::decodeN() const {
   invariant(numRestartIntervals >= 0);
   invariant(numRestartIntervals != 0);
 
-  ByteStream inputStream(DataBuffer(input, Endianness::little));
-  for (int restartIntervalIndex = 0;
-       restartIntervalIndex != numRestartIntervals; ++restartIntervalIndex) {
-    auto predStorage = getInitialPreds<N_COMP>();
-    auto pred = Array2DRef(predStorage.data(), MCU.x, MCU.y);
-
-    if (restartIntervalIndex != 0) {
-      auto marker = peekMarker(inputStream);
-      if (!marker) // FIXME: can there be padding bytes before the marker?
-        ThrowRDE("Jpeg marker not encountered");
-      Optional<int> number = getRestartMarkerNumber(*marker);
-      if (!number)
-        ThrowRDE("Not a restart marker!");
-      if (*number != ((restartIntervalIndex - 1) % 8))
-        ThrowRDE("Unexpected restart marker found");
-      inputStream.skipBytes(2); // Good restart marker.
-    }
-
-    BitStreamerJPEG bs(inputStream.peekRemainingBuffer().getAsArray1DRef());
-
-    for (int ljpegRowOfRestartInterval = 0;
-         ljpegRowOfRestartInterval != numLJpegRowsPerRestartInterval;
-         ++ljpegRowOfRestartInterval) {
-      const int row =
-          frame.mcu.y * (numLJpegRowsPerRestartInterval * restartIntervalIndex +
-                         ljpegRowOfRestartInterval);
-      invariant(row >= 0);
-      invariant(row <= imgFrame.dim.y);
-
-      // For y, we can simply stop decoding when we reached the border.
-      if (row == imgFrame.dim.y) {
-        invariant((restartIntervalIndex + 1) == numRestartIntervals);
-        break;
+  const std::vector<ByteStream::size_type> intervalBegins =
+      findRestartIntervals(numRestartIntervals);
+
+  // Each restart interval starts with the initial predictors, so they can be
+  // decoded independently of each other, and thus concurrently.
+  ByteStream::size_type endPosition = 0;
+  mRaw->executor->parallelFor(numRestartIntervals, [&](int begin, int end) {
+    // The differences of one row of MCUs, see decodeRowN().
+    const int numStoredMCUs = numFullMCUs + (trailingPixels != 0 ? 1 : 0);
+    std::vector<uint16_t> diffsStorage(
+        implicit_cast<size_t>(N_COMP) * numStoredMCUs);
+    const auto diffs =
+        Array2DRef(diffsStorage.data(), MCU.x * numStoredMCUs, MCU.y);
+
+    JPEGUnstuffer unstuffer;
+    for (int restartIntervalIndex = begin; restartIntervalIndex != end;
+         ++restartIntervalIndex) {
+      auto predStorage = getInitialPreds<N_COMP>();
+      auto pred = Array2DRef(predStorage.data(), MCU.x, MCU.y);
+
+      auto decodeRows = [&](auto& bs) {
+        for (int ljpegRowOfRestartInterval = 0;
+             ljpegRowOfRestartInterval != numLJpegRowsPerRestartInterval;
+             ++ljpegRowOfRestartInterval) {
+          mRaw->checkCancelled();
+
+          const int row =
+              frame.mcu.y *
+              (numLJpegRowsPerRestartInterval * restartIntervalIndex +
+               ljpegRowOfRestartInterval);
+          invariant(row >= 0);
+          invariant(row <= imgFrame.dim.y);
+
+          // For y, we can simply stop decoding when we reached the border.
+          if (row == imgFrame.dim.y) {
+            invariant((restartIntervalIndex + 1) == numRestartIntervals);
+            break;
+          }
+
+          const auto outStripe =
+              CroppedArray2DRef(img,
+                                /*offsetCols=*/0,
+                                /*offsetRows=*/row,
+                                /*croppedWidth=*/img.width(),
+                                /*croppedHeight=*/frame.mcu.y)
+                  .getAsArray2DRef();
+
+          decodeRowN<MCU, N_COMP>(outStripe, pred, diffs, ht, bs);
+
+          // The predictor for the next line is the start of this line.
+          pred = CroppedArray2DRef(outStripe,
+                                   /*offsetCols=*/0,
+                                   /*offsetRows=*/0,
+                                   /*croppedWidth=*/MCU.x,
+                                   /*croppedHeight=*/MCU.y)
+                     .getAsArray2DRef();
+        }
+      };
+
+      const ByteStream::size_type intervalBegin =
+          intervalBegins[restartIntervalIndex];
+      const auto interval =
+          input
+              .getCrop(implicit_cast<int>(intervalBegin),
+                       input.size() - implicit_cast<int>(intervalBegin))
+              .getAsArray1DRef();
+      ByteStream::size_type intervalSize;
+      if (mRaw->unstuffJPEGUpFront) {
+        // Remove the byte stuffing of the whole restart interval up front,
+        // so that the decoding does not need to look for it.
+        const UnstuffedJPEGSegment segment = unstuffer.unstuff(interval);
+        BitStreamerMSB bs(segment.bytes);
+        decodeRows(bs);
+        intervalSize = segment.streamPosition;
+      } else {
+        BitStreamerJPEG bs(interval);
+        decodeRows(bs);
+        intervalSize = bs.getStreamPosition();
       }
 
-      const auto outStripe = CroppedArray2DRef(img,
-                                               /*offsetCols=*/0,
-                                               /*offsetRows=*/row,
-                                               /*croppedWidth=*/img.width(),
-                                               /*croppedHeight=*/frame.mcu.y)
-                                 .getAsArray2DRef();
-
-      decodeRowN<MCU, N_COMP>(outStripe, pred, ht, bs);
-
-      // The predictor for the next line is the start of this line.
-      pred = CroppedArray2DRef(outStripe,
-                               /*offsetCols=*/0,
-                               /*offsetRows=*/0,
-                               /*croppedWidth=*/MCU.x,
-                               /*croppedHeight=*/MCU.y)
-                 .getAsArray2DRef();
+      if (restartIntervalIndex + 1 == numRestartIntervals)
+        endPosition = intervalBegin + intervalSize;
     }
+  });
 
-    inputStream.skipBytes(bs.getStreamPosition());
-  }
-
-  return inputStream.getPosition();
+  return endPosition;
 }
 
 ByteStream::size_type LJpegDecompressor::decode() const {
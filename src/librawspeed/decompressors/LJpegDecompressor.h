@@ -24,7 +24,6 @@
 #include "adt/Array1DRef.h"
 #include "adt/Array2DRef.h"
 #include "adt/Point.h"
-#include "bitstreams/BitStreamerJPEG.h"
 #include "codes/PrefixCodeDecoder.h"
 #include "common/RawImage.h"
 #include "io/ByteStream.h"
@@ -76,11 +75,16 @@ private:
   template <int N_COMP>
   [[nodiscard]] std::array<uint16_t, N_COMP> getInitialPreds() const;
 
-  template <const iPoint2D& MCUSize, int N_COMP>
+  // The input positions of the first numRestartIntervals restart intervals.
+  [[nodiscard]] std::vector<ByteStream::size_type>
+  findRestartIntervals(int numRestartIntervals) const;
+
+  template <const iPoint2D& MCUSize, int N_COMP, typename BitStreamer>
   __attribute__((always_inline)) inline void decodeRowN(
       Array2DRef<uint16_t> outStripe, Array2DRef<const uint16_t> pred,
+      Array2DRef<uint16_t> diffs,
       std::array<std::reference_wrapper<const PrefixCodeDecoder<>>, N_COMP> ht,
-      BitStreamerJPEG& bs) const;
+      BitStreamer& bs) const;
 
   template <const iPoint2D& MCUSize>
   [[nodiscard]] __attribute__((noinline)) ByteStream::size_type decodeN() const;
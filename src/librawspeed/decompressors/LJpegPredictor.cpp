@@ -0,0 +1,165 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decompressors/LJpegPredictor.h"
+#include "adt/Array1DRef.h"
+#include "adt/CroppedArray1DRef.h"
+#include "adt/Invariant.h"
+#include "common/CpuFeatures.h"
+#include <cstdint>
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+#include <array>
+#include <immintrin.h>
+#endif
+
+namespace rawspeed {
+
+namespace {
+
+using ReconstructKernel = void (*)(Array1DRef<uint16_t> out,
+                                   Array1DRef<const uint16_t> diffs,
+                                   Array1DRef<uint16_t> preds);
+
+void reconstructGeneric(Array1DRef<uint16_t> out,
+                        Array1DRef<const uint16_t> diffs,
+                        Array1DRef<uint16_t> preds) {
+  const int stride = preds.size();
+  for (int i = 0; i != out.size(); i += stride) {
+    for (int c = 0; c != stride; ++c) {
+      preds(c) = static_cast<uint16_t>(preds(c) + diffs(i + c));
+      out(i + c) = preds(c);
+    }
+  }
+}
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+// Moves each 16-bit lane up by NumLanes lanes (across the 128-bit halves),
+// shifting in zeros.
+template <int NumLanes>
+RAWSPEED_TARGET_AVX2 __m256i shiftLanesUp(__m256i v) {
+  static_assert(NumLanes > 0 && NumLanes < 16);
+  // The low half of `v` in the high half, and zeros in the low half.
+  const __m256i lo = _mm256_permute2x128_si256(v, v, 0x08);
+  if constexpr (NumLanes >= 8)
+    return _mm256_slli_si256(lo, 2 * (NumLanes - 8));
+  else
+    return _mm256_alignr_epi8(v, lo, 16 - (2 * NumLanes));
+}
+
+// The prefix sum of every Stride'th lane.
+template <int Stride, int Step = Stride>
+RAWSPEED_TARGET_AVX2 __m256i prefixSum(__m256i v) {
+  if constexpr (Step >= 16)
+    return v;
+  else
+    return prefixSum<Stride, 2 * Step>(
+        _mm256_add_epi16(v, shiftLanesUp<Step>(v)));
+}
+
+// Broadcasts the last Stride lanes, i.e. the last sample of each component.
+template <int Stride>
+RAWSPEED_TARGET_AVX2 __m256i broadcastLast(__m256i v) {
+  v = _mm256_permute4x64_epi64(v, 0xFF);
+  if constexpr (Stride == 1)
+    v = _mm256_shufflehi_epi16(v, 0xFF);
+  if constexpr (Stride <= 2)
+    v = _mm256_shuffle_epi32(v, 0xFF);
+  return v;
+}
+
+template <int Stride>
+RAWSPEED_TARGET_AVX2 void reconstructAVX2Impl(Array1DRef<uint16_t> out,
+                                              Array1DRef<const uint16_t> diffs,
+                                              Array1DRef<uint16_t> preds) {
+  static_assert(16 % Stride == 0);
+  constexpr int VecLanes = sizeof(__m256i) / sizeof(uint16_t);
+  invariant(preds.size() == Stride);
+
+  // The (previous) last sample of each component, in every lane.
+  std::array<uint16_t, VecLanes> initial;
+  for (int i = 0; i != VecLanes; ++i)
+    initial[i] = preds(i % Stride);
+  __m256i carry =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(initial.data()));
+
+  int i = 0;
+  for (; i + VecLanes <= out.size(); i += VecLanes) {
+    __m256i v = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(diffs.begin() + i));
+    v = _mm256_add_epi16(prefixSum<Stride>(v), carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.begin() + i), v);
+    carry = broadcastLast<Stride>(v);
+  }
+  if (i != 0) {
+    for (int c = 0; c != Stride; ++c)
+      preds(c) = out(i - Stride + c);
+  }
+  reconstructGeneric(out.getCrop(i, out.size() - i).getAsArray1DRef(),
+                     diffs.getCrop(i, diffs.size() - i).getAsArray1DRef(),
+                     preds);
+}
+
+RAWSPEED_TARGET_AVX2 void reconstructAVX2(Array1DRef<uint16_t> out,
+                                          Array1DRef<const uint16_t> diffs,
+                                          Array1DRef<uint16_t> preds) {
+  switch (preds.size()) {
+  case 1:
+    reconstructAVX2Impl<1>(out, diffs, preds);
+    return;
+  case 2:
+    reconstructAVX2Impl<2>(out, diffs, preds);
+    return;
+  case 4:
+    reconstructAVX2Impl<4>(out, diffs, preds);
+    return;
+  default:
+    // The components do not line up with the vector lanes.
+    reconstructGeneric(out, diffs, preds);
+    return;
+  }
+}
+
+#endif
+
+ReconstructKernel getReconstructKernel() {
+  return selectKernel<ReconstructKernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX2, &reconstructAVX2},
+#endif
+      {CpuIsa::Generic, &reconstructGeneric},
+  });
+}
+
+} // namespace
+
+void reconstructFromLeftPredictor(Array1DRef<uint16_t> out,
+                                  Array1DRef<const uint16_t> diffs,
+                                  Array1DRef<uint16_t> preds) {
+  invariant(preds.size() > 0);
+  invariant(diffs.size() == out.size());
+  invariant(out.size() % preds.size() == 0);
+
+  static const ReconstructKernel kernel = getReconstructKernel();
+  kernel(out, diffs, preds);
+}
+
+} // namespace rawspeed
@@ -0,0 +1,42 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Array1DRef.h"
+#include <cstdint>
+
+namespace rawspeed {
+
+// Reconstructs the samples that were coded with the lossless JPEG
+// predictor 1 (the sample to the left), with `preds.size()` interleaved
+// components, i.e.
+//   out[i] = (i < stride ? preds[i] : out[i - stride]) + diffs[i]
+// (modulo 2^16), where stride = preds.size(). On return, preds holds the
+// last sample of each component, to continue the reconstruction with.
+//
+// This is the second half of the two-pass decoding: the prefix code decoder
+// first only produces the differences, and then they are summed up here,
+// for the 1, 2 and 4 components many at a time.
+void reconstructFromLeftPredictor(Array1DRef<uint16_t> out,
+                                  Array1DRef<const uint16_t> diffs,
+                                  Array1DRef<uint16_t> preds);
+
+} // namespace rawspeed
@@ -329,7 +329,7 @@ public:
     int code;
     unsigned val;
 
-    bits.fill();
+    bits.fillWide();
     code = bits.peekBitsNoFill(14);
     val = static_cast<unsigned>(dctbl1.bigTable[code]);
     if ((val & 0xff) != 0xff) {
@@ -456,8 +456,8 @@ Huffman NikonDecompressor::createPrefixCodeDecoder(uint32_t huffSelect) {
 }
 
 template <>
-PrefixCodeDecoder<>
-NikonDecompressor::createPrefixCodeDecoder<PrefixCodeDecoder<>>(
+NikonDecompressor::HuffmanDecoder
+NikonDecompressor::createPrefixCodeDecoder<NikonDecompressor::HuffmanDecoder>(
     uint32_t huffSelect) {
   HuffmanCode<BaselineCodeTag> hc;
   uint32_t count =
@@ -465,7 +465,7 @@ NikonDecompressor::createPrefixCodeDecoder<PrefixCodeDecoder<>>(
   hc.setCodeValues(
       Array1DRef<const uint8_t>(nikon_tree[huffSelect][1].data(), count));
 
-  PrefixCodeDecoder<> ht(std::move(hc));
+  HuffmanDecoder ht(std::move(hc));
   ht.setup(true, false);
   return ht;
 }
@@ -522,20 +522,17 @@ void NikonDecompressor::decompress(BitStreamerMSB& bits, int start_y,
 
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
 
-  // allow gcc to devirtualize the calls below
-  auto* rawdata = reinterpret_cast<RawImageDataU16*>(mRaw.get());
-
   invariant(out.width() % 2 == 0);
   invariant(out.width() >= 2);
   for (int row = start_y; row < end_y; row++) {
+    mRaw->checkCancelled();
+
     std::array<int, 2> pred = pUp[row & 1];
     for (int col = 0; col < out.width(); col++) {
       pred[col & 1] += ht.decodeDifference(bits);
       if (col < 2)
         pUp[row & 1][col & 1] = pred[col & 1];
-      rawdata->setWithLookUp(clampBits(pred[col & 1], 15),
-                             reinterpret_cast<std::byte*>(&out(row, col)),
-                             &random);
+      out(row, col) = clampBits(pred[col & 1], 15);
     }
   }
 }
@@ -546,17 +543,17 @@ void NikonDecompressor::decompress(Array1DRef<const uint8_t> input,
 
   BitStreamerMSB bits(input);
 
-  random = bits.peekBits(24);
-
   invariant(split == 0 || split < static_cast<unsigned>(mRaw->dim.y));
 
   if (!split) {
-    decompress<PrefixCodeDecoder<>>(bits, 0, mRaw->dim.y);
+    decompress<HuffmanDecoder>(bits, 0, mRaw->dim.y);
   } else {
-    decompress<PrefixCodeDecoder<>>(bits, 0, split);
+    decompress<HuffmanDecoder>(bits, 0, split);
     huffSelect += 1;
     decompress<NikonLASDecompressor>(bits, split, mRaw->dim.y);
   }
+
+  curveHandler.apply();
 }
 
 } // namespace rawspeed
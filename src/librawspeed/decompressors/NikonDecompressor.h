@@ -22,6 +22,7 @@
 
 #include "adt/Array1DRef.h"
 #include "bitstreams/BitStreamerMSB.h"
+#include "codes/AbstractPrefixCode.h"
 #include "codes/PrefixCodeDecoder.h"
 #include "common/RawImage.h"
 #include "decompressors/AbstractDecompressor.h"
@@ -36,6 +37,10 @@ class ByteStream;
 namespace rawspeed {
 
 class NikonDecompressor final : public AbstractDecompressor {
+  // Most of the symbols are 7..9 bits long, so a slightly deeper table pays
+  // off, see PrefixCodeDecoderBenchmark.
+  using HuffmanDecoder = PrefixCodeDecoder<BaselineCodeTag, 12>;
+
   RawImage mRaw;
   uint32_t bitsPS;
 
@@ -46,8 +51,6 @@ class NikonDecompressor final : public AbstractDecompressor {
 
   std::vector<uint16_t> curve;
 
-  uint32_t random;
-
 public:
   NikonDecompressor(RawImage raw, ByteStream metadata, uint32_t bitsPS);
 
@@ -67,8 +70,8 @@ private:
 };
 
 template <>
-PrefixCodeDecoder<>
-NikonDecompressor::createPrefixCodeDecoder<PrefixCodeDecoder<>>(
+NikonDecompressor::HuffmanDecoder
+NikonDecompressor::createPrefixCodeDecoder<NikonDecompressor::HuffmanDecoder>(
     uint32_t huffSelect);
 
 } // namespace rawspeed
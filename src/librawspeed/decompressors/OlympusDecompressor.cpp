@@ -207,10 +207,12 @@ void OlympusDecompressorImpl::decompress(ByteStream input) const {
   invariant(mRaw->dim.x % 2 == 0);
 
   input.skipBytes(7);
-  BitStreamerMSB bits(input.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerMSB bits(input.peekRemainingBuffer());
 
-  for (int y = 0; y < mRaw->dim.y; y++)
+  for (int y = 0; y < mRaw->dim.y; y++) {
+    mRaw->checkCancelled();
     decompressRow(bits, y);
+  }
 }
 
 } // namespace
@@ -22,7 +22,6 @@
 
 #include "rawspeedconfig.h"
 #include "decompressors/PanasonicV4Decompressor.h"
-#include "adt/Array1DRef.h"
 #include "adt/Array2DRef.h"
 #include "adt/Bit.h"
 #include "adt/Casts.h"
@@ -32,6 +31,7 @@
 #include "common/Common.h"
 #include "common/RawImage.h"
 #include "decoders/RawDecoderException.h"
+#include "decompressors/TileEngine.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include <algorithm>
@@ -172,7 +172,7 @@ public:
 
 inline void PanasonicV4Decompressor::processPixelPacket(
     ProxyStream& bits, int row, int col,
-    std::vector<uint32_t>* zero_pos) const noexcept {
+    std::vector<iPoint2D>* zero_pos) const noexcept {
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
 
   int sh = 0;
@@ -211,14 +211,14 @@ inline void PanasonicV4Decompressor::processPixelPacket(
     out(row, col) = implicit_cast<uint16_t>(pred[c]);
 
     if (zero_is_bad && 0 == pred[c])
-      zero_pos->push_back((row << 16) | col);
+      zero_pos->emplace_back(col, row);
 
     u++;
   }
 }
 
 void PanasonicV4Decompressor::processBlock(
-    const Block& block, std::vector<uint32_t>* zero_pos) const noexcept {
+    const Block& block, std::vector<iPoint2D>* zero_pos) const noexcept {
   ProxyStream bits(block.bs, section_split_offset);
 
   for (int row = block.beginCoord.y; row <= block.endCoord.y; row++) {
@@ -240,23 +240,9 @@ void PanasonicV4Decompressor::processBlock(
   }
 }
 
-void PanasonicV4Decompressor::decompressThread() const noexcept {
-  std::vector<uint32_t> zero_pos;
-
-  assert(!blocks.empty());
-
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (const auto& block :
-       Array1DRef(blocks.data(), implicit_cast<int>(blocks.size()))) {
-    try {
-      processBlock(block, &zero_pos);
-    } catch (...) {
-      // We should not get any exceptions here.
-      __builtin_unreachable();
-    }
-  }
+void PanasonicV4Decompressor::decompressBlock(const Block& block) const {
+  std::vector<iPoint2D> zero_pos;
+  processBlock(block, &zero_pos);
 
   if (zero_is_bad && !zero_pos.empty()) {
     MutexLocker guard(&mRaw->mBadPixelMutex);
@@ -265,13 +251,13 @@ void PanasonicV4Decompressor::decompressThread() const noexcept {
   }
 }
 
-void PanasonicV4Decompressor::decompress() const noexcept {
+void PanasonicV4Decompressor::decompress() const {
   assert(!blocks.empty());
-#ifdef HAVE_OPENMP
-#pragma omp parallel default(none)                                             \
-    num_threads(rawspeed_get_number_of_processor_cores())
-#endif
-  decompressThread();
+
+  // All the blocks (but maybe the last one) are of the same size.
+  TileEngine(mRaw, implicit_cast<int>(blocks.size())).run([this](int i) {
+    decompressBlock(blocks[i]);
+  });
 }
 
 } // namespace rawspeed
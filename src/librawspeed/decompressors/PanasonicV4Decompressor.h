@@ -74,18 +74,18 @@ class PanasonicV4Decompressor final : public AbstractDecompressor {
 
   inline void
   processPixelPacket(ProxyStream& bits, int row, int col,
-                     std::vector<uint32_t>* zero_pos) const noexcept;
+                     std::vector<iPoint2D>* zero_pos) const noexcept;
 
   void processBlock(const Block& block,
-                    std::vector<uint32_t>* zero_pos) const noexcept;
+                    std::vector<iPoint2D>* zero_pos) const noexcept;
 
-  void decompressThread() const noexcept;
+  void decompressBlock(const Block& block) const;
 
 public:
   PanasonicV4Decompressor(RawImage img, ByteStream input_, bool zero_is_not_bad,
                           uint32_t section_split_offset_);
 
-  void decompress() const noexcept;
+  void decompress() const;
 };
 
 } // namespace rawspeed
@@ -212,7 +212,7 @@ void PanasonicV5Decompressor::processBlock(const Block& block) const {
   static_assert(BlockSize % bytesPerPacket == 0);
 
   ProxyStream proxy(block.bs);
-  BitStreamerLSB bs(proxy.getStream().peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerLSB bs(proxy.getStream().peekRemainingBuffer());
 
   for (int row = block.beginCoord.y; row <= block.endCoord.y; row++) {
     int col = 0;
@@ -234,23 +234,23 @@ void PanasonicV5Decompressor::processBlock(const Block& block) const {
 }
 
 template <const PanasonicV5Decompressor::PacketDsc& dsc>
-void PanasonicV5Decompressor::decompressInternal() const noexcept {
-#ifdef HAVE_OPENMP
-#pragma omp parallel for num_threads(rawspeed_get_number_of_processor_cores()) \
-    schedule(static) default(none)
-#endif
-  for (const auto& block :
-       Array1DRef(blocks.data(), implicit_cast<int>(blocks.size()))) {
-    try {
-      processBlock<dsc>(block);
-    } catch (...) {
-      // We should not get any exceptions here.
-      __builtin_unreachable();
-    }
-  }
+void PanasonicV5Decompressor::decompressInternal() const {
+  mRaw->executor->parallelFor(
+      implicit_cast<int>(blocks.size()), [this](int beginBlock, int endBlock) {
+        for (const auto& block :
+             Array1DRef(blocks.data(), implicit_cast<int>(blocks.size()))
+                 .getCrop(beginBlock, endBlock - beginBlock)) {
+          try {
+            processBlock<dsc>(block);
+          } catch (...) {
+            // We should not get any exceptions here.
+            __builtin_unreachable();
+          }
+        }
+      });
 }
 
-void PanasonicV5Decompressor::decompress() const noexcept {
+void PanasonicV5Decompressor::decompress() const {
   switch (bps) {
   case 12:
     decompressInternal<TwelveBitPacket>();
@@ -93,12 +93,12 @@ class PanasonicV5Decompressor final : public AbstractDecompressor {
 
   template <const PacketDsc& dsc> void processBlock(const Block& block) const;
 
-  template <const PacketDsc& dsc> void decompressInternal() const noexcept;
+  template <const PacketDsc& dsc> void decompressInternal() const;
 
 public:
   PanasonicV5Decompressor(RawImage img, ByteStream input_, uint32_t bps_);
 
-  void decompress() const noexcept;
+  void decompress() const;
 };
 
 } // namespace rawspeed
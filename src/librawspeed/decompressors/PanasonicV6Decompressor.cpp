@@ -88,7 +88,7 @@ template <int B> struct pana_cs6_page_decoder final {
 template <>
 inline void __attribute__((always_inline))
 pana_cs6_page_decoder<12>::fillBuffer(ByteStream bs_) noexcept {
-  BitStreamerLSB bs(bs_.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerLSB bs(bs_.peekRemainingBuffer());
   bs.fill(32);
   pixelbuffer[17] = implicit_cast<uint16_t>(bs.getBits(8));
   pixelbuffer[16] = implicit_cast<uint16_t>(bs.getBits(8));
@@ -113,7 +113,7 @@ pana_cs6_page_decoder<12>::fillBuffer(ByteStream bs_) noexcept {
 template <>
 inline void __attribute__((always_inline))
 pana_cs6_page_decoder<14>::fillBuffer(ByteStream bs_) noexcept {
-  BitStreamerLSB bs(bs_.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerLSB bs(bs_.peekRemainingBuffer());
   bs.fill(32);
   bs.skipBitsNoFill(4);
   pixelbuffer[13] = implicit_cast<uint16_t>(bs.getBits(10));
@@ -232,22 +232,20 @@ void PanasonicV6Decompressor::decompressRow(int row) const noexcept {
 }
 
 template <const PanasonicV6Decompressor::BlockDsc& dsc>
-void PanasonicV6Decompressor::decompressInternal() const noexcept {
-#ifdef HAVE_OPENMP
-#pragma omp parallel for num_threads(rawspeed_get_number_of_processor_cores()) \
-    schedule(static) default(none)
-#endif
-  for (int row = 0; row < mRaw->dim.y; ++row) {
-    try {
-      decompressRow<dsc>(row);
-    } catch (...) {
-      // We should not get any exceptions here.
-      __builtin_unreachable();
+void PanasonicV6Decompressor::decompressInternal() const {
+  mRaw->executor->parallelFor(mRaw->dim.y, [this](int beginRow, int endRow) {
+    for (int row = beginRow; row < endRow; ++row) {
+      try {
+        decompressRow<dsc>(row);
+      } catch (...) {
+        // We should not get any exceptions here.
+        __builtin_unreachable();
+      }
     }
-  }
+  });
 }
 
-void PanasonicV6Decompressor::decompress() const noexcept {
+void PanasonicV6Decompressor::decompress() const {
   switch (bps) {
   case 12:
     decompressInternal<TwelveBitBlock>();
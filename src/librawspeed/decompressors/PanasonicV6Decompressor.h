@@ -47,12 +47,12 @@ class PanasonicV6Decompressor final : public AbstractDecompressor {
 
   template <const BlockDsc& dsc> void decompressRow(int row) const noexcept;
 
-  template <const BlockDsc& dsc> void decompressInternal() const noexcept;
+  template <const BlockDsc& dsc> void decompressInternal() const;
 
 public:
   PanasonicV6Decompressor(RawImage img, ByteStream input_, uint32_t bps_);
 
-  void decompress() const noexcept;
+  void decompress() const;
 };
 
 } // namespace rawspeed
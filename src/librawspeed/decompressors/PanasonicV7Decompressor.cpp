@@ -68,7 +68,7 @@ inline void __attribute__((always_inline))
 PanasonicV7Decompressor::decompressBlock(
     ByteStream block, CroppedArray1DRef<uint16_t> out) noexcept {
   invariant(out.size() == PixelsPerBlock);
-  BitStreamerLSB pump(block.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerLSB pump(block.peekRemainingBuffer());
   for (int pix = 0; pix < PixelsPerBlock; pix++)
     out(pix) = implicit_cast<uint16_t>(pump.getBits(BitsPerSample));
 }
@@ -89,18 +89,16 @@ void PanasonicV7Decompressor::decompressRow(int row) const noexcept {
 }
 
 void PanasonicV7Decompressor::decompress() const {
-#ifdef HAVE_OPENMP
-#pragma omp parallel for num_threads(rawspeed_get_number_of_processor_cores()) \
-    schedule(static) default(none)
-#endif
-  for (int row = 0; row < mRaw->dim.y; ++row) {
-    try {
-      decompressRow(row);
-    } catch (...) {
-      // We should not get any exceptions here.
-      __builtin_unreachable();
+  mRaw->executor->parallelFor(mRaw->dim.y, [this](int beginRow, int endRow) {
+    for (int row = beginRow; row < endRow; ++row) {
+      try {
+        decompressRow(row);
+      } catch (...) {
+        // We should not get any exceptions here.
+        __builtin_unreachable();
+      }
     }
-  }
+  });
 }
 
 } // namespace rawspeed
@@ -138,7 +138,7 @@ PentaxDecompressor::SetupPrefixCodeDecoder_Modern(ByteStream stream) {
   return hc;
 }
 
-PrefixCodeDecoder<>
+PentaxDecompressor::HuffmanDecoder
 PentaxDecompressor::SetupPrefixCodeDecoder(Optional<ByteStream> metaData) {
   Optional<HuffmanCode<BaselineCodeTag>> hc;
 
@@ -147,7 +147,7 @@ PentaxDecompressor::SetupPrefixCodeDecoder(Optional<ByteStream> metaData) {
   else
     hc = SetupPrefixCodeDecoder_Legacy();
 
-  PrefixCodeDecoder<> ht(std::move(*hc));
+  HuffmanDecoder ht(std::move(*hc));
   ht.setup(true, false);
 
   return ht;
@@ -160,14 +160,27 @@ void PentaxDecompressor::decompress(ByteStream data) const {
   invariant(out.width() > 0);
   invariant(out.width() % 2 == 0);
 
-  BitStreamerMSB bs(data.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerMSB bs(data.peekRemainingBuffer());
+
+  // A single lookup may resolve several differences, even ones that already
+  // belong to the next row, so the leftovers are carried over.
+  std::array<int, HuffmanDecoder::MaxSymbolsPerLookup> diffs;
+  int numDiffs = 0;
+  int nextDiff = 0;
+
   for (int row = 0; row < out.height(); row++) {
+    mRaw->checkCancelled();
+
     std::array<int, 2> pred = {{}};
     if (row >= 2)
       pred = {out(row - 2, 0), out(row - 2, 1)};
 
     for (int col = 0; col < out.width(); col++) {
-      pred[col & 1] += ht.decodeDifference(bs);
+      if (nextDiff == numDiffs) {
+        numDiffs = ht.decodeDifferences(bs, diffs);
+        nextDiff = 0;
+      }
+      pred[col & 1] += diffs[nextDiff++];
       int value = pred[col & 1];
       if (!isIntN(value, 16))
         ThrowRDE("decoded value out of bounds at %d:%d", col, row);
@@ -35,8 +35,12 @@ namespace rawspeed {
 class ByteStream;
 
 class PentaxDecompressor final : public AbstractDecompressor {
+  // The symbols are short enough for a 12-bit table to usually resolve two
+  // of them at once, see PrefixCodeDecoderBenchmark.
+  using HuffmanDecoder = MultiSymbolPrefixCodeDecoder<BaselineCodeTag, 12>;
+
   RawImage mRaw;
-  const PrefixCodeDecoder<> ht;
+  const HuffmanDecoder ht;
 
 public:
   PentaxDecompressor(RawImage img, Optional<ByteStream> metaData);
@@ -47,8 +51,7 @@ private:
   static HuffmanCode<BaselineCodeTag> SetupPrefixCodeDecoder_Legacy();
   static HuffmanCode<BaselineCodeTag>
   SetupPrefixCodeDecoder_Modern(ByteStream stream);
-  static PrefixCodeDecoder<>
-  SetupPrefixCodeDecoder(Optional<ByteStream> metaData);
+  static HuffmanDecoder SetupPrefixCodeDecoder(Optional<ByteStream> metaData);
 
   static const std::array<std::array<std::array<uint8_t, 16>, 2>, 1>
       pentax_tree;
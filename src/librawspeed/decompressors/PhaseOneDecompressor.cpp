@@ -31,10 +31,10 @@
 #include "common/Common.h"
 #include "common/RawImage.h"
 #include "decoders/RawDecoderException.h"
+#include "decompressors/TileEngine.h"
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <string>
 #include <utility>
 #include <vector>
 
@@ -91,7 +91,7 @@ void PhaseOneDecompressor::decompressStrip(const PhaseOneStrip& strip) const {
   static constexpr std::array<const int, 10> length = {8,  7, 6,  9,  11,
                                                        10, 5, 12, 14, 13};
 
-  BitStreamerMSB32 pump(strip.bs.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerMSB32 pump(strip.bs.peekRemainingBuffer());
 
   std::array<int32_t, 2> pred;
   pred.fill(0);
@@ -135,36 +135,11 @@ void PhaseOneDecompressor::decompressStrip(const PhaseOneStrip& strip) const {
   }
 }
 
-void PhaseOneDecompressor::decompressThread() const noexcept {
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (const auto& strip :
-       Array1DRef(strips.data(), implicit_cast<int>(strips.size()))) {
-    try {
-      decompressStrip(strip);
-    } catch (const RawspeedException& err) {
-      // Propagate the exception out of OpenMP magic.
-      mRaw->setError(err.what());
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
-  }
-}
-
 void PhaseOneDecompressor::decompress() const {
-#ifdef HAVE_OPENMP
-#pragma omp parallel default(none)                                             \
-    num_threads(rawspeed_get_number_of_processor_cores())
-#endif
-  decompressThread();
-
-  std::string firstErr;
-  if (mRaw->isTooManyErrors(1, &firstErr)) {
-    ThrowRDE("Too many errors encountered. Giving up. First Error:\n%s",
-             firstErr.c_str());
-  }
+  // Each strip is one row, so they all cost about the same.
+  TileEngine(mRaw, implicit_cast<int>(strips.size())).run([this](int i) {
+    decompressStrip(strips[i]);
+  });
 }
 
 } // namespace rawspeed
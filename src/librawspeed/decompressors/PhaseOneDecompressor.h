@@ -44,8 +44,6 @@ class PhaseOneDecompressor final : public AbstractDecompressor {
 
   void decompressStrip(const PhaseOneStrip& strip) const;
 
-  void decompressThread() const noexcept;
-
   void prepareStrips();
 
 public:
@@ -121,8 +121,10 @@ void SamsungV1Decompressor::decompress() const {
   invariant(out.width() % 32 == 0 &&
             "Should have even count of pixels per row.");
   invariant(out.height() % 2 == 0 && "Should have even row count.");
-  BitStreamerMSB pump(bs.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerMSB pump(bs.peekRemainingBuffer());
   for (int row = 0; row < out.height(); row++) {
+    mRaw->checkCancelled();
+
     std::array<int, 2> pred = {{}};
     if (row >= 2)
       pred = {out(row - 2, 0), out(row - 2, 1)};
@@ -100,7 +100,7 @@ SamsungV2Decompressor::SamsungV2Decompressor(const RawImage& image,
   static constexpr const auto headerSize = 16;
   (void)bs.check(headerSize);
 
-  BitStreamerMSB32 startpump(bs.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerMSB32 startpump(bs.peekRemainingBuffer());
 
   // Process the initial metadata bits, we only really use initVal, width and
   // height (the last two match the TIFF values anyway)
@@ -331,7 +331,7 @@ void SamsungV2Decompressor::decompressRow(int row) {
   if (const auto line_offset = data.getPosition(); (line_offset & 0xf) != 0)
     data.skipBytes(16 - (line_offset & 0xf));
 
-  BitStreamerMSB32 pump(data.peekRemainingBuffer().getAsArray1DRef());
+  BitStreamerMSB32 pump(data.peekRemainingBuffer());
 
   // Initialize the motion and diff modes at the start of the line
   motion = 7;
@@ -350,8 +350,10 @@ void SamsungV2Decompressor::decompressRow(int row) {
 }
 
 void SamsungV2Decompressor::decompress() {
-  for (int row = 0; row < height; row++)
+  for (int row = 0; row < height; row++) {
+    mRaw->checkCancelled();
     decompressRow(row);
+  }
 }
 
 } // namespace rawspeed
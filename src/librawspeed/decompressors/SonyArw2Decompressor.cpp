@@ -30,10 +30,10 @@
 #include "common/Common.h"
 #include "common/RawImage.h"
 #include "decoders/RawDecoderException.h"
+#include "decompressors/TileEngine.h"
 #include "io/ByteStream.h"
 #include <cstddef>
 #include <cstdint>
-#include <string>
 #include <utility>
 
 namespace rawspeed {
@@ -58,16 +58,11 @@ void SonyArw2Decompressor::decompressRow(int row) const {
   invariant(out.width() > 0);
   invariant(out.width() % 32 == 0);
 
-  // Allow compiler to devirtualize the calls below.
-  auto& rawdata = reinterpret_cast<RawImageDataU16&>(*mRaw);
-
   ByteStream rowBs = input;
   rowBs.skipBytes(row * out.width());
   rowBs = rowBs.peekStream(out.width());
 
-  BitStreamerLSB bits(rowBs.peekRemainingBuffer().getAsArray1DRef());
-
-  uint32_t random = bits.peekBits(24);
+  BitStreamerLSB bits(rowBs.peekRemainingBuffer());
 
   // Each loop iteration processes 16 pixels, consuming 128 bits of input.
   for (int col = 0; col < out.width(); col += ((col & 1) != 0) ? 31 : 1) {
@@ -102,49 +97,18 @@ void SonyArw2Decompressor::decompressRow(int row) const {
             p = 0x7ff;
         }
       }
-      rawdata.setWithLookUp(
-          implicit_cast<uint16_t>(p << 1),
-          reinterpret_cast<std::byte*>(&out(row, col + i * 2)), &random);
+      out(row, col + i * 2) = implicit_cast<uint16_t>(p << 1);
     }
   }
 }
 
-void SonyArw2Decompressor::decompressThread() const noexcept {
+void SonyArw2Decompressor::decompress() const {
   invariant(mRaw->dim.x > 0);
   invariant(mRaw->dim.x % 32 == 0);
   invariant(mRaw->dim.y > 0);
 
-#ifdef HAVE_OPENMP
-#pragma omp for schedule(static)
-#endif
-  for (int y = 0; y < mRaw->dim.y; y++) {
-    try {
-      decompressRow(y);
-    } catch (const RawspeedException& err) {
-      // Propagate the exception out of OpenMP magic.
-      mRaw->setError(err.what());
-#ifdef HAVE_OPENMP
-#pragma omp cancel for
-#endif
-    } catch (...) {
-      // We should not get any other exception type here.
-      __builtin_unreachable();
-    }
-  }
-}
-
-void SonyArw2Decompressor::decompress() const {
-#ifdef HAVE_OPENMP
-#pragma omp parallel default(none)                                             \
-    num_threads(rawspeed_get_number_of_processor_cores())
-#endif
-  decompressThread();
-
-  std::string firstErr;
-  if (mRaw->isTooManyErrors(1, &firstErr)) {
-    ThrowRDE("Too many errors encountered. Giving up. First Error:\n%s",
-             firstErr.c_str());
-  }
+  // All the rows cost the same.
+  TileEngine(mRaw, mRaw->dim.y).run([this](int row) { decompressRow(row); });
 }
 
 } // namespace rawspeed
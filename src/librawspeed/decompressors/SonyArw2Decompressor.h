@@ -28,7 +28,6 @@ namespace rawspeed {
 
 class SonyArw2Decompressor final : public AbstractDecompressor {
   void decompressRow(int row) const;
-  void decompressThread() const noexcept;
 
   RawImage mRaw;
   ByteStream input;
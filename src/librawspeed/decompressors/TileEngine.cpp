@@ -0,0 +1,93 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decompressors/TileEngine.h"
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "adt/Invariant.h"
+#include "common/Cancellation.h"
+#include "common/RawImage.h"
+#include "common/RawspeedException.h"
+#include "decoders/RawDecoderException.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <utility>
+
+namespace rawspeed {
+
+TileEngine::TileEngine(RawImage img, int numItems_)
+    : mRaw(std::move(img)), numItems(numItems_) {
+  invariant(numItems >= 0);
+}
+
+TileEngine::TileEngine(RawImage img, Array1DRef<const Cost> costs)
+    : TileEngine(std::move(img), costs.size()) {
+  order.resize(numItems);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [costs](int a, int b) { return costs(a) > costs(b); });
+}
+
+void TileEngine::runItems(
+    const std::function<void(int)>& decodeItem) noexcept {
+  while (true) {
+    // Give up early if another item has already failed, or if cancelled.
+    if (mRaw->hasErrors() || mRaw->isCancelled())
+      return;
+
+    const int n = nextItem.fetch_add(1, std::memory_order_relaxed);
+    if (n >= numItems)
+      return;
+
+    try {
+      decodeItem(order.empty() ? n : order[n]);
+    } catch (const DecodeCancelledException&) {
+      // runWorkers() rethrows it.
+      return;
+    } catch (const RawspeedException& err) {
+      // Propagate the exception out of the executor.
+      mRaw->setError(err.what());
+    } catch (...) {
+      // We should not get any other exception type here.
+      __builtin_unreachable();
+    }
+  }
+}
+
+void TileEngine::runWorkers(const std::function<void()>& worker) {
+  const int numWorkers = std::min(mRaw->executor->getNumThreads(), numItems);
+  mRaw->executor->parallelFor(numWorkers, [&worker](int begin, int end) {
+    for (int i = begin; i != end; ++i)
+      worker();
+  });
+
+  mRaw->checkCancelled();
+
+  std::string firstErr;
+  if (mRaw->isTooManyErrors(1, &firstErr)) {
+    ThrowRDE("Too many errors encountered. Giving up. First Error:\n%s",
+             firstErr.c_str());
+  }
+}
+
+} // namespace rawspeed
@@ -0,0 +1,83 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "rawspeedconfig.h"
+#include "adt/Array1DRef.h"
+#include "common/RawImage.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace rawspeed {
+
+// Decodes the independent work items (tiles, strips, slices, rows, ...)
+// of an image on the image's executor.
+//
+// The items are handed out one at a time to whichever thread is free,
+// costliest first, so that a single large item that is started last does
+// not leave all the other threads idle. The cost of an item only needs to be
+// a relative estimate; the compressed byte length is usually a good one.
+//
+// A RawspeedException thrown by an item is recorded in the image's error log,
+// and no further items are started. Once all the threads are done,
+// the decoding is abandoned by throwing if any item failed,
+// or if it got cancelled.
+class TileEngine final {
+public:
+  using Cost = int64_t;
+
+private:
+  RawImage mRaw;
+  const int numItems;
+  std::vector<int> order; // Item indices, costliest first. Empty if uniform.
+
+  alignas(RAWSPEED_CACHELINESIZE) std::atomic<int> nextItem = 0;
+
+  void runItems(const std::function<void(int)>& decodeItem) noexcept;
+  void runWorkers(const std::function<void()>& worker);
+
+public:
+  // The items are [0, costs.size()).
+  TileEngine(RawImage img, Array1DRef<const Cost> costs);
+
+  // All of the numItems items cost the same.
+  TileEngine(RawImage img, int numItems);
+
+  // Calls decodeItem(i) once for each item i.
+  void run(const std::function<void(int)>& decodeItem) {
+    runWorkers([this, &decodeItem]() { runItems(decodeItem); });
+  }
+
+  // Same, but each of the threads first obtains its own scratch state from
+  // makeState(), and then passes it to decodeItem(state, i) for each of
+  // the items it decodes.
+  template <typename MakeState, typename DecodeItem>
+  void run(const MakeState& makeState, const DecodeItem& decodeItem) {
+    runWorkers([this, &makeState, &decodeItem]() {
+      auto state = makeState();
+      runItems([&state, &decodeItem](int i) { decodeItem(state, i); });
+    });
+  }
+};
+
+} // namespace rawspeed
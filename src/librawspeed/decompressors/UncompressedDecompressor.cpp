@@ -20,8 +20,11 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 */
 
+#include "rawspeedconfig.h"
 #include "decompressors/UncompressedDecompressor.h"
+#include "adt/Array1DRef.h"
 #include "adt/Array2DRef.h"
+#include "adt/Bit.h"
 #include "adt/Casts.h"
 #include "adt/Invariant.h"
 #include "adt/Point.h"
@@ -31,6 +34,7 @@
 #include "bitstreams/BitStreamerMSB32.h"
 #include "bitstreams/BitStreams.h"
 #include "common/Common.h"
+#include "common/CpuFeatures.h"
 #include "common/FloatingPoint.h"
 #include "common/RawImage.h"
 #include "decoders/RawDecoderException.h"
@@ -39,16 +43,272 @@
 #include "io/Endianness.h"
 #include "io/IOException.h"
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cinttypes>
 #include <cstddef>
 #include <cstdint>
 #include <utility>
 
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 using std::min;
 
 namespace rawspeed {
 
+namespace {
+
+// A packed row is a stream of bps-bit pixels, each one starting either with
+// its most significant bit (BitOrder::MSB*), or with its least significant
+// bit (BitOrder::LSB). For MSB16 and MSB32, the stream is then stored as
+// little-endian 16-bit or 32-bit words, i.e. with the bytes of each word
+// swapped.
+constexpr int packedWordBytes(BitOrder order) {
+  switch (order) {
+  case BitOrder::MSB16:
+    return 2;
+  case BitOrder::MSB32:
+    return 4;
+  default:
+    return 1;
+  }
+}
+
+template <BitOrder order, int bps> struct PackedRow final {
+  static_assert(bps % 2 == 0 && bps >= 8 && bps <= 16);
+
+  static constexpr int wordBytes = packedWordBytes(order);
+
+  // With the even bit depths, every four pixels take whole bytes.
+  static constexpr int quadBytes = bps / 2;
+  static_assert(quadBytes % wordBytes == 0,
+                "Each quad of pixels must start at a word boundary");
+
+  // Where is the i'th byte of the stream stored within the row?
+  static constexpr int byteAt(int i) { return i ^ (wordBytes - 1); }
+
+  static uint16_t pixel(const uint8_t* row, int i) {
+    const int firstBit = i * bps;
+    const int first = firstBit / 8;
+    const int skip = firstBit % 8;
+    const int numBytes = (skip + bps + 7) / 8;
+
+    uint32_t v = 0;
+    for (int k = 0; k < numBytes; k++) {
+      const uint32_t b = row[byteAt(first + k)];
+      if constexpr (order == BitOrder::LSB)
+        v |= b << (8 * k);
+      else
+        v = (v << 8) | b;
+    }
+    if constexpr (order == BitOrder::LSB)
+      v >>= skip;
+    else
+      v >>= (8 * numBytes) - skip - bps;
+    return implicit_cast<uint16_t>(extractLowBits<uint32_t>(v, bps));
+  }
+
+  // For each pixel of a quad, picks the three bytes that contain it into its
+  // own 32-bit lane, in the significance order of the bit order.
+  static constexpr std::array<int8_t, 16> quadShuffle() {
+    std::array<int8_t, 16> shuffle = {};
+    for (int j = 0; j < 4; j++) {
+      const int first = (j * bps) / 8;
+      for (int k = 0; k < 3; k++) {
+        const int lane = order == BitOrder::LSB ? k : 2 - k;
+        shuffle[(4 * j) + lane] = static_cast<int8_t>(byteAt(first + k));
+      }
+      shuffle[(4 * j) + 3] = -128; // Zero.
+    }
+    return shuffle;
+  }
+
+  // ... and then how far each lane needs to be shifted down.
+  static constexpr std::array<int32_t, 4> quadShifts() {
+    std::array<int32_t, 4> shifts = {};
+    for (int j = 0; j < 4; j++) {
+      const int skip = (j * bps) % 8;
+      shifts[j] = order == BitOrder::LSB ? skip : 24 - skip - bps;
+    }
+    return shifts;
+  }
+};
+
+// Unpacks the rows [row, rows) of the image, the first of them being at the
+// beginning of the input.
+using UnpackKernel = void (*)(Array1DRef<const uint8_t> input, int inputPitch,
+                              const Array2DRef<uint16_t>& out, int row,
+                              int rows, int cols);
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+RAWSPEED_TARGET_AVX2 inline __m128i loadBytesAVX2(const void* p) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+
+template <BitOrder order, int bps>
+RAWSPEED_TARGET_AVX2 inline __m256i unpackQuadsAVX2(const uint8_t* lo,
+                                                    const uint8_t* hi) {
+  using Row = PackedRow<order, bps>;
+  static constexpr std::array<int8_t, 16> shuffle = Row::quadShuffle();
+  static constexpr std::array<int32_t, 4> shifts = Row::quadShifts();
+
+  __m256i v = _mm256_set_m128i(loadBytesAVX2(hi), loadBytesAVX2(lo));
+  v = _mm256_shuffle_epi8(
+      v, _mm256_broadcastsi128_si256(loadBytesAVX2(shuffle.data())));
+  v = _mm256_srlv_epi32(
+      v, _mm256_broadcastsi128_si256(loadBytesAVX2(shifts.data())));
+  return _mm256_and_si256(v, _mm256_set1_epi32((1 << bps) - 1));
+}
+
+template <BitOrder order, int bps>
+RAWSPEED_TARGET_AVX2 void unpackAVX2(Array1DRef<const uint8_t> input,
+                                     int inputPitch,
+                                     const Array2DRef<uint16_t>& out, int row,
+                                     int rows, int cols) {
+  using Row = PackedRow<order, bps>;
+  static constexpr int q = Row::quadBytes;
+
+  for (int inRow = 0; row < rows; row++, inRow++) {
+    const uint8_t* in = input.begin() + (inRow * inputPitch);
+    const int avail = input.size() - (inRow * inputPitch);
+    uint16_t* line = &out(row, 0);
+
+    // Each step unpacks 16 pixels, loading 16 bytes for each of the 4 quads,
+    // which must not overrun the input.
+    int x = 0;
+    for (; x + 16 <= cols && ((x / 4) + 3) * q + 16 <= avail; x += 16) {
+      const uint8_t* quads = in + ((x / 4) * q);
+      const __m256i lo = unpackQuadsAVX2<order, bps>(quads, quads + q);
+      const __m256i hi =
+          unpackQuadsAVX2<order, bps>(quads + (2 * q), quads + (3 * q));
+      // Packing works within 128-bit lanes, restore the order.
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(line + x),
+                          _mm256_permute4x64_epi64(
+                              _mm256_packus_epi32(lo, hi), 0b11011000));
+    }
+    for (; x < cols; x++)
+      line[x] = Row::pixel(in, x);
+  }
+}
+
+#endif
+
+// Without a specialized unpacker for the layout (or the CPU), the generic
+// bit pump is used instead.
+template <BitOrder order, int bps> UnpackKernel getUnpackKernel() {
+  return selectKernel<UnpackKernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX2, &unpackAVX2<order, bps>},
+#endif
+      {CpuIsa::Generic, nullptr},
+  });
+}
+
+template <int bps> UnpackKernel getUnpackKernel(BitOrder order) {
+  switch (order) {
+  case BitOrder::LSB:
+    return getUnpackKernel<BitOrder::LSB, bps>();
+  case BitOrder::MSB:
+    return getUnpackKernel<BitOrder::MSB, bps>();
+  case BitOrder::MSB16:
+    if constexpr ((bps / 2) % packedWordBytes(BitOrder::MSB16) == 0)
+      return getUnpackKernel<BitOrder::MSB16, bps>();
+    return nullptr;
+  case BitOrder::MSB32:
+    if constexpr ((bps / 2) % packedWordBytes(BitOrder::MSB32) == 0)
+      return getUnpackKernel<BitOrder::MSB32, bps>();
+    return nullptr;
+  case BitOrder::JPEG:
+    return nullptr;
+  }
+  __builtin_unreachable();
+}
+
+UnpackKernel getUnpackKernel(BitOrder order, int bps, int inputPitch) {
+  // The rows must start at the word boundaries too.
+  if (inputPitch % packedWordBytes(order) != 0)
+    return nullptr;
+
+  switch (bps) {
+  case 8:
+    return getUnpackKernel<8>(order);
+  case 10:
+    return getUnpackKernel<10>(order);
+  case 12:
+    return getUnpackKernel<12>(order);
+  case 14:
+    return getUnpackKernel<14>(order);
+  case 16:
+    return getUnpackKernel<16>(order);
+  default:
+    return nullptr;
+  }
+}
+
+// Unpacks the leading whole blocks of a row of 12-bit pixels with a control
+// byte after every 10 pixels, and returns how many pixels that was.
+using Unpack12BitWithControlKernel = int (*)(Array1DRef<const uint8_t> in,
+                                             Array1DRef<uint16_t> out);
+
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+
+// Each 16-byte block is 5 pairs of pixels, packed into 3 bytes each, followed
+// by the control byte. For the big endian layout, the even pixel is the high
+// 12 bits of the first two bytes, and the odd pixel is the low 12 bits of the
+// last two bytes. For the little endian layout, it is the other way around.
+// Unpacks 4 pairs of pixels, with each pixel's two bytes already gathered
+// into its own 16-bit lane.
+template <Endianness e>
+RAWSPEED_TARGET_AVX2 inline __m128i unpack12BitPairsAVX2(__m128i v) {
+  const __m128i shifted = _mm_srli_epi16(v, 4);
+  const __m128i masked = _mm_and_si128(v, _mm_set1_epi16(0x0fff));
+  if constexpr (e == Endianness::big)
+    return _mm_blend_epi16(shifted, masked, 0b10101010);
+  else
+    return _mm_blend_epi16(masked, shifted, 0b10101010);
+}
+
+template <Endianness e>
+RAWSPEED_TARGET_AVX2 int
+unpack12BitWithControlAVX2(Array1DRef<const uint8_t> in,
+                           Array1DRef<uint16_t> out) {
+  // Pixels 0..7 come from the bytes 0..11, and pixels 2..9 (overlapping)
+  // from the bytes 3..14.
+  const __m128i pairs =
+      e == Endianness::big
+          ? _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10)
+          : _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+  const __m128i lastPairs = _mm_add_epi8(pairs, _mm_set1_epi8(3));
+
+  int x = 0;
+  for (; x + 10 <= out.size(); x += 10) {
+    const __m128i block = loadBytesAVX2(in.begin() + ((x / 10) * 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.begin() + x),
+                     unpack12BitPairsAVX2<e>(_mm_shuffle_epi8(block, pairs)));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(out.begin() + x + 2),
+        unpack12BitPairsAVX2<e>(_mm_shuffle_epi8(block, lastPairs)));
+  }
+  return x;
+}
+
+#endif
+
+template <Endianness e>
+Unpack12BitWithControlKernel getUnpack12BitWithControlKernel() {
+  return selectKernel<Unpack12BitWithControlKernel>({
+#ifdef RAWSPEED_HAVE_CPU_DISPATCH
+      {CpuIsa::AVX2, &unpack12BitWithControlAVX2<e>},
+#endif
+      {CpuIsa::Generic, nullptr},
+  });
+}
+
+} // namespace
+
 void UncompressedDecompressor::sanityCheck(const uint32_t* h,
                                            int bytesPerLine) const {
   invariant(h != nullptr);
@@ -171,7 +431,7 @@ UncompressedDecompressor::UncompressedDecompressor(
 template <typename Pump, typename NarrowFpType>
 void UncompressedDecompressor::decodePackedFP(int rows, int row) const {
   const Array2DRef<float> out(mRaw->getF32DataAsUncroppedArray2DRef());
-  Pump bits(input.peekRemainingBuffer().getAsArray1DRef());
+  Pump bits(getRowsInput(row));
 
   int cols = size.x * mRaw->getCpp();
   for (; row < rows; row++) {
@@ -188,7 +448,7 @@ void UncompressedDecompressor::decodePackedFP(int rows, int row) const {
 template <typename Pump>
 void UncompressedDecompressor::decodePackedInt(int rows, int row) const {
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
-  Pump bits(input.peekRemainingBuffer().getAsArray1DRef());
+  Pump bits(getRowsInput(row));
 
   int cols = size.x * mRaw->getCpp();
   for (; row < rows; row++) {
@@ -199,75 +459,106 @@ void UncompressedDecompressor::decodePackedInt(int rows, int row) const {
   }
 }
 
-void UncompressedDecompressor::readUncompressedRaw() {
-  uint32_t outPitch = mRaw->pitch;
-  uint32_t w = size.x;
-  uint32_t h = size.y;
-  uint32_t cpp = mRaw->getCpp();
-  uint64_t oy = offset.y;
+Array1DRef<const uint8_t>
+UncompressedDecompressor::getRowsInput(int row) const {
+  const Array1DRef<const uint8_t> in =
+      input.peekRemainingBuffer().getAsArray1DRef();
+  const int begin = (row - offset.y) * inputPitchBytes;
+  return in.getCrop(begin, in.size() - begin).getAsArray1DRef();
+}
+
+void UncompressedDecompressor::decodeRows(int row, int rowEnd) const {
+  invariant(row < rowEnd);
 
-  uint64_t y = oy;
-  h = implicit_cast<uint32_t>(min(h + oy, static_cast<uint64_t>(mRaw->dim.y)));
+  const int outPitch = mRaw->pitch;
+  const int w = size.x;
+  const int cpp = implicit_cast<int>(mRaw->getCpp());
+  const int numRows = rowEnd - row;
 
   if (mRaw->getDataType() == RawImageType::F32) {
     if (bitPerPixel == 32) {
       const Array2DRef<float> out(mRaw->getF32DataAsUncroppedArray2DRef());
-      copyPixels(
-          reinterpret_cast<std::byte*>(
-              &out(implicit_cast<int>(y), offset.x * cpp)),
-          outPitch,
-          reinterpret_cast<const std::byte*>(input.getData(
-              implicit_cast<Buffer::size_type>(inputPitchBytes * (h - y)))),
-          inputPitchBytes, w * mRaw->getBpp(), implicit_cast<int>(h - y));
+      copyPixels(reinterpret_cast<std::byte*>(&out(row, offset.x * cpp)),
+                 outPitch,
+                 reinterpret_cast<const std::byte*>(getRowsInput(row).begin()),
+                 inputPitchBytes, w * mRaw->getBpp(), numRows);
       return;
     }
     if (BitOrder::MSB == order && bitPerPixel == 16) {
-      decodePackedFP<BitStreamerMSB, ieee_754_2008::Binary16>(
-          h, implicit_cast<int>(y));
+      decodePackedFP<BitStreamerMSB, ieee_754_2008::Binary16>(rowEnd, row);
       return;
     }
     if (BitOrder::LSB == order && bitPerPixel == 16) {
-      decodePackedFP<BitStreamerLSB, ieee_754_2008::Binary16>(
-          h, implicit_cast<int>(y));
+      decodePackedFP<BitStreamerLSB, ieee_754_2008::Binary16>(rowEnd, row);
       return;
     }
     if (BitOrder::MSB == order && bitPerPixel == 24) {
-      decodePackedFP<BitStreamerMSB, ieee_754_2008::Binary24>(
-          h, implicit_cast<int>(y));
+      decodePackedFP<BitStreamerMSB, ieee_754_2008::Binary24>(rowEnd, row);
       return;
     }
     if (BitOrder::LSB == order && bitPerPixel == 24) {
-      decodePackedFP<BitStreamerLSB, ieee_754_2008::Binary24>(
-          h, implicit_cast<int>(y));
+      decodePackedFP<BitStreamerLSB, ieee_754_2008::Binary24>(rowEnd, row);
       return;
     }
     ThrowRDE("Unsupported floating-point input bitwidth/bit packing: %d / %u",
              bitPerPixel, static_cast<unsigned>(order));
   }
 
+  if (BitOrder::LSB == order && bitPerPixel == 16 &&
+      getHostEndianness() == Endianness::little) {
+    const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
+    copyPixels(reinterpret_cast<std::byte*>(&out(row, offset.x * cpp)),
+               outPitch,
+               reinterpret_cast<const std::byte*>(getRowsInput(row).begin()),
+               inputPitchBytes, w * mRaw->getBpp(), numRows);
+    return;
+  }
+
+  if (const UnpackKernel unpack =
+          getUnpackKernel(order, bitPerPixel, inputPitchBytes)) {
+    unpack(getRowsInput(row), inputPitchBytes,
+           mRaw->getU16DataAsUncroppedArray2DRef(), row, rowEnd, w * cpp);
+    return;
+  }
+
   if (BitOrder::MSB == order) {
-    decodePackedInt<BitStreamerMSB>(h, implicit_cast<int>(y));
+    decodePackedInt<BitStreamerMSB>(rowEnd, row);
   } else if (BitOrder::MSB16 == order) {
-    decodePackedInt<BitStreamerMSB16>(h, implicit_cast<int>(y));
+    decodePackedInt<BitStreamerMSB16>(rowEnd, row);
   } else if (BitOrder::MSB32 == order) {
-    decodePackedInt<BitStreamerMSB32>(h, implicit_cast<int>(y));
+    decodePackedInt<BitStreamerMSB32>(rowEnd, row);
   } else {
-    if (bitPerPixel == 16 && getHostEndianness() == Endianness::little) {
-      const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
-      copyPixels(
-          reinterpret_cast<std::byte*>(
-              &out(implicit_cast<int>(y), offset.x * cpp)),
-          outPitch,
-          reinterpret_cast<const std::byte*>(input.getData(
-              implicit_cast<Buffer::size_type>(inputPitchBytes * (h - y)))),
-          inputPitchBytes, w * mRaw->getBpp(), implicit_cast<int>(h - y));
-      return;
-    }
-    decodePackedInt<BitStreamerLSB>(h, implicit_cast<int>(y));
+    decodePackedInt<BitStreamerLSB>(rowEnd, row);
+  }
+}
+
+void UncompressedDecompressor::readUncompressedRaw() {
+  const int firstRow = offset.y;
+  const int endRow = min(offset.y + size.y, mRaw->dim.y);
+  if (firstRow >= endRow)
+    return;
+  const int numRows = endRow - firstRow;
+
+  // The input of each row is at a known offset, so the rows can be decoded
+  // in independent bands, concurrently. The bands are large enough for that
+  // to pay off, and can not split the words of the MSB16/MSB32 bit orders.
+  static constexpr int minBandBytes = 256 << 10;
+  int rowsPerBand = numRows;
+  if (inputPitchBytes % packedWordBytes(order) == 0) {
+    rowsPerBand =
+        std::min(std::max(1, minBandBytes / inputPitchBytes), numRows);
   }
+  const auto numBands =
+      implicit_cast<int>(roundUpDivisionSafe(numRows, rowsPerBand));
+
+  mRaw->executor->parallelFor(
+      numBands, [this, firstRow, endRow, rowsPerBand](int begin, int end) {
+        mRaw->checkCancelled();
+        decodeRows(firstRow + (begin * rowsPerBand),
+                   min(firstRow + (end * rowsPerBand), endRow));
+      });
 }
 
-template <bool uncorrectedRawValues>
 void UncompressedDecompressor::decode8BitRaw() {
   uint32_t w = size.x;
   uint32_t h = size.y;
@@ -276,23 +567,12 @@ void UncompressedDecompressor::decode8BitRaw() {
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
 
   const auto in = Array2DRef(input.getData(w * h), w, h);
-  uint32_t random = 0;
   for (uint32_t row = 0; row < h; row++) {
-    for (uint32_t col = 0; col < w; col++) {
-      if constexpr (uncorrectedRawValues)
-        out(row, col) = in(row, col);
-      else {
-        mRaw->setWithLookUp(in(row, col),
-                            reinterpret_cast<std::byte*>(&out(row, col)),
-                            &random);
-      }
-    }
+    for (uint32_t col = 0; col < w; col++)
+      out(row, col) = in(row, col);
   }
 }
 
-template void UncompressedDecompressor::decode8BitRaw<false>();
-template void UncompressedDecompressor::decode8BitRaw<true>();
-
 template <Endianness e>
 void UncompressedDecompressor::decode12BitRawWithControl() {
   uint32_t w = size.x;
@@ -316,10 +596,21 @@ void UncompressedDecompressor::decode12BitRawWithControl() {
 
   const Array2DRef<uint16_t> out(mRaw->getU16DataAsUncroppedArray2DRef());
 
+  const Unpack12BitWithControlKernel unpackBlocks =
+      getUnpack12BitWithControlKernel<e>();
+
   const auto in = Array2DRef(input.getData(perline * h), perline, h);
   for (uint32_t row = 0; row < h; row++) {
-    uint32_t col = 0;
-    for (uint32_t x = 0; x < w; x += 2) {
+    uint32_t x = 0;
+    if (unpackBlocks) {
+      x = static_cast<uint32_t>(unpackBlocks(
+          in[implicit_cast<int>(row)],
+          out[implicit_cast<int>(row)].getCrop(0, implicit_cast<int>(w))
+              .getAsArray1DRef()));
+    }
+    // The blocks are 10 pixels, 16 bytes.
+    uint32_t col = (x / 10) * 16;
+    for (; x < w; x += 2) {
       uint32_t g1 = in(row, col + 0);
       uint32_t g2 = in(row, col + 1);
 
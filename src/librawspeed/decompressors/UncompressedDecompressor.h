@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "adt/Array1DRef.h"
 #include "adt/Point.h"
 #include "bitstreams/BitStreams.h"
 #include "common/RawImage.h"
@@ -55,11 +56,17 @@ class UncompressedDecompressor final : public AbstractDecompressor {
   // for special packed formats
   static int bytesPerLine(int w, bool skips);
 
+  // The input of the given row, and of all the rows after it.
+  [[nodiscard]] Array1DRef<const uint8_t> getRowsInput(int row) const;
+
   template <typename Pump, typename NarrowFpType>
   void decodePackedFP(int rows, int row) const;
 
   template <typename Pump> void decodePackedInt(int rows, int row) const;
 
+  // Decodes the rows [row, rowEnd).
+  void decodeRows(int row, int rowEnd) const;
+
 public:
   UncompressedDecompressor(ByteStream input, RawImage img,
                            const iRectangle2D& crop, int inputPitchBytes,
@@ -75,7 +82,7 @@ public:
   void readUncompressedRaw();
 
   /* Faster versions for unpacking 8 bit data */
-  template <bool uncorrectedRawValues> void decode8BitRaw();
+  void decode8BitRaw();
 
   /* Faster version for unpacking 12 bit data with control byte every 10 pixels
    */
@@ -86,9 +93,6 @@ public:
   template <Endianness e> void decode12BitRawUnpackedLeftAligned();
 };
 
-extern template void UncompressedDecompressor::decode8BitRaw<false>();
-extern template void UncompressedDecompressor::decode8BitRaw<true>();
-
 extern template void
 UncompressedDecompressor::decode12BitRawWithControl<Endianness::little>();
 extern template void
@@ -822,6 +822,14 @@ void VC5Decompressor::createWaveletBandDecodingTasks(
         waveletLevel == 0 ? 1 : Wavelet::maxBands;
     for (int bandId = numBandsInCurrentWavelet - 1; bandId >= 0; --bandId) {
       for (const auto& channel : channels) {
+        if (mRaw->isCancelled()) {
+          // Stop creating tasks, and make the already-created ones bail out.
+#ifdef HAVE_OPENMP
+#pragma omp atomic write
+#endif
+          exceptionThrown = true;
+          return;
+        }
         channel.wavelets[waveletLevel].bands[bandId]->createDecodingTasks(
             static_cast<ErrorLog&>(*mRaw), exceptionThrown);
         if (readValue(exceptionThrown)) {
@@ -858,10 +866,12 @@ void VC5Decompressor::decode(unsigned int offsetX, unsigned int offsetY,
 
 #ifdef HAVE_OPENMP
 #pragma omp parallel default(none) shared(exceptionThrown)                     \
-    num_threads(rawspeed_get_number_of_processor_cores())
+    num_threads(mRaw->executor->getNumOpenMPThreads())
 #endif
   decodeThread(exceptionThrown);
 
+  mRaw->checkCancelled();
+
   std::string firstErr;
   if (mRaw->isTooManyErrors(1, &firstErr)) {
     assert(exceptionThrown);
@@ -392,16 +392,13 @@ template <int version> void Cr2sRawInterpolator::interpolate_420() {
     }
   };
 
-  int row = 0;
-#ifdef HAVE_OPENMP
-#pragma omp parallel for default(none) schedule(static)                        \
-    num_threads(rawspeed_get_number_of_processor_cores()) firstprivate(out)    \
-    lastprivate(row)
-#endif
-  for (row = 0; row < input.height() - 1; ++row)
-    interpolate_420_row<version>(row);
-
-  invariant(row + 1 == input.height());
+  mRaw->executor->parallelFor(input.height() - 1,
+                              [this](int beginRow, int endRow) {
+                                for (int row = beginRow; row < endRow; ++row)
+                                  interpolate_420_row<version>(row);
+                              });
+
+  const int row = input.height() - 1;
 
   // Last two lines, the packed input format is:
   //          p0 p1 p2 p3 p0 p0     p4 p5 p6 p7 p4 p4
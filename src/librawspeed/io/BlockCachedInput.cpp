@@ -0,0 +1,155 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "io/BlockCachedInput.h"
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "adt/Invariant.h"
+#include "common/Common.h"
+#include "io/Buffer.h"
+#include "io/IOException.h"
+#include "io/InputSource.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#else
+#ifndef NOMINMAX
+#define NOMINMAX // do not want the min()/max() macros!
+#endif
+
+#include <Windows.h>
+#endif
+
+namespace rawspeed {
+
+BlockCachedInput::BlockCachedInput(InputSource* source_) : source(source_) {
+  invariant(source);
+
+  size = source->getSize();
+  if (size == 0)
+    ThrowIOE("File is 0 bytes.");
+  if (size > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+    ThrowIOE("File is too big (%u bytes).", size);
+
+  // Anonymous pages read as zeros, and are only backed by memory once they
+  // are written to, so this merely reserves the address space.
+  mappedSize = size_t(size) + Buffer::TailPadding;
+#if defined(__unix__) || defined(__APPLE__)
+  void* addr = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (addr == MAP_FAILED)
+    ThrowIOE("Could not reserve %zu bytes.", mappedSize);
+#else
+  void* addr = VirtualAlloc(nullptr, mappedSize, MEM_RESERVE | MEM_COMMIT,
+                            PAGE_READWRITE);
+  if (addr == nullptr)
+    ThrowIOE("Could not reserve %zu bytes.", mappedSize);
+#endif
+  storage = static_cast<uint8_t*>(addr);
+
+  fetchedBlocks.resize(roundUpDivisionSafe(size, BlockSize), false);
+}
+
+BlockCachedInput::~BlockCachedInput() {
+#if defined(__unix__) || defined(__APPLE__)
+  munmap(storage, mappedSize);
+#else
+  VirtualFree(storage, 0, MEM_RELEASE);
+#endif
+}
+
+Buffer BlockCachedInput::getBuffer() const {
+  if (numFetchedBlocks != implicit_cast<int>(fetchedBlocks.size()))
+    ThrowIOE("Only %i of %zu blocks were fetched.", numFetchedBlocks,
+             fetchedBlocks.size());
+  return getSparseBuffer();
+}
+
+Buffer BlockCachedInput::getSparseBuffer() const {
+  return Buffer(Array1DRef<const uint8_t>(storage, implicit_cast<int>(size)),
+                Buffer::TailPadding);
+}
+
+void BlockCachedInput::fetchBlocks(int firstBlock, int numBlocks) {
+  invariant(firstBlock >= 0);
+  invariant(numBlocks > 0);
+
+  const auto begin = implicit_cast<Buffer::size_type>(firstBlock) * BlockSize;
+  const auto end =
+      std::min(implicit_cast<Buffer::size_type>(firstBlock + numBlocks) *
+                   BlockSize,
+               getSize());
+  invariant(begin < end);
+
+  source->read(begin, Array1DRef(storage, implicit_cast<int>(getSize()))
+                          .getCrop(implicit_cast<int>(begin),
+                                   implicit_cast<int>(end - begin))
+                          .getAsArray1DRef());
+
+  for (int block = firstBlock; block != firstBlock + numBlocks; ++block)
+    fetchedBlocks[block] = true;
+  numFetchedBlocks += numBlocks;
+}
+
+Buffer BlockCachedInput::fetch(Buffer::size_type offset,
+                               Buffer::size_type size_) {
+  const Buffer res = getSparseBuffer().getSubView(offset, size_);
+  if (size_ == 0)
+    return res;
+
+  const auto firstBlock = implicit_cast<int>(offset / BlockSize);
+  const auto lastBlock = implicit_cast<int>((offset + size_ - 1) / BlockSize);
+
+  // Coalesce the runs of the missing blocks, to issue as few reads as possible.
+  for (int block = firstBlock; block <= lastBlock;) {
+    if (fetchedBlocks[block]) {
+      ++block;
+      continue;
+    }
+    const int runBegin = block;
+    while (block <= lastBlock && !fetchedBlocks[block])
+      ++block;
+    fetchBlocks(runBegin, block - runBegin);
+  }
+
+  return res;
+}
+
+bool BlockCachedInput::isFetched(Buffer::size_type offset,
+                                 Buffer::size_type size_) const {
+  if (!getSparseBuffer().isValid(offset, size_))
+    return false;
+  if (size_ == 0)
+    return true;
+
+  const auto firstBlock = implicit_cast<int>(offset / BlockSize);
+  const auto lastBlock = implicit_cast<int>((offset + size_ - 1) / BlockSize);
+  for (int block = firstBlock; block <= lastBlock; ++block) {
+    if (!fetchedBlocks[block])
+      return false;
+  }
+  return true;
+}
+
+} // namespace rawspeed
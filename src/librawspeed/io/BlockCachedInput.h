@@ -0,0 +1,87 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "io/Buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rawspeed {
+
+class InputSource;
+
+// A file-sized view of an InputSource that is only populated on demand,
+// in BlockSize-granular blocks. Each block is read from the source at most
+// once.
+//
+// Only the address space for the whole file is reserved up-front, the memory
+// is committed by the OS one page at a time, as the blocks get fetched.
+// The storage is followed by Buffer::TailPadding bytes of (zero) tail padding.
+class BlockCachedInput final {
+public:
+  static constexpr Buffer::size_type BlockSize = 64 * 1024;
+
+private:
+  InputSource* source;
+
+  uint8_t* storage = nullptr;
+  Buffer::size_type size = 0;
+  size_t mappedSize = 0; // Including the tail padding.
+
+  std::vector<bool> fetchedBlocks;
+  int numFetchedBlocks = 0;
+
+  void fetchBlocks(int firstBlock, int numBlocks);
+
+public:
+  explicit BlockCachedInput(InputSource* source);
+
+  BlockCachedInput(const BlockCachedInput&) = delete;
+  BlockCachedInput(BlockCachedInput&&) noexcept = delete;
+  BlockCachedInput& operator=(const BlockCachedInput&) = delete;
+  BlockCachedInput& operator=(BlockCachedInput&&) noexcept = delete;
+
+  ~BlockCachedInput();
+
+  [[nodiscard]] Buffer::size_type getSize() const { return size; }
+
+  // The whole file. Throws IOException unless all of it was fetch()'ed.
+  [[nodiscard]] Buffer getBuffer() const;
+
+  // The whole file, in which the bytes that were not fetched yet read as
+  // zeros (without committing any memory). This is what allows the parsers
+  // to find out what to fetch() on a partially-fetched file, but everything
+  // that is going to be actually used must be fetch()'ed first.
+  [[nodiscard]] Buffer getSparseBuffer() const;
+
+  // Makes the given range resident, and returns it.
+  Buffer fetch(Buffer::size_type offset, Buffer::size_type size);
+
+  void fetchAll() { (void)fetch(0, getSize()); }
+
+  [[nodiscard]] bool isFetched(Buffer::size_type offset,
+                               Buffer::size_type size) const;
+
+  [[nodiscard]] int getNumFetchedBlocks() const { return numFetchedBlocks; }
+};
+
+} // namespace rawspeed
@@ -26,6 +26,7 @@
 #include "adt/Casts.h"
 #include "io/Endianness.h"
 #include "io/IOException.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <utility>
@@ -43,16 +44,25 @@ namespace rawspeed {
  * of a raw file. The underlying memory is never owned by the buffer.
  * It intentionally supports only read/const access to the underlying memory.
  *
+ * The memory may be followed by some tail padding: bytes that are not a part
+ * of the buffer, and have unspecified contents, but that can be safely read,
+ * so that e.g. the bit streams can do full-width loads up to the very end.
+ *
  *************************************************************************/
 class Buffer {
 public:
   using size_type = uint32_t;
 
+  // The tail padding that the file readers, and the internal scratch buffers
+  // that are read with the bit streams, provide.
+  static constexpr size_type TailPadding = 32;
+
 protected:
   const uint8_t* data = nullptr;
 
 private:
   size_type size = 0;
+  size_type tailPadding = 0;
 
 public:
   Buffer() = default;
@@ -67,6 +77,13 @@ public:
   explicit Buffer(const uint8_t* data_, size_type size_)
       : Buffer(Array1DRef(data_, implicit_cast<int>(size_))) {}
 
+  // The memory must be followed by at least tailPadding_ readable bytes.
+  explicit Buffer(Array1DRef<const uint8_t> data_, size_type tailPadding_)
+      : Buffer(data_) {
+    tailPadding = tailPadding_;
+    assert(!ASan::RegionIsPoisoned(data, size + tailPadding));
+  }
+
   [[nodiscard]] Array1DRef<const uint8_t> getAsArray1DRef() const {
     return {data, implicit_cast<int>(size)};
   }
@@ -79,7 +96,12 @@ public:
     if (!isValid(offset, size_))
       ThrowIOE("Buffer overflow: image file may be truncated");
 
-    return getAsArray1DRef().getCrop(offset, size_).getAsArray1DRef();
+    // The rest of this buffer, and its own padding, pads the sub-view.
+    const uint64_t subViewTailPadding =
+        static_cast<uint64_t>(getSize() - (offset + size_)) + tailPadding;
+    return Buffer(getAsArray1DRef().getCrop(offset, size_).getAsArray1DRef(),
+                  implicit_cast<size_type>(
+                      std::min<uint64_t>(subViewTailPadding, TailPadding)));
   }
 
   [[nodiscard]] Buffer getSubView(size_type offset) const {
@@ -114,6 +136,11 @@ public:
 
   [[nodiscard]] size_type RAWSPEED_READONLY getSize() const { return size; }
 
+  // How many bytes past the end of the buffer can be read.
+  [[nodiscard]] size_type RAWSPEED_READONLY getTailPadding() const {
+    return tailPadding;
+  }
+
   [[nodiscard]] bool isValid(size_type offset, size_type count = 1) const {
     return static_cast<uint64_t>(offset) + count <=
            static_cast<uint64_t>(getSize());
@@ -21,10 +21,13 @@
 
 #include "io/FileReader.h"
 #include "adt/AlignedAllocator.h"
+#include "adt/Array1DRef.h"
 #include "adt/Casts.h"
 #include "adt/DefaultInitAllocatorAdaptor.h"
 #include "io/Buffer.h"
 #include "io/FileIOException.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <limits>
@@ -32,7 +35,12 @@
 #include <utility>
 #include <vector>
 
-#if !(defined(__unix__) || defined(__APPLE__))
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
 #ifndef NOMINMAX
 #define NOMINMAX // do not want the min()/max() macros!
 #endif
@@ -45,6 +53,130 @@
 
 namespace rawspeed {
 
+FileMapping::~FileMapping() {
+#if defined(__unix__) || defined(__APPLE__)
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  munmap(const_cast<uint8_t*>(data), mappedSize);
+#else
+  UnmapViewOfFile(data);
+#endif
+}
+
+std::pair<std::unique_ptr<FileMapping>, Buffer> FileReader::mapFile() const {
+  size_t fileSize = 0;
+  std::unique_ptr<FileMapping> mapping;
+
+#if defined(__unix__) || defined(__APPLE__)
+  struct FileDescriptor final {
+    int fd;
+
+    explicit FileDescriptor(int fd_) : fd(fd_) {}
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor(FileDescriptor&&) noexcept = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(FileDescriptor&&) noexcept = delete;
+    ~FileDescriptor() {
+      if (fd >= 0)
+        close(fd);
+    }
+  };
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+  const FileDescriptor file(open(fileName, O_RDONLY | O_CLOEXEC));
+
+  if (file.fd < 0)
+    ThrowFIE("Could not open file \"%s\".", fileName);
+
+  struct stat st;
+  if (fstat(file.fd, &st) != 0)
+    ThrowFIE("Could not stat file \"%s\".", fileName);
+
+  if (!S_ISREG(st.st_mode))
+    ThrowFIE("File \"%s\" is not a regular file.", fileName);
+
+  if (st.st_size <= 0)
+    ThrowFIE("File is 0 bytes.");
+
+  if (static_cast<int64_t>(st.st_size) >
+      std::numeric_limits<Buffer::size_type>::max())
+    ThrowFIE("File is too big (%lld bytes).",
+             static_cast<long long>(st.st_size)); // NOLINT(google-runtime-int)
+
+  fileSize = st.st_size;
+
+  // Reserve the address space for the file and its tail padding, and map the
+  // file over the beginning of it. Past the end of the file, the rest of its
+  // last page, and then the anonymous pages of the reservation, read as zeros.
+  const size_t mappedSize = fileSize + Buffer::TailPadding;
+  void* reservation = mmap(nullptr, mappedSize, PROT_READ,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reservation == MAP_FAILED)
+    ThrowFIE("Could not map file \"%s\".", fileName);
+
+  // The mapping holds its own reference to the file, the descriptor is closed
+  // on return.
+  void* addr = mmap(reservation, fileSize, PROT_READ, MAP_PRIVATE | MAP_FIXED,
+                    file.fd, 0);
+  if (addr == MAP_FAILED) {
+    munmap(reservation, mappedSize);
+    ThrowFIE("Could not map file \"%s\".", fileName);
+  }
+
+  mapping = std::make_unique<FileMapping>(static_cast<const uint8_t*>(addr),
+                                          fileSize, mappedSize);
+  constexpr Buffer::size_type tailPadding = Buffer::TailPadding;
+
+  // Every decoder ends up touching the bulk of the file, so ask the kernel to
+  // start the read-ahead right away. This is only a hint, failure is harmless.
+  (void)posix_madvise(addr, fileSize, POSIX_MADV_WILLNEED);
+
+#else // __unix__
+
+  auto wFileName = widenFileName(fileName);
+
+  using file_ptr = std::unique_ptr<std::remove_pointer<HANDLE>::type,
+                                   decltype(&CloseHandle)>;
+  file_ptr file(CreateFileW(wFileName.data(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr),
+                &CloseHandle);
+
+  if (file.get() == INVALID_HANDLE_VALUE)
+    ThrowFIE("Could not open file \"%s\".", fileName);
+
+  LARGE_INTEGER size;
+  GetFileSizeEx(file.get(), &size);
+
+  if (size.HighPart > 0)
+    ThrowFIE("File is too big.");
+  if (size.LowPart <= 0)
+    ThrowFIE("File is 0 bytes.");
+
+  fileSize = size.LowPart;
+
+  file_ptr fileMapping(CreateFileMappingW(file.get(), nullptr, PAGE_READONLY,
+                                          0, 0, nullptr),
+                       &CloseHandle);
+  if (fileMapping.get() == nullptr)
+    ThrowFIE("Could not map file \"%s\".", fileName);
+
+  // The view holds its own reference to the mapping object.
+  const void* addr =
+      MapViewOfFile(fileMapping.get(), FILE_MAP_READ, 0, 0, fileSize);
+  if (addr == nullptr)
+    ThrowFIE("Could not map file \"%s\".", fileName);
+
+  // The view can not be padded.
+  mapping = std::make_unique<FileMapping>(static_cast<const uint8_t*>(addr),
+                                          fileSize, fileSize);
+  constexpr Buffer::size_type tailPadding = 0;
+
+#endif // __unix__
+
+  Buffer buf(Array1DRef(mapping->begin(), implicit_cast<int>(fileSize)),
+             tailPadding);
+  return {std::move(mapping), buf};
+}
+
 std::pair<std::unique_ptr<std::vector<
               uint8_t, DefaultInitAllocatorAdaptor<
                            uint8_t, AlignedAllocator<uint8_t, 16>>>>,
@@ -77,7 +209,7 @@ FileReader::readFile() const {
   auto dest = std::make_unique<std::vector<
       uint8_t,
       DefaultInitAllocatorAdaptor<uint8_t, AlignedAllocator<uint8_t, 16>>>>(
-      fileSize);
+      fileSize + Buffer::TailPadding);
 
   if (auto bytes_read = fread(dest->data(), 1, fileSize, file.get());
       fileSize != bytes_read) {
@@ -117,7 +249,7 @@ FileReader::readFile() const {
   auto dest = std::make_unique<std::vector<
       uint8_t,
       DefaultInitAllocatorAdaptor<uint8_t, AlignedAllocator<uint8_t, 16>>>>(
-      size.LowPart);
+      size_t(size.LowPart) + Buffer::TailPadding);
 
   DWORD bytes_read;
   if (!ReadFile(file.get(), dest->data(), size.LowPart, &bytes_read, nullptr))
@@ -130,8 +262,11 @@ FileReader::readFile() const {
 
 #endif // __unix__
 
+  std::fill(dest->begin() + fileSize, dest->end(), uint8_t(0));
   return {std::move(dest),
-          Buffer(dest->data(), implicit_cast<Buffer::size_type>(fileSize))};
+          Buffer(Array1DRef<const uint8_t>(dest->data(),
+                                           implicit_cast<int>(fileSize)),
+                 Buffer::TailPadding)};
 }
 
 } // namespace rawspeed
@@ -23,6 +23,7 @@
 #include "adt/AlignedAllocator.h"
 #include "adt/DefaultInitAllocatorAdaptor.h"
 #include "io/Buffer.h"
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <utility>
@@ -33,12 +34,41 @@ namespace rawspeed {
 class Buffer;
 template <class T, int alignment> class AlignedAllocator;
 
+// Owning handle of a read-only memory mapping of the whole file.
+// The mapping is released when the handle is destroyed, so it must outlive
+// every Buffer that references it.
+class FileMapping final {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  size_t mappedSize = 0; // Including the tail padding, if any.
+
+public:
+  FileMapping(const uint8_t* data_, size_t size_, size_t mappedSize_)
+      : data(data_), size(size_), mappedSize(mappedSize_) {}
+
+  FileMapping(const FileMapping&) = delete;
+  FileMapping(FileMapping&&) noexcept = delete;
+  FileMapping& operator=(const FileMapping&) = delete;
+  FileMapping& operator=(FileMapping&&) noexcept = delete;
+
+  ~FileMapping();
+
+  [[nodiscard]] const uint8_t* begin() const { return data; }
+  [[nodiscard]] size_t getSize() const { return size; }
+};
+
 class FileReader final {
   const char* fileName;
 
 public:
   explicit FileReader(const char* fileName_) : fileName(fileName_) {}
 
+  // Zero-copy alternative to readFile(): the file is mapped read-only, and the
+  // decoders read straight from the page cache.
+  // Where supported, like readFile(), it provides Buffer::TailPadding bytes
+  // of tail padding.
+  [[nodiscard]] std::pair<std::unique_ptr<FileMapping>, Buffer> mapFile() const;
+
   [[nodiscard]] std::pair<
       std::unique_ptr<std::vector<
           uint8_t,
@@ -0,0 +1,71 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Array1DRef.h"
+#include "io/Buffer.h"
+#include <functional>
+#include <utility>
+
+namespace rawspeed {
+
+// A source of the raw file bytes that is accessed by ranges, e.g. a file on a
+// network volume or in an object storage, as opposed to a Buffer that has to
+// hold the whole file in memory up-front.
+class InputSource {
+public:
+  InputSource() = default;
+  InputSource(const InputSource&) = delete;
+  InputSource(InputSource&&) noexcept = delete;
+  InputSource& operator=(const InputSource&) = delete;
+  InputSource& operator=(InputSource&&) noexcept = delete;
+  virtual ~InputSource() = default;
+
+  // Total size of the file, in bytes.
+  [[nodiscard]] virtual Buffer::size_type getSize() const = 0;
+
+  // Must fill the whole `out` with the file bytes starting at `offset`,
+  // or throw. The range is always within [0, getSize()).
+  virtual void read(Buffer::size_type offset, Array1DRef<uint8_t> out) = 0;
+};
+
+// Adapts a plain read callback into an InputSource.
+class CallbackInputSource final : public InputSource {
+public:
+  using Callback =
+      std::function<void(Buffer::size_type offset, Array1DRef<uint8_t> out)>;
+
+private:
+  Buffer::size_type size;
+  Callback callback;
+
+public:
+  CallbackInputSource(Buffer::size_type size_, Callback callback_)
+      : size(size_), callback(std::move(callback_)) {}
+
+  [[nodiscard]] Buffer::size_type getSize() const override { return size; }
+
+  void read(Buffer::size_type offset, Array1DRef<uint8_t> out) override {
+    callback(offset, out);
+  }
+};
+
+} // namespace rawspeed
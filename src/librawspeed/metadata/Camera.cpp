@@ -304,7 +304,11 @@ void Camera::parseHints(const xml_node& cur) {
 
     std::string value = c.attribute("value").as_string();
 
-    hints.add(name, value);
+    try {
+      hints.add(name, value);
+    } catch (const CameraMetadataException& e) {
+      ThrowCME("%s %s: %s", make.c_str(), model.c_str(), e.what());
+    }
   }
 }
 
@@ -26,10 +26,8 @@
 #include "metadata/BlackArea.h"
 #include "metadata/CameraSensorInfo.h"
 #include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
 #include <cstdint>
-#include <functional>
-#include <map>
-#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -44,36 +42,6 @@ class xml_node;
 
 namespace rawspeed {
 
-class Hints final {
-  std::map<std::string, std::string, std::less<>> data;
-
-public:
-  void add(const std::string& key, const std::string& value) {
-    data.try_emplace(key, value);
-  }
-
-  [[nodiscard]] bool contains(const std::string& key) const {
-    return data.contains(key);
-  }
-
-  template <typename T>
-  [[nodiscard]] T get(const std::string& key, T defaultValue) const {
-    if (auto hint = data.find(key);
-        hint != data.end() && !hint->second.empty()) {
-      std::istringstream iss(hint->second);
-      iss >> defaultValue;
-    }
-    return defaultValue;
-  }
-
-  [[nodiscard]] bool get(const std::string& key, bool defaultValue) const {
-    auto hint = data.find(key);
-    if (hint == data.end())
-      return defaultValue;
-    return "true" == hint->second;
-  }
-};
-
 class Camera final {
 public:
   enum class SupportStatus : uint8_t {
@@ -85,6 +53,8 @@ public:
     Unsupported,      // Claimed as unsupported (explicitly).
   };
 
+  Camera() = default;
+
 #ifdef HAVE_PUGIXML
   explicit Camera(const pugi::xml_node& camera);
 #endif
@@ -101,12 +71,12 @@ public:
   std::vector<std::string> aliases;
   std::vector<std::string> canonical_aliases;
   ColorFilterArray cfa;
-  SupportStatus supportStatus;
+  SupportStatus supportStatus = SupportStatus::Supported;
   iPoint2D cropSize;
   iPoint2D cropPos;
   std::vector<BlackArea> blackAreas;
   std::vector<CameraSensorInfo> sensorInfo;
-  int decoderVersion;
+  int decoderVersion = 0;
   Hints hints;
   std::vector<NotARational<int>> color_matrix;
   /*
@@ -0,0 +1,131 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "metadata/CameraIndex.h"
+#include "adt/Invariant.h"
+#include "adt/Optional.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace rawspeed {
+
+// FNV-1a. The mode does not participate, so that all the modes of a camera
+// (and thus its "ANY mode" entry) are found within the same probe sequence.
+uint64_t CameraIndex::hash(std::string_view make, std::string_view model) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (std::string_view str : {make, model}) {
+    for (char c : str) {
+      h ^= static_cast<uint8_t>(c);
+      h *= 0x100000001b3ULL;
+    }
+    // Keep ("ab", "c") and ("a", "bc") apart.
+    h ^= 0xFF;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+template <typename Table>
+auto* CameraIndex::probe(Table* table, const Slot& key, bool compareMode) {
+  invariant(std::has_single_bit(table->size()));
+  const size_t mask = table->size() - 1;
+  for (size_t i = key.hash & mask;; i = (i + 1) & mask) {
+    auto& slot = (*table)[i];
+    if (slot.value == Empty)
+      return &slot;
+    if (slot.hash == key.hash &&
+        std::tie(slot.make, slot.model) == std::tie(key.make, key.model) &&
+        (!compareMode || slot.mode == key.mode))
+      return &slot;
+  }
+}
+
+void CameraIndex::rehash(std::vector<Slot>* table, size_t numEntries) {
+  // Keep the load factor at or below 1/2, so the probe sequences stay short.
+  const size_t capacity = std::bit_ceil(std::max<size_t>(16, 2 * numEntries));
+  if (capacity <= table->size())
+    return;
+
+  const std::vector<Slot> old =
+      std::exchange(*table, std::vector<Slot>(capacity));
+  for (const Slot& slot : old) {
+    if (slot.value != Empty)
+      *probe(table, slot, /*compareMode=*/true) = slot;
+  }
+}
+
+void CameraIndex::reserve(size_t count) {
+  rehash(&slots, count);
+  rehash(&anyModeSlots, count);
+}
+
+bool CameraIndex::insert(std::string_view make, std::string_view model,
+                         std::string_view mode, uint32_t value) {
+  invariant(value != Empty);
+  const Slot key{hash(make, model), make, model, mode, value};
+
+  rehash(&slots, numEntries + 1);
+  Slot* slot = probe(&slots, key, /*compareMode=*/true);
+  if (slot->value != Empty)
+    return false;
+  *slot = key;
+  ++numEntries;
+
+  rehash(&anyModeSlots, numAnyModeEntries + 1);
+  slot = probe(&anyModeSlots, key, /*compareMode=*/false);
+  if (slot->value == Empty) {
+    *slot = key;
+    ++numAnyModeEntries;
+  } else if (mode < slot->mode) {
+    *slot = key;
+  }
+  return true;
+}
+
+Optional<uint32_t> CameraIndex::find(std::string_view make,
+                                     std::string_view model,
+                                     std::string_view mode) const {
+  if (slots.empty())
+    return std::nullopt;
+  const Slot key{hash(make, model), make, model, mode, Empty};
+  if (const Slot* slot = probe(&slots, key, /*compareMode=*/true);
+      slot->value != Empty)
+    return slot->value;
+  return std::nullopt;
+}
+
+Optional<uint32_t> CameraIndex::find(std::string_view make,
+                                     std::string_view model) const {
+  if (anyModeSlots.empty())
+    return std::nullopt;
+  const Slot key{hash(make, model), make, model, {}, Empty};
+  if (const Slot* slot = probe(&anyModeSlots, key, /*compareMode=*/false);
+      slot->value != Empty)
+    return slot->value;
+  return std::nullopt;
+}
+
+} // namespace rawspeed
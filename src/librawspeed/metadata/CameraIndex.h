@@ -0,0 +1,78 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Optional.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace rawspeed {
+
+// A flat open-addressing (linear probing) hash table, mapping the already
+// normalized (make, model, mode) of a camera onto some caller-defined index.
+// It also maps (make, model) onto the camera with the lexicographically
+// smallest mode, consistently with the ordering of `CameraId`.
+//
+// NOTE: does not own the strings, they must outlive the index.
+class CameraIndex final {
+  struct Slot final {
+    uint64_t hash = 0;
+    std::string_view make;
+    std::string_view model;
+    std::string_view mode;
+    uint32_t value = Empty;
+  };
+
+  static constexpr uint32_t Empty = ~0U;
+
+  std::vector<Slot> slots;
+  std::vector<Slot> anyModeSlots;
+  size_t numEntries = 0;
+  size_t numAnyModeEntries = 0;
+
+  static uint64_t hash(std::string_view make, std::string_view model);
+
+  // Either the slot with the given key, or the empty slot to put it into.
+  template <typename Table>
+  static auto* probe(Table* table, const Slot& key, bool compareMode);
+  static void rehash(std::vector<Slot>* table, size_t numEntries);
+
+public:
+  [[nodiscard]] size_t size() const { return numEntries; }
+
+  void reserve(size_t count);
+
+  // Returns false if there already was an entry with this key, in which case
+  // the old entry is kept.
+  bool insert(std::string_view make, std::string_view model,
+              std::string_view mode, uint32_t value);
+
+  [[nodiscard]] Optional<uint32_t> find(std::string_view make,
+                                        std::string_view model,
+                                        std::string_view mode) const;
+
+  [[nodiscard]] Optional<uint32_t> find(std::string_view make,
+                                        std::string_view model) const;
+};
+
+} // namespace rawspeed
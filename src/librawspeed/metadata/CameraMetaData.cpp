@@ -20,8 +20,17 @@
 
 #include "rawspeedconfig.h"
 #include "metadata/CameraMetaData.h"
+#include "adt/Casts.h"
+#include "adt/Mutex.h"
 #include "common/Common.h"
+#include "io/Buffer.h"
+#include "io/FileIOException.h"
+#include "io/FileReader.h"
 #include "metadata/Camera.h"
+#include "metadata/CameraIndex.h"
+#include "metadata/CameraMetadataException.h"
+#include "metadata/CompiledCameraMetaData.h"
+#include "metadata/Hints.h"
 #include <algorithm>
 #include <cstdint>
 #include <map>
@@ -30,11 +39,10 @@
 #include <string_view>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #ifdef HAVE_PUGIXML
-#include "metadata/CameraMetadataException.h"
 #include <pugixml.hpp>
-#include <vector>
 
 using pugi::xml_document;
 using pugi::xml_node;
@@ -43,8 +51,37 @@ using pugi::xml_parse_result;
 
 namespace rawspeed {
 
-#ifdef HAVE_PUGIXML
+CameraMetaData::CameraMetaData() = default;
+
+CameraMetaData::~CameraMetaData() = default;
+
 CameraMetaData::CameraMetaData(const char* docname) {
+  std::unique_ptr<FileMapping> mapping;
+  Buffer blob;
+  try {
+    std::tie(mapping, blob) = FileReader(docname).mapFile();
+  } catch (const FileIOException& e) {
+    ThrowCME("Camera database \"%s\" could not be read: %s", docname,
+             e.what());
+  }
+
+  if (CompiledCameraMetaData::isCompiled(blob)) {
+    compiled = std::make_unique<CompiledCameraMetaData>(blob);
+    compiledMapping = std::move(mapping);
+
+    // The keys are views into the mapping, so this does not allocate much.
+    // NOTE: the records are in the order of the entries.
+    index.reserve(compiled->size());
+    records.reserve(compiled->size());
+    for (uint32_t entry = 0; entry != compiled->size(); ++entry) {
+      const auto key = compiled->getKey(entry);
+      (void)index.insert(key.make, key.model, key.mode, entry);
+      records.emplace_back(CameraRecord{nullptr, entry});
+    }
+    return;
+  }
+
+#ifdef HAVE_PUGIXML
   xml_document doc;
 
   if (xml_parse_result result =
@@ -62,100 +99,139 @@ CameraMetaData::CameraMetaData(const char* docname) {
   }
 
   for (xml_node camera : doc.child("Cameras").children("Camera")) {
-    const auto* cam = addCamera(std::make_unique<Camera>(camera));
-
-    if (cam == nullptr)
-      continue;
-
-    // Create cameras for aliases.
-    for (auto i = 0UL; i < cam->aliases.size(); i++) {
-      addCamera(std::make_unique<Camera>(cam, i));
-    }
+    (void)addCamera(std::make_unique<Camera>(camera));
   }
-}
+#else
+  ThrowCME("\"%s\" is not a compiled camera database, and XML support is "
+           "disabled",
+           docname);
 #endif
-
-namespace {
-
-inline CameraId getId(const std::string& make, const std::string& model,
-                      const std::string& mode) {
-  CameraId id;
-  id.make = trimSpaces(make);
-  id.model = trimSpaces(model);
-  id.mode = trimSpaces(mode);
-
-  return id;
 }
 
-} // namespace
-
-const Camera* CameraMetaData::getCamera(const std::string& make,
-                                        const std::string& model,
-                                        const std::string& mode) const {
-  auto camera = cameras.find(getId(make, model, mode));
-  return camera == cameras.end() ? nullptr : camera->second.get();
+const Camera* CameraMetaData::resolve(uint32_t record) const {
+  const CameraRecord& r = records[record];
+  if (r.camera && r.alias == CameraRecord::NoAlias)
+    return r.camera;
+
+  MutexLocker guard(&mutex);
+
+  auto& cam = resolvedCameras[record];
+  if (cam)
+    return cam.get();
+
+  if (r.camera)
+    cam = std::make_unique<Camera>(r.camera, r.alias);
+  else
+    cam = compiled->getCamera(r.compiledEntry);
+  if (std::find(disabledMakes.begin(), disabledMakes.end(), cam->make) !=
+          disabledMakes.end() ||
+      std::find(disabledCameras.begin(), disabledCameras.end(),
+                std::pair(cam->make, cam->model)) != disabledCameras.end())
+    cam->supportStatus = Camera::SupportStatus::Unsupported;
+  return cam.get();
 }
 
-const Camera* CameraMetaData::getCamera(const std::string& make,
-                                        const std::string& model) const {
-  auto id = getId(make, model, "");
+const Camera* CameraMetaData::getCamera(std::string_view make,
+                                        std::string_view model,
+                                        std::string_view mode) const {
+  make = trimSpacesView(make);
+  model = trimSpacesView(model);
+  mode = trimSpacesView(mode);
 
-  auto iter = find_if(
-      cameras.cbegin(), cameras.cend(), [&id](decltype(*cameras.cbegin())& i) {
-        const auto& cid = i.first;
-        return tie(id.make, id.model) == tie(cid.make, cid.model);
-      });
+  auto record = index.find(make, model, mode);
+  return record ? resolve(*record) : nullptr;
+}
 
-  if (iter == cameras.end())
-    return nullptr;
+const Camera* CameraMetaData::getCamera(std::string_view make,
+                                        std::string_view model) const {
+  make = trimSpacesView(make);
+  model = trimSpacesView(model);
 
-  return iter->second.get();
+  auto record = index.find(make, model);
+  return record ? resolve(*record) : nullptr;
 }
 
-bool CameraMetaData::hasCamera(const std::string& make,
-                               const std::string& model,
-                               const std::string& mode) const {
+bool CameraMetaData::hasCamera(std::string_view make, std::string_view model,
+                               std::string_view mode) const {
   return getCamera(make, model, mode);
 }
 
-const Camera* RAWSPEED_READONLY
-CameraMetaData::getChdkCamera(uint32_t filesize) const {
-  auto camera = chdkCameras.find(filesize);
-  return camera == chdkCameras.end() ? nullptr : camera->second;
+const Camera* CameraMetaData::getChdkCamera(uint32_t filesize) const {
+  if (auto camera = chdkCameras.find(filesize); camera != chdkCameras.end())
+    return camera->second;
+
+  if (!compiled)
+    return nullptr;
+  auto entry = compiled->findChdk(filesize);
+  return entry ? resolve(*entry) : nullptr;
 }
 
-bool RAWSPEED_READONLY CameraMetaData::hasChdkCamera(uint32_t filesize) const {
-  return chdkCameras.contains(filesize);
+bool CameraMetaData::hasChdkCamera(uint32_t filesize) const noexcept {
+  return chdkCameras.contains(filesize) ||
+         (compiled && compiled->findChdk(filesize));
 }
 
 const Camera* CameraMetaData::addCamera(std::unique_ptr<Camera> cam) {
-  auto id = getId(cam->make, cam->model, cam->mode);
-  if (cameras.contains(id)) {
+  // NOTE: the index refers to the strings of the camera itself.
+  if (!index.insert(trimSpacesView(cam->make), trimSpacesView(cam->model),
+                    trimSpacesView(cam->mode),
+                    implicit_cast<uint32_t>(records.size()))) {
     writeLog(
         DEBUG_PRIO::WARNING,
         "CameraMetaData: Duplicate entry found for camera: %s %s, Skipping!",
         cam->make.c_str(), cam->model.c_str());
     return nullptr;
   }
-  cameras[id] = std::move(cam);
+  const Camera* camera = cameras.emplace_back(std::move(cam)).get();
+  records.emplace_back(CameraRecord{camera});
+  addAliases(camera);
 
-  if (std::string::npos != cameras[id]->mode.find("chdk")) {
-    auto filesize_hint = cameras[id]->hints.get("filesize", std::string());
-    if (filesize_hint.empty()) {
+  if (std::string::npos != camera->mode.find("chdk")) {
+    if (!camera->hints.contains(Hint::filesize)) {
       writeLog(DEBUG_PRIO::WARNING,
                "CameraMetaData: CHDK camera: %s %s, no \"filesize\" hint set!",
-               cameras[id]->make.c_str(), cameras[id]->model.c_str());
+               camera->make.c_str(), camera->model.c_str());
     } else {
-      chdkCameras[stoi(filesize_hint)] = cameras[id].get();
+      chdkCameras[camera->hints.get(Hint::filesize, 0U)] = camera;
       // writeLog(DEBUG_PRIO::WARNING, "CHDK camera: %s %s size:%u",
-      // cameras[id]->make.c_str(), cameras[id]->model.c_str(), size);
+      // camera->make.c_str(), camera->model.c_str(), size);
+    }
+  }
+  return camera;
+}
+
+void CameraMetaData::addAliases(const Camera* cam) {
+  const std::string_view make = trimSpacesView(cam->make);
+  const std::string_view mode = trimSpacesView(cam->mode);
+  for (auto i = 0UL; i < cam->aliases.size(); i++) {
+    if (!index.insert(make, trimSpacesView(cam->aliases[i]), mode,
+                      implicit_cast<uint32_t>(records.size()))) {
+      writeLog(
+          DEBUG_PRIO::WARNING,
+          "CameraMetaData: Duplicate entry found for camera: %s %s, Skipping!",
+          cam->make.c_str(), cam->aliases[i].c_str());
+      continue;
     }
+    records.emplace_back(CameraRecord{cam, 0, implicit_cast<uint32_t>(i)});
   }
-  return cameras[id].get();
+}
+
+void CameraMetaData::forEachCamera(
+    const std::function<void(const Camera&)>& f) const {
+  for (uint32_t record = 0; record != records.size(); ++record)
+    f(*resolve(record));
 }
 
 void CameraMetaData::disableMake(std::string_view make) const {
-  for (const auto& [id, cam] : cameras) {
+  for (const auto& cam : cameras) {
+    if (cam->make == make)
+      cam->supportStatus = Camera::SupportStatus::Unsupported;
+  }
+
+  // The compiled cameras that were not resolved yet get disabled on lookup.
+  MutexLocker guard(&mutex);
+  disabledMakes.emplace_back(make);
+  for (const auto& [entry, cam] : resolvedCameras) {
     if (cam->make == make)
       cam->supportStatus = Camera::SupportStatus::Unsupported;
   }
@@ -163,7 +239,14 @@ void CameraMetaData::disableMake(std::string_view make) const {
 
 void CameraMetaData::disableCamera(std::string_view make,
                                    std::string_view model) const {
-  for (const auto& [id, cam] : cameras) {
+  for (const auto& cam : cameras) {
+    if (cam->make == make && cam->model == model)
+      cam->supportStatus = Camera::SupportStatus::Unsupported;
+  }
+
+  MutexLocker guard(&mutex);
+  disabledCameras.emplace_back(make, model);
+  for (const auto& [entry, cam] : resolvedCameras) {
     if (cam->make == make && cam->model == model)
       cam->supportStatus = Camera::SupportStatus::Unsupported;
   }
@@ -21,16 +21,24 @@
 #pragma once
 
 #include "rawspeedconfig.h"
+#include "ThreadSafetyAnalysis.h"
+#include "adt/Mutex.h"
 #include "metadata/Camera.h"
+#include "metadata/CameraIndex.h"
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace rawspeed {
 class Camera;
+class CompiledCameraMetaData;
+class FileMapping;
 
 struct CameraId final {
   std::string make;
@@ -46,35 +54,82 @@ struct CameraId final {
 // NOTE: *NOT* `final`, could be derived from by downstream.
 class CameraMetaData {
 public:
-  CameraMetaData() = default;
+  CameraMetaData();
 
-#ifdef HAVE_PUGIXML
+  // Either a cameras.xml (if built with XML support), or a database compiled
+  // from it. The latter is memory-mapped, and the cameras are only
+  // materialized once they are looked up.
   explicit CameraMetaData(const char* docname);
-#endif
 
-  std::map<CameraId, std::unique_ptr<Camera>> cameras;
-  std::map<uint32_t, Camera*> chdkCameras;
+  CameraMetaData(const CameraMetaData&) = delete;
+  CameraMetaData(CameraMetaData&&) = delete;
+  CameraMetaData& operator=(const CameraMetaData&) = delete;
+  CameraMetaData& operator=(CameraMetaData&&) = delete;
+
+  ~CameraMetaData();
+
+  // Adds the camera (and its aliases), unless there already is one with the
+  // same make + model + mode. Returns the added camera, or nullptr.
+  const Camera* addCamera(std::unique_ptr<Camera> cam);
+
+  // Calls f() for every camera, including the aliases, in the order they were
+  // added (or in which they are stored in the compiled database).
+  // NOTE: this materializes all the cameras that were not looked up yet.
+  void forEachCamera(const std::function<void(const Camera&)>& f) const;
 
   // searches for camera with given make + model + mode
-  [[nodiscard]] const Camera* getCamera(const std::string& make,
-                                        const std::string& model,
-                                        const std::string& mode) const;
+  [[nodiscard]] const Camera* getCamera(std::string_view make,
+                                        std::string_view model,
+                                        std::string_view mode) const;
 
   // searches for camera with given make + model, with ANY mode
-  [[nodiscard]] const Camera* getCamera(const std::string& make,
-                                        const std::string& model) const;
-
-  [[nodiscard]] bool hasCamera(const std::string& make,
-                               const std::string& model,
-                               const std::string& mode) const;
-  [[nodiscard]] const Camera* RAWSPEED_READONLY
-  getChdkCamera(uint32_t filesize) const;
-  [[nodiscard]] bool RAWSPEED_READONLY hasChdkCamera(uint32_t filesize) const;
+  [[nodiscard]] const Camera* getCamera(std::string_view make,
+                                        std::string_view model) const;
+
+  [[nodiscard]] bool hasCamera(std::string_view make, std::string_view model,
+                               std::string_view mode) const;
+  [[nodiscard]] const Camera* getChdkCamera(uint32_t filesize) const;
+  // Never throws, so that it can be used by RawParser::probe().
+  [[nodiscard]] bool hasChdkCamera(uint32_t filesize) const noexcept;
   void disableMake(std::string_view make) const;
   void disableCamera(std::string_view make, std::string_view model) const;
 
 private:
-  const Camera* addCamera(std::unique_ptr<Camera> cam);
+  // compile() serializes the in-memory cameras as they are stored here.
+  friend class CompiledCameraMetaData;
+
+  // What an index entry refers to: either an alias of an in-memory camera
+  // (or the camera itself), or an entry of the compiled database.
+  struct CameraRecord final {
+    static constexpr uint32_t NoAlias = ~0U;
+
+    const Camera* camera = nullptr;
+    uint32_t compiledEntry = 0;
+    uint32_t alias = NoAlias;
+  };
+
+  // The aliases are only materialized as cameras once they are looked up.
+  void addAliases(const Camera* cam);
+
+  std::unique_ptr<FileMapping> compiledMapping;
+  std::unique_ptr<const CompiledCameraMetaData> compiled;
+
+  // NOTE: the index refers to the strings of these cameras, so they must not
+  // be modified (other than their supportStatus) once added.
+  std::vector<std::unique_ptr<Camera>> cameras;
+  std::map<uint32_t, const Camera*> chdkCameras;
+
+  CameraIndex index;
+  std::vector<CameraRecord> records;
+
+  mutable Mutex mutex;
+  mutable std::map<uint32_t, std::unique_ptr<Camera>>
+      resolvedCameras GUARDED_BY(mutex);
+  mutable std::vector<std::string> disabledMakes GUARDED_BY(mutex);
+  mutable std::vector<std::pair<std::string, std::string>>
+      disabledCameras GUARDED_BY(mutex);
+
+  [[nodiscard]] const Camera* resolve(uint32_t record) const REQUIRES(!mutex);
 };
 
 } // namespace rawspeed
@@ -0,0 +1,530 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "metadata/CompiledCameraMetaData.h"
+#include "adt/Casts.h"
+#include "adt/Invariant.h"
+#include "adt/NotARational.h"
+#include "adt/Optional.h"
+#include "adt/Point.h"
+#include "common/Common.h"
+#include "io/Buffer.h"
+#include "io/ByteStream.h"
+#include "io/Endianness.h"
+#include "io/IOException.h"
+#include "metadata/BlackArea.h"
+#include "metadata/Camera.h"
+#include "metadata/CameraMetaData.h"
+#include "metadata/CameraMetadataException.h"
+#include "metadata/CameraSensorInfo.h"
+#include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace rawspeed {
+
+namespace {
+
+// Magic, followed by: version, number of index entries, offset of the index,
+// number of CHDK entries, offset of the CHDK table, offset and size of the
+// string table, offset and size of the camera records.
+constexpr uint32_t HeaderSize = 8 + (9 * 4);
+
+// String references are (offset, size) pairs into the string table.
+// Index entry: make, model, mode, record offset, alias number.
+constexpr uint32_t EntryWords = (3 * 2) + 2;
+// CHDK entry: file size, index entry.
+constexpr uint32_t ChdkWords = 2;
+
+// The CFA of any real camera is tiny, X-Trans being the largest at 6x6.
+constexpr int MaxCFADim = 64;
+
+class BlobWriter final {
+  std::vector<uint32_t> words;
+
+public:
+  [[nodiscard]] uint32_t size() const {
+    return implicit_cast<uint32_t>(words.size());
+  }
+
+  void put(uint32_t w) { words.emplace_back(w); }
+  void putInt(int i) { put(static_cast<uint32_t>(i)); }
+
+  void serialize(std::vector<uint8_t>* out) const {
+    for (uint32_t w : words) {
+      for (int i = 0; i != 4; ++i)
+        out->emplace_back(static_cast<uint8_t>(w >> (8 * i)));
+    }
+  }
+};
+
+class StringTable final {
+  std::vector<uint8_t> bytes;
+  std::map<std::string, uint32_t, std::less<>> offsets;
+
+public:
+  [[nodiscard]] const std::vector<uint8_t>& data() const { return bytes; }
+
+  void put(BlobWriter* w, std::string_view str) {
+    auto it = offsets.find(str);
+    if (it == offsets.end()) {
+      it = offsets
+               .try_emplace(std::string(str),
+                            implicit_cast<uint32_t>(bytes.size()))
+               .first;
+      bytes.insert(bytes.end(), str.begin(), str.end());
+    }
+    w->put(it->second);
+    w->put(implicit_cast<uint32_t>(str.size()));
+  }
+};
+
+void writeRecord(BlobWriter* w, StringTable* strings, const Camera& cam) {
+  for (const std::string* str :
+       {&cam.make, &cam.model, &cam.mode, &cam.canonical_make,
+        &cam.canonical_model, &cam.canonical_alias, &cam.canonical_id})
+    strings->put(w, *str);
+
+  invariant(cam.aliases.size() == cam.canonical_aliases.size());
+  w->put(implicit_cast<uint32_t>(cam.aliases.size()));
+  for (size_t i = 0; i != cam.aliases.size(); ++i) {
+    strings->put(w, cam.aliases[i]);
+    strings->put(w, cam.canonical_aliases[i]);
+  }
+
+  const iPoint2D cfaSize = cam.cfa.getSize();
+  w->putInt(cfaSize.x);
+  w->putInt(cfaSize.y);
+  for (int y = 0; y < cfaSize.y; ++y) {
+    for (int x = 0; x < cfaSize.x; ++x)
+      w->put(static_cast<uint32_t>(cam.cfa.getColorAt(x, y)));
+  }
+
+  w->put(static_cast<uint32_t>(cam.supportStatus));
+
+  w->putInt(cam.cropSize.x);
+  w->putInt(cam.cropSize.y);
+  w->putInt(cam.cropPos.x);
+  w->putInt(cam.cropPos.y);
+  w->put(cam.cropAvailable);
+
+  w->put(implicit_cast<uint32_t>(cam.blackAreas.size()));
+  for (const BlackArea& area : cam.blackAreas) {
+    w->put(area.offset);
+    w->put(area.size);
+    w->put(area.isVertical);
+  }
+
+  w->put(implicit_cast<uint32_t>(cam.sensorInfo.size()));
+  for (const CameraSensorInfo& sensor : cam.sensorInfo) {
+    w->putInt(sensor.mBlackLevel);
+    w->putInt(sensor.mWhiteLevel);
+    w->putInt(sensor.mMinIso);
+    w->putInt(sensor.mMaxIso);
+    w->put(implicit_cast<uint32_t>(sensor.mBlackLevelSeparate.size()));
+    for (int black : sensor.mBlackLevelSeparate)
+      w->putInt(black);
+  }
+
+  w->putInt(cam.decoderVersion);
+
+  w->put(implicit_cast<uint32_t>(
+      std::distance(cam.hints.begin(), cam.hints.end())));
+  for (const Hints::Entry& hint : cam.hints) {
+    strings->put(w, Hints::getName(hint.hint));
+    strings->put(w, hint.value);
+  }
+
+  w->put(implicit_cast<uint32_t>(cam.color_matrix.size()));
+  for (const NotARational<int>& val : cam.color_matrix) {
+    w->putInt(val.num);
+    w->putInt(val.den);
+  }
+}
+
+int getInt(ByteStream* bs) { return static_cast<int>(bs->getI32()); }
+
+// Reads an element count, rejecting obviously bogus ones before anything
+// gets allocated.
+uint32_t getCount(ByteStream* bs, uint32_t minWordsPerElement) {
+  const uint32_t count = bs->getU32();
+  (void)bs->check(count, 4 * minWordsPerElement);
+  return count;
+}
+
+} // namespace
+
+bool CompiledCameraMetaData::isCompiled(Buffer data) noexcept {
+  if (data.getSize() < HeaderSize)
+    return false;
+  return std::equal(Magic.begin(), Magic.end(), data.begin());
+}
+
+std::vector<uint8_t>
+CompiledCameraMetaData::compile(const CameraMetaData& meta) {
+  // The aliases do not get records of their own, their entries refer to the
+  // record of the canonical camera.
+  StringTable strings;
+  BlobWriter records;
+  std::map<const Camera*, uint32_t> recordOffsets;
+  for (const auto& cam : meta.cameras) {
+    recordOffsets[cam.get()] = 4 * records.size();
+    writeRecord(&records, &strings, *cam);
+  }
+
+  struct Entry final {
+    CameraId id;
+    const Camera* camera;
+    uint32_t alias;
+  };
+  static_assert(CameraMetaData::CameraRecord::NoAlias == NoAlias);
+  std::vector<Entry> index;
+  index.reserve(meta.records.size());
+  for (const CameraMetaData::CameraRecord& r : meta.records) {
+    if (!r.camera)
+      continue; // Not materialized, the database is compiled already.
+    const std::string& model =
+        r.alias == NoAlias ? r.camera->model : r.camera->aliases[r.alias];
+    index.emplace_back(Entry{CameraId{trimSpaces(r.camera->make),
+                                      trimSpaces(model),
+                                      trimSpaces(r.camera->mode)},
+                             r.camera, r.alias});
+  }
+  // NOTE: the keys are unique already, CameraMetaData rejects duplicates.
+  std::sort(index.begin(), index.end(),
+            [](const Entry& a, const Entry& b) { return a.id < b.id; });
+
+  BlobWriter entries;
+  std::map<std::pair<const Camera*, uint32_t>, uint32_t> entryIndices;
+  for (const Entry& e : index) {
+    entryIndices.try_emplace({e.camera, e.alias}, entries.size() / EntryWords);
+    strings.put(&entries, e.id.make);
+    strings.put(&entries, e.id.model);
+    strings.put(&entries, e.id.mode);
+    entries.put(recordOffsets.at(e.camera));
+    entries.put(e.alias);
+  }
+
+  BlobWriter chdk;
+  for (const auto& [filesize, cam] : meta.chdkCameras) {
+    chdk.put(filesize);
+    chdk.put(entryIndices.at({cam, NoAlias}));
+  }
+
+  // Keep the sections 4-byte aligned.
+  std::vector<uint8_t> stringBytes = strings.data();
+  stringBytes.resize(roundUp(stringBytes.size(), 4));
+
+  const uint32_t entriesOffset = HeaderSize;
+  const uint32_t chdkOffset = entriesOffset + (4 * entries.size());
+  const uint32_t stringsOffset = chdkOffset + (4 * chdk.size());
+  const auto stringsSize = implicit_cast<uint32_t>(stringBytes.size());
+  const uint32_t recordsOffset = stringsOffset + stringsSize;
+
+  BlobWriter header;
+  header.put(Version);
+  header.put(entries.size() / EntryWords);
+  header.put(entriesOffset);
+  header.put(chdk.size() / ChdkWords);
+  header.put(chdkOffset);
+  header.put(stringsOffset);
+  header.put(stringsSize);
+  header.put(recordsOffset);
+  header.put(4 * records.size());
+
+  std::vector<uint8_t> blob(Magic.begin(), Magic.end());
+  header.serialize(&blob);
+  entries.serialize(&blob);
+  chdk.serialize(&blob);
+  blob.insert(blob.end(), stringBytes.begin(), stringBytes.end());
+  records.serialize(&blob);
+  invariant(blob.size() == recordsOffset + (4 * records.size()));
+  return blob;
+}
+
+CompiledCameraMetaData::CompiledCameraMetaData(Buffer blob_) : blob(blob_) {
+  if (!isCompiled(blob))
+    ThrowCME("Not a compiled camera database");
+
+  ByteStream bs(DataBuffer(blob, Endianness::little));
+  bs.skipBytes(implicit_cast<Buffer::size_type>(Magic.size()));
+  if (const uint32_t version = bs.getU32(); version != Version) {
+    ThrowCME("Unsupported compiled camera database version %u (expected %u)",
+             version, Version);
+  }
+
+  try {
+    numEntries = bs.getU32();
+    const uint32_t entriesOffset = bs.getU32();
+    numChdk = bs.getU32();
+    const uint32_t chdkOffset = bs.getU32();
+    const uint32_t stringsOffset = bs.getU32();
+    const uint32_t stringsSize = bs.getU32();
+    const uint32_t recordsOffset = bs.getU32();
+    const uint32_t recordsSize = bs.getU32();
+
+    const uint64_t entriesSize = uint64_t(4) * EntryWords * numEntries;
+    const uint64_t chdkSize = uint64_t(4) * ChdkWords * numChdk;
+    if (entriesSize > blob.getSize() || chdkSize > blob.getSize())
+      ThrowCME("Compiled camera database is truncated");
+
+    entries = blob.getSubView(entriesOffset,
+                              implicit_cast<Buffer::size_type>(entriesSize));
+    chdk =
+        blob.getSubView(chdkOffset, implicit_cast<Buffer::size_type>(chdkSize));
+    strings = blob.getSubView(stringsOffset, stringsSize);
+    records = blob.getSubView(recordsOffset, recordsSize);
+  } catch (const IOException&) {
+    ThrowCME("Compiled camera database is truncated");
+  }
+
+  // Validate the CHDK table once, so that the lookups can not fail.
+  const DataBuffer table(chdk, Endianness::little);
+  for (uint32_t i = 0; i != numChdk; ++i) {
+    if (i != 0 && table.get<uint32_t>(0, ChdkWords * (i - 1)) >=
+                      table.get<uint32_t>(0, ChdkWords * i))
+      ThrowCME("Corrupt compiled camera database: unsorted CHDK table");
+    if (table.get<uint32_t>(0, (ChdkWords * i) + 1) >= numEntries)
+      ThrowCME("Corrupt compiled camera database: bad CHDK entry");
+  }
+
+  // Likewise, validate the index, so that the keys can always be read.
+  for (uint32_t entry = 0; entry != numEntries; ++entry) {
+    for (uint32_t field = 0; field != 3; ++field) {
+      const uint64_t offset = entryWord(entry, 2 * field);
+      const uint64_t size_ = entryWord(entry, (2 * field) + 1);
+      if (size_ != 0 && offset + size_ > strings.getSize())
+        ThrowCME("Corrupt compiled camera database: bad string in entry %u",
+                 entry);
+    }
+    if (entryWord(entry, 6) >= records.getSize())
+      ThrowCME("Corrupt compiled camera database: bad record of entry %u",
+               entry);
+  }
+}
+
+uint32_t CompiledCameraMetaData::entryWord(uint32_t entry,
+                                           uint32_t word) const {
+  invariant(entry < numEntries);
+  invariant(word < EntryWords);
+  return DataBuffer(entries, Endianness::little)
+      .get<uint32_t>(0, (EntryWords * entry) + word);
+}
+
+std::string_view CompiledCameraMetaData::getString(uint32_t offset,
+                                                   uint32_t size_) const {
+  if (size_ == 0)
+    return {};
+  const Buffer str = strings.getSubView(offset, size_);
+  return {reinterpret_cast<const char*>(str.begin()), str.getSize()};
+}
+
+std::string_view CompiledCameraMetaData::entryString(uint32_t entry,
+                                                     uint32_t field) const {
+  return getString(entryWord(entry, 2 * field),
+                   entryWord(entry, (2 * field) + 1));
+}
+
+CompiledCameraMetaData::Key
+CompiledCameraMetaData::getKey(uint32_t entry) const {
+  return {entryString(entry, 0), entryString(entry, 1), entryString(entry, 2)};
+}
+
+uint32_t CompiledCameraMetaData::lowerBound(std::string_view make,
+                                            std::string_view model,
+                                            std::string_view mode) const {
+  const auto key = std::tie(make, model, mode);
+  uint32_t first = 0;
+  uint32_t count = numEntries;
+  while (count > 0) {
+    const uint32_t step = count / 2;
+    const uint32_t mid = first + step;
+    if (std::tuple(entryString(mid, 0), entryString(mid, 1),
+                   entryString(mid, 2)) < key) {
+      first = mid + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+Optional<uint32_t>
+CompiledCameraMetaData::find(std::string_view make, std::string_view model,
+                             std::string_view mode) const {
+  const uint32_t entry = lowerBound(make, model, mode);
+  if (entry == numEntries ||
+      std::tuple(entryString(entry, 0), entryString(entry, 1),
+                 entryString(entry, 2)) != std::tie(make, model, mode))
+    return std::nullopt;
+  return entry;
+}
+
+Optional<uint32_t> CompiledCameraMetaData::find(std::string_view make,
+                                                std::string_view model) const {
+  const uint32_t entry = lowerBound(make, model, "");
+  if (entry == numEntries ||
+      std::tuple(entryString(entry, 0), entryString(entry, 1)) !=
+          std::tie(make, model))
+    return std::nullopt;
+  return entry;
+}
+
+Optional<uint32_t>
+CompiledCameraMetaData::findChdk(uint32_t filesize) const noexcept {
+  const DataBuffer table(chdk, Endianness::little);
+  uint32_t first = 0;
+  uint32_t count = numChdk;
+  while (count > 0) {
+    const uint32_t step = count / 2;
+    const uint32_t mid = first + step;
+    if (table.get<uint32_t>(0, ChdkWords * mid) < filesize) {
+      first = mid + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  if (first == numChdk || table.get<uint32_t>(0, ChdkWords * first) != filesize)
+    return std::nullopt;
+  const uint32_t entry = table.get<uint32_t>(0, (ChdkWords * first) + 1);
+  invariant(entry < numEntries);
+  return entry;
+}
+
+std::unique_ptr<Camera> CompiledCameraMetaData::getCamera(uint32_t entry) const
+    try {
+  ByteStream bs(DataBuffer(records.getSubView(entryWord(entry, 6)),
+                           Endianness::little));
+  auto getStr = [this, &bs]() {
+    const uint32_t offset = bs.getU32();
+    const uint32_t size_ = bs.getU32();
+    return std::string(getString(offset, size_));
+  };
+
+  auto cam = std::make_unique<Camera>();
+  for (std::string* str :
+       {&cam->make, &cam->model, &cam->mode, &cam->canonical_make,
+        &cam->canonical_model, &cam->canonical_alias, &cam->canonical_id})
+    *str = getStr();
+
+  const uint32_t numAliases = getCount(&bs, 4);
+  cam->aliases.reserve(numAliases);
+  cam->canonical_aliases.reserve(numAliases);
+  for (uint32_t i = 0; i != numAliases; ++i) {
+    cam->aliases.emplace_back(getStr());
+    cam->canonical_aliases.emplace_back(getStr());
+  }
+
+  iPoint2D cfaSize;
+  cfaSize.x = getInt(&bs);
+  cfaSize.y = getInt(&bs);
+  if (cfaSize.x < 0 || cfaSize.y < 0 || cfaSize.x > MaxCFADim ||
+      cfaSize.y > MaxCFADim)
+    ThrowCME("Bad CFA size: %i x %i", cfaSize.x, cfaSize.y);
+  if (cfaSize.hasPositiveArea()) {
+    cam->cfa.setSize(cfaSize);
+    for (int y = 0; y < cfaSize.y; ++y) {
+      for (int x = 0; x < cfaSize.x; ++x) {
+        const uint32_t c = bs.getU32();
+        if (c >= static_cast<uint32_t>(CFAColor::END) &&
+            c != static_cast<uint32_t>(CFAColor::UNKNOWN))
+          ThrowCME("Bad CFA color: %u", c);
+        cam->cfa.setColorAt({x, y}, static_cast<CFAColor>(c));
+      }
+    }
+  }
+
+  const uint32_t supportStatus = bs.getU32();
+  if (supportStatus >
+      static_cast<uint32_t>(Camera::SupportStatus::Unsupported))
+    ThrowCME("Bad support status: %u", supportStatus);
+  cam->supportStatus = static_cast<Camera::SupportStatus>(supportStatus);
+
+  cam->cropSize.x = getInt(&bs);
+  cam->cropSize.y = getInt(&bs);
+  cam->cropPos.x = getInt(&bs);
+  cam->cropPos.y = getInt(&bs);
+  cam->cropAvailable = bs.getU32() != 0;
+
+  const uint32_t numBlackAreas = getCount(&bs, 3);
+  cam->blackAreas.reserve(numBlackAreas);
+  for (uint32_t i = 0; i != numBlackAreas; ++i) {
+    const int offset = getInt(&bs);
+    const int size_ = getInt(&bs);
+    const bool isVertical = bs.getU32() != 0;
+    cam->blackAreas.emplace_back(offset, size_, isVertical);
+  }
+
+  const uint32_t numSensors = getCount(&bs, 5);
+  cam->sensorInfo.reserve(numSensors);
+  for (uint32_t i = 0; i != numSensors; ++i) {
+    const int black = getInt(&bs);
+    const int white = getInt(&bs);
+    const int minIso = getInt(&bs);
+    const int maxIso = getInt(&bs);
+    std::vector<int> blackSeparate(getCount(&bs, 1));
+    for (int& b : blackSeparate)
+      b = getInt(&bs);
+    cam->sensorInfo.emplace_back(black, white, minIso, maxIso,
+                                 std::move(blackSeparate));
+  }
+
+  cam->decoderVersion = getInt(&bs);
+
+  const uint32_t numHints = getCount(&bs, 4);
+  for (uint32_t i = 0; i != numHints; ++i) {
+    const std::string key = getStr();
+    const std::string value = getStr();
+    cam->hints.add(key, value);
+  }
+
+  const uint32_t numColorMatrix = getCount(&bs, 2);
+  cam->color_matrix.reserve(numColorMatrix);
+  for (uint32_t i = 0; i != numColorMatrix; ++i) {
+    const int num = getInt(&bs);
+    const int den = getInt(&bs);
+    cam->color_matrix.emplace_back(num, den);
+  }
+
+  if (const uint32_t alias = entryWord(entry, 7); alias != NoAlias) {
+    if (alias >= cam->aliases.size())
+      ThrowCME("Corrupt compiled camera database");
+    return std::make_unique<Camera>(cam.get(), alias);
+  }
+
+  return cam;
+} catch (const IOException&) {
+  ThrowCME("Corrupt compiled camera database");
+}
+
+} // namespace rawspeed
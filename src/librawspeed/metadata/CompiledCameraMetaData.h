@@ -0,0 +1,106 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Optional.h"
+#include "io/Buffer.h"
+#include "metadata/CameraMetaData.h"
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace rawspeed {
+
+class Camera;
+
+// A compiled form of the camera database (data/cameras.xml).
+//
+// The blob is little-endian, versioned and position-independent (all
+// references are offsets from the start of the blob), so it can be mapped
+// read-only and shared between processes. It consists of a header, an index
+// of (make, model, mode) triples sorted the same way as `CameraId`, a table of
+// CHDK file sizes, a string table, and the variable-length camera records.
+// Alias cameras do not get records of their own, their index entries refer to
+// the record of the canonical camera instead.
+class CompiledCameraMetaData final {
+  Buffer blob;
+
+  uint32_t numEntries = 0;
+  Buffer entries;
+  uint32_t numChdk = 0;
+  Buffer chdk;
+  Buffer strings;
+  Buffer records;
+
+  [[nodiscard]] uint32_t entryWord(uint32_t entry, uint32_t word) const;
+  [[nodiscard]] std::string_view getString(uint32_t offset,
+                                           uint32_t size) const;
+  [[nodiscard]] std::string_view entryString(uint32_t entry,
+                                             uint32_t field) const;
+  [[nodiscard]] uint32_t lowerBound(std::string_view make,
+                                    std::string_view model,
+                                    std::string_view mode) const;
+
+public:
+  static constexpr std::string_view Magic = {"RSCAMDB\0", 8};
+  static constexpr uint32_t Version = 1;
+
+  static constexpr uint32_t NoAlias = ~0U;
+
+  // Does the buffer look like a compiled database?
+  static bool isCompiled(Buffer data) noexcept;
+
+  // Serialize the cameras of the given (XML-loaded) database.
+  static std::vector<uint8_t> compile(const CameraMetaData& meta);
+
+  explicit CompiledCameraMetaData(Buffer blob);
+
+  [[nodiscard]] uint32_t size() const { return numEntries; }
+
+  struct Key final {
+    std::string_view make;
+    std::string_view model;
+    std::string_view mode;
+  };
+
+  // The key of the given index entry, pointing into the blob. The index was
+  // validated upon construction, so this can not fail.
+  [[nodiscard]] Key getKey(uint32_t entry) const;
+
+  // Index entry with the given (already trimmed) make + model + mode.
+  [[nodiscard]] Optional<uint32_t> find(std::string_view make,
+                                        std::string_view model,
+                                        std::string_view mode) const;
+
+  // First index entry with the given make + model, with ANY mode.
+  [[nodiscard]] Optional<uint32_t> find(std::string_view make,
+                                        std::string_view model) const;
+
+  // Index entry of the CHDK camera with the given file size. The CHDK table
+  // was validated upon construction, so this can not fail.
+  [[nodiscard]] Optional<uint32_t> findChdk(uint32_t filesize) const noexcept;
+
+  // Materialize the camera of the given index entry.
+  [[nodiscard]] std::unique_ptr<Camera> getCamera(uint32_t entry) const;
+};
+
+} // namespace rawspeed
@@ -0,0 +1,179 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "metadata/Hints.h"
+#include "adt/Casts.h"
+#include "adt/Invariant.h"
+#include "adt/Optional.h"
+#include "metadata/CameraMetadataException.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace rawspeed {
+
+namespace {
+
+struct HintInfo final {
+  Hint hint;
+  std::string_view name;
+  Hints::Type type;
+};
+
+constexpr std::array<HintInfo, Hints::NumHints> HintInfos = {{
+    {Hint::bits, "bits", Hints::Type::Int},
+    {Hint::coolpixmangled, "coolpixmangled", Hints::Type::Flag},
+    {Hint::coolpixsplit, "coolpixsplit", Hints::Type::Flag},
+    {Hint::double_width_unpacked, "double_width_unpacked", Hints::Type::Flag},
+    {Hint::easyshare_offset_hack, "easyshare_offset_hack", Hints::Type::Flag},
+    {Hint::filesize, "filesize", Hints::Type::Int},
+    {Hint::final_cfa_black, "final_cfa_black", Hints::Type::String},
+    {Hint::force_new_sraw_hue, "force_new_sraw_hue", Hints::Type::Flag},
+    {Hint::force_uncompressed, "force_uncompressed", Hints::Type::Flag},
+    {Hint::fuji_rotate, "fuji_rotate", Hints::Type::Flag},
+    {Hint::full_height, "full_height", Hints::Type::Int},
+    {Hint::full_width, "full_width", Hints::Type::Int},
+    {Hint::invert_sraw_wb, "invert_sraw_wb", Hints::Type::Flag},
+    {Hint::jpeg32_bitorder, "jpeg32_bitorder", Hints::Type::Flag},
+    {Hint::msb_override, "msb_override", Hints::Type::Bool},
+    {Hint::nikon_wb_adjustment, "nikon_wb_adjustment", Hints::Type::Flag},
+    {Hint::no_decompressed_lowbits, "no_decompressed_lowbits",
+     Hints::Type::Flag},
+    {Hint::offset, "offset", Hints::Type::Int},
+    {Hint::old_sraw_hue, "old_sraw_hue", Hints::Type::Flag},
+    {Hint::order, "order", Hints::Type::String},
+    {Hint::pixel_aspect_ratio, "pixel_aspect_ratio", Hints::Type::Double},
+    {Hint::real_bpp, "real_bpp", Hints::Type::Int},
+    {Hint::sr2_format, "sr2_format", Hints::Type::Flag},
+    {Hint::sraw_40d, "sraw_40d", Hints::Type::Flag},
+    {Hint::sraw_new, "sraw_new", Hints::Type::Flag},
+    {Hint::srf_format, "srf_format", Hints::Type::Flag},
+    {Hint::swapped_wb, "swapped_wb", Hints::Type::Flag},
+    {Hint::wb_mangle, "wb_mangle", Hints::Type::Flag},
+    {Hint::wb_offset, "wb_offset", Hints::Type::Int},
+    {Hint::zero_is_not_bad, "zero_is_not_bad", Hints::Type::Flag},
+}};
+
+// The table is indexed by the hint, and binary-searched by the name.
+constexpr bool isValidTable() {
+  for (size_t i = 0; i != HintInfos.size(); ++i) {
+    if (static_cast<size_t>(HintInfos[i].hint) != i)
+      return false;
+    if (i != 0 && !(HintInfos[i - 1].name < HintInfos[i].name))
+      return false;
+  }
+  return true;
+}
+static_assert(isValidTable());
+
+const HintInfo& getInfo(Hint hint) {
+  invariant(hint < Hint::END);
+  return HintInfos[static_cast<size_t>(hint)];
+}
+
+Optional<int64_t> parseInt(std::string_view str) {
+  int64_t val;
+  const char* end = str.data() + str.size();
+  const auto [ptr, ec] = std::from_chars(str.data(), end, val);
+  if (ec != std::errc() || ptr != end)
+    return std::nullopt;
+  return val;
+}
+
+Optional<double> parseDouble(std::string_view str) {
+  // NOTE: std::from_chars() for floating-point is not universally available.
+  const std::string tmp(str);
+  char* end = nullptr;
+  const double val = std::strtod(tmp.c_str(), &end);
+  if (tmp.empty() || end != tmp.c_str() + tmp.size())
+    return std::nullopt;
+  return val;
+}
+
+} // namespace
+
+std::string_view Hints::getName(Hint hint) { return getInfo(hint).name; }
+
+Hints::Type Hints::getType(Hint hint) { return getInfo(hint).type; }
+
+Optional<Hint> Hints::getHint(std::string_view name) {
+  const auto* it = std::lower_bound(
+      HintInfos.begin(), HintInfos.end(), name,
+      [](const HintInfo& info, std::string_view n) { return info.name < n; });
+  if (it == HintInfos.end() || it->name != name)
+    return std::nullopt;
+  return it->hint;
+}
+
+void Hints::add(std::string_view name, std::string_view value) {
+  const Optional<Hint> hint = getHint(name);
+  if (!hint) {
+    ThrowCME("Unknown hint \"%.*s\"", static_cast<int>(name.size()),
+             name.data());
+  }
+
+  if (contains(*hint))
+    return;
+
+  Entry e{*hint, std::string(value), std::monostate()};
+  switch (getType(*hint)) {
+    using enum Type;
+  case Flag:
+  case String:
+    break;
+  case Bool:
+    if (value != "true" && value != "false") {
+      ThrowCME("Hint \"%.*s\": expected \"true\" or \"false\", got \"%s\"",
+               static_cast<int>(name.size()), name.data(), e.value.c_str());
+    }
+    e.parsed = value == "true";
+    break;
+  case Int: {
+    const auto val = parseInt(value);
+    if (!val) {
+      ThrowCME("Hint \"%.*s\": expected an integer, got \"%s\"",
+               static_cast<int>(name.size()), name.data(), e.value.c_str());
+    }
+    e.parsed = *val;
+    break;
+  }
+  case Double: {
+    const auto val = parseDouble(value);
+    if (!val) {
+      ThrowCME("Hint \"%.*s\": expected a number, got \"%s\"",
+               static_cast<int>(name.size()), name.data(), e.value.c_str());
+    }
+    e.parsed = *val;
+    break;
+  }
+  }
+
+  slots[static_cast<size_t>(*hint)] = implicit_cast<uint8_t>(entries.size());
+  entries.emplace_back(std::move(e));
+}
+
+} // namespace rawspeed
@@ -0,0 +1,147 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "adt/Optional.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace rawspeed {
+
+// All the hints that may be specified for a camera in cameras.xml.
+// The enumerators are spelled exactly like the hints themselves,
+// and are sorted alphabetically.
+enum class Hint : uint8_t {
+  bits,
+  coolpixmangled,
+  coolpixsplit,
+  double_width_unpacked,
+  easyshare_offset_hack,
+  filesize,
+  final_cfa_black,
+  force_new_sraw_hue,
+  force_uncompressed,
+  fuji_rotate,
+  full_height,
+  full_width,
+  invert_sraw_wb,
+  jpeg32_bitorder,
+  msb_override,
+  nikon_wb_adjustment,
+  no_decompressed_lowbits,
+  offset,
+  old_sraw_hue,
+  order,
+  pixel_aspect_ratio,
+  real_bpp,
+  sr2_format,
+  sraw_40d,
+  sraw_new,
+  srf_format,
+  swapped_wb,
+  wb_mangle,
+  wb_offset,
+  zero_is_not_bad,
+  END, // keep it last!
+};
+
+// The hints of a camera, parsed (and validated) once, when they are added.
+class Hints final {
+public:
+  enum class Type : uint8_t {
+    Flag,   // Only the presence matters.
+    Bool,   // "true" or "false".
+    Int,    // Decimal integer.
+    Double, // Decimal floating-point.
+    String, // Used as-is.
+  };
+
+  struct Entry final {
+    Hint hint;
+    std::string value; // As specified.
+    std::variant<std::monostate, bool, int64_t, double> parsed;
+  };
+
+  static constexpr auto NumHints = static_cast<size_t>(Hint::END);
+
+  [[nodiscard]] static std::string_view getName(Hint hint);
+  [[nodiscard]] static Type getType(Hint hint);
+  [[nodiscard]] static Optional<Hint> getHint(std::string_view name);
+
+private:
+  static constexpr uint8_t NoEntry = 0xFF;
+
+  std::array<uint8_t, NumHints> slots = makeEmptySlots();
+  std::vector<Entry> entries;
+
+  static constexpr std::array<uint8_t, NumHints> makeEmptySlots() {
+    std::array<uint8_t, NumHints> s;
+    s.fill(NoEntry);
+    return s;
+  }
+
+  [[nodiscard]] const Entry* find(Hint hint) const {
+    const uint8_t slot = slots[static_cast<size_t>(hint)];
+    return slot == NoEntry ? nullptr : &entries[slot];
+  }
+
+public:
+  // Throws if the hint is unknown, or the value is malformed for its type.
+  // If the hint was already added, the first value is kept.
+  void add(std::string_view name, std::string_view value);
+
+  [[nodiscard]] bool contains(Hint hint) const {
+    return slots[static_cast<size_t>(hint)] != NoEntry;
+  }
+
+  [[nodiscard]] bool get(Hint hint, bool defaultValue) const {
+    const Entry* e = find(hint);
+    return e ? std::get<bool>(e->parsed) : defaultValue;
+  }
+
+  template <typename T>
+    requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+  [[nodiscard]] T get(Hint hint, T defaultValue) const {
+    const Entry* e = find(hint);
+    if (!e)
+      return defaultValue;
+    if constexpr (std::is_integral_v<T>)
+      return static_cast<T>(std::get<int64_t>(e->parsed));
+    else
+      return static_cast<T>(std::get<double>(e->parsed));
+  }
+
+  [[nodiscard]] std::string get(Hint hint, std::string defaultValue) const {
+    const Entry* e = find(hint);
+    return e ? e->value : defaultValue;
+  }
+
+  [[nodiscard]] auto begin() const { return entries.begin(); }
+  [[nodiscard]] auto end() const { return entries.end(); }
+};
+
+} // namespace rawspeed
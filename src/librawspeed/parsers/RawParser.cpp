@@ -20,11 +20,13 @@
 */
 
 #include "parsers/RawParser.h"
+#include "adt/Casts.h"
+#include "common/RawspeedException.h"
 #include "decoders/MrwDecoder.h"
 #include "decoders/NakedDecoder.h"
-#include "decoders/RafDecoder.h"
 #include "decoders/RawDecoder.h"
 #include "decoders/RawDecoderException.h"
+#include "io/BlockCachedInput.h"
 #include "io/Buffer.h"
 #include "metadata/CameraMetaData.h"
 #include "parsers/CiffParser.h"
@@ -33,53 +35,115 @@
 #include "parsers/FiffParserException.h"
 #include "parsers/TiffParser.h"
 #include "parsers/TiffParserException.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
 #include <memory>
+#include <string_view>
 
 namespace rawspeed {
 
 class Camera;
 
+namespace {
+
+using std::string_view_literals::operator""sv;
+
+struct Signature final {
+  RawParser::Format format;
+  Buffer::size_type offset;
+  std::string_view magic;
+};
+
+// NOTE: the CIFF signature must come before the TIFF ones, both start with
+// "II".
+constexpr std::array<Signature, 5> Signatures = {{
+    {RawParser::Format::MRW, 0, "\0MRM"sv},
+    {RawParser::Format::FIFF, 0, "FUJIFILMCCD-RAW "sv},
+    {RawParser::Format::CIFF, 6, "HEAPCCDR"sv},
+    // Just the "II"/"MM" byte order mark. The 16-bit magic that follows it
+    // varies (42 for the ordinary TIFF, 0x4f52/0x5352 for ORF, 0x55 for RW2,
+    // ...), so it is left to the TiffParser to check it.
+    {RawParser::Format::TIFF, 0, "II"sv},
+    {RawParser::Format::TIFF, 0, "MM"sv},
+}};
+
+// We need some data.
+// For now it is 104 bytes for RAF/FUJIFIM images.
+// FIXME: each decoder/parser should check it on their own.
+constexpr Buffer::size_type MinFileSize = 104 + 1;
+
+} // namespace
+
+RawParser::Format RawParser::probe(Buffer input,
+                                   const CameraMetaData* meta) noexcept {
+  if (input.getSize() < MinFileSize)
+    return Format::Unknown;
+
+  for (const Signature& sig : Signatures) {
+    const auto size = implicit_cast<Buffer::size_type>(sig.magic.size());
+    if (!input.isValid(sig.offset, size))
+      continue;
+    if (std::equal(sig.magic.begin(), sig.magic.end(),
+                   input.begin() + sig.offset, [](char magic, uint8_t byte) {
+                     return static_cast<uint8_t>(magic) == byte;
+                   }))
+      return sig.format;
+  }
+
+  // Detect camera on filesize (CHDK).
+  if (meta != nullptr && meta->hasChdkCamera(input.getSize()))
+    return Format::CHDK;
+
+  return Format::Unknown;
+}
+
 std::unique_ptr<RawDecoder> RawParser::getDecoder(const CameraMetaData* meta) {
-  // We need some data.
-  // For now it is 104 bytes for RAF/FUJIFIM images.
-  // FIXME: each decoder/parser should check it on their own.
-  if (mInput.getSize() <= 104)
+  if (mInput.getSize() < MinFileSize)
     ThrowRDE("File too small");
 
-  // MRW images are easy to check for, let's try that first
-  if (MrwDecoder::isMRW(mInput)) {
+  const Format format = probe(mInput, meta);
+
+  // Only the parser that matches the signature is tried. If it fails,
+  // the file may still be a headerless CHDK raw.
+  switch (format) {
+  case Format::MRW:
     try {
       return std::make_unique<MrwDecoder>(mInput);
     } catch (const RawDecoderException&) { // NOLINT(bugprone-empty-catch)
       // Yes, just ignore the exception.
     }
-  }
-
-  // FUJI has pointers to IFD's at fixed byte offsets
-  // So if camera is FUJI, we cannot use ordinary TIFF parser
-  if (RafDecoder::isRAF(mInput)) {
+    break;
+  case Format::FIFF:
+    // FUJI has pointers to IFD's at fixed byte offsets
+    // So if camera is FUJI, we cannot use ordinary TIFF parser
     try {
       FiffParser p(mInput);
       return p.getDecoder(meta);
     } catch (const FiffParserException&) { // NOLINT(bugprone-empty-catch)
       // Yes, just ignore the exception.
     }
-  }
-
-  // Ordinary TIFF images
-  try {
-    TiffParser p(mInput);
-    return p.getDecoder(meta);
-  } catch (const TiffParserException&) { // NOLINT(bugprone-empty-catch)
-                                         // Yes, just ignore the exception.
-  }
-
-  // CIFF images
-  try {
-    CiffParser p(mInput);
-    return p.getDecoder(meta);
-  } catch (const CiffParserException&) { // NOLINT(bugprone-empty-catch)
-                                         // Yes, just ignore the exception.
+    break;
+  case Format::TIFF:
+    try {
+      TiffParser p(mInput);
+      return p.getDecoder(meta);
+    } catch (const TiffParserException&) { // NOLINT(bugprone-empty-catch)
+      // Yes, just ignore the exception.
+    }
+    break;
+  case Format::CIFF:
+    try {
+      CiffParser p(mInput);
+      return p.getDecoder(meta);
+    } catch (const CiffParserException&) { // NOLINT(bugprone-empty-catch)
+      // Yes, just ignore the exception.
+    }
+    break;
+  case Format::CHDK:
+  case Format::Unknown:
+    break;
   }
 
   // Detect camera on filesize (CHDK).
@@ -97,4 +161,32 @@ std::unique_ptr<RawDecoder> RawParser::getDecoder(const CameraMetaData* meta) {
   ThrowRDE("No decoder found. Sorry.");
 }
 
+std::unique_ptr<RawDecoder>
+RawParser::getDecoderLazily(BlockCachedInput* input,
+                            const CameraMetaData* meta) {
+  assert(input);
+
+  const Buffer header = input->fetch(
+      0, std::min(input->getSize(), BlockCachedInput::BlockSize));
+
+  // Only the plain TIFF structure can be fetched piecewise.
+  if (probe(header) == Format::TIFF) {
+    TiffParser::fetchStructure(input);
+    try {
+      RawParser parser(input->getSparseBuffer());
+      auto decoder = parser.getDecoder(meta);
+      if (!decoder->fetchPayload(input))
+        input->fetchAll();
+      return decoder;
+    } catch (const RawspeedException&) { // NOLINT(bugprone-empty-catch)
+      // Something beyond the TIFF structure was needed after all,
+      // just fall back to fetching everything.
+    }
+  }
+
+  input->fetchAll();
+  RawParser parser(input->getBuffer());
+  return parser.getDecoder(meta);
+}
+
 } // namespace rawspeed
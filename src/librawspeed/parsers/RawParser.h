@@ -21,21 +21,47 @@
 #pragma once
 
 #include "io/Buffer.h"
+#include <cstdint>
 #include <memory>
 
 namespace rawspeed {
 
+class BlockCachedInput;
 class CameraMetaData;
 class RawDecoder;
 
 class RawParser {
 public:
+  // The container formats, as told apart by their header signature.
+  enum class Format : uint8_t {
+    Unknown, // Not a raw file, or not a supported one.
+    MRW,
+    FIFF,
+    TIFF,
+    CIFF,
+    CHDK, // Headerless, recognized by the file size only.
+  };
+
   explicit RawParser(Buffer inputData) : mInput(inputData) {}
   virtual ~RawParser() = default;
 
+  // Cheaply sniffs the format of the input, without any parsing.
+  // A non-Unknown result does not guarantee that the file will decode,
+  // but Unknown guarantees that getDecoder() would fail.
+  [[nodiscard]] static Format
+  probe(Buffer input, const CameraMetaData* meta = nullptr) noexcept;
+
   virtual std::unique_ptr<RawDecoder>
   getDecoder(const CameraMetaData* meta = nullptr);
 
+  // Same as getDecoder(), but only fetches the parts of the input that the
+  // decoder will need: the container structure, and then whatever the decoder
+  // reports via RawDecoder::fetchPayload(). If either is not known for the
+  // format at hand, the whole input is fetched.
+  static std::unique_ptr<RawDecoder>
+  getDecoderLazily(BlockCachedInput* input,
+                   const CameraMetaData* meta = nullptr);
+
 protected:
   Buffer mInput;
 };
@@ -22,7 +22,9 @@
 */
 
 #include "parsers/TiffParser.h"
+#include "adt/Casts.h"
 #include "adt/NORangesSet.h"
+#include "common/RawspeedException.h"
 #include "decoders/ArwDecoder.h"
 #include "decoders/Cr2Decoder.h"
 #include "decoders/DcrDecoder.h"
@@ -40,15 +42,18 @@
 #include "decoders/SrwDecoder.h"
 #include "decoders/StiDecoder.h"
 #include "decoders/ThreefrDecoder.h"
+#include "io/BlockCachedInput.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
 #include "parsers/RawParser.h"
 #include "parsers/TiffParserException.h"
 #include "tiff/TiffIFD.h"
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -64,6 +69,14 @@ std::unique_ptr<RawDecoder> TiffParser::getDecoder(const CameraMetaData* meta) {
 }
 
 TiffRootIFDOwner TiffParser::parse(TiffIFD* parent, Buffer data) {
+  NORangesSet<Buffer> ifds;
+  return parse(parent, data, &ifds);
+}
+
+TiffRootIFDOwner TiffParser::parse(TiffIFD* parent, Buffer data,
+                                   NORangesSet<Buffer>* ifds) {
+  assert(ifds);
+
   ByteStream bs(DataBuffer(data, Endianness::unknown));
   bs.setByteOrder(getTiffByteOrder(bs, 0, "TIFF header"));
   bs.skipBytes(2);
@@ -77,13 +90,11 @@ TiffRootIFDOwner TiffParser::parse(TiffIFD* parent, Buffer data) {
       parent, nullptr, bs,
       UINT32_MAX); // tell TiffIFD constructor not to parse bs as IFD
 
-  NORangesSet<Buffer> ifds;
-
   for (uint32_t IFDOffset = bs.getU32(); IFDOffset;
        IFDOffset = root->getSubIFDs().back()->getNextIFD()) {
     std::unique_ptr<TiffIFD> subIFD;
     try {
-      subIFD = std::make_unique<TiffIFD>(root.get(), &ifds, bs, IFDOffset);
+      subIFD = std::make_unique<TiffIFD>(root.get(), ifds, bs, IFDOffset);
     } catch (const TiffParserException&) {
       // This IFD may fail to parse, in which case exit the loop,
       // because the offset to the next IFD is last 4 bytes of an IFD,
@@ -98,6 +109,48 @@ TiffRootIFDOwner TiffParser::parse(TiffIFD* parent, Buffer data) {
   return root;
 }
 
+void TiffParser::fetchStructure(BlockCachedInput* input) {
+  assert(input);
+
+  const Buffer file = input->getSparseBuffer();
+  const auto fetch = [input, file](Buffer range) {
+    const auto* const begin = range.begin();
+    if (range.getSize() == 0 || std::less<>()(begin, file.begin()) ||
+        std::less<>()(file.end(), range.end()))
+      return; // Not a part of the file, e.g. a decrypted copy.
+    (void)input->fetch(implicit_cast<Buffer::size_type>(begin - file.begin()),
+                       range.getSize());
+  };
+  const auto fetchEntries = [fetch](const TiffIFD* ifd, auto& self) -> void {
+    for (const auto& entry : ifd->entries)
+      fetch(entry.second->getData());
+    for (const auto& subIFD : ifd->subIFDs)
+      self(subIFD.get(), self);
+  };
+
+  (void)input->fetch(0, std::min(file.getSize(), BlockCachedInput::BlockSize));
+
+  // Parsing of the partially-fetched file discovers further IFD's and entries,
+  // so we have to keep going until nothing new needs to be fetched.
+  // The bytes that were not fetched yet read as zeros, so an IFD that is not
+  // resident yet merely looks empty. Each parse is only used to find out
+  // what to fetch next.
+  for (int numFetchedBlocks = -1;
+       numFetchedBlocks != input->getNumFetchedBlocks();) {
+    numFetchedBlocks = input->getNumFetchedBlocks();
+
+    NORangesSet<Buffer> ifds;
+    try {
+      const TiffRootIFDOwner root = parse(nullptr, file, &ifds);
+      fetchEntries(root.get(), fetchEntries);
+    } catch (const RawspeedException&) { // NOLINT(bugprone-empty-catch)
+      // The IFD's that were found before the failure still need to be fetched.
+    }
+    for (const Buffer& ifd : ifds)
+      fetch(ifd);
+  }
+}
+
 std::unique_ptr<RawDecoder> TiffParser::makeDecoder(TiffRootIFDOwner root,
                                                     Buffer data) {
   if (!root)
@@ -30,11 +30,16 @@
 
 namespace rawspeed {
 
+class BlockCachedInput;
 class Buffer;
 class CameraMetaData;
 class RawDecoder;
+template <typename T> class NORangesSet;
 
 class TiffParser final : public RawParser {
+  static TiffRootIFDOwner parse(TiffIFD* parent, Buffer data,
+                                NORangesSet<Buffer>* ifds);
+
 public:
   explicit TiffParser(Buffer file);
 
@@ -45,6 +50,10 @@ public:
   // may be deleted immediately
   static TiffRootIFDOwner parse(TiffIFD* parent, Buffer data);
 
+  // Fetches all the IFD's, and the data of all of their entries,
+  // but not the image data referenced by the entries.
+  static void fetchStructure(BlockCachedInput* input);
+
   // transfers ownership of TiffIFD into RawDecoder
   static std::unique_ptr<RawDecoder> makeDecoder(TiffRootIFDOwner root,
                                                  Buffer data);
@@ -0,0 +1,64 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "RawSpeed-API.h"
+#include "adt/Array1DRef.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using rawspeed::CameraMetaData;
+using rawspeed::CompiledCameraMetaData;
+using rawspeed::RawspeedException;
+
+int main(int argc_, char* argv_[]) {
+  auto argv = rawspeed::Array1DRef(argv_, argc_);
+
+  if (argv.size() != 3) {
+    fprintf(stderr, "Usage: %s <cameras.xml> <cameras.bin>\n", argv(0));
+    return 1;
+  }
+
+  std::vector<uint8_t> blob;
+  try {
+    const CameraMetaData meta(argv(1));
+    blob = CompiledCameraMetaData::compile(meta);
+    // Make sure that the result can actually be loaded back.
+    (void)CompiledCameraMetaData(rawspeed::Buffer(
+        blob.data(), rawspeed::implicit_cast<rawspeed::Buffer::size_type>(
+                         blob.size())));
+  } catch (const RawspeedException& e) {
+    fprintf(stderr, "ERROR: [rawspeed] %s\n", e.what());
+    return 2;
+  }
+
+  FILE* out = fopen(argv(2), "wb");
+  if (!out) {
+    fprintf(stderr, "ERROR: could not open \"%s\" for writing\n", argv(2));
+    return 2;
+  }
+  const bool ok = fwrite(blob.data(), 1, blob.size(), out) == blob.size();
+  if (fclose(out) != 0 || !ok) {
+    fprintf(stderr, "ERROR: could not write \"%s\"\n", argv(2));
+    return 2;
+  }
+
+  return 0;
+}
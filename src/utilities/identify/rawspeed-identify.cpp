@@ -144,7 +144,7 @@ int main(int argc_, char* argv_[]) {
 
     FileReader f(argv(1));
 
-    auto [storage, buf] = f.readFile();
+    auto [storage, buf] = f.mapFile();
 
     RawParser t(buf);
 
@@ -0,0 +1,155 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "RawSpeed-API.h"
+#include "adt/Array1DRef.h"
+#include "common/ChecksumFile.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using rawspeed::BatchDecoder;
+using rawspeed::CameraMetaData;
+using rawspeed::ThreadPool;
+using std::cerr;
+using std::cout;
+
+namespace rawspeed::rsbatch {
+
+namespace {
+
+int usage(const char* progname) {
+  cout << "usage: " << progname << R"(
+  [-h] print this help
+  [-j <N>] use N threads (default: one per hardware thread)
+  [-q <N>] capacity of each of the queues between the stages
+           (default: twice the number of threads)
+  [-r <DIR>] also decode all the files listed in DIR/filelist.sha1
+  <FILE[S]> the file[s] to decode.
+
+  Decodes all the files through the BatchDecoder pipeline,
+  and reports the end-to-end throughput.
+)";
+  return 0;
+}
+
+} // namespace
+
+} // namespace rawspeed::rsbatch
+
+using rawspeed::rsbatch::usage;
+
+int main(int argc_, char** argv_) {
+  auto argv = rawspeed::Array1DRef(argv_, argc_);
+
+  // Returns the value of the option, and removes both from the argv.
+  auto getOption = [argv](std::string_view flag) -> const char* {
+    const char* value = nullptr;
+    for (int i = 1; i + 1 < argv.size(); ++i) {
+      if (!argv(i) || argv(i) != flag)
+        continue;
+      value = argv(i + 1);
+      argv(i) = nullptr;
+      argv(i + 1) = nullptr;
+    }
+    return value;
+  };
+  auto hasFlag = [argv](std::string_view flag) {
+    bool found = false;
+    for (int i = 1; i < argv.size(); ++i) {
+      if (!argv(i) || argv(i) != flag)
+        continue;
+      found = true;
+      argv(i) = nullptr;
+    }
+    return found;
+  };
+
+  if (1 == argv.size() || hasFlag("-h"))
+    return usage(argv(0));
+
+  BatchDecoder::Options options;
+  int threads = 0;
+  if (const char* j = getOption("-j"))
+    threads = std::atoi(j);
+  if (const char* q = getOption("-q"))
+    options.queueDepth = std::atoi(q);
+  const char* repo = getOption("-r");
+
+#ifdef HAVE_PUGIXML
+  const CameraMetaData metadata(RAWSPEED_SOURCE_DIR "/data/cameras.xml");
+#else
+  const CameraMetaData metadata{};
+#endif
+
+  auto pool = std::make_shared<ThreadPool>(threads);
+
+  std::mutex ioMutex;
+  std::atomic<int> numDecoded = 0;
+  std::atomic<int> numFailed = 0;
+  std::atomic<int64_t> numPixels = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    BatchDecoder batch(
+        &metadata, pool,
+        [&](BatchDecoder::Result r) {
+          if (!r.image) {
+            ++numFailed;
+            std::scoped_lock lock(ioMutex);
+            cerr << r.name << " failed: " << r.error << '\n';
+            return;
+          }
+          ++numDecoded;
+          numPixels += (*r.image)->getUncroppedDim().area();
+        },
+        options);
+
+    if (repo) {
+      for (const rawspeed::ChecksumFileEntry& e :
+           rawspeed::ReadChecksumFile(repo))
+        batch.submit(e.FullFileName);
+    }
+    for (int i = 1; i < argv.size(); ++i) {
+      if (argv(i))
+        batch.submit(argv(i));
+    }
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  const double seconds = elapsed.count();
+  cout << "Decoded " << numDecoded << " files (" << numFailed
+       << " failed) with " << pool->getNumThreads() << " threads in "
+       << seconds << "s\n";
+  if (seconds > 0) {
+    cout << (numDecoded + numFailed) / seconds << " files/s, "
+         << static_cast<double>(numPixels) / 1e6 / seconds << " MPix/s\n";
+  }
+
+  return numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
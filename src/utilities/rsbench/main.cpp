@@ -19,10 +19,8 @@
 */
 
 #include "RawSpeed-API.h"
-#include "adt/AlignedAllocator.h"
 #include "adt/Array1DRef.h"
 #include "adt/Casts.h"
-#include "adt/DefaultInitAllocatorAdaptor.h"
 #include "common/ChecksumFile.h"
 #include <chrono>
 #include <cstdint>
@@ -110,10 +108,7 @@ struct Timer final {
 // requested the first time.
 struct Entry final {
   rawspeed::ChecksumFileEntry Name;
-  std::unique_ptr<std::vector<
-      uint8_t, rawspeed::DefaultInitAllocatorAdaptor<
-                   uint8_t, rawspeed::AlignedAllocator<uint8_t, 16>>>>
-      Storage;
+  std::unique_ptr<rawspeed::FileMapping> Storage;
   rawspeed::Buffer Content;
 
   const rawspeed::Buffer& getFileContents() {
@@ -121,7 +116,7 @@ struct Entry final {
       return Content;
 
     std::tie(Storage, Content) =
-        FileReader(Name.FullFileName.c_str()).readFile();
+        FileReader(Name.FullFileName.c_str()).mapFile();
     return Content;
   }
 };
@@ -19,11 +19,9 @@
 */
 
 #include "RawSpeed-API.h"
-#include "adt/AlignedAllocator.h"
 #include "adt/Array1DRef.h"
 #include "adt/Array2DRef.h"
 #include "adt/Casts.h"
-#include "adt/DefaultInitAllocatorAdaptor.h"
 #include "adt/NotARational.h"
 #include "md5.h"
 #include <array>
@@ -251,8 +249,12 @@ std::string img_hash(const RawImage& r, bool noSamples) {
   APPEND(&oss, "badPixelPositions: ");
   {
     MutexLocker guard(&r->mBadPixelMutex);
-    for (uint32_t p : r->mBadPixelPositions)
-      APPEND(&oss, "%u, ", p);
+    // In the historical `x | (y << 16)` form, to keep the hashes stable.
+    for (const rawspeed::iPoint2D& p : r->mBadPixelPositions) {
+      APPEND(&oss, "%llu, ",
+             (static_cast<unsigned long long>(p.y) << 16U) |
+                 static_cast<unsigned long long>(p.x));
+    }
   }
 
   APPEND(&oss, "\n");
@@ -388,12 +390,9 @@ int64_t process(const std::string& filename, const CameraMetaData* metadata,
 
   FileReader reader(filename.c_str());
 
-  std::unique_ptr<std::vector<
-      uint8_t, rawspeed::DefaultInitAllocatorAdaptor<
-                   uint8_t, rawspeed::AlignedAllocator<uint8_t, 16>>>>
-      storage;
+  std::unique_ptr<rawspeed::FileMapping> storage;
   rawspeed::Buffer buf;
-  std::tie(storage, buf) = reader.readFile();
+  std::tie(storage, buf) = reader.mapFile();
 
   Timer t;
 
@@ -102,4 +102,34 @@ TEST(VariableLengthLoadTest, Exhaustive) {
   }
 }
 
+TEST(VariableLengthLoadTest, FromPaddedMatches) {
+  static constexpr int MaxBytes = 64;
+  static constexpr int Padding = 8;
+
+  for (int numInputBytes = 1; numInputBytes <= MaxBytes; ++numInputBytes) {
+    // The padding bytes are garbage, they must not be observed.
+    std::vector<unsigned char> inputStorage(numInputBytes + Padding, 0xFF);
+    auto input = Array1DRef(inputStorage.data(), numInputBytes);
+    std::iota(input.begin(), input.end(), 1);
+
+    for (int numOutputBytes = 1; numOutputBytes <= 8; numOutputBytes *= 2) {
+      for (int inPos = 0; inPos + numOutputBytes <= numInputBytes + Padding;
+           ++inPos) {
+        std::vector<unsigned char> outputReferenceStorage(numOutputBytes);
+        auto outputReference =
+            Array1DRef(outputReferenceStorage.data(), numOutputBytes);
+        variableLengthLoadNaiveViaConditionalLoad(
+            outputReference, Array1DRef<const unsigned char>(input), inPos);
+
+        std::vector<unsigned char> outputStorage(numOutputBytes);
+        auto output = Array1DRef(outputStorage.data(), numOutputBytes);
+        variableLengthLoadFromPadded(
+            output, Array1DRef<const unsigned char>(input), inPos);
+
+        EXPECT_THAT(output, testing::ContainerEq(outputReference));
+      }
+    }
+  }
+}
+
 } // namespace rawpeed_test
@@ -19,12 +19,18 @@
 */
 
 #include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "bitstreams/BitStream.h"
+#include "bitstreams/BitStreamer.h"
 #include "io/Buffer.h"
 #include "io/ByteStream.h"
 #include "io/Endianness.h"
+#include "io/IOException.h"
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <type_traits>
+#include <vector>
 #include <gtest/gtest.h>
 
 using rawspeed::Buffer;
@@ -164,9 +170,83 @@ TYPED_TEST_P(BitStreamerTest, IncreasingPeekLengthNoFillTest) {
       TypeParam::PatternT::Data, TypeParam::PatternT::data);
 }
 
+TYPED_TEST_P(BitStreamerTest, TailPaddingIsNotObservable) {
+  using PumpT = typename TypeParam::PumpT;
+  const auto& data = TypeParam::PatternT::Data;
+  const auto size = rawspeed::implicit_cast<int>(data.size());
+
+  // The padding is garbage, and must neither be read, nor prevent detecting
+  // the reads past the end of the input.
+  static constexpr int Padding = 64;
+  std::vector<uint8_t> padded(data.begin(), data.end());
+  padded.resize(data.size() + Padding, uint8_t(~0U));
+
+  PumpT pump(rawspeed::Array1DRef<const uint8_t>(data.data(), size));
+  PumpT paddedPump(rawspeed::Array1DRef<const uint8_t>(padded.data(), size),
+                   Padding);
+  for (bool done = false; !done;) {
+    uint32_t bits = 0;
+    uint32_t paddedBits = 0;
+    bool threw = false;
+    bool paddedThrew = false;
+    try {
+      bits = pump.getBits(7);
+    } catch (const rawspeed::IOException&) {
+      threw = true;
+    }
+    try {
+      paddedBits = paddedPump.getBits(7);
+    } catch (const rawspeed::IOException&) {
+      paddedThrew = true;
+    }
+    ASSERT_EQ(paddedThrew, threw);
+    ASSERT_EQ(paddedBits, bits);
+    done = threw;
+  }
+}
+
+TYPED_TEST_P(BitStreamerTest, WideRefillMatchesFill) {
+  using PumpT = typename TypeParam::PumpT;
+  if constexpr (!rawspeed::BitStreamerTraits<PumpT>::canUseWideRefill) {
+    GTEST_SKIP() << "The stream does not support the wide refill";
+  } else {
+    uint32_t seed = 42;
+    auto rng = [&seed]() {
+      seed = (seed * 1103515245U) + 12345U;
+      return seed >> 16U;
+    };
+
+    std::vector<uint8_t> data(256);
+    for (auto& byte : data)
+      byte = rawspeed::implicit_cast<uint8_t>(rng());
+    const rawspeed::Array1DRef<const uint8_t> input(
+        data.data(), rawspeed::implicit_cast<int>(data.size()));
+
+    // Are the first bits of the stream the high bits of the value?
+    constexpr bool highBitsFirst =
+        std::is_same_v<typename PumpT::Cache,
+                       rawspeed::BitStreamCacheRightInLeftOut>;
+
+    PumpT pump(input);
+    PumpT widePump(input);
+    while (widePump.getStreamPosition() < 200) {
+      const int len = 1 + rawspeed::implicit_cast<int>(
+                              rng() % PumpT::Cache::MaxWideGetBits);
+      widePump.fillWide(len);
+      const uint64_t bits = widePump.getBitsNoFillWide(len);
+      for (int i = 0; i != len; ++i) {
+        const int bitPos = highBitsFirst ? len - 1 - i : i;
+        ASSERT_EQ(pump.getBits(1), (bits >> bitPos) & 1U);
+      }
+      ASSERT_EQ(widePump.getStreamPosition(), pump.getStreamPosition());
+    }
+  }
+}
+
 REGISTER_TYPED_TEST_SUITE_P(BitStreamerTest, GetTest, GetNoFillTest, PeekTest,
                             PeekNoFillTest, IncreasingPeekLengthTest,
-                            IncreasingPeekLengthNoFillTest);
+                            IncreasingPeekLengthNoFillTest,
+                            TailPaddingIsNotObservable, WideRefillMatchesFill);
 
 template <typename Pump, typename PatternTag> struct Pattern final {};
 
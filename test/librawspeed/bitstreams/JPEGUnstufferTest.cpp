@@ -0,0 +1,156 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "bitstreams/JPEGUnstuffer.h"
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "bitstreams/BitStreamerJPEG.h"
+#include "bitstreams/BitStreamerMSB.h"
+#include "common/CpuFeatures.h"
+#include "common/CpuIsaDeathTest.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::BitStreamerJPEG;
+using rawspeed::BitStreamerMSB;
+using rawspeed::CpuIsa;
+using rawspeed::implicit_cast;
+using rawspeed::JPEGUnstuffer;
+using rawspeed::UnstuffedJPEGSegment;
+
+namespace rawspeed_test {
+
+namespace {
+
+Array1DRef<const uint8_t> getInput(const std::vector<uint8_t>& data) {
+  return {data.data(), implicit_cast<int>(data.size())};
+}
+
+std::vector<uint8_t> getBytes(const UnstuffedJPEGSegment& segment) {
+  const int numBytes = segment.bytes.size() - JPEGUnstuffer::Padding;
+  return {segment.bytes.begin(), segment.bytes.begin() + numBytes};
+}
+
+TEST(JPEGUnstufferTest, StuffingIsRemoved) {
+  const std::vector<uint8_t> data = {0x01, 0xFF, 0x00, 0x02, 0xFF,
+                                     0x00, 0xFF, 0x00, 0x03};
+  JPEGUnstuffer unstuffer;
+  const UnstuffedJPEGSegment segment = unstuffer.unstuff(getInput(data));
+  EXPECT_EQ(getBytes(segment),
+            (std::vector<uint8_t>{0x01, 0xFF, 0x02, 0xFF, 0xFF, 0x03}));
+  EXPECT_EQ(segment.streamPosition, implicit_cast<int>(data.size()));
+}
+
+TEST(JPEGUnstufferTest, StopsAtMarker) {
+  const std::vector<uint8_t> data = {0x01, 0xFF, 0x00, 0x02,
+                                     0xFF, 0xD0, 0x03, 0x04};
+  JPEGUnstuffer unstuffer;
+  const UnstuffedJPEGSegment segment = unstuffer.unstuff(getInput(data));
+  EXPECT_EQ(getBytes(segment), (std::vector<uint8_t>{0x01, 0xFF, 0x02}));
+  EXPECT_EQ(segment.streamPosition, 4);
+  EXPECT_EQ(JPEGUnstuffer::findMarker(getInput(data)), 4);
+}
+
+TEST(JPEGUnstufferTest, TrailingFFIsData) {
+  const std::vector<uint8_t> data = {0x01, 0x02, 0xFF};
+  JPEGUnstuffer unstuffer;
+  const UnstuffedJPEGSegment segment = unstuffer.unstuff(getInput(data));
+  EXPECT_EQ(getBytes(segment), data);
+  EXPECT_EQ(segment.streamPosition, implicit_cast<int>(data.size()));
+}
+
+TEST(JPEGUnstufferTest, IsZeroPadded) {
+  JPEGUnstuffer unstuffer;
+  // Leave garbage in the storage first.
+  const std::vector<uint8_t> garbage(256, 0xAB);
+  (void)unstuffer.unstuff(getInput(garbage));
+
+  const std::vector<uint8_t> data = {0x01, 0xFF, 0xD9};
+  const UnstuffedJPEGSegment segment = unstuffer.unstuff(getInput(data));
+  ASSERT_EQ(segment.bytes.size(), 1 + JPEGUnstuffer::Padding);
+  for (int i = 1; i != segment.bytes.size(); ++i)
+    EXPECT_EQ(segment.bytes(i), 0);
+}
+
+// Random streams with the given density of the 0xFF bytes, of which
+// markers are a given fraction.
+int countMismatches(unsigned ffPerMille, unsigned markersPerMille) {
+  uint32_t seed = 42;
+  auto rng = [&seed]() {
+    seed = (seed * 1103515245U) + 12345U;
+    return seed >> 16U;
+  };
+
+  int mismatches = 0;
+  JPEGUnstuffer unstuffer;
+  for (int iter = 0; iter != 256; ++iter) {
+    std::vector<uint8_t> data(8 + (rng() % 512));
+    for (int i = 0; i != implicit_cast<int>(data.size()); ++i) {
+      if (rng() % 1000 >= ffPerMille) {
+        data[i] = implicit_cast<uint8_t>(rng() % 0xFF);
+        continue;
+      }
+      data[i] = 0xFF;
+      if (i + 1 == implicit_cast<int>(data.size()))
+        break;
+      ++i;
+      data[i] = rng() % 1000 >= markersPerMille
+                    ? 0x00
+                    : implicit_cast<uint8_t>(1 + (rng() % 0xFF));
+    }
+
+    const UnstuffedJPEGSegment segment = unstuffer.unstuff(getInput(data));
+    BitStreamerJPEG ref(getInput(data));
+    BitStreamerMSB bs(segment.bytes);
+    // Also read some of the zeros past the end of the segment.
+    const int numBytes = segment.bytes.size() - JPEGUnstuffer::Padding;
+    for (int i = 0; i != numBytes + 8; ++i)
+      mismatches += ref.getBits(8) != bs.getBits(8);
+    const bool sawMarker =
+        segment.streamPosition != implicit_cast<int>(data.size());
+    if (sawMarker)
+      mismatches += ref.getStreamPosition() != segment.streamPosition;
+    mismatches +=
+        JPEGUnstuffer::findMarker(getInput(data)) != segment.streamPosition;
+  }
+  return mismatches;
+}
+
+class JPEGUnstufferDeathTest : public CpuIsaDeathTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, JPEGUnstufferDeathTest,
+                         ::testing::Values(CpuIsa::Generic, CpuIsa::AVX2));
+
+} // namespace
+
+TEST_P(JPEGUnstufferDeathTest, MatchesBitStreamerJPEG) {
+  for (const auto& [ffPerMille, markersPerMille] :
+       {std::pair(5U, 0U), std::pair(5U, 100U), std::pair(100U, 20U),
+        std::pair(500U, 5U), std::pair(1000U, 0U)}) {
+    runWithIsa([ffPerMille, markersPerMille]() {
+      return countMismatches(ffPerMille, markersPerMille);
+    });
+  }
+}
+
+} // namespace rawspeed_test
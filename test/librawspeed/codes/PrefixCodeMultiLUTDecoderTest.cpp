@@ -0,0 +1,163 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "codes/PrefixCodeMultiLUTDecoder.h"
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "bitstreams/BitStreamerMSB.h"
+#include "codes/AbstractPrefixCode.h"
+#include "codes/HuffmanCode.h"
+#include "codes/PrefixCodeDecoder.h"
+#include "codes/PrefixCodeLookupDecoder.h"
+#include "io/Buffer.h"
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::BaselineCodeTag;
+using rawspeed::BitStreamerMSB;
+
+namespace rawspeed_test {
+
+namespace {
+
+using MultiLUTDecoder = rawspeed::PrefixCodeMultiLUTDecoder<
+    BaselineCodeTag, rawspeed::PrefixCodeLookupDecoder<BaselineCodeTag>>;
+
+rawspeed::HuffmanCode<BaselineCodeTag>
+genCode(std::vector<uint8_t> nCodesPerLength,
+        const std::vector<uint8_t>& codeValues) {
+  rawspeed::HuffmanCode<BaselineCodeTag> hc;
+
+  nCodesPerLength.resize(16);
+  hc.setNCodesPerLength(rawspeed::Buffer(
+      nCodesPerLength.data(),
+      rawspeed::implicit_cast<rawspeed::Buffer::size_type>(
+          nCodesPerLength.size())));
+  hc.setCodeValues(rawspeed::Array1DRef<const uint8_t>(
+      codeValues.data(), rawspeed::implicit_cast<int>(codeValues.size())));
+
+  return hc;
+}
+
+BitStreamerMSB getBits(const std::vector<uint8_t>& data) {
+  const auto size = rawspeed::implicit_cast<int>(data.size());
+  return BitStreamerMSB(rawspeed::Array1DRef(data.data(), size));
+}
+
+TEST(PrefixCodeMultiLUTDecoderTest, SeveralSymbolsPerLookup) {
+  // Codes: 00 -> 1-bit diff, 01 -> 2-bit diff.
+  auto code = genCode({0, 2}, {1, 2});
+  MultiLUTDecoder ht(std::move(code));
+  ht.setup(/*fullDecode=*/true, /*fixDNGBug16=*/false);
+
+  // 00|1, 01|10, 00|0, followed by zeros.
+  std::vector<uint8_t> data(16);
+  data[0] = 0b00101100;
+  data[1] = 0b00000000;
+  auto bits = getBits(data);
+
+  std::array<int, MultiLUTDecoder::MaxSymbolsPerLookup> diffs;
+  ASSERT_EQ(ht.decodeDifferences(bits, diffs), 3);
+  EXPECT_EQ(diffs[0], 1);
+  EXPECT_EQ(diffs[1], 2);
+  EXPECT_EQ(diffs[2], -1);
+  ASSERT_EQ(ht.decodeDifferences(bits, diffs), 3);
+  EXPECT_EQ(diffs, (std::array<int, 3>{-1, -1, -1}));
+}
+
+TEST(PrefixCodeMultiLUTDecoderTest, LongCodeFallsBack) {
+  // The 12-bit code does not fit into the lookup at all.
+  auto code = genCode({1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}, {0, 3});
+  MultiLUTDecoder ht(std::move(code));
+  ht.setup(/*fullDecode=*/true, /*fixDNGBug16=*/false);
+
+  // 100000000000|011, 0, 0, ...
+  std::vector<uint8_t> data(16);
+  data[0] = 0b10000000;
+  data[1] = 0b00000110;
+  auto bits = getBits(data);
+
+  std::array<int, MultiLUTDecoder::MaxSymbolsPerLookup> diffs;
+  ASSERT_EQ(ht.decodeDifferences(bits, diffs), 1);
+  EXPECT_EQ(diffs[0], -4);
+  ASSERT_EQ(ht.decodeDifferences(bits, diffs), 3);
+  EXPECT_EQ(diffs, (std::array<int, 3>{0, 0, 0}));
+}
+
+template <unsigned LookupDepth> void checkMatchesSingleSymbolDecoding() {
+  using Decoder = rawspeed::PrefixCodeMultiLUTDecoder<
+      BaselineCodeTag, rawspeed::PrefixCodeLookupDecoder<BaselineCodeTag>,
+      LookupDepth>;
+
+  uint32_t seed = 42;
+  auto rng = [&seed]() {
+    seed = (seed * 1103515245U) + 12345U;
+    return seed >> 16U;
+  };
+
+  int numLookups = 0;
+  int numSymbols = 0;
+  for (int iter = 0; iter != 64; ++iter) {
+    // A complete code with short codes and mostly short differences.
+    const std::vector<uint8_t> nCodesPerLength = {0, 1, 2, 4, 8};
+    std::vector<uint8_t> codeValues;
+    for (int i = 0; i != 15; ++i) {
+      codeValues.push_back(
+          rawspeed::implicit_cast<uint8_t>(i < 13 ? rng() % 7 : rng() % 17));
+    }
+    const bool fixDNGBug16 = iter % 2;
+
+    Decoder ht(genCode(nCodesPerLength, codeValues));
+    ht.setup(/*fullDecode=*/true, fixDNGBug16);
+    rawspeed::PrefixCodeDecoder<> ref(genCode(nCodesPerLength, codeValues));
+    ref.setup(/*fullDecode=*/true, fixDNGBug16);
+
+    std::vector<uint8_t> data(4096);
+    for (auto& byte : data)
+      byte = rawspeed::implicit_cast<uint8_t>(rng());
+    auto bits = getBits(data);
+    auto refBits = getBits(data);
+
+    while (bits.getInputPosition() < 4000) {
+      std::array<int, Decoder::MaxSymbolsPerLookup> diffs;
+      const int num = ht.decodeDifferences(bits, diffs);
+      ASSERT_GE(num, 1);
+      for (int i = 0; i != num; ++i)
+        ASSERT_EQ(diffs[i], ref.decodeDifference(refBits));
+      ASSERT_EQ(bits.getStreamPosition(), refBits.getStreamPosition());
+      ++numLookups;
+      numSymbols += num;
+    }
+  }
+  EXPECT_GT(numSymbols, numLookups);
+}
+
+TEST(PrefixCodeMultiLUTDecoderTest, MatchesSingleSymbolDecoding) {
+  checkMatchesSingleSymbolDecoding<9>();
+  checkMatchesSingleSymbolDecoding<11>();
+  checkMatchesSingleSymbolDecoding<14>();
+}
+
+} // namespace
+
+} // namespace rawspeed_test
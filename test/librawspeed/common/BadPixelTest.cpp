@@ -0,0 +1,109 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "adt/Array2DRef.h"
+#include "adt/Mutex.h"
+#include "adt/Point.h"
+#include "common/RawImage.h"
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::iPoint2D;
+using rawspeed::MutexLocker;
+using rawspeed::RawImage;
+
+namespace rawspeed_test {
+
+namespace {
+
+constexpr uint16_t goodValue = 1000;
+
+RawImage createImage(const iPoint2D& dim) {
+  RawImage img = RawImage::create(dim);
+  const auto out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y < out.height(); y++) {
+    for (int x = 0; x < out.width(); x++)
+      out(y, x) = goodValue;
+  }
+  return img;
+}
+
+void markBad(const RawImage& img, const std::vector<iPoint2D>& positions) {
+  const auto out = img->getU16DataAsUncroppedArray2DRef();
+  MutexLocker guard(&img->mBadPixelMutex);
+  for (const iPoint2D& pos : positions) {
+    out(pos.y, pos.x) = 0;
+    img->mBadPixelPositions.emplace_back(pos);
+  }
+}
+
+} // namespace
+
+TEST(BadPixelTest, WordBoundaries) {
+  const RawImage img = createImage({200, 6});
+  const std::vector<iPoint2D> bad = {{0, 0},  {63, 1},  {64, 1},
+                                     {65, 2}, {127, 3}, {128, 3},
+                                     {191, 2}};
+  markBad(img, bad);
+
+  img->transferBadPixelsToMap();
+  for (const iPoint2D& pos : bad)
+    EXPECT_TRUE(img->isBadPixel(pos.x, pos.y));
+  EXPECT_FALSE(img->isBadPixel(1, 0));
+  EXPECT_FALSE(img->isBadPixel(62, 1));
+
+  img->fixBadPixels();
+  const auto out = img->getU16DataAsUncroppedArray2DRef();
+  for (const iPoint2D& pos : bad)
+    EXPECT_EQ(out(pos.y, pos.x), goodValue);
+}
+
+TEST(BadPixelTest, WidestImage) {
+  const RawImage img = createImage({65535, 5});
+  const std::vector<iPoint2D> bad = {{65471, 2}, {65472, 2}, {65532, 1}};
+  markBad(img, bad);
+
+  img->fixBadPixels();
+  const auto out = img->getU16DataAsUncroppedArray2DRef();
+  for (const iPoint2D& pos : bad)
+    EXPECT_EQ(out(pos.y, pos.x), goodValue);
+}
+
+TEST(BadPixelTest, ManyDefects) {
+  const RawImage img = createImage({512, 64});
+  std::vector<iPoint2D> bad;
+  // NOTE: the interpolation is known to be off next to the right and bottom
+  // edges of the image, so those are avoided.
+  for (int y = 0; y < 62; y += 3) {
+    for (int x = y % 5; x < 510; x += 7)
+      bad.emplace_back(x, y);
+  }
+  markBad(img, bad);
+
+  img->fixBadPixels();
+  const auto out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y < 64; y++) {
+    for (int x = 0; x < 512; x++)
+      ASSERT_EQ(out(y, x), goodValue) << "at " << x << ", " << y;
+  }
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,120 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "adt/Array2DRef.h"
+#include "adt/Point.h"
+#include "common/RawImage.h"
+#include "metadata/BlackArea.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array2DRef;
+using rawspeed::BlackArea;
+using rawspeed::iPoint2D;
+using rawspeed::iRectangle2D;
+using rawspeed::RawImage;
+
+namespace rawspeed_test {
+
+namespace {
+
+RawImage createImage() {
+  RawImage img = RawImage::create(iPoint2D(48, 24));
+  const auto out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y < out.height(); y++) {
+    for (int x = 0; x < out.width(); x++)
+      out(y, x) = 500 + (7 * (((31 * y) + (17 * x)) % 23));
+  }
+  // Odd crop offsets, so that the CFA phase of the crop matters.
+  img->subFrame(iRectangle2D(iPoint2D(5, 3), iPoint2D(40, 19)));
+  return img;
+}
+
+// A straight-forward per-pixel reimplementation of calculateBlackAreas().
+std::array<int, 4> referenceBlackLevels(const RawImage& raw) {
+  const auto img = raw->getU16DataAsUncroppedArray2DRef();
+  const iPoint2D off = raw->getCropOffset();
+  const iPoint2D dim = raw->dim;
+
+  std::vector<std::vector<int>> histogram(4, std::vector<int>(65536, 0));
+  int totalpixels = 0;
+  for (auto area : raw->blackAreas) {
+    area.size = area.size - (area.size & 1);
+    if (!area.isVertical) {
+      for (int y = area.offset; y < static_cast<int>(area.offset + area.size);
+           y++) {
+        for (int x = off.x; x < off.x + dim.x; x++)
+          histogram[(2 * (y & 1)) + (x & 1)][img(y, off.x)]++;
+      }
+      totalpixels += area.size * dim.x;
+    } else {
+      for (int y = off.y; y < off.y + dim.y; y++) {
+        for (int x = area.offset; x < static_cast<int>(area.offset + area.size);
+             x++)
+          histogram[(2 * (y & 1)) + (x & 1)][img(y, area.offset)]++;
+      }
+      totalpixels += area.size * dim.y;
+    }
+  }
+
+  totalpixels /= 4 * 2;
+  std::array<int, 4> levels;
+  for (int i = 0; i < 4; i++) {
+    int acc = histogram[i][0];
+    int v = 0;
+    while (acc <= totalpixels && v < 65535)
+      acc += histogram[i][++v];
+    levels[i] = v;
+  }
+  return levels;
+}
+
+void check(const std::vector<BlackArea>& areas) {
+  RawImage img = createImage();
+  img->blackAreas = areas;
+  const std::array<int, 4> expected = referenceBlackLevels(img);
+  img->calculateBlackAreas();
+  ASSERT_TRUE(img->blackLevelSeparate);
+  const Array2DRef<int> levels = *img->blackLevelSeparate;
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(levels(i / 2, i % 2), expected[i]) << "component " << i;
+}
+
+} // namespace
+
+TEST(BlackAreasTest, OddWidthVerticalArea) {
+  check({BlackArea(3, 5, /*isVertical=*/true)});
+  check({BlackArea(2, 5, /*isVertical=*/true)});
+}
+
+TEST(BlackAreasTest, OddHeightHorizontalArea) {
+  check({BlackArea(1, 3, /*isVertical=*/false)});
+}
+
+TEST(BlackAreasTest, MixedAreas) {
+  check({BlackArea(3, 5, /*isVertical=*/true),
+         BlackArea(44, 2, /*isVertical=*/true),
+         BlackArea(1, 3, /*isVertical=*/false),
+         BlackArea(22, 2, /*isVertical=*/false)});
+}
+
+} // namespace rawspeed_test
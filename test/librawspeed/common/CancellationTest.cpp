@@ -0,0 +1,90 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "common/Cancellation.h"
+#include "adt/Point.h"
+#include "common/RawImage.h"
+#include "decompressors/SonyArw2Decompressor.h"
+#include "io/Buffer.h"
+#include "io/ByteStream.h"
+#include "io/Endianness.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::CancellationToken;
+using rawspeed::DecodeCancelledException;
+using rawspeed::RawImage;
+
+namespace rawspeed_test {
+
+TEST(CancellationTokenTest, Cancel) {
+  CancellationToken token;
+  ASSERT_FALSE(token.isCancelled());
+  ASSERT_NO_THROW(token.check());
+  token.cancel();
+  ASSERT_TRUE(token.isCancelled());
+  ASSERT_THROW(token.check(), DecodeCancelledException);
+}
+
+TEST(CancellationTokenTest, Deadline) {
+  CancellationToken token;
+  token.setTimeout(std::chrono::hours(1));
+  ASSERT_FALSE(token.isCancelled());
+  token.setDeadline(CancellationToken::Clock::now());
+  ASSERT_TRUE(token.isCancelled());
+  // It stays cancelled even if the deadline is moved afterwards.
+  token.setTimeout(std::chrono::hours(1));
+  ASSERT_TRUE(token.isCancelled());
+}
+
+TEST(CancellationTokenTest, RawImage) {
+  RawImage img = RawImage::create();
+  ASSERT_FALSE(img->isCancelled());
+  ASSERT_NO_THROW(img->checkCancelled());
+
+  auto token = std::make_shared<CancellationToken>();
+  img->cancellation = token;
+  ASSERT_FALSE(img->isCancelled());
+  token->cancel();
+  ASSERT_TRUE(img->isCancelled());
+  ASSERT_THROW(img->checkCancelled(), DecodeCancelledException);
+}
+
+TEST(CancellationTokenTest, Decompressor) {
+  const rawspeed::iPoint2D dim(32, 8);
+  std::vector<uint8_t> input(32 * 8);
+  const rawspeed::ByteStream bs(rawspeed::DataBuffer(
+      rawspeed::Buffer(input.data(), input.size()),
+      rawspeed::Endianness::little));
+
+  RawImage img = RawImage::create(dim);
+  auto token = std::make_shared<CancellationToken>();
+  img->cancellation = token;
+
+  // The input is garbage, but it does not get looked at.
+  rawspeed::SonyArw2Decompressor d(img, bs);
+  token->cancel();
+  ASSERT_THROW(d.decompress(), DecodeCancelledException);
+}
+
+} // namespace rawspeed_test
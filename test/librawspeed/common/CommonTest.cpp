@@ -19,6 +19,7 @@
 */
 
 #include "common/Common.h"
+#include "adt/Array1DRef.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
@@ -31,6 +32,7 @@
 #include <gtest/gtest.h>
 
 using rawspeed::copyPixels;
+using rawspeed::getMinMax;
 using rawspeed::isAligned;
 using rawspeed::isIn;
 using rawspeed::isPowerOfTwo;
@@ -39,6 +41,7 @@ using rawspeed::roundUp;
 using rawspeed::roundUpDivisionSafe;
 using rawspeed::splitString;
 using rawspeed::trimSpaces;
+using rawspeed::trimSpacesView;
 using std::make_tuple;
 using std::min;
 using std::numeric_limits;
@@ -233,6 +236,9 @@ static const TrimSpacesType TrimSpacesValues[] = {
 INSTANTIATE_TEST_SUITE_P(TrimSpacesTest, TrimSpacesTest,
                          ::testing::ValuesIn(TrimSpacesValues));
 TEST_P(TrimSpacesTest, TrimSpacesTest) { ASSERT_EQ(trimSpaces(in), out); }
+TEST_P(TrimSpacesTest, TrimSpacesViewTest) {
+  ASSERT_EQ(trimSpacesView(in), out);
+}
 
 using splitStringType = std::tuple<string, char, vector<string>>;
 class SplitStringTest : public ::testing::TestWithParam<splitStringType> {
@@ -330,4 +336,32 @@ TEST_P(CopyPixelsTest, CopyPixelsTest) {
   compare();
 }
 
+TEST(GetMinMaxTest, AllLengths) {
+  // Enough to cover the vectorized loops and all of the possible tails.
+  vector<uint16_t> values(130);
+  uint32_t seed = 42;
+  for (auto& v : values) {
+    seed = (seed * 1103515245U) + 12345U;
+    v = static_cast<uint16_t>(seed >> 16U);
+  }
+  for (int size = 1; size <= static_cast<int>(values.size()); size++) {
+    const auto [lo, hi] = std::minmax_element(values.begin(),
+                                              values.begin() + size);
+    const auto minMax =
+        getMinMax(rawspeed::Array1DRef<const uint16_t>(values.data(), size));
+    ASSERT_EQ(minMax.first, *lo);
+    ASSERT_EQ(minMax.second, *hi);
+  }
+}
+
+TEST(GetMinMaxTest, Extremes) {
+  vector<uint16_t> values(100, 1000);
+  values[97] = 0;
+  values[98] = 65535;
+  const auto [lo, hi] =
+      getMinMax(rawspeed::Array1DRef<const uint16_t>(values.data(), 100));
+  ASSERT_EQ(lo, 0);
+  ASSERT_EQ(hi, 65535);
+}
+
 } // namespace rawspeed_test
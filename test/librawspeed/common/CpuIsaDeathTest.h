@@ -0,0 +1,53 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "common/CpuFeatures.h"
+#include <cstdlib>
+#include <gtest/gtest.h>
+
+namespace rawspeed_test {
+
+// The SIMD kernels are picked by the RAWSPEED_ISA environment variable,
+// once per process, so each ISA has to be checked in a child process.
+// The ISAs this CPU does not support are skipped, since a narrower kernel
+// would silently be picked instead.
+class CpuIsaDeathTest : public ::testing::TestWithParam<rawspeed::CpuIsa> {
+protected:
+  void SetUp() override {
+    if (rawspeed::detectCpuIsa(rawspeed::getCpuIsaName(GetParam())) !=
+        GetParam())
+      GTEST_SKIP() << "Not supported by this CPU";
+  }
+
+  // Runs countMismatches() in a child restricted to the GetParam() ISA,
+  // and expects it to find none.
+  template <typename F> void runWithIsa(F countMismatches) {
+    EXPECT_EXIT(
+        {
+          setenv("RAWSPEED_ISA", rawspeed::getCpuIsaName(GetParam()), 1);
+          std::exit(countMismatches() == 0 ? 0 : 1);
+        },
+        ::testing::ExitedWithCode(0), "");
+  }
+};
+
+} // namespace rawspeed_test
@@ -20,14 +20,19 @@
 
 #include "rawspeedconfig.h" // IWYU pragma: keep
 #include "common/CpuFeatures.h"
+#include <algorithm>
 #include <cstdlib>
 #include <gtest/gtest.h>
 
+using rawspeed::CpuIsa;
 using rawspeed::Cpuid;
+using rawspeed::detectCpuIsa;
+using rawspeed::getCpuIsa;
+using rawspeed::getCpuIsaName;
+using rawspeed::selectKernel;
 
 namespace rawspeed_test {
 
-// do not care about WITH_SSE2 here.
 TEST(CpuidDeathTest, SSE2Test) {
 #if defined(__SSE2__)
   ASSERT_EXIT(
@@ -46,4 +51,58 @@ TEST(CpuidDeathTest, SSE2Test) {
 #endif
 }
 
+TEST(CpuidTest, IsaLevelsAreNested) {
+  const CpuIsa isa = detectCpuIsa(nullptr);
+  EXPECT_EQ(isa >= CpuIsa::SSE2, Cpuid::SSE2());
+  if (isa >= CpuIsa::AVX2) {
+    EXPECT_TRUE(Cpuid::AVX2());
+    EXPECT_TRUE(Cpuid::BMI2());
+  }
+  if (isa >= CpuIsa::AVX512) {
+    EXPECT_TRUE(Cpuid::AVX512BW());
+  }
+  if (isa >= CpuIsa::AVX512VBMI) {
+    EXPECT_TRUE(Cpuid::AVX512VBMI());
+  }
+}
+
+TEST(CpuidTest, RequestedIsaOnlyRestricts) {
+  const CpuIsa supported = detectCpuIsa(nullptr);
+  for (const CpuIsa isa : {CpuIsa::Generic, CpuIsa::SSE2, CpuIsa::AVX2,
+                           CpuIsa::AVX512, CpuIsa::AVX512VBMI}) {
+    EXPECT_EQ(detectCpuIsa(getCpuIsaName(isa)), std::min(isa, supported));
+  }
+  EXPECT_EQ(detectCpuIsa(""), supported);
+  EXPECT_EQ(detectCpuIsa("avx9000"), supported);
+}
+
+TEST(CpuidDeathTest, EnvironmentOverride) {
+  ASSERT_EXIT(
+      {
+        setenv("RAWSPEED_ISA", "generic", 1);
+        ASSERT_EQ(getCpuIsa(), CpuIsa::Generic);
+        exit(0);
+      },
+      ::testing::ExitedWithCode(0), "");
+}
+
+namespace {
+
+int generic() { return 0; }
+int sse2() { return 1; }
+int avx2() { return 2; }
+
+} // namespace
+
+TEST(CpuidTest, SelectKernel) {
+  using Kernel = int (*)();
+  const Kernel kernel = selectKernel<Kernel>({{CpuIsa::AVX2, &avx2},
+                                              {CpuIsa::SSE2, &sse2},
+                                              {CpuIsa::Generic, &generic}});
+  EXPECT_EQ(kernel(), std::min(static_cast<int>(getCpuIsa()), 2));
+
+  const Kernel fallback = selectKernel<Kernel>({{CpuIsa::Generic, &generic}});
+  EXPECT_EQ(fallback, &generic);
+}
+
 } // namespace rawspeed_test
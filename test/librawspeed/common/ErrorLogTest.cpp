@@ -0,0 +1,75 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "common/ErrorLog.h"
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::ErrorLog;
+
+namespace rawspeed_test {
+
+TEST(ErrorLogTest, Basic) {
+  ErrorLog log;
+  ASSERT_FALSE(log.hasErrors());
+  ASSERT_EQ(log.getNumErrors(), 0);
+  ASSERT_FALSE(log.isTooManyErrors(1));
+
+  log.setError("first");
+  log.setError("second");
+  ASSERT_TRUE(log.hasErrors());
+  ASSERT_EQ(log.getNumErrors(), 2);
+  ASSERT_FALSE(log.isTooManyErrors(3));
+
+  std::string firstErr;
+  ASSERT_TRUE(log.isTooManyErrors(2, &firstErr));
+  ASSERT_EQ(firstErr, "first");
+
+  const std::vector<std::string> errors = log.getErrors();
+  ASSERT_EQ(errors, (std::vector<std::string>{"first", "second"}));
+  ASSERT_FALSE(log.hasErrors());
+  ASSERT_TRUE(log.getErrors().empty());
+
+  // The log is usable again once the errors have been taken.
+  log.setError("third");
+  ASSERT_EQ(log.getNumErrors(), 1);
+  ASSERT_EQ(log.getErrors(), (std::vector<std::string>{"third"}));
+  ASSERT_EQ(errors.size(), 2);
+}
+
+TEST(ErrorLogTest, Concurrent) {
+  ErrorLog log;
+  std::vector<std::thread> threads;
+  threads.reserve(4);
+  for (int t = 0; t != 4; ++t) {
+    threads.emplace_back([&log]() {
+      for (int i = 0; i != 100; ++i)
+        log.setError("error");
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  ASSERT_EQ(log.getNumErrors(), 400);
+  ASSERT_EQ(log.getErrors().size(), 400);
+}
+
+} // namespace rawspeed_test
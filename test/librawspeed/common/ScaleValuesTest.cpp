@@ -0,0 +1,157 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "adt/Array2DRef.h"
+#include "adt/CroppedArray2DRef.h"
+#include "adt/Point.h"
+#include "common/CpuFeatures.h"
+#include "common/CpuIsaDeathTest.h"
+#include "common/Dither.h"
+#include "common/RawImage.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array2DRef;
+using rawspeed::CpuIsa;
+using rawspeed::iPoint2D;
+using rawspeed::iRectangle2D;
+using rawspeed::RawImage;
+using rawspeed::RawImageType;
+
+namespace rawspeed_test {
+
+namespace {
+
+constexpr iPoint2D uncroppedDim(75, 10);
+constexpr iRectangle2D crop({1, 1}, {70, 8});
+constexpr int whitePoint = 4095;
+constexpr std::array<int, 4> blackLevels = {256, 260, 250, 270};
+
+void setupImage(const RawImage& img) {
+  img->blackLevelSeparateStorage = blackLevels;
+  img->blackLevelSeparate =
+      Array2DRef(img->blackLevelSeparateStorage.data(), 2, 2);
+  img->whitePoint = whitePoint;
+  img->subFrame(crop);
+}
+
+// Scales as the generic kernel is specified to, but in 64-bit arithmetic.
+uint16_t referenceScale(int pixel, int black, bool dither, uint32_t counter) {
+  const float appScale =
+      65535.0F / static_cast<float>(whitePoint - blackLevels[0]);
+  const auto fullScaleFp = static_cast<int64_t>(appScale * 4.0F);
+  const auto halfScaleFp = static_cast<int64_t>(appScale * 4095.0F);
+  const auto mul = static_cast<int64_t>(16384.0F * 65535.0F /
+                                        static_cast<float>(whitePoint - black));
+  int64_t rand = 0;
+  if (dither)
+    rand = halfScaleFp - (fullScaleFp * rawspeed::ditherNoise(counter));
+  const int64_t v = (((pixel - black) * mul) + 8192 + rand) >> 14;
+  return static_cast<uint16_t>(std::clamp<int64_t>(v, 0, 65535));
+}
+
+int countU16Mismatches(bool dither) {
+  RawImage img = RawImage::create(uncroppedDim, RawImageType::UINT16);
+  img->mDitherScale = dither;
+
+  // Includes values both below the black level and above the white level.
+  const Array2DRef<uint16_t> full = img->getU16DataAsUncroppedArray2DRef();
+  uint32_t seed = 1;
+  for (int y = 0; y < full.height(); y++) {
+    for (int x = 0; x < full.width(); x++) {
+      seed = (seed * 1103515245U) + 12345U;
+      full(y, x) = static_cast<uint16_t>((seed >> 16U) % 5000);
+    }
+  }
+  std::vector<uint16_t> orig;
+  for (int y = 0; y < full.height(); y++) {
+    for (int x = 0; x < full.width(); x++)
+      orig.emplace_back(full(y, x));
+  }
+
+  setupImage(img);
+  img->scaleBlackWhite();
+
+  int mismatches = 0;
+  const auto out = img->getU16DataAsCroppedArray2DRef();
+  for (int y = 0; y < out.croppedHeight; y++) {
+    for (int x = 0; x < out.croppedWidth; x++) {
+      const int ux = crop.pos.x + x;
+      const int uy = crop.pos.y + y;
+      const int black = blackLevels[(2 * (uy & 1)) + (ux & 1)];
+      const auto counter = static_cast<uint32_t>((y * crop.dim.x) + x);
+      const uint16_t expected = referenceScale(
+          orig[(uy * uncroppedDim.x) + ux], black, dither, counter);
+      mismatches += out(y, x) != expected;
+    }
+  }
+  return mismatches;
+}
+
+int countF32Mismatches() {
+  RawImage img = RawImage::create(uncroppedDim, RawImageType::F32);
+
+  const Array2DRef<float> full = img->getF32DataAsUncroppedArray2DRef();
+  for (int y = 0; y < full.height(); y++) {
+    for (int x = 0; x < full.width(); x++)
+      full(y, x) = static_cast<float>(((y * 997) + (x * 131)) % 5000) + 0.25F;
+  }
+
+  setupImage(img);
+  img->scaleBlackWhite();
+
+  int mismatches = 0;
+  const auto out = img->getF32DataAsCroppedArray2DRef();
+  for (int y = 0; y < out.croppedHeight; y++) {
+    for (int x = 0; x < out.croppedWidth; x++) {
+      const int ux = crop.pos.x + x;
+      const int uy = crop.pos.y + y;
+      const int black = blackLevels[(2 * (uy & 1)) + (ux & 1)];
+      const float in =
+          static_cast<float>(((uy * 997) + (ux * 131)) % 5000) + 0.25F;
+      const float scale = 65535.0F / static_cast<float>(whitePoint - black);
+      const float expected = (in - static_cast<float>(black)) * scale;
+      mismatches += out(y, x) != expected;
+    }
+  }
+  return mismatches;
+}
+
+class ScaleValuesDeathTest : public CpuIsaDeathTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, ScaleValuesDeathTest,
+                         ::testing::Values(CpuIsa::Generic, CpuIsa::SSE2,
+                                           CpuIsa::AVX2, CpuIsa::AVX512));
+
+} // namespace
+
+TEST_P(ScaleValuesDeathTest, U16MatchesReference) {
+  for (const bool dither : {false, true})
+    runWithIsa([dither]() { return countU16Mismatches(dither); });
+}
+
+TEST_P(ScaleValuesDeathTest, F32MatchesReference) {
+  runWithIsa([]() { return countF32Mismatches(); });
+}
+
+} // namespace rawspeed_test
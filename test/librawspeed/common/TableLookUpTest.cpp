@@ -0,0 +1,165 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "adt/Array1DRef.h"
+#include "adt/Array2DRef.h"
+#include "adt/Point.h"
+#include "common/CpuFeatures.h"
+#include "common/CpuIsaDeathTest.h"
+#include "common/RawImage.h"
+#include "common/TableLookUp.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::Array2DRef;
+using rawspeed::CpuIsa;
+using rawspeed::iPoint2D;
+using rawspeed::RawImage;
+using rawspeed::RawImageCurveGuard;
+using rawspeed::RawImageType;
+using rawspeed::TableLookUp;
+
+namespace rawspeed_test {
+
+namespace {
+
+// Not a multiple of any vector width, to exercise the tails of the rows.
+constexpr iPoint2D dim(75, 40);
+
+// A non-linear, partially non-monotonic curve.
+std::vector<uint16_t> makeCurve() {
+  std::vector<uint16_t> curve(4096);
+  for (int i = 0; i < static_cast<int>(curve.size()); i++)
+    curve[i] = static_cast<uint16_t>(std::min((i * i) / 200, 65535));
+  std::swap(curve[100], curve[101]);
+  return curve;
+}
+
+// Includes codes past the end of the curve.
+uint16_t makeCode(int x, int y) {
+  return static_cast<uint16_t>(((y * 1657) + (x * 4099)) % 5000);
+}
+
+RawImage makeImage() {
+  RawImage img = RawImage::create(dim, RawImageType::UINT16);
+  const Array2DRef<uint16_t> out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y < out.height(); y++) {
+    for (int x = 0; x < out.width(); x++)
+      out(y, x) = makeCode(x, y);
+  }
+  return img;
+}
+
+int countMismatches(bool dither) {
+  const std::vector<uint16_t> curve = makeCurve();
+
+  TableLookUp ref(1, dither);
+  ref.setTable(0, curve);
+  const Array1DRef<const uint16_t> t = ref.getTable(0);
+
+  RawImage img = makeImage();
+  img->setTable(curve, dither);
+  img->sixteenBitLookup();
+
+  int mismatches = 0;
+  const Array2DRef<uint16_t> out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y < out.height(); y++) {
+    for (int x = 0; x < out.width(); x++) {
+      const uint16_t code = makeCode(x, y);
+      const auto counter = static_cast<uint32_t>((y * out.width()) + x);
+      const uint16_t expected =
+          dither ? TableLookUp::lookUpDithered(t, code, counter)
+                 : curve[std::min<size_t>(code, curve.size() - 1)];
+      mismatches += out(y, x) != expected;
+    }
+  }
+  return mismatches;
+}
+
+class TableLookUpDeathTest : public CpuIsaDeathTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, TableLookUpDeathTest,
+                         ::testing::Values(CpuIsa::Generic, CpuIsa::AVX2,
+                                           CpuIsa::AVX512));
+
+} // namespace
+
+TEST_P(TableLookUpDeathTest, MatchesReference) {
+  for (const bool dither : {false, true})
+    runWithIsa([dither]() { return countMismatches(dither); });
+}
+
+TEST(TableLookUpTest, DitherIsCentered) {
+  // With a linear curve, the dither must not shift the values on average.
+  std::vector<uint16_t> curve(4096);
+  for (int i = 0; i < static_cast<int>(curve.size()); i++)
+    curve[i] = static_cast<uint16_t>(16 * i);
+
+  TableLookUp lut(1, true);
+  lut.setTable(0, curve);
+  const Array1DRef<const uint16_t> t = lut.getTable(0);
+
+  constexpr int numSamples = 1 << 16;
+  int64_t sum = 0;
+  for (int i = 0; i < numSamples; i++) {
+    const uint16_t v = TableLookUp::lookUpDithered(t, 1000, i);
+    EXPECT_LE(std::abs(v - 16000), 8);
+    sum += v;
+  }
+  EXPECT_NEAR(static_cast<double>(sum) / numSamples, 16000.0, 0.5);
+}
+
+TEST(TableLookUpTest, CurveGuard) {
+  const std::vector<uint16_t> curve = makeCurve();
+
+  TableLookUp dithered(1, true);
+  dithered.setTable(0, curve);
+  const Array1DRef<const uint16_t> t = dithered.getTable(0);
+
+  for (const bool uncorrectedRawValues : {false, true}) {
+    RawImage img = makeImage();
+    {
+      RawImageCurveGuard curveHandler(&img, curve, uncorrectedRawValues);
+      curveHandler.apply();
+    }
+    // The uncorrected image retains the curve, to be applied later,
+    // without the dither, while the corrected one must not be mapped twice.
+    img->sixteenBitLookup();
+
+    const Array2DRef<uint16_t> out = img->getU16DataAsUncroppedArray2DRef();
+    for (int y = 0; y < out.height(); y++) {
+      for (int x = 0; x < out.width(); x++) {
+        const uint16_t code = makeCode(x, y);
+        const auto counter = static_cast<uint32_t>((y * out.width()) + x);
+        ASSERT_EQ(out(y, x),
+                  uncorrectedRawValues
+                      ? curve[std::min<size_t>(code, curve.size() - 1)]
+                      : TableLookUp::lookUpDithered(t, code, counter));
+      }
+    }
+  }
+}
+
+} // namespace rawspeed_test
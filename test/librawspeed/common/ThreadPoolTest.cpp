@@ -0,0 +1,146 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "rawspeedconfig.h" // IWYU pragma: keep
+#include "common/Executor.h"
+#include "common/ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Executor;
+using rawspeed::SerialExecutor;
+using rawspeed::ThreadPool;
+
+namespace rawspeed_test {
+
+namespace {
+
+// Every item must be visited exactly once.
+void checkParallelFor(Executor& executor, int numItems) {
+  std::vector<std::atomic<int>> visits(numItems);
+  std::atomic<int> numCalls = 0;
+  executor.parallelFor(numItems, [&](int begin, int end) {
+    ASSERT_LT(begin, end);
+    ++numCalls;
+    for (int i = begin; i != end; ++i)
+      ++visits[i];
+  });
+  for (const auto& v : visits)
+    ASSERT_EQ(v, 1);
+  ASSERT_LE(numCalls, executor.getNumThreads());
+}
+
+} // namespace
+
+TEST(ExecutorTest, Default) {
+  const auto& executor = Executor::getDefault();
+  ASSERT_TRUE(executor);
+  ASSERT_GE(executor->getNumThreads(), 1);
+  for (int n : {0, 1, 2, 3, 100, 1001})
+    checkParallelFor(*executor, n);
+}
+
+TEST(ExecutorTest, Serial) {
+  SerialExecutor executor;
+  ASSERT_EQ(executor.getNumThreads(), 1);
+  for (int n : {0, 1, 7})
+    checkParallelFor(executor, n);
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  for (int numThreads : {1, 2, 3, 8}) {
+    ThreadPool pool(numThreads);
+    ASSERT_EQ(pool.getNumThreads(), numThreads);
+    // Must not start OpenMP teams on top of the pool's threads.
+    ASSERT_EQ(pool.getNumOpenMPThreads(), 1);
+    for (int n : {0, 1, 2, 3, 7, 100, 1001})
+      checkParallelFor(pool, n);
+  }
+}
+
+TEST(ThreadPoolTest, NestedParallelFor) {
+  ThreadPool pool(4);
+  std::atomic<int> sum = 0;
+  pool.parallelFor(16, [&](int begin, int end) {
+    for (int i = begin; i != end; ++i) {
+      pool.parallelFor(16, [&](int b, int e) { sum += e - b; });
+    }
+  });
+  ASSERT_EQ(sum, 16 * 16);
+}
+
+TEST(ThreadPoolTest, ExceptionIsRethrown) {
+  ThreadPool pool(4);
+  std::atomic<int> numItems = 0;
+  ASSERT_THROW(pool.parallelFor(100,
+                                [&](int begin, int end) {
+                                  numItems += end - begin;
+                                  if (begin == 0)
+                                    throw std::runtime_error("oops");
+                                }),
+               std::runtime_error);
+  // All of the other chunks still ran.
+  ASSERT_EQ(numItems, 100);
+}
+
+TEST(ThreadPoolTest, WaiterOnlyHelpsWithItsOwnLoop) {
+  std::atomic<bool> release = false;
+  std::thread::id unrelatedThread;
+  {
+    ThreadPool pool(2);
+    // Keep all the workers busy.
+    std::atomic<int> numBlocked = 0;
+    for (int i = 0; i != pool.getNumThreads(); ++i) {
+      pool.submit([&]() {
+        ++numBlocked;
+        while (!release)
+          std::this_thread::yield();
+      });
+    }
+    while (numBlocked != pool.getNumThreads())
+      std::this_thread::yield();
+
+    pool.submit([&]() { unrelatedThread = std::this_thread::get_id(); });
+
+    // With no workers available, the caller has to do the whole loop itself,
+    // but it must not pick up the unrelated task while at it.
+    checkParallelFor(pool, 100);
+    release = true;
+  }
+  ASSERT_NE(unrelatedThread, std::thread::id());
+  ASSERT_NE(unrelatedThread, std::this_thread::get_id());
+}
+
+TEST(ThreadPoolTest, Submit) {
+  std::atomic<int> numRan = 0;
+  {
+    ThreadPool pool(3);
+    for (int i = 0; i != 100; ++i)
+      pool.submit([&numRan]() { ++numRan; });
+    // The destructor waits for all the submitted tasks.
+  }
+  ASSERT_EQ(numRan, 100);
+}
+
+} // namespace rawspeed_test
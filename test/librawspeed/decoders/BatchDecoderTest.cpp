@@ -0,0 +1,107 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decoders/BatchDecoder.h"
+#include "common/ThreadPool.h"
+#include "io/Buffer.h"
+#include "metadata/CameraMetaData.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::BatchDecoder;
+using rawspeed::Buffer;
+using rawspeed::CameraMetaData;
+using rawspeed::ThreadPool;
+
+namespace rawspeed_test {
+
+namespace {
+
+struct Collector final {
+  std::mutex mutex;
+  std::vector<BatchDecoder::Result> results;
+
+  BatchDecoder::Callback getCallback() {
+    return [this](BatchDecoder::Result r) {
+      std::scoped_lock lock(mutex);
+      results.emplace_back(std::move(r));
+    };
+  }
+};
+
+} // namespace
+
+TEST(BatchDecoderTest, EveryInputCompletesOnce) {
+  const CameraMetaData meta;
+  const std::vector<uint8_t> garbage(1024, 0xAB);
+
+  for (int threads : {1, 2, 4}) {
+    for (int depth : {1, 3}) {
+      Collector c;
+      constexpr int NumInputs = 50;
+      {
+        BatchDecoder::Options options;
+        options.queueDepth = depth;
+        BatchDecoder batch(&meta, std::make_shared<ThreadPool>(threads),
+                           c.getCallback(), options);
+        for (int i = 0; i != NumInputs; ++i) {
+          ASSERT_EQ(batch.submit(std::to_string(i),
+                                 Buffer(garbage.data(), garbage.size())),
+                    i);
+        }
+      }
+
+      ASSERT_EQ(c.results.size(), NumInputs);
+      std::vector<int> seen(NumInputs);
+      for (const BatchDecoder::Result& r : c.results) {
+        ASSERT_GE(r.index, 0);
+        ASSERT_LT(r.index, NumInputs);
+        ASSERT_EQ(r.name, std::to_string(r.index));
+        ++seen[r.index];
+        // Not a raw.
+        ASSERT_FALSE(r.image);
+        ASSERT_FALSE(r.error.empty());
+      }
+      for (int s : seen)
+        ASSERT_EQ(s, 1);
+    }
+  }
+}
+
+TEST(BatchDecoderTest, MissingFile) {
+  const CameraMetaData meta;
+  Collector c;
+  {
+    BatchDecoder batch(&meta, std::make_shared<ThreadPool>(2),
+                       c.getCallback());
+    batch.submit("this/file/does/not/exist.raw");
+    batch.wait();
+    ASSERT_EQ(c.results.size(), 1);
+  }
+  ASSERT_EQ(c.results[0].index, 0);
+  ASSERT_FALSE(c.results[0].image);
+  ASSERT_FALSE(c.results[0].error.empty());
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,214 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decompressors/LJpegDecompressor.h"
+#include "adt/Array1DRef.h"
+#include "adt/Array2DRef.h"
+#include "adt/Casts.h"
+#include "adt/Point.h"
+#include "codes/HuffmanCode.h"
+#include "codes/PrefixCodeDecoder.h"
+#include "common/Executor.h"
+#include "common/RawImage.h"
+#include "common/ThreadPool.h"
+#include "decoders/RawDecoderException.h"
+#include "io/Buffer.h"
+#include "io/ByteStream.h"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::BaselineCodeTag;
+using rawspeed::Buffer;
+using rawspeed::ByteStream;
+using rawspeed::Executor;
+using rawspeed::HuffmanCode;
+using rawspeed::implicit_cast;
+using rawspeed::iPoint2D;
+using rawspeed::iRectangle2D;
+using rawspeed::LJpegDecompressor;
+using rawspeed::PrefixCodeDecoder;
+using rawspeed::RawDecoderException;
+using rawspeed::RawImage;
+using rawspeed::RawImageType;
+using rawspeed::SerialExecutor;
+using rawspeed::ThreadPool;
+
+namespace rawspeed_test {
+
+namespace {
+
+// Two components, interleaved horizontally.
+constexpr iPoint2D MCU = {2, 1};
+
+// A complete code: any bit sequence decodes, into differences of 0-3 bits.
+PrefixCodeDecoder<> getPrefixCodeDecoder() {
+  HuffmanCode<BaselineCodeTag> hc;
+  std::vector<uint8_t> nCodesPerLength = {0, 4};
+  nCodesPerLength.resize(16);
+  hc.setNCodesPerLength(
+      Buffer(nCodesPerLength.data(),
+             implicit_cast<Buffer::size_type>(nCodesPerLength.size())));
+  std::vector<uint8_t> codeValues = {0, 1, 2, 3};
+  hc.setCodeValues(Array1DRef<uint8_t>(
+      codeValues.data(), implicit_cast<int>(codeValues.size())));
+  PrefixCodeDecoder<> ht(std::move(hc));
+  ht.setup(/*fullDecode_=*/true, /*fixDNGBug16_=*/false);
+  return ht;
+}
+
+struct Stream final {
+  std::vector<uint8_t> bytes;
+  // Where each of the restart markers is.
+  std::vector<int> restartMarkers;
+};
+
+// The entropy-coded segments of a frame of the given size, with random
+// (but byte-stuffed) contents, each long enough for its rows.
+Stream generateStream(iPoint2D dim, int rowsPerRestartInterval) {
+  std::minstd_rand rng(dim.x * 1000 + dim.y);
+  std::uniform_int_distribution<int> byteDist(0, 255);
+
+  Stream s;
+  const int numRestartIntervals =
+      (dim.y + rowsPerRestartInterval - 1) / rowsPerRestartInterval;
+  for (int i = 0; i != numRestartIntervals; ++i) {
+    if (i != 0) {
+      s.restartMarkers.emplace_back(implicit_cast<int>(s.bytes.size()));
+      s.bytes.emplace_back(0xFF);
+      s.bytes.emplace_back(0xD0 + ((i - 1) % 8));
+    }
+    // At most 5 bits per pixel, plus some slack.
+    const int numBytes = ((rowsPerRestartInterval * dim.x * 5) / 8) + 8;
+    for (int b = 0; b != numBytes; ++b) {
+      const auto byte = implicit_cast<uint8_t>(byteDist(rng));
+      s.bytes.emplace_back(byte);
+      if (byte == 0xFF)
+        s.bytes.emplace_back(0x00);
+    }
+  }
+  s.bytes.emplace_back(0xFF);
+  s.bytes.emplace_back(0xD9); // EOI
+  return s;
+}
+
+struct Decoded final {
+  ByteStream::size_type endPosition;
+  std::vector<uint16_t> pixels;
+};
+
+Decoded decode(const std::vector<uint8_t>& bytes, iPoint2D dim,
+               int rowsPerRestartInterval,
+               const std::shared_ptr<Executor>& executor,
+               bool unstuffJPEGUpFront = true) {
+  RawImage img = RawImage::create(dim, RawImageType::UINT16, 1);
+  img->executor = executor;
+  img->unstuffJPEGUpFront = unstuffJPEGUpFront;
+
+  const PrefixCodeDecoder<> ht = getPrefixCodeDecoder();
+  const Array1DRef<const uint8_t> input(bytes.data(),
+                                        implicit_cast<int>(bytes.size()));
+  const LJpegDecompressor d(img, iRectangle2D({0, 0}, dim),
+                            {MCU, {dim.x / MCU.x, dim.y}},
+                            {{ht, 1 << 13}, {ht, 1 << 13}},
+                            rowsPerRestartInterval, input);
+
+  Decoded res;
+  res.endPosition = d.decode();
+  const auto out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y != out.height(); ++y) {
+    for (int x = 0; x != out.width(); ++x)
+      res.pixels.emplace_back(out(y, x));
+  }
+  return res;
+}
+
+class LJpegDecompressorTest
+    : public ::testing::TestWithParam<std::pair<iPoint2D, int>> {
+protected:
+  const std::shared_ptr<Executor> serial = std::make_shared<SerialExecutor>();
+  const std::shared_ptr<Executor> pool = std::make_shared<ThreadPool>(4);
+};
+
+// {dimensions, rows per restart interval}
+INSTANTIATE_TEST_SUITE_P(
+    RestartIntervals, LJpegDecompressorTest,
+    ::testing::Values(std::pair(iPoint2D(8, 5), 5), // A single one.
+                      std::pair(iPoint2D(8, 16), 1),
+                      std::pair(iPoint2D(10, 17), 3), // Partial last one.
+                      std::pair(iPoint2D(64, 40), 4),
+                      std::pair(iPoint2D(6, 30), 2))); // The markers wrap.
+
+} // namespace
+
+TEST_P(LJpegDecompressorTest, ConcurrentMatchesSerial) {
+  const auto [dim, rowsPerRestartInterval] = GetParam();
+  const Stream s = generateStream(dim, rowsPerRestartInterval);
+
+  const Decoded ref = decode(s.bytes, dim, rowsPerRestartInterval, serial);
+  // Every interval got decoded up to its terminating marker, the last one
+  // up to the EOI.
+  EXPECT_EQ(ref.endPosition, s.bytes.size() - 2);
+
+  const Decoded res = decode(s.bytes, dim, rowsPerRestartInterval, pool);
+  EXPECT_EQ(res.endPosition, ref.endPosition);
+  EXPECT_EQ(res.pixels, ref.pixels);
+}
+
+TEST_P(LJpegDecompressorTest, UnstuffingUpFrontMatchesDefault) {
+  const auto [dim, rowsPerRestartInterval] = GetParam();
+  const Stream s = generateStream(dim, rowsPerRestartInterval);
+
+  const Decoded ref = decode(s.bytes, dim, rowsPerRestartInterval, serial,
+                             /*unstuffJPEGUpFront=*/false);
+  for (const auto& executor : {serial, pool}) {
+    const Decoded res = decode(s.bytes, dim, rowsPerRestartInterval, executor,
+                               /*unstuffJPEGUpFront=*/true);
+    EXPECT_EQ(res.pixels, ref.pixels);
+  }
+}
+
+TEST_P(LJpegDecompressorTest, BadRestartMarker) {
+  const auto [dim, rowsPerRestartInterval] = GetParam();
+  const Stream s = generateStream(dim, rowsPerRestartInterval);
+
+  for (const int marker : s.restartMarkers) {
+    for (const uint8_t bad : {0xD9,   // Not a restart marker.
+                              0xD7}) { // Out of order.
+      std::vector<uint8_t> bytes = s.bytes;
+      if (bytes[marker + 1] == bad)
+        continue;
+      bytes[marker + 1] = bad;
+      for (const auto& executor : {serial, pool}) {
+        for (const bool unstuff : {false, true}) {
+          EXPECT_THROW(
+              decode(bytes, dim, rowsPerRestartInterval, executor, unstuff),
+              RawDecoderException);
+        }
+      }
+    }
+  }
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,97 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decompressors/LJpegPredictor.h"
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "common/CpuFeatures.h"
+#include "common/CpuIsaDeathTest.h"
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::CpuIsa;
+using rawspeed::implicit_cast;
+using rawspeed::reconstructFromLeftPredictor;
+
+namespace rawspeed_test {
+
+namespace {
+
+int countMismatches(int stride, int length) {
+  uint32_t seed = 1;
+  auto rng = [&seed]() {
+    seed = (seed * 1103515245U) + 12345U;
+    return implicit_cast<uint16_t>(seed >> 16U);
+  };
+
+  std::vector<uint16_t> diffs(length);
+  for (auto& d : diffs)
+    d = rng();
+  std::vector<uint16_t> preds(stride);
+  for (auto& p : preds)
+    p = rng();
+
+  std::vector<uint16_t> ref(length);
+  std::vector<uint16_t> refPreds = preds;
+  for (int i = 0; i != length; ++i) {
+    refPreds[i % stride] =
+        implicit_cast<uint16_t>(refPreds[i % stride] + diffs[i]);
+    ref[i] = refPreds[i % stride];
+  }
+
+  // Reconstruct in two calls, to also check that preds carries over.
+  std::vector<uint16_t> out(length);
+  const int split = (length / stride / 3) * stride;
+  const Array1DRef<uint16_t> predsRef(preds.data(), stride);
+  reconstructFromLeftPredictor(
+      Array1DRef(out.data(), split),
+      Array1DRef<const uint16_t>(diffs.data(), split), predsRef);
+  reconstructFromLeftPredictor(
+      Array1DRef(out.data() + split, length - split),
+      Array1DRef<const uint16_t>(diffs.data() + split, length - split),
+      predsRef);
+
+  int mismatches = out != ref;
+  mismatches += preds != refPreds;
+  return mismatches;
+}
+
+class LJpegPredictorDeathTest : public CpuIsaDeathTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, LJpegPredictorDeathTest,
+                         ::testing::Values(CpuIsa::Generic, CpuIsa::AVX2));
+
+} // namespace
+
+TEST_P(LJpegPredictorDeathTest, MatchesReference) {
+  runWithIsa([]() {
+    int mismatches = 0;
+    for (const int stride : {1, 2, 3, 4}) {
+      // Including the lengths that leave a tail after the vector loop.
+      for (const int groups : {1, 5, 16, 17, 63, 256, 1000})
+        mismatches += countMismatches(stride, stride * groups);
+    }
+    return mismatches;
+  });
+}
+
+} // namespace rawspeed_test
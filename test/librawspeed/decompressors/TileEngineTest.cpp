@@ -0,0 +1,134 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decompressors/TileEngine.h"
+#include "adt/Array1DRef.h"
+#include "common/Cancellation.h"
+#include "common/Executor.h"
+#include "common/RawImage.h"
+#include "common/ThreadPool.h"
+#include "decoders/RawDecoderException.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::DecodeCancelledException;
+using rawspeed::RawDecoderException;
+using rawspeed::RawImage;
+using rawspeed::TileEngine;
+
+namespace rawspeed_test {
+
+namespace {
+
+class TileEngineTest : public ::testing::TestWithParam<int> {
+protected:
+  RawImage img = RawImage::create();
+
+  void SetUp() override {
+    if (GetParam() == 0)
+      img->executor = std::make_shared<rawspeed::SerialExecutor>();
+    else
+      img->executor = std::make_shared<rawspeed::ThreadPool>(GetParam());
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(Threads, TileEngineTest, ::testing::Values(0, 1, 4));
+
+} // namespace
+
+TEST_P(TileEngineTest, EachItemOnce) {
+  for (int numItems : {0, 1, 2, 3, 100}) {
+    std::vector<std::atomic<int>> visits(numItems);
+    TileEngine(img, numItems).run([&visits](int i) { ++visits[i]; });
+    for (const auto& v : visits)
+      ASSERT_EQ(v, 1);
+  }
+}
+
+TEST_P(TileEngineTest, CostliestFirst) {
+  const std::vector<TileEngine::Cost> costs = {3, 10, 1, 7, 7, 0};
+  std::vector<int> order;
+  std::mutex mutex;
+  TileEngine(img, Array1DRef(costs.data(), static_cast<int>(costs.size())))
+      .run([&](int i) {
+        std::scoped_lock lock(mutex);
+        order.emplace_back(i);
+      });
+  ASSERT_EQ(order.size(), costs.size());
+  // Only a single thread hands them out in exactly that order.
+  if (img->executor->getNumThreads() == 1) {
+    ASSERT_EQ(order, (std::vector<int>{1, 3, 4, 0, 2, 5}));
+  }
+}
+
+TEST_P(TileEngineTest, PerThreadState) {
+  std::atomic<int> numStates = 0;
+  std::atomic<int> numItems = 0;
+  TileEngine(img, 100).run(
+      [&numStates]() {
+        ++numStates;
+        return std::vector<int>();
+      },
+      [&numItems](std::vector<int>& state, int i) {
+        state.emplace_back(i);
+        ++numItems;
+      });
+  ASSERT_EQ(numItems, 100);
+  ASSERT_GE(numStates, 1);
+  ASSERT_LE(numStates, img->executor->getNumThreads());
+}
+
+TEST_P(TileEngineTest, FailsFast) {
+  std::atomic<int> numItems = 0;
+  ASSERT_THROW(TileEngine(img, 1000).run([&numItems](int i) {
+    ++numItems;
+    if (i == 0)
+      ThrowRDE("bad tile");
+  }),
+               RawDecoderException);
+  ASSERT_TRUE(img->isTooManyErrors(1));
+  // The rest of the items are not started.
+  ASSERT_LT(numItems, 1000);
+  if (img->executor->getNumThreads() == 1) {
+    ASSERT_EQ(numItems, 1);
+  }
+}
+
+TEST_P(TileEngineTest, Cancelled) {
+  auto token = std::make_shared<rawspeed::CancellationToken>();
+  img->cancellation = token;
+  std::atomic<int> numItems = 0;
+  ASSERT_THROW(TileEngine(img, 1000).run([&numItems, &token](int) {
+    ++numItems;
+    token->cancel();
+  }),
+               DecodeCancelledException);
+  ASSERT_FALSE(img->isTooManyErrors(1));
+  ASSERT_LT(numItems, 1000);
+  if (img->executor->getNumThreads() == 1) {
+    ASSERT_EQ(numItems, 1);
+  }
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,214 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "decompressors/UncompressedDecompressor.h"
+#include "adt/Array2DRef.h"
+#include "adt/Point.h"
+#include "bitstreams/BitStreams.h"
+#include "common/CpuFeatures.h"
+#include "common/CpuIsaDeathTest.h"
+#include "common/Executor.h"
+#include "common/RawImage.h"
+#include "common/ThreadPool.h"
+#include "io/Buffer.h"
+#include "io/ByteStream.h"
+#include "io/Endianness.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array2DRef;
+using rawspeed::BitOrder;
+using rawspeed::Buffer;
+using rawspeed::ByteStream;
+using rawspeed::CpuIsa;
+using rawspeed::DataBuffer;
+using rawspeed::Endianness;
+using rawspeed::Executor;
+using rawspeed::iPoint2D;
+using rawspeed::iRectangle2D;
+using rawspeed::RawImage;
+using rawspeed::RawImageType;
+using rawspeed::ThreadPool;
+using rawspeed::UncompressedDecompressor;
+
+namespace rawspeed_test {
+
+namespace {
+
+constexpr int height = 6;
+
+std::vector<uint8_t> makeInput(int size) {
+  std::vector<uint8_t> input(size);
+  uint32_t seed = 1;
+  for (auto& b : input) {
+    seed = (seed * 1103515245U) + 12345U;
+    b = static_cast<uint8_t>(seed >> 16U);
+  }
+  return input;
+}
+
+// The bytes of the stream are stored byte-swapped within the words.
+int wordBytes(BitOrder order) {
+  switch (order) {
+  case BitOrder::MSB16:
+    return 2;
+  case BitOrder::MSB32:
+    return 4;
+  default:
+    return 1;
+  }
+}
+
+// Extracts the pixel bit by bit. The words are relative to the start of the
+// whole input, not of the row.
+uint16_t referencePixel(const std::vector<uint8_t>& input, int rowOffset,
+                        BitOrder order, int bps, int i) {
+  uint32_t v = 0;
+  for (int b = 0; b < bps; b++) {
+    const int pos = (i * bps) + b;
+    const uint8_t byte =
+        input[(rowOffset + (pos / 8)) ^ (wordBytes(order) - 1)];
+    if (order == BitOrder::LSB)
+      v |= ((byte >> (pos % 8)) & 1U) << b;
+    else
+      v = (v << 1) | ((byte >> (7 - (pos % 8))) & 1U);
+  }
+  return static_cast<uint16_t>(v);
+}
+
+int countPackedMismatches(BitOrder order, int bps, int width,
+                          int numRows = height, int pitchPadding = 4,
+                          int firstRow = 0,
+                          const std::shared_ptr<Executor>& executor =
+                              Executor::getDefault()) {
+  const int pitch = ((((width * bps) / 8) + 3) / 4 * 4) + pitchPadding;
+  const std::vector<uint8_t> input = makeInput(pitch * numRows);
+
+  RawImage img = RawImage::create(iPoint2D(width, firstRow + numRows),
+                                  RawImageType::UINT16, 1);
+  img->executor = executor;
+  UncompressedDecompressor u(
+      ByteStream(DataBuffer(Buffer(input.data(), pitch * numRows),
+                            Endianness::little)),
+      img, iRectangle2D({0, firstRow}, iPoint2D(width, numRows)), pitch, bps,
+      order);
+  u.readUncompressedRaw();
+
+  int mismatches = 0;
+  const Array2DRef<uint16_t> out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y < numRows; y++) {
+    for (int x = 0; x < width; x++) {
+      mismatches += out(firstRow + y, x) !=
+                    referencePixel(input, y * pitch, order, bps, x);
+    }
+  }
+  return mismatches;
+}
+
+int countWithControlMismatches(Endianness e, int width) {
+  const int pitch = ((12 * width) / 8) + ((width + 2) / 10);
+  const std::vector<uint8_t> input = makeInput(pitch * height);
+
+  RawImage img =
+      RawImage::create(iPoint2D(width, height), RawImageType::UINT16, 1);
+  UncompressedDecompressor u(
+      ByteStream(DataBuffer(Buffer(input.data(), pitch * height),
+                            Endianness::little)),
+      img, iRectangle2D({0, 0}, iPoint2D(width, height)), pitch, 12,
+      BitOrder::MSB);
+  if (e == Endianness::big)
+    u.decode12BitRawWithControl<Endianness::big>();
+  else
+    u.decode12BitRawWithControl<Endianness::little>();
+
+  int mismatches = 0;
+  const Array2DRef<uint16_t> out = img->getU16DataAsUncroppedArray2DRef();
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += 2) {
+      // Each 5 pairs of pixels are followed by a control byte.
+      const uint8_t* p = &input[(y * pitch) + (3 * (x / 2)) + (x / 10)];
+      const uint32_t b0 = p[0];
+      const uint32_t b1 = p[1];
+      const uint32_t b2 = p[2];
+      if (e == Endianness::big) {
+        mismatches += out(y, x) != ((b0 << 4) | (b1 >> 4));
+        mismatches += out(y, x + 1) != (((b1 & 0xf) << 8) | b2);
+      } else {
+        mismatches += out(y, x) != (((b1 & 0xf) << 8) | b0);
+        mismatches += out(y, x + 1) != ((b2 << 4) | (b1 >> 4));
+      }
+    }
+  }
+  return mismatches;
+}
+
+class UncompressedDecompressorDeathTest : public CpuIsaDeathTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, UncompressedDecompressorDeathTest,
+                         ::testing::Values(CpuIsa::Generic, CpuIsa::AVX2));
+
+} // namespace
+
+TEST_P(UncompressedDecompressorDeathTest, PackedMatchesReference) {
+  runWithIsa([]() {
+    int mismatches = 0;
+    for (const BitOrder order :
+         {BitOrder::LSB, BitOrder::MSB, BitOrder::MSB16, BitOrder::MSB32}) {
+      // Including the bit depths without a specialized unpacker.
+      for (const int bps : {8, 10, 11, 12, 14, 16}) {
+        // Including the widths that leave a tail in each row.
+        for (const int width : {8, 24, 40, 96})
+          mismatches += countPackedMismatches(order, bps, width);
+      }
+    }
+    return mismatches;
+  });
+}
+
+TEST_P(UncompressedDecompressorDeathTest, WithControlMatchesReference) {
+  runWithIsa([]() {
+    int mismatches = 0;
+    for (const Endianness e : {Endianness::big, Endianness::little}) {
+      for (const int width : {8, 46, 100})
+        mismatches += countWithControlMismatches(e, width);
+    }
+    return mismatches;
+  });
+}
+
+TEST(UncompressedDecompressorTest, RowBands) {
+  const auto pool = std::make_shared<ThreadPool>(4);
+  // Tall enough for several bands, also when the input does not start at
+  // the first row of the image.
+  for (const BitOrder order :
+       {BitOrder::LSB, BitOrder::MSB, BitOrder::MSB16, BitOrder::MSB32}) {
+    for (const int bps : {11, 12, 16}) {
+      EXPECT_EQ(countPackedMismatches(order, bps, 2048, 200, 4, 0, pool), 0);
+      EXPECT_EQ(countPackedMismatches(order, bps, 2048, 200, 4, 5, pool), 0);
+    }
+  }
+  // The rows that do not start at a word boundary are not split up.
+  for (const BitOrder order : {BitOrder::MSB16, BitOrder::MSB32})
+    EXPECT_EQ(countPackedMismatches(order, 12, 2048, 200, 1, 0, pool), 0);
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,139 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "io/BlockCachedInput.h"
+#include "adt/Array1DRef.h"
+#include "io/Buffer.h"
+#include "io/IOException.h"
+#include "io/InputSource.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::BlockCachedInput;
+using rawspeed::Buffer;
+using rawspeed::CallbackInputSource;
+
+namespace rawspeed_test {
+
+namespace {
+
+class BlockCachedInputTest : public ::testing::Test {
+protected:
+  static constexpr auto BlockSize = BlockCachedInput::BlockSize;
+
+  std::vector<uint8_t> file;
+  std::vector<std::pair<Buffer::size_type, int>> reads;
+
+  CallbackInputSource source{
+      3 * BlockSize + 42,
+      [this](Buffer::size_type offset, Array1DRef<uint8_t> out) {
+        reads.emplace_back(offset, out.size());
+        std::copy_n(file.begin() + offset, out.size(), out.begin());
+      }};
+
+  void SetUp() override {
+    file.resize(source.getSize());
+    for (size_t i = 0; i != file.size(); ++i)
+      file[i] = static_cast<uint8_t>(i ^ (i >> 8));
+  }
+};
+
+} // namespace
+
+TEST_F(BlockCachedInputTest, NothingFetchedUpFront) {
+  const BlockCachedInput input(&source);
+  EXPECT_EQ(input.getSize(), file.size());
+  EXPECT_EQ(input.getNumFetchedBlocks(), 0);
+  EXPECT_TRUE(reads.empty());
+  EXPECT_FALSE(input.isFetched(0, 1));
+}
+
+TEST_F(BlockCachedInputTest, UnfetchedBytesOfSparseBufferAreZero) {
+  BlockCachedInput input(&source);
+  (void)input.fetch(BlockSize, 1);
+
+  const Buffer b = input.getSparseBuffer();
+  EXPECT_TRUE(std::all_of(b.begin(), b.begin() + BlockSize,
+                          [](uint8_t byte) { return byte == 0; }));
+  EXPECT_TRUE(std::equal(b.begin() + BlockSize, b.begin() + (2 * BlockSize),
+                         file.begin() + BlockSize));
+  EXPECT_TRUE(std::all_of(b.begin() + (2 * BlockSize), b.end(),
+                          [](uint8_t byte) { return byte == 0; }));
+}
+
+TEST_F(BlockCachedInputTest, AccessingUnfetchedBytesThrows) {
+  BlockCachedInput input(&source);
+  EXPECT_THROW((void)input.getBuffer(), rawspeed::IOException);
+  // All but the last, partial, block.
+  (void)input.fetch(0, 3 * BlockSize);
+  EXPECT_THROW((void)input.getBuffer(), rawspeed::IOException);
+
+  input.fetchAll();
+  EXPECT_EQ(reads.size(), 2);
+  const Buffer b = input.getBuffer();
+  EXPECT_TRUE(std::equal(b.begin(), b.end(), file.begin(), file.end()));
+}
+
+TEST_F(BlockCachedInputTest, FetchIsBlockGranularAndCached) {
+  BlockCachedInput input(&source);
+
+  const Buffer b = input.fetch(BlockSize + 10, 20);
+  ASSERT_EQ(b.getSize(), 20);
+  EXPECT_TRUE(std::equal(b.begin(), b.end(), file.begin() + BlockSize + 10));
+  ASSERT_EQ(reads.size(), 1);
+  EXPECT_EQ(reads[0], std::pair(BlockSize, static_cast<int>(BlockSize)));
+  EXPECT_TRUE(input.isFetched(BlockSize, BlockSize));
+  EXPECT_FALSE(input.isFetched(0, BlockSize + 1));
+
+  // Already resident, no new reads.
+  (void)input.fetch(BlockSize, BlockSize);
+  EXPECT_EQ(reads.size(), 1);
+  EXPECT_EQ(input.getNumFetchedBlocks(), 1);
+}
+
+TEST_F(BlockCachedInputTest, MissingBlocksAreCoalesced) {
+  BlockCachedInput input(&source);
+
+  (void)input.fetch(BlockSize, 1);
+  reads.clear();
+
+  // The blocks 0, 2 and 3 are missing, the last one is partial.
+  const Buffer b = input.fetch(0, input.getSize());
+  EXPECT_TRUE(std::equal(b.begin(), b.end(), file.begin()));
+  ASSERT_EQ(reads.size(), 2);
+  EXPECT_EQ(reads[0], std::pair(Buffer::size_type(0),
+                                static_cast<int>(BlockSize)));
+  EXPECT_EQ(reads[1],
+            std::pair(2 * BlockSize, static_cast<int>(BlockSize + 42)));
+  EXPECT_EQ(input.getNumFetchedBlocks(), 4);
+}
+
+TEST_F(BlockCachedInputTest, OutOfBoundsThrows) {
+  BlockCachedInput input(&source);
+  EXPECT_THROW((void)input.fetch(input.getSize() - 1, 2),
+               rawspeed::IOException);
+  EXPECT_TRUE(reads.empty());
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,107 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "io/FileReader.h"
+#include "io/Buffer.h"
+#include "io/FileIOException.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Buffer;
+using rawspeed::FileIOException;
+using rawspeed::FileReader;
+
+namespace rawspeed_test {
+
+namespace {
+
+std::string writeTempFile(const char* name, const std::vector<uint8_t>& data) {
+  std::string path = testing::TempDir() + name;
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  f.write(reinterpret_cast<const char*>(data.data()),
+          static_cast<std::streamsize>(data.size()));
+  return path;
+}
+
+} // namespace
+
+TEST(FileReaderTest, MapFileMatchesReadFile) {
+  std::vector<uint8_t> data(12345);
+  for (size_t i = 0; i != data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i * 7 + 3);
+  const std::string path = writeTempFile("rawspeed-mapfile", data);
+
+  const FileReader reader(path.c_str());
+  const auto [storage, buf] = reader.readFile();
+  const auto [mapping, mappedBuf] = reader.mapFile();
+
+  ASSERT_NE(mapping, nullptr);
+  ASSERT_EQ(mapping->getSize(), data.size());
+  ASSERT_EQ(buf.getSize(), data.size());
+  ASSERT_EQ(mappedBuf.getSize(), data.size());
+  ASSERT_EQ(mappedBuf.begin(), mapping->begin());
+  ASSERT_TRUE(std::equal(buf.begin(), buf.end(), data.begin()));
+  ASSERT_TRUE(std::equal(mappedBuf.begin(), mappedBuf.end(), data.begin()));
+}
+
+TEST(FileReaderTest, BuffersAreTailPadded) {
+  std::vector<uint8_t> data(4097, 0xFF);
+  const std::string path = writeTempFile("rawspeed-padded", data);
+
+  const FileReader reader(path.c_str());
+  const auto [storage, buf] = reader.readFile();
+  const auto [mapping, mappedBuf] = reader.mapFile();
+
+  ASSERT_EQ(buf.getTailPadding(), Buffer::TailPadding);
+#if defined(__unix__) || defined(__APPLE__)
+  ASSERT_EQ(mappedBuf.getTailPadding(), Buffer::TailPadding);
+#endif
+  for (const auto* b : {&buf, &mappedBuf}) {
+    // The padding is readable, and is zero-filled.
+    ASSERT_TRUE(std::all_of(b->end(), b->end() + b->getTailPadding(),
+                            [](uint8_t c) { return c == 0; }));
+  }
+
+  // Sub-views are padded by the rest of the parent, and by its padding.
+  EXPECT_EQ(buf.getSubView(4096, 1).getTailPadding(), Buffer::TailPadding);
+  const Buffer unpadded(data.data(), 4097);
+  EXPECT_EQ(unpadded.getTailPadding(), 0);
+  EXPECT_EQ(unpadded.getSubView(4096, 1).getTailPadding(), 0);
+  EXPECT_EQ(unpadded.getSubView(4090, 1).getTailPadding(), 6);
+  EXPECT_EQ(unpadded.getSubView(0, 1).getTailPadding(), Buffer::TailPadding);
+}
+
+TEST(FileReaderTest, MapEmptyFileThrows) {
+  const std::string path = writeTempFile("rawspeed-mapfile-empty", {});
+  ASSERT_THROW((void)FileReader(path.c_str()).mapFile(), FileIOException);
+}
+
+TEST(FileReaderTest, MapMissingFileThrows) {
+  const std::string path = testing::TempDir() + "rawspeed-does-not-exist";
+  ASSERT_THROW((void)FileReader(path.c_str()).mapFile(), FileIOException);
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,86 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "metadata/CameraIndex.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::CameraIndex;
+
+namespace rawspeed_test {
+
+TEST(CameraIndexTest, Empty) {
+  const CameraIndex index;
+  EXPECT_EQ(index.size(), 0U);
+  EXPECT_FALSE(index.find("make", "model", "mode"));
+  EXPECT_FALSE(index.find("make", "model"));
+}
+
+TEST(CameraIndexTest, FindsEveryEntry) {
+  std::vector<std::string> models;
+  for (int i = 0; i != 1000; ++i)
+    models.emplace_back("Model " + std::to_string(i));
+
+  CameraIndex index;
+  for (uint32_t i = 0; i != models.size(); ++i) {
+    ASSERT_TRUE(index.insert("Make", models[i], "", 2 * i));
+    ASSERT_TRUE(index.insert("Make", models[i], "compressed", (2 * i) + 1));
+  }
+  ASSERT_EQ(index.size(), 2 * models.size());
+
+  for (uint32_t i = 0; i != models.size(); ++i) {
+    ASSERT_EQ(index.find("Make", models[i], ""), 2 * i);
+    ASSERT_EQ(index.find("Make", models[i], "compressed"), (2 * i) + 1);
+    ASSERT_FALSE(index.find("Make", models[i], "bogus"));
+    ASSERT_FALSE(index.find("Other", models[i], ""));
+  }
+  ASSERT_FALSE(index.find("Make", "Model", ""));
+}
+
+TEST(CameraIndexTest, FirstInsertionWins) {
+  CameraIndex index;
+  ASSERT_TRUE(index.insert("Make", "Model", "", 1));
+  ASSERT_FALSE(index.insert("Make", "Model", "", 2));
+  EXPECT_EQ(index.size(), 1U);
+  EXPECT_EQ(index.find("Make", "Model", ""), 1U);
+}
+
+TEST(CameraIndexTest, AnyModeIsSmallestMode) {
+  CameraIndex index;
+  ASSERT_TRUE(index.insert("Make", "Model", "b", 1));
+  EXPECT_EQ(index.find("Make", "Model"), 1U);
+  ASSERT_TRUE(index.insert("Make", "Model", "a", 2));
+  EXPECT_EQ(index.find("Make", "Model"), 2U);
+  ASSERT_TRUE(index.insert("Make", "Model", "c", 3));
+  EXPECT_EQ(index.find("Make", "Model"), 2U);
+  EXPECT_FALSE(index.find("Make", "Mode"));
+}
+
+TEST(CameraIndexTest, KeyPartsDoNotRunTogether) {
+  CameraIndex index;
+  ASSERT_TRUE(index.insert("ab", "c", "", 1));
+  ASSERT_TRUE(index.insert("a", "bc", "", 2));
+  EXPECT_EQ(index.find("ab", "c", ""), 1U);
+  EXPECT_EQ(index.find("a", "bc", ""), 2U);
+}
+
+} // namespace rawspeed_test
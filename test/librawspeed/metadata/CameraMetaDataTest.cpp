@@ -26,6 +26,7 @@
 #include <string>
 #include <gtest/gtest.h>
 
+using rawspeed::Camera;
 using rawspeed::CameraMetaData;
 using std::unique_ptr;
 
@@ -81,6 +82,19 @@ TEST(CameraMetaDataTest, PrefixSearch) {
   });
 }
 
+TEST(CameraMetaDataTest, AliasesAreRegistered) {
+  const CameraMetaData Data(camfile.c_str());
+
+  const Camera* alias = Data.getCamera("Canon", "Canon EOS REBEL SL1", "");
+  ASSERT_NE(alias, nullptr);
+  EXPECT_EQ("EOS Rebel SL1", alias->canonical_alias);
+
+  bool visited = false;
+  Data.forEachCamera(
+      [alias, &visited](const Camera& cam) { visited |= &cam == alias; });
+  EXPECT_TRUE(visited);
+}
+
 #endif
 
 } // namespace rawspeed_test
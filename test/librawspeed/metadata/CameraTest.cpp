@@ -19,10 +19,15 @@
 */
 
 #include "metadata/Camera.h"
+#include "metadata/CameraMetadataException.h"
+#include "metadata/Hints.h"
+#include <iterator>
 #include <string>
 #include <tuple>
 #include <gtest/gtest.h>
 
+using rawspeed::CameraMetadataException;
+using rawspeed::Hint;
 using rawspeed::Hints;
 using std::string;
 using std::to_string;
@@ -31,128 +36,166 @@ namespace rawspeed_test {
 
 TEST(CameraTest, HintsEmpty) {
   Hints hints;
-  ASSERT_FALSE(hints.contains("something"));
+  ASSERT_FALSE(hints.contains(Hint::sraw_new));
+  ASSERT_EQ(hints.begin(), hints.end());
 }
 
 TEST(CameraTest, HintsGetDefault) {
   Hints hints;
-  ASSERT_FALSE(hints.get("something", false));
-  ASSERT_TRUE(hints.get("something", true));
-  ASSERT_EQ(hints.get("something", string("the default value")),
+  ASSERT_FALSE(hints.get(Hint::msb_override, false));
+  ASSERT_TRUE(hints.get(Hint::msb_override, true));
+  ASSERT_EQ(hints.get(Hint::order, string("the default value")),
             "the default value");
-  ASSERT_EQ(hints.get("something", 42), 42);
-  ASSERT_EQ(hints.get("something", -84), -84);
-  ASSERT_EQ(hints.get("something", 3.14f), 3.14f);
-  ASSERT_EQ(hints.get("something", 2.71), 2.71);
+  ASSERT_EQ(hints.get(Hint::offset, 42), 42);
+  ASSERT_EQ(hints.get(Hint::offset, -84), -84);
+  ASSERT_EQ(hints.get(Hint::pixel_aspect_ratio, 3.14f), 3.14f);
+  ASSERT_EQ(hints.get(Hint::pixel_aspect_ratio, 2.71), 2.71);
 }
 
-TEST(CameraTest, HintsAssignmentConstructor) {
-  const string key("something");
+TEST(CameraTest, HintNames) {
+  for (int i = 0; i != static_cast<int>(Hint::END); ++i) {
+    const auto hint = static_cast<Hint>(i);
+    ASSERT_EQ(Hints::getHint(Hints::getName(hint)), hint);
+  }
+  ASSERT_EQ(Hints::getName(Hint::sraw_new), "sraw_new");
+  ASSERT_FALSE(Hints::getHint("sraw_nwe"));
+  ASSERT_FALSE(Hints::getHint(""));
+}
 
+TEST(CameraTest, HintsAssignmentConstructor) {
   Hints hints;
-  ASSERT_FALSE(hints.contains(key));
+  ASSERT_FALSE(hints.contains(Hint::fuji_rotate));
 
-  hints.add(key, "indeed");
-  ASSERT_TRUE(hints.contains(key));
+  hints.add("fuji_rotate", "");
+  ASSERT_TRUE(hints.contains(Hint::fuji_rotate));
 
   const Hints hints2(hints);
-  ASSERT_TRUE(hints2.contains(key));
+  ASSERT_TRUE(hints2.contains(Hint::fuji_rotate));
 
   const Hints hints3(hints2);
-  ASSERT_TRUE(hints3.contains(key));
+  ASSERT_TRUE(hints3.contains(Hint::fuji_rotate));
 }
 
 TEST(CameraTest, HintsAssignment) {
-  const string key("something");
-
   Hints hints;
 
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, "indeed");
-  ASSERT_TRUE(hints.contains(key));
+  ASSERT_FALSE(hints.contains(Hint::fuji_rotate));
+  hints.add("fuji_rotate", "");
+  ASSERT_TRUE(hints.contains(Hint::fuji_rotate));
 
   const Hints hints2 = hints;
-  ASSERT_TRUE(hints2.contains(key));
+  ASSERT_TRUE(hints2.contains(Hint::fuji_rotate));
 
   const Hints hints3 = hints2;
-  ASSERT_TRUE(hints3.contains(key));
+  ASSERT_TRUE(hints3.contains(Hint::fuji_rotate));
 }
 
 TEST(CameraTest, HintsAdd) {
   Hints hints;
-  const string key("something"), value("whocares");
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, value);
-  ASSERT_TRUE(hints.contains(key));
-  ASSERT_EQ(hints.get(key, string()), value);
+  const string value("plain");
+  ASSERT_FALSE(hints.contains(Hint::order));
+  hints.add("order", value);
+  ASSERT_TRUE(hints.contains(Hint::order));
+  ASSERT_EQ(hints.get(Hint::order, string()), value);
+  ASSERT_FALSE(hints.contains(Hint::offset));
+}
+
+TEST(CameraTest, HintsFirstValueWins) {
+  Hints hints;
+  hints.add("order", "plain");
+  hints.add("order", "jpeg");
+  ASSERT_EQ(hints.get(Hint::order, string()), "plain");
+  ASSERT_EQ(std::distance(hints.begin(), hints.end()), 1);
+}
+
+TEST(CameraTest, HintsUnknownThrows) {
+  Hints hints;
+  ASSERT_THROW(hints.add("something", "indeed"), CameraMetadataException);
+  ASSERT_THROW(hints.add("Order", "plain"), CameraMetadataException);
 }
 
 TEST(CameraTest, HintsInt) {
   Hints hints;
   const int val = -42;
-  const string key("thenum"), value(to_string(val));
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, value);
-  ASSERT_TRUE(hints.contains(key));
-  ASSERT_EQ(hints.get(key, 0), val);
+  ASSERT_FALSE(hints.contains(Hint::offset));
+  hints.add("offset", to_string(val));
+  ASSERT_TRUE(hints.contains(Hint::offset));
+  ASSERT_EQ(hints.get(Hint::offset, 0), val);
 }
 
 TEST(CameraTest, HintsUInt) {
   Hints hints;
   const unsigned int val = 84;
-  const string key("thenum"), value(to_string(val));
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, value);
-  ASSERT_TRUE(hints.contains(key));
-  ASSERT_EQ(hints.get(key, 0U), val);
+  ASSERT_FALSE(hints.contains(Hint::full_width));
+  hints.add("full_width", to_string(val));
+  ASSERT_TRUE(hints.contains(Hint::full_width));
+  ASSERT_EQ(hints.get(Hint::full_width, 0U), val);
+}
+
+TEST(CameraTest, HintsIntMalformedThrows) {
+  Hints hints;
+  for (const char* str : {"", "x", "12x", " 12", "1.5"}) {
+    ASSERT_THROW(hints.add("offset", str), CameraMetadataException);
+    ASSERT_FALSE(hints.contains(Hint::offset));
+  }
 }
 
 TEST(CameraTest, HintsFloat) {
   Hints hints;
   const float val = 3.14f;
-  const string key("theflt"), value(to_string(val));
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, value);
-  ASSERT_TRUE(hints.contains(key));
-  ASSERT_EQ(hints.get(key, 0.0F), val);
+  ASSERT_FALSE(hints.contains(Hint::pixel_aspect_ratio));
+  hints.add("pixel_aspect_ratio", to_string(val));
+  ASSERT_TRUE(hints.contains(Hint::pixel_aspect_ratio));
+  ASSERT_EQ(hints.get(Hint::pixel_aspect_ratio, 0.0F), val);
 }
 
 TEST(CameraTest, HintsDouble) {
   Hints hints;
   const double val = 2.71;
-  const string key("thedbl"), value(to_string(val));
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, value);
-  ASSERT_TRUE(hints.contains(key));
-  ASSERT_EQ(hints.get(key, 0.0), val);
+  ASSERT_FALSE(hints.contains(Hint::pixel_aspect_ratio));
+  hints.add("pixel_aspect_ratio", to_string(val));
+  ASSERT_TRUE(hints.contains(Hint::pixel_aspect_ratio));
+  ASSERT_EQ(hints.get(Hint::pixel_aspect_ratio, 0.0), val);
+}
+
+TEST(CameraTest, HintsDoubleMalformedThrows) {
+  Hints hints;
+  for (const char* str : {"", "x", "0.5x"}) {
+    ASSERT_THROW(hints.add("pixel_aspect_ratio", str),
+                 CameraMetadataException);
+  }
 }
 
 TEST(BoolHintTest, HintsBoolTrue) {
   Hints hints;
 
-  const string key("key1");
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, "true");
-  ASSERT_TRUE(hints.contains(key));
-  ASSERT_TRUE(hints.get(key, false));
+  ASSERT_FALSE(hints.contains(Hint::msb_override));
+  hints.add("msb_override", "true");
+  ASSERT_TRUE(hints.contains(Hint::msb_override));
+  ASSERT_TRUE(hints.get(Hint::msb_override, false));
+}
+
+TEST(BoolHintTest, HintsBoolFalse) {
+  Hints hints;
+
+  hints.add("msb_override", "false");
+  ASSERT_TRUE(hints.contains(Hint::msb_override));
+  ASSERT_FALSE(hints.get(Hint::msb_override, true));
 }
 
 class BoolHintTest : public ::testing::TestWithParam<std::tuple<string>> {
 protected:
-  virtual void SetUp() final { notTrue = std::get<0>(GetParam()); }
-  string notTrue;
+  virtual void SetUp() final { notBool = std::get<0>(GetParam()); }
+  string notBool;
 };
-INSTANTIATE_TEST_SUITE_P(NotTrue, BoolHintTest,
-                         ::testing::Values("True", "false", "False", "", "_"));
+INSTANTIATE_TEST_SUITE_P(NotBool, BoolHintTest,
+                         ::testing::Values("True", "False", "", "_"));
 
-TEST_P(BoolHintTest, HintsBool) {
+TEST_P(BoolHintTest, HintsBoolMalformedThrows) {
   Hints hints;
 
-  const string key("key");
-  ASSERT_FALSE(hints.contains(key));
-  hints.add(key, notTrue);
-  ASSERT_TRUE(hints.contains(key));
-  ASSERT_FALSE(hints.get(key, true));
+  ASSERT_THROW(hints.add("msb_override", notBool), CameraMetadataException);
+  ASSERT_FALSE(hints.contains(Hint::msb_override));
 }
 
 } // namespace rawspeed_test
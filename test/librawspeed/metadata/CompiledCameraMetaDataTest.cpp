@@ -0,0 +1,310 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "metadata/CompiledCameraMetaData.h"
+#include "adt/NotARational.h"
+#include "adt/Point.h"
+#include "io/Buffer.h"
+#include "metadata/Camera.h"
+#include "metadata/CameraMetaData.h"
+#include "metadata/CameraMetadataException.h"
+#include "metadata/ColorFilterArray.h"
+#include "metadata/Hints.h"
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Buffer;
+using rawspeed::Camera;
+using rawspeed::CameraMetaData;
+using rawspeed::CameraMetadataException;
+using rawspeed::CFAColor;
+using rawspeed::CompiledCameraMetaData;
+using rawspeed::Hint;
+using rawspeed::iPoint2D;
+
+namespace rawspeed_test {
+
+namespace {
+
+std::unique_ptr<Camera> makeCamera() {
+  auto cam = std::make_unique<Camera>();
+  cam->make = "Make";
+  cam->model = "Model";
+  cam->mode = "";
+  cam->canonical_make = "Canonical Make";
+  cam->canonical_model = "Canonical Model";
+  cam->canonical_alias = "Canonical Model";
+  cam->canonical_id = "Canonical Make Canonical Model";
+  cam->aliases = {"Alias"};
+  cam->canonical_aliases = {"Canonical Alias"};
+  cam->cfa.setSize({2, 2});
+  cam->cfa.setColorAt({0, 0}, CFAColor::RED);
+  cam->cfa.setColorAt({1, 0}, CFAColor::GREEN);
+  cam->cfa.setColorAt({0, 1}, CFAColor::GREEN);
+  cam->cfa.setColorAt({1, 1}, CFAColor::BLUE);
+  cam->supportStatus = Camera::SupportStatus::SupportedNoSamples;
+  cam->cropSize = {-4, -2};
+  cam->cropPos = {8, 6};
+  cam->cropAvailable = true;
+  cam->blackAreas.emplace_back(0, 32, true);
+  cam->sensorInfo.emplace_back(512, 16383, 0, 0, std::vector<int>{1, 2, 3, 4});
+  cam->decoderVersion = 3;
+  cam->hints.add("wb_offset", "96");
+  cam->hints.add("sraw_new", "");
+  cam->color_matrix = {{-1, 10000}, {2, 10000}, {3, 10000}};
+  return cam;
+}
+
+void fillMetaData(CameraMetaData* meta) {
+  // Along with its "Alias".
+  ASSERT_NE(meta->addCamera(makeCamera()), nullptr);
+
+  auto other = makeCamera();
+  other->mode = "compressed";
+  other->aliases.clear();
+  other->canonical_aliases.clear();
+  other->decoderVersion = 0;
+  ASSERT_NE(meta->addCamera(std::move(other)), nullptr);
+
+  auto chdk = std::make_unique<Camera>();
+  chdk->make = "Canon";
+  chdk->model = "PowerShot";
+  chdk->mode = "chdk";
+  chdk->hints.add("filesize", "1234567");
+  ASSERT_NE(meta->addCamera(std::move(chdk)), nullptr);
+}
+
+void expectSameCamera(const Camera& a, const Camera& b) {
+  EXPECT_EQ(a.make, b.make);
+  EXPECT_EQ(a.model, b.model);
+  EXPECT_EQ(a.mode, b.mode);
+  EXPECT_EQ(a.canonical_make, b.canonical_make);
+  EXPECT_EQ(a.canonical_model, b.canonical_model);
+  EXPECT_EQ(a.canonical_alias, b.canonical_alias);
+  EXPECT_EQ(a.canonical_id, b.canonical_id);
+  EXPECT_EQ(a.aliases, b.aliases);
+  EXPECT_EQ(a.canonical_aliases, b.canonical_aliases);
+  ASSERT_EQ(a.cfa.getSize(), b.cfa.getSize());
+  for (int y = 0; y < a.cfa.getSize().y; ++y) {
+    for (int x = 0; x < a.cfa.getSize().x; ++x)
+      EXPECT_EQ(a.cfa.getColorAt(x, y), b.cfa.getColorAt(x, y));
+  }
+  EXPECT_EQ(a.supportStatus, b.supportStatus);
+  EXPECT_EQ(a.cropSize, b.cropSize);
+  EXPECT_EQ(a.cropPos, b.cropPos);
+  EXPECT_EQ(a.cropAvailable, b.cropAvailable);
+  ASSERT_EQ(a.blackAreas.size(), b.blackAreas.size());
+  for (size_t i = 0; i != a.blackAreas.size(); ++i) {
+    EXPECT_EQ(a.blackAreas[i].offset, b.blackAreas[i].offset);
+    EXPECT_EQ(a.blackAreas[i].size, b.blackAreas[i].size);
+    EXPECT_EQ(a.blackAreas[i].isVertical, b.blackAreas[i].isVertical);
+  }
+  ASSERT_EQ(a.sensorInfo.size(), b.sensorInfo.size());
+  for (size_t i = 0; i != a.sensorInfo.size(); ++i) {
+    EXPECT_EQ(a.sensorInfo[i].mBlackLevel, b.sensorInfo[i].mBlackLevel);
+    EXPECT_EQ(a.sensorInfo[i].mWhiteLevel, b.sensorInfo[i].mWhiteLevel);
+    EXPECT_EQ(a.sensorInfo[i].mMinIso, b.sensorInfo[i].mMinIso);
+    EXPECT_EQ(a.sensorInfo[i].mMaxIso, b.sensorInfo[i].mMaxIso);
+    EXPECT_EQ(a.sensorInfo[i].mBlackLevelSeparate,
+              b.sensorInfo[i].mBlackLevelSeparate);
+  }
+  EXPECT_EQ(a.decoderVersion, b.decoderVersion);
+  EXPECT_EQ(a.hints.get(Hint::wb_offset, 0), b.hints.get(Hint::wb_offset, 0));
+  EXPECT_EQ(a.hints.contains(Hint::sraw_new), b.hints.contains(Hint::sraw_new));
+  EXPECT_EQ(a.hints.get(Hint::filesize, 0), b.hints.get(Hint::filesize, 0));
+  ASSERT_EQ(a.color_matrix.size(), b.color_matrix.size());
+  for (size_t i = 0; i != a.color_matrix.size(); ++i) {
+    EXPECT_EQ(a.color_matrix[i].num, b.color_matrix[i].num);
+    EXPECT_EQ(a.color_matrix[i].den, b.color_matrix[i].den);
+  }
+}
+
+Buffer asBuffer(const std::vector<uint8_t>& blob) {
+  return Buffer(blob.data(), static_cast<Buffer::size_type>(blob.size()));
+}
+
+} // namespace
+
+TEST(CompiledCameraMetaDataTest, RoundTrip) {
+  CameraMetaData meta;
+  fillMetaData(&meta);
+
+  const std::vector<uint8_t> blob = CompiledCameraMetaData::compile(meta);
+  ASSERT_TRUE(CompiledCameraMetaData::isCompiled(asBuffer(blob)));
+  const CompiledCameraMetaData compiled(asBuffer(blob));
+
+  uint32_t numCameras = 0;
+  meta.forEachCamera([&compiled, &numCameras](const Camera& cam) {
+    ++numCameras;
+    const auto entry = compiled.find(cam.make, cam.model, cam.mode);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(compiled.getKey(*entry).model, cam.model);
+    expectSameCamera(cam, *compiled.getCamera(*entry));
+  });
+  ASSERT_EQ(compiled.size(), numCameras);
+
+  EXPECT_FALSE(compiled.find("Make", "Model", "bogus"));
+  EXPECT_FALSE(compiled.find("Make", "Mode"));
+  ASSERT_TRUE(compiled.find("Make", "Model"));
+  EXPECT_EQ(compiled.getKey(*compiled.find("Make", "Model")).mode, "");
+
+  ASSERT_TRUE(compiled.findChdk(1234567));
+  EXPECT_EQ(compiled.getCamera(*compiled.findChdk(1234567))->model,
+            "PowerShot");
+  EXPECT_FALSE(compiled.findChdk(1234568));
+}
+
+TEST(CompiledCameraMetaDataTest, AliasesShareRecord) {
+  CameraMetaData meta;
+  fillMetaData(&meta);
+
+  // The alias is already there, generated from the canonical camera.
+  const Camera* canonical = meta.getCamera("Make", "Model", "");
+  ASSERT_NE(canonical, nullptr);
+  EXPECT_EQ(meta.addCamera(std::make_unique<Camera>(canonical, 0)), nullptr);
+
+  const std::vector<uint8_t> blob = CompiledCameraMetaData::compile(meta);
+  const CompiledCameraMetaData compiled(asBuffer(blob));
+  ASSERT_EQ(compiled.size(), 4U);
+  const auto alias = compiled.find("Make", "Alias", "");
+  ASSERT_TRUE(alias);
+  EXPECT_EQ(compiled.getCamera(*alias)->canonical_alias, "Canonical Alias");
+}
+
+TEST(CompiledCameraMetaDataTest, LoadFromFile) {
+  std::vector<uint8_t> blob;
+  {
+    CameraMetaData meta;
+    fillMetaData(&meta);
+    blob = CompiledCameraMetaData::compile(meta);
+  }
+
+  const std::string path = testing::TempDir() + "rawspeed-cameras.bin";
+  {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    f.write(reinterpret_cast<const char*>(blob.data()),
+            static_cast<std::streamsize>(blob.size()));
+  }
+
+  const CameraMetaData meta(path.c_str());
+
+  const Camera* cam = meta.getCamera(" Make ", "Alias", "");
+  ASSERT_NE(cam, nullptr);
+  EXPECT_EQ(cam->model, "Alias");
+  EXPECT_EQ(cam->canonical_alias, "Canonical Alias");
+  EXPECT_TRUE(cam->aliases.empty());
+  // Resolved just once.
+  EXPECT_EQ(cam, meta.getCamera("Make", "Alias", ""));
+
+  EXPECT_NE(meta.getCamera("Make", "Model"), nullptr);
+  EXPECT_EQ(meta.getCamera("Make", "Model", "bogus"), nullptr);
+  EXPECT_TRUE(meta.hasCamera("Make", "Model", "compressed"));
+
+  EXPECT_TRUE(meta.hasChdkCamera(1234567));
+  ASSERT_NE(meta.getChdkCamera(1234567), nullptr);
+  EXPECT_EQ(meta.getChdkCamera(1234567)->mode, "chdk");
+
+  // Everything, including the alias, gets materialized for the iteration.
+  int numCameras = 0;
+  meta.forEachCamera([&numCameras](const Camera&) { ++numCameras; });
+  EXPECT_EQ(numCameras, 4);
+  EXPECT_EQ(cam, meta.getCamera("Make", "Alias", ""));
+
+  meta.disableMake("Make");
+  EXPECT_EQ(cam->supportStatus, Camera::SupportStatus::Unsupported);
+  EXPECT_EQ(meta.getCamera("Make", "Model", "compressed")->supportStatus,
+            Camera::SupportStatus::Unsupported);
+  meta.disableCamera("Canon", "PowerShot");
+  EXPECT_EQ(meta.getChdkCamera(1234567)->supportStatus,
+            Camera::SupportStatus::Unsupported);
+}
+
+TEST(CompiledCameraMetaDataTest, MissingFileThrows) {
+  const std::string path = testing::TempDir() + "rawspeed-no-such-file.bin";
+  ASSERT_THROW(CameraMetaData{path.c_str()}, CameraMetadataException);
+}
+
+TEST(CompiledCameraMetaDataTest, RejectsCorruptBlobs) {
+  CameraMetaData meta;
+  fillMetaData(&meta);
+  std::vector<uint8_t> blob = CompiledCameraMetaData::compile(meta);
+
+  {
+    std::vector<uint8_t> badVersion = blob;
+    badVersion[8] = 42;
+    ASSERT_THROW(CompiledCameraMetaData{asBuffer(badVersion)},
+                 CameraMetadataException);
+  }
+
+  {
+    std::vector<uint8_t> truncated = blob;
+    truncated.resize(truncated.size() / 2);
+    ASSERT_THROW(CompiledCameraMetaData{asBuffer(truncated)},
+                 CameraMetadataException);
+  }
+
+  {
+    // Point the CHDK entry past the end of the index.
+    std::vector<uint8_t> badChdk = blob;
+    const uint32_t chdkOffset = badChdk[24] | (badChdk[25] << 8) |
+                                (badChdk[26] << 16) | (badChdk[27] << 24);
+    for (int i = 0; i != 4; ++i)
+      badChdk[chdkOffset + 4 + i] = 0xFF;
+    ASSERT_THROW(CompiledCameraMetaData{asBuffer(badChdk)},
+                 CameraMetadataException);
+  }
+
+  {
+    // Make the string of an index entry run past the end of the string table.
+    std::vector<uint8_t> badKey = blob;
+    const uint32_t entriesOffset = badKey[16] | (badKey[17] << 8) |
+                                   (badKey[18] << 16) | (badKey[19] << 24);
+    for (int i = 0; i != 4; ++i)
+      badKey[entriesOffset + 4 + i] = 0xFF;
+    ASSERT_THROW(CompiledCameraMetaData{asBuffer(badKey)},
+                 CameraMetadataException);
+  }
+
+  {
+    // Point the record of an index entry past the end of the records.
+    std::vector<uint8_t> badRecord = blob;
+    const uint32_t entriesOffset = badRecord[16] | (badRecord[17] << 8) |
+                                   (badRecord[18] << 16) |
+                                   (badRecord[19] << 24);
+    for (int i = 0; i != 4; ++i)
+      badRecord[entriesOffset + 24 + i] = 0xFF;
+    ASSERT_THROW(CompiledCameraMetaData{asBuffer(badRecord)},
+                 CameraMetadataException);
+  }
+
+  blob[0] = 'X';
+  EXPECT_FALSE(CompiledCameraMetaData::isCompiled(asBuffer(blob)));
+  ASSERT_THROW(CompiledCameraMetaData{asBuffer(blob)},
+               CameraMetadataException);
+}
+
+} // namespace rawspeed_test
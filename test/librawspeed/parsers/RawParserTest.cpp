@@ -0,0 +1,178 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "parsers/RawParser.h"
+#include "adt/Array1DRef.h"
+#include "adt/Casts.h"
+#include "decoders/RawDecoder.h"
+#include "io/BlockCachedInput.h"
+#include "io/Buffer.h"
+#include "io/InputSource.h"
+#include "metadata/CameraMetaData.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::BlockCachedInput;
+using rawspeed::Buffer;
+using rawspeed::CallbackInputSource;
+using rawspeed::implicit_cast;
+using rawspeed::CameraMetaData;
+using rawspeed::RawParser;
+using std::string_view_literals::operator""sv;
+
+namespace rawspeed_test {
+
+namespace {
+
+using Format = RawParser::Format;
+
+Format probe(std::string_view header, unsigned offset = 0,
+             unsigned size = 1024) {
+  std::vector<uint8_t> file(size);
+  std::copy(header.begin(), header.end(), file.begin() + offset);
+  return RawParser::probe(Buffer(file.data(), size));
+}
+
+class RawParserProbeTest
+    : public ::testing::TestWithParam<std::tuple<std::string_view, Format>> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    Signatures, RawParserProbeTest,
+    ::testing::Values(std::tuple("\0MRM"sv, Format::MRW),
+                      std::tuple("FUJIFILMCCD-RAW "sv, Format::FIFF),
+                      std::tuple("II\x2a\0"sv, Format::TIFF),
+                      std::tuple("MM\0\x2a"sv, Format::TIFF),
+                      std::tuple("IIRO"sv, Format::TIFF),
+                      std::tuple("MMOR"sv, Format::TIFF),
+                      std::tuple("IIRS"sv, Format::TIFF),
+                      std::tuple("MMSR"sv, Format::TIFF),
+                      std::tuple("IIU\0"sv, Format::TIFF),
+                      std::tuple("MM\0U"sv, Format::TIFF),
+                      std::tuple("II\x1a\0\0\0HEAPCCDR"sv, Format::CIFF),
+                      // Unusual magics are still left to the TiffParser.
+                      std::tuple("II\x2b\0"sv, Format::TIFF),
+                      std::tuple("MM\0\x2b"sv, Format::TIFF),
+                      std::tuple("IM\x2a\0"sv, Format::Unknown),
+                      std::tuple("\xff\xd8\xff\xe0"sv, Format::Unknown),
+                      std::tuple("FUJIFILM"sv, Format::Unknown)));
+
+TEST_P(RawParserProbeTest, Probe) {
+  const auto [header, format] = GetParam();
+  EXPECT_EQ(probe(header), format);
+}
+
+// A DNG whose IFD, and whose only strip, are in the third and fifth
+// BlockCachedInput blocks respectively. The other blocks are garbage.
+class RawParserLazyTest : public ::testing::Test {
+protected:
+  static constexpr auto BlockSize = BlockCachedInput::BlockSize;
+  static constexpr uint32_t IFDOffset = (2 * BlockSize) + 100;
+  static constexpr uint32_t StripOffset = (4 * BlockSize) + 10;
+  static constexpr uint32_t StripSize = 100;
+
+  std::vector<uint8_t> file = std::vector<uint8_t>(5 * BlockSize, 0xAB);
+  std::vector<Buffer::size_type> reads;
+
+  CallbackInputSource source{
+      implicit_cast<Buffer::size_type>(file.size()),
+      [this](Buffer::size_type offset, Array1DRef<uint8_t> out) {
+        reads.emplace_back(offset);
+        std::copy_n(file.begin() + offset, out.size(), out.begin());
+      }};
+
+  void put16(uint32_t pos, uint32_t v) {
+    for (int i = 0; i != 2; ++i)
+      file[pos + i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+  void put32(uint32_t pos, uint32_t v) {
+    for (int i = 0; i != 4; ++i)
+      file[pos + i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+
+  void SetUp() override {
+    std::copy_n("II\x2a\0", 4, file.begin());
+    put32(4, IFDOffset);
+
+    // tag, type, count, value
+    const std::array<std::array<uint32_t, 4>, 4> entries = {{
+        {259, 3, 1, 1}, // Compression: none
+        {273, 4, 1, StripOffset}, // StripOffsets
+        {279, 4, 1, StripSize}, // StripByteCounts
+        {50706, 1, 4, 0x00000401}, // DNGVersion: 1.4.0.0
+    }};
+    uint32_t pos = IFDOffset;
+    put16(pos, entries.size());
+    pos += 2;
+    for (const auto& [tag, type, count, value] : entries) {
+      put16(pos, tag);
+      put16(pos + 2, type);
+      put32(pos + 4, count);
+      put32(pos + 8, value);
+      pos += 12;
+    }
+    put32(pos, 0); // No next IFD.
+  }
+};
+
+} // namespace
+
+TEST_F(RawParserLazyTest, FetchesOnlyStructureAndPayload) {
+  BlockCachedInput input(&source);
+  const auto decoder = RawParser::getDecoderLazily(&input, nullptr);
+  ASSERT_NE(decoder, nullptr);
+
+  EXPECT_TRUE(input.isFetched(0, 8));
+  EXPECT_TRUE(input.isFetched(IFDOffset, 2 + (4 * 12) + 4));
+  EXPECT_TRUE(input.isFetched(StripOffset, StripSize));
+  EXPECT_FALSE(input.isFetched(BlockSize, 1));
+  EXPECT_FALSE(input.isFetched(3 * BlockSize, 1));
+  EXPECT_EQ(input.getNumFetchedBlocks(), 3);
+  EXPECT_EQ(reads.size(), 3);
+}
+
+TEST_F(RawParserLazyTest, FallsBackToFetchingEverything) {
+  // Not a TIFF, so the structure can not be fetched piecewise.
+  file[0] = 'X';
+  BlockCachedInput input(&source);
+  EXPECT_ANY_THROW((void)RawParser::getDecoderLazily(&input, nullptr));
+  EXPECT_TRUE(input.isFetched(0, input.getSize()));
+}
+
+TEST(RawParserTest, ProbeTooSmall) {
+  EXPECT_EQ(probe("II\x2a\0"sv, 0, 104), Format::Unknown);
+  EXPECT_EQ(probe("II\x2a\0"sv, 0, 105), Format::TIFF);
+}
+
+TEST(RawParserTest, ProbeDoesNotThrow) {
+  static_assert(noexcept(RawParser::probe(Buffer())));
+  EXPECT_EQ(RawParser::probe(Buffer()), Format::Unknown);
+  // The CHDK fallback must not be able to throw either.
+  static_assert(
+      noexcept(std::declval<const CameraMetaData&>().hasChdkCamera(0)));
+}
+
+} // namespace rawspeed_test
@@ -0,0 +1,101 @@
+/*
+    RawSpeed - RAW file decoder.
+
+    Copyright (C) 2026 Roman Lebedev
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "parsers/TiffParser.h"
+#include "adt/Array1DRef.h"
+#include "io/BlockCachedInput.h"
+#include "io/Buffer.h"
+#include "io/InputSource.h"
+#include "tiff/TiffEntry.h"
+#include "tiff/TiffIFD.h"
+#include "tiff/TiffTag.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+
+using rawspeed::Array1DRef;
+using rawspeed::BlockCachedInput;
+using rawspeed::Buffer;
+using rawspeed::CallbackInputSource;
+using rawspeed::TiffParser;
+
+namespace rawspeed_test {
+
+namespace {
+
+constexpr Buffer::size_type IFDOffset = 3 * BlockCachedInput::BlockSize + 16;
+constexpr Buffer::size_type MakeOffset = 5 * BlockCachedInput::BlockSize + 8;
+constexpr Buffer::size_type FileSize = 7 * BlockCachedInput::BlockSize;
+
+void putU16(std::vector<uint8_t>* file, Buffer::size_type pos, uint16_t v) {
+  (*file)[pos + 0] = static_cast<uint8_t>(v);
+  (*file)[pos + 1] = static_cast<uint8_t>(v >> 8);
+}
+
+void putU32(std::vector<uint8_t>* file, Buffer::size_type pos, uint32_t v) {
+  putU16(file, pos + 0, static_cast<uint16_t>(v));
+  putU16(file, pos + 2, static_cast<uint16_t>(v >> 16));
+}
+
+// A little-endian TIFF with a single IFD with a single MAKE entry,
+// with both the IFD and the entry data far away from the header.
+std::vector<uint8_t> makeTiff() {
+  std::vector<uint8_t> file(FileSize);
+  file[0] = 'I';
+  file[1] = 'I';
+  putU16(&file, 2, 42);
+  putU32(&file, 4, IFDOffset);
+
+  putU16(&file, IFDOffset, 1);         // one entry
+  putU16(&file, IFDOffset + 2, 0x10f); // MAKE
+  putU16(&file, IFDOffset + 4, 2);     // ASCII
+  putU32(&file, IFDOffset + 6, 10);    // count
+  putU32(&file, IFDOffset + 10, MakeOffset);
+  putU32(&file, IFDOffset + 14, 0); // no next IFD
+
+  const char make[] = "RawSpeed!";
+  std::copy_n(make, sizeof(make), file.begin() + MakeOffset);
+  return file;
+}
+
+} // namespace
+
+TEST(TiffParserTest, FetchStructureFetchesOnlyTheStructure) {
+  const std::vector<uint8_t> file = makeTiff();
+  CallbackInputSource source(
+      FileSize, [&file](Buffer::size_type offset, Array1DRef<uint8_t> out) {
+        std::copy_n(file.begin() + offset, out.size(), out.begin());
+      });
+  BlockCachedInput input(&source);
+
+  TiffParser::fetchStructure(&input);
+
+  EXPECT_TRUE(input.isFetched(0, 8));
+  EXPECT_TRUE(input.isFetched(IFDOffset, 2 + 12 + 4));
+  EXPECT_TRUE(input.isFetched(MakeOffset, 10));
+  EXPECT_EQ(input.getNumFetchedBlocks(), 3);
+
+  const auto root = TiffParser::parse(nullptr, input.getSparseBuffer());
+  EXPECT_EQ(root->getEntryRecursive(rawspeed::TiffTag::MAKE)->getString(),
+            "RawSpeed!");
+}
+
+} // namespace rawspeed_test